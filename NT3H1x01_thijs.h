@@ -190,9 +190,7 @@ TO write (specific functions):
 - printConfig() (print contents of Session registers, LAST_NDEF_BLOCK, etc. in a LEGIBLE fashion)
 - (arbetrary file writing funtion (mostly setting LAST_NDEF_BLOCK to indicate the size))
 - block writing/reading to/from file/flash/EEPROM/idk   (2kB of data coming from somewhere, going to somewhere!)
-- static lock functions (_setStaticLockBits, staticLockPage, _staticBlockLockPageToChunk, staticBlockLockChunks)
-- dynamic lock functions (_setDynamicLockBits, _dynamicLockPageToChunk, dynamicLockChunks, _dynamicBlockLockPageToChunk, dynamicBlockLockChunks)
-- generalized lock function: lockArea(startBlock,endBlock,roundUp=true)
+- unlocking (clearing lock bits from I2C, if the IC allows it at all)
 - Memory-Mirror mode functions
 - Pass-Through mode functions
 - check ATQA bytes to verify UID size (find what ATQA and SAK are defined as in NFC spec)
@@ -205,8 +203,23 @@ TO write (specific functions):
 #ifndef NT3H1x01_thijs_h
 #define NT3H1x01_thijs_h
 
-#include "Arduino.h"
+#if defined(NT3H1x01_useSimulator) && !defined(ARDUINO) // simulating on a host PC (no Arduino core available), see _NT3H1x01_thijs_sim.h
+  #include <stdint.h>
+  #include <stddef.h>
+  #ifndef constrain
+    #define constrain(amt,low,high) ((amt)<(low)?(low):((amt)>(high)?(high):(amt)))
+  #endif
+#else
+  #include "Arduino.h"
+#endif
+
 
+//#define NT3H1x01_useSimulator   // talk to a simulated tag (NT3H1x01_simTag, in RAM) instead of real hardware. Also works on a host PC (without Arduino core)
+
+//#define NT3H1x01_trace   // record every I2C transaction into a ring buffer (yourTag.trace), see _NT3H1x01_thijs_trace.h
+//#define NT3H1x01_capture   // stream every I2C transaction (with data) to a binary log (yourTag.capture), for replaying into the simulator, see _NT3H1x01_thijs_capture.h
+//#define NT3H1x01_retries   // retry failed I2C transactions (up to yourTag.maxRetries times, counted in stats.retries)
+//#define NT3H1x01_stats   // keep running bus statistics (yourTag.stats: transactions, bytes, EEPROM writes, cache hits, latency per public function), ~1.5kB of RAM, see _NT3H1x01_thijs_stats.h
 
 //#define NT3H1x01_unlock_burning   // enable the permanent chip-burning features of the NT3H1x01 (e.g. REG_LOCK)
 
@@ -248,6 +261,9 @@ static const uint8_t  NT3H1x01_CAPA_CONT_DEFAULT[2][4] = {{0xE1,0x10,0x6D,0x00},
 #define NT3H1201_DYNA_LOCK_MEMA 0x78            // Dynamic Locking bytes memory block for the 2k variant
 #define NT3H1101_DYNA_LOCK_RFUI_bits 0xFF0F3F00   // Dynamic Locking RFUI mask for the 1k variant (RFU = Reserved for Future Use)
 #define NT3H1201_DYNA_LOCK_RFUI_bits 0xFF7FFF00   // Dynamic Locking RFUI mask for the 2k variant
+#define NT3H1x01_DYNA_LOCK_FIRST_MEMA 0x04      // first block covered by Dynamic Locking (page 0x10), the ones before it are covered by Static Locking
+#define NT3H1101_DYNA_LOCK_CHUNK_BLOCKS 4       // blocks locked by 1 Dynamic Locking bit on the 1k variant (16 pages)
+#define NT3H1201_DYNA_LOCK_CHUNK_BLOCKS 8       // blocks locked by 1 Dynamic Locking bit on the 2k variant (32 pages)
 
 #define NT3H1101_CONF_REGS_MEMA 0x3A            // Configuration registers memory block for the 1k variant
 #define NT3H1201_CONF_REGS_MEMA 0x7A            // Configuration registers memory block for the 2k variant
@@ -256,6 +272,154 @@ static const uint8_t  NT3H1x01_CAPA_CONT_DEFAULT[2][4] = {{0xE1,0x10,0x6D,0x00},
 #define NT3H1x01_INVALID_MEMA   0xFF // ther are several invalid memory block addresses, but this is the most recognisable one
 // other invalid addresses include: 0x79, (0x3B@1k/0x7B@2k)~0xF7, 0xFC~0xFD
 
+#define NT3H1x01_SRAM_MEMA_START 0xF8           // SRAM (64 bytes) memory blocks, accessible from I2C at all times (for Pass-Through and Memory-Mirror modes)
+#define NT3H1x01_SRAM_MEMA_END   0xFB
+
+//// TLV block types (NFC Forum Type 2 Tag spec):
+#define NT3H1x01_TLV_NULL        0x00 // padding (no length byte)
+#define NT3H1x01_TLV_LOCK_CTRL   0x01 // Lock Control
+#define NT3H1x01_TLV_MEM_CTRL    0x02 // Memory Control
+#define NT3H1x01_TLV_NDEF        0x03 // NDEF message
+#define NT3H1x01_TLV_PROPRIETARY 0xFD
+#define NT3H1x01_TLV_TERMINATOR  0xFE // end of the TLV list (no length byte)
+#define NT3H1x01_TLV_LONG_LENGTH 0xFF // a length byte of 0xFF means the next 2 bytes hold the (big-endian) length
+
+enum NT3H1x01_VARIANT_ENUM : uint8_t { // which variant the NT3H1x01 class template is specialized for
+  NT3H1x01_VARIANT_1k = 0,      // NT3H1101 (fixed at compile-time)
+  NT3H1x01_VARIANT_2k = 1,      // NT3H1201 (fixed at compile-time)
+  NT3H1x01_VARIANT_RUNTIME = 2  // decided at runtime (by the is2kVariant constructor argument), this is what NT3H1x01_thijs uses
+};
+
+/**
+ * a (constexpr) description of the I2C memory map of one variant, see NT3H1x01_getMemMap().
+ * all the 1k/2k differences are in here, so the rest of the code doesn't need to check is2kVariant all over the place
+ */
+struct NT3H1x01_memMap
+{
+  uint8_t userStart;      // first block of user memory
+  uint8_t userEnd;        // last block (partially) holding user memory
+  uint8_t userEndBytes;   // how many bytes of userEnd are user memory (the 1k variant shares that block with the Dynamic Locking bytes)
+  uint16_t userBytes;     // total user memory in bytes (888 or 1904)
+  uint8_t dynaLockMEMA;   // Dynamic Locking bytes memory block
+  uint8_t dynaLockByte;   // where in that block the (3) Dynamic Locking bytes start
+  uint32_t dynaLockRFUI;  // Dynamic Locking RFUI mask (RFU = Reserved for Future Use)
+  uint8_t confRegsMEMA;   // Configuration registers memory block
+  uint8_t ccSizeByte;     // the memory size byte of the Capability Container (CC byte 2)
+  uint8_t dynaLockChunk;  // how many blocks 1 Dynamic Locking bit locks
+
+  constexpr bool isUserBlock(uint8_t blockAddress) const { return((blockAddress >= userStart) && (blockAddress <= userEnd)); }
+  constexpr bool isSRAMBlock(uint8_t blockAddress) const { return((blockAddress >= NT3H1x01_SRAM_MEMA_START) && (blockAddress <= NT3H1x01_SRAM_MEMA_END)); }
+  constexpr bool isValidBlock(uint8_t blockAddress) const { // whether the IC would ACK this memory address
+    return((blockAddress <= dynaLockMEMA) || (blockAddress == confRegsMEMA) || isSRAMBlock(blockAddress) || (blockAddress == NT3H1x01_SESS_REGS_MEMA)); }
+  constexpr uint8_t userBytesInBlock(uint8_t blockAddress) const { return(isUserBlock(blockAddress) ? ((blockAddress == userEnd) ? userEndBytes : NT3H1x01_BLOCK_SIZE) : 0); }
+};
+
+/**
+ * get the memory map of a variant (constexpr, so with a compile-time variant all of this folds away)
+ * @param is2kVariant true for the NT3H1201, false for the NT3H1101
+ * @return the memory map
+ */
+constexpr NT3H1x01_memMap NT3H1x01_getMemMap(bool is2kVariant) {
+  return(is2kVariant ? NT3H1x01_memMap{0x01, 0x77, 16, 1904, NT3H1201_DYNA_LOCK_MEMA, 0, NT3H1201_DYNA_LOCK_RFUI_bits, NT3H1201_CONF_REGS_MEMA, 0xEA, NT3H1201_DYNA_LOCK_CHUNK_BLOCKS}
+                     : NT3H1x01_memMap{0x01, 0x38,  8,  888, NT3H1101_DYNA_LOCK_MEMA, 8, NT3H1101_DYNA_LOCK_RFUI_bits, NT3H1101_CONF_REGS_MEMA, 0x6D, NT3H1101_DYNA_LOCK_CHUNK_BLOCKS});
+}
+
+/**
+ * a set of lock bits, laid out like the Static and Dynamic Locking bytes, see lockArea() and NT3H1x01_lockBitsForArea()
+ */
+struct NT3H1x01_lockBits
+{
+  uint16_t staticBits;   // Static Locking bytes (block 0x00, bytes 10~11), byte 10 in the LSB: bit N locks page N (pages 3~15), bits 0~2 are the block-locking bits
+  uint32_t dynamicBits;  // Dynamic Locking bytes 0~2, byte 0 in the LSB: bit N locks chunk N (see memMap().dynaLockChunk), bits 16~23 are the block-locking bits (2 chunks each)
+
+  constexpr NT3H1x01_lockBits operator|(const NT3H1x01_lockBits& other) const { return(NT3H1x01_lockBits{(uint16_t)(staticBits | other.staticBits), dynamicBits | other.dynamicBits}); }
+  constexpr bool intersects(const NT3H1x01_lockBits& other) const { return((staticBits & other.staticBits) || (dynamicBits & other.dynamicBits)); }
+  constexpr bool covers(const NT3H1x01_lockBits& other) const { return(((other.staticBits & ~staticBits) == 0) && ((other.dynamicBits & ~dynamicBits) == 0)); }
+};
+
+/**
+ * (private) bits first~last (inclusive) set, 0 if last < first
+ */
+constexpr uint32_t _NT3H1x01_bitRange(int first, int last) { return((last < first) ? 0 : ((2UL << last) - (1UL << first))); }
+/**
+ * the Static Locking bits for an area: block 0x00 only has the CC page (3) to lock, blocks 0x01~0x03 are pages 4~15 (blocks past that are Dynamic Locking)
+ * @param startBlock MEMory Address (MEMA) of the first block
+ * @param endBlock MEMA of the last block (inclusive)
+ * @return the lock bits (see NT3H1x01_lockBits::staticBits)
+ */
+constexpr uint16_t NT3H1x01_staticLockBitsForArea(uint8_t startBlock, uint8_t endBlock) {
+  return(((startBlock >= NT3H1x01_DYNA_LOCK_FIRST_MEMA) || (startBlock > endBlock)) ? 0
+         : (uint16_t)_NT3H1x01_bitRange((startBlock == 0) ? 3 : (4 * startBlock), (4 * ((endBlock < NT3H1x01_DYNA_LOCK_FIRST_MEMA) ? endBlock : (NT3H1x01_DYNA_LOCK_FIRST_MEMA - 1))) + 3)); }
+/**
+ * (private) NT3H1x01_dynamicLockBitsForArea(), for an area that's already clamped to the Dynamic Locking range
+ */
+constexpr uint32_t _NT3H1x01_dynamicLockBits(const NT3H1x01_memMap& map, int startBlock, int endBlock, bool roundUp) {
+  return((startBlock > endBlock) ? 0
+         : roundUp ? _NT3H1x01_bitRange((startBlock - NT3H1x01_DYNA_LOCK_FIRST_MEMA) / map.dynaLockChunk, (endBlock - NT3H1x01_DYNA_LOCK_FIRST_MEMA) / map.dynaLockChunk)
+                   : _NT3H1x01_bitRange((startBlock - NT3H1x01_DYNA_LOCK_FIRST_MEMA + map.dynaLockChunk - 1) / map.dynaLockChunk,  // (only whole chunks, the last one may be cut short by the end of the user memory)
+                                        (endBlock == map.userEnd) ? ((endBlock - NT3H1x01_DYNA_LOCK_FIRST_MEMA) / map.dynaLockChunk) : (((endBlock - NT3H1x01_DYNA_LOCK_FIRST_MEMA + 1) / map.dynaLockChunk) - 1))); }
+/**
+ * the Dynamic Locking bits for an area (each bit locks a chunk of memMap().dynaLockChunk blocks, from block 0x04 onwards)
+ * @param map the memory map of the variant
+ * @param startBlock MEMory Address (MEMA) of the first block
+ * @param endBlock MEMA of the last block (inclusive)
+ * @param roundUp true to lock every chunk the area touches (may lock more than the area), false for only the chunks entirely inside it (may lock less)
+ * @return the lock bits (see NT3H1x01_lockBits::dynamicBits), NOT masked with the RFUI mask (see NT3H1x01_lockBitsUsable())
+ */
+constexpr uint32_t NT3H1x01_dynamicLockBitsForArea(const NT3H1x01_memMap& map, uint8_t startBlock, uint8_t endBlock, bool roundUp=true) {
+  return(_NT3H1x01_dynamicLockBits(map, (startBlock < NT3H1x01_DYNA_LOCK_FIRST_MEMA) ? NT3H1x01_DYNA_LOCK_FIRST_MEMA : startBlock, (endBlock > map.userEnd) ? map.userEnd : endBlock, roundUp)); }
+/**
+ * the block-locking bits that freeze a set of lock bits (so they can't be changed from RF anymore)
+ * Static: bit 0 for the CC page, bit 1 for pages 4~9, bit 2 for pages 10~15. Dynamic: bit 16+N for chunks 2N and 2N+1
+ * @param bits the lock bits
+ * @param i (private, recursion) which Dynamic block-locking bit to start at
+ * @return just the block-locking bits
+ */
+constexpr NT3H1x01_lockBits NT3H1x01_blockLockBitsFor(const NT3H1x01_lockBits& bits, uint8_t i=0) {
+  return((i >= 8) ? NT3H1x01_lockBits{(uint16_t)(((bits.staticBits & 0x0008) ? 0b001 : 0) | ((bits.staticBits & 0x03F0) ? 0b010 : 0) | ((bits.staticBits & 0xFC00) ? 0b100 : 0)), 0}
+                  : (NT3H1x01_lockBits{0, ((bits.dynamicBits >> (2*i)) & 0b11) ? ((uint32_t)1 << (16 + i)) : (uint32_t)0} | NT3H1x01_blockLockBitsFor(bits, i+1))); }
+/**
+ * all the lock bits to lock an area (what lockArea() sets)
+ * @param map the memory map of the variant
+ * @param startBlock MEMory Address (MEMA) of the first block
+ * @param endBlock MEMA of the last block (inclusive)
+ * @param roundUp (only matters for Dynamic Locking, Static Locking is per page) see NT3H1x01_dynamicLockBitsForArea()
+ * @param blockLock whether to also set the block-locking bits for them (see NT3H1x01_blockLockBitsFor())
+ * @return the lock bits
+ */
+constexpr NT3H1x01_lockBits NT3H1x01_lockBitsForArea(const NT3H1x01_memMap& map, uint8_t startBlock, uint8_t endBlock, bool roundUp=true, bool blockLock=false) {
+  return(blockLock ? (NT3H1x01_lockBitsForArea(map, startBlock, endBlock, roundUp, false) | NT3H1x01_blockLockBitsFor(NT3H1x01_lockBitsForArea(map, startBlock, endBlock, roundUp, false)))
+                   : NT3H1x01_lockBits{NT3H1x01_staticLockBitsForArea(startBlock, endBlock), NT3H1x01_dynamicLockBitsForArea(map, startBlock, endBlock, roundUp)}); }
+/**
+ * the Dynamic Locking bits that are NOT RFUI (memMap().dynaLockRFUI has the lock bytes MSByte first, this is LSByte first, like NT3H1x01_lockBits::dynamicBits)
+ * @param map the memory map of the variant
+ */
+constexpr uint32_t NT3H1x01_dynamicLockUsableBits(const NT3H1x01_memMap& map) {
+  return(((map.dynaLockRFUI >> 24) & 0xFF) | (((map.dynaLockRFUI >> 16) & 0xFF) << 8) | (((map.dynaLockRFUI >> 8) & 0xFF) << 16)); }
+/**
+ * whether a set of lock bits can actually be set (none of them are RFUI)
+ * @param map the memory map of the variant
+ * @param bits the lock bits
+ */
+constexpr bool NT3H1x01_lockBitsUsable(const NT3H1x01_memMap& map, const NT3H1x01_lockBits& bits) { return((bits.dynamicBits & ~NT3H1x01_dynamicLockUsableBits(map)) == 0); }
+
+static_assert(NT3H1x01_lockBitsForArea(NT3H1x01_getMemMap(false), 0x01, 0x01).staticBits == 0x00F0, "block 0x01 is pages 4~7");
+static_assert(NT3H1x01_lockBitsForArea(NT3H1x01_getMemMap(true), 0x01, 0x77, true, true).covers(NT3H1x01_lockBits{0xFFF6, 0xFF7FFF}), "the whole 2k user memory");
+static_assert(NT3H1x01_dynamicLockBitsForArea(NT3H1x01_getMemMap(false), 0x05, 0x0C, false) == 0b10, "only 0x08~0x0B is a whole chunk");
+
+/**
+ * everything in block 0, as read by probe()
+ */
+struct NT3H1x01_deviceInfo
+{
+  uint8_t UID[7];         // Serial Number (UID[0] is the manufacturer ID)
+  uint8_t SAK;
+  uint8_t ATQA[2];
+  uint8_t staticLock[2];  // Static Locking bytes
+  uint8_t CC[4];          // Capability Container
+  bool is2kVariant;       // what the CC memory size byte says
+};
+
 enum NT3H1x01_CONF_SESS_REGS_ENUM : uint8_t { // you could also do this with just defines, but it's slightly fancier this way
 //// configuration/session registers common:
   NT3H1x01_COMN_REGS_NC_REG_BYTE = 0,  // NC_REG register location in the conf/sess. registers
@@ -290,6 +454,11 @@ enum NT3H1x01_FD_OFF_ENUM : uint8_t { // 2bit value to determine what triggers t
   NT3H1x01_FD_OFF_LAST_NDEF_READ = 2, // (RF field gone or) last block of data has been read (defined by LAST_NDEF_BLOCK)
   NT3H1x01_FD_OFF_PTHRU_MODE     = 3  // (in Pass-Through mode and FD_ON set to NT3H1x01_FD_ON_PTHRU_MODE) (RF field gone or) data in buffer: has-been-read-by-I2C OR ready-to-be-read-by-RF
 };
+enum NT3H1x01_AUTO_LAST_NDEF_ENUM : uint8_t { // whether the user memory write functions keep LAST_NDEF_BLOCK up to date (see autoLastNdefBlock and updateLastNdefBlock())
+  NT3H1x01_AUTO_LAST_NDEF_OFF  = 0, // LAST_NDEF_BLOCK is left alone (default)
+  NT3H1x01_AUTO_LAST_NDEF_SESS = 1, // the Session register is kept up to date (it's reloaded from the Configuration register at a reset)
+  NT3H1x01_AUTO_LAST_NDEF_BOTH = 2  // the Session and Configuration registers are kept up to date (the Configuration register is an EEPROM write, but only when it changes)
+};
 
 //// NC_REG common:
 #define NT3H1x01_NC_REG_I2C_RST_bits  0b10000000 // I2C_RST_ON_OFF enables soft-reset through repeated starts in I2C communication (very cool, slightly niche)
@@ -314,21 +483,373 @@ enum NT3H1x01_FD_OFF_ENUM : uint8_t { // 2bit value to determine what triggers t
 #define NT3H1x01_NS_REG_EPR_WR_BSY_bits 0b00000010 // EEPROM_WR_BUSY is 1 if EEPROM writing is in progress (access is disabled while writing)
 #define NT3H1x01_NS_REG_RF_FIELD_bits   0b00000001 // RF_FIELD_PRESENT is 1 if an RF field is detected
 
+//// register field descriptors (for the generic get<FIELD>() and set<FIELDS...>() functions):
+enum NT3H1x01_FIELD_REGS_ENUM : uint8_t { // which set of registers a field lives in
+  NT3H1x01_FIELD_SESS = 0, // Session registers (special 1-byte read/write format, with a mask byte)
+  NT3H1x01_FIELD_CONF = 1  // Configuration registers (a normal memory block, so setting bits means read-modify-write)
+};
+enum NT3H1x01_FIELD_ACCESS_ENUM : uint8_t {
+  NT3H1x01_FIELD_RW   = 0, // Read/Write
+  NT3H1x01_FIELD_RO   = 1, // Read-only
+  NT3H1x01_FIELD_BURN = 2  // one-time-program burn bits, only writable if NT3H1x01_unlock_burning is defined
+};
+
+/**
+ * (private) the position of the lowest set bit in a mask (constexpr, so it folds away)
+ */
+constexpr uint8_t _NT3H1x01_maskShift(uint8_t mask) { return((mask & 0x01) ? 0 : (1 + _NT3H1x01_maskShift(mask >> 1))); }
+
+/**
+ * a (constexpr) description of one field of the Configuration/Session registers: where it is, and how to encode/decode it
+ * @tparam REGS_T Session or Configuration registers
+ * @tparam REG_T which register byte (use NT3H1x01_CONF_SESS_REGS_ENUM enum)
+ * @tparam MASK_T which bits of the register byte are this field
+ * @tparam VAL_T the (decoded) type of the field
+ * @tparam ACCESS_T whether the I2C master may write this field
+ */
+template<NT3H1x01_FIELD_REGS_ENUM REGS_T, NT3H1x01_CONF_SESS_REGS_ENUM REG_T, uint8_t MASK_T, typename VAL_T, NT3H1x01_FIELD_ACCESS_ENUM ACCESS_T=NT3H1x01_FIELD_RW>
+struct NT3H1x01_regField
+{
+  static_assert(MASK_T != 0, "NT3H1x01_regField mask can't be 0");
+  typedef VAL_T valType;
+  static constexpr NT3H1x01_FIELD_REGS_ENUM regs() { return(REGS_T); }
+  static constexpr NT3H1x01_CONF_SESS_REGS_ENUM reg() { return(REG_T); }
+  static constexpr uint8_t mask() { return(MASK_T); }
+  static constexpr uint8_t shift() { return(_NT3H1x01_maskShift(MASK_T)); }
+  static constexpr NT3H1x01_FIELD_ACCESS_ENUM access() { return(ACCESS_T); }
+  static constexpr bool writable() {
+    #ifdef NT3H1x01_unlock_burning
+      return(ACCESS_T != NT3H1x01_FIELD_RO);
+    #else
+      return(ACCESS_T == NT3H1x01_FIELD_RW);
+    #endif
+  }
+  static constexpr uint8_t encode(VAL_T newVal) { return((static_cast<uint8_t>(newVal) << shift()) & MASK_T); } // field value -> (masked) register byte
+  static constexpr VAL_T decode(uint8_t regByte) { return(static_cast<VAL_T>((regByte & MASK_T) >> shift())); } // register byte -> field value
+};
+
+/**
+ * the name of a field (and the labels its get<>()/getVal<>()/set<>() calls get in the stats, see NT3H1x01_STATS_API_NAMED()), specialized by NT3H1x01_REG_FIELD().
+ * Fields that are declared some other way all share the "?" name
+ */
+template<typename FIELD_T>
+struct NT3H1x01_fieldName
+{
+  static constexpr const char* name() { return("?"); }
+  static constexpr const char* getLabel() { return("get<?>"); }
+  static constexpr const char* getValLabel() { return("getVal<?>"); }
+  static constexpr const char* setLabel() { return("set<?>"); }
+};
+#define NT3H1x01_REG_FIELD(NAME, ...)  typedef NT3H1x01_regField<__VA_ARGS__> NAME; /* declare a field (see NT3H1x01_regField) and its name */ \
+  template<> struct NT3H1x01_fieldName<NAME> { static constexpr const char* name() { return(#NAME); }  static constexpr const char* getLabel() { return("get<" #NAME ">"); } \
+    static constexpr const char* getValLabel() { return("getVal<" #NAME ">"); }  static constexpr const char* setLabel() { return("set<" #NAME ">"); } }
+
+/**
+ * (private) a group of fields that is written in one go by set<FIELDS...>(), combines the masks and checks whether that's actually possible
+ */
+template<typename... FIELDS_T> struct _NT3H1x01_regFieldGroup;
+template<typename FIELD_T> struct _NT3H1x01_regFieldGroup<FIELD_T>
+{
+  static constexpr NT3H1x01_FIELD_REGS_ENUM regs() { return(FIELD_T::regs()); }
+  static constexpr NT3H1x01_CONF_SESS_REGS_ENUM reg() { return(FIELD_T::reg()); }
+  static constexpr uint8_t mask() { return(FIELD_T::mask()); }
+  static constexpr bool sameReg() { return(true); }
+  static constexpr bool noOverlap() { return(true); }
+  static constexpr bool writable() { return(FIELD_T::writable()); }
+  static constexpr uint8_t encode(typename FIELD_T::valType newVal) { return(FIELD_T::encode(newVal)); }
+};
+template<typename FIELD_T, typename... REST_T> struct _NT3H1x01_regFieldGroup<FIELD_T, REST_T...>
+{
+  typedef _NT3H1x01_regFieldGroup<REST_T...> _rest;
+  static constexpr NT3H1x01_FIELD_REGS_ENUM regs() { return(FIELD_T::regs()); }
+  static constexpr NT3H1x01_CONF_SESS_REGS_ENUM reg() { return(FIELD_T::reg()); }
+  static constexpr uint8_t mask() { return(FIELD_T::mask() | _rest::mask()); }
+  static constexpr bool sameReg() { return((FIELD_T::regs() == _rest::regs()) && (FIELD_T::reg() == _rest::reg()) && _rest::sameReg()); }
+  static constexpr bool noOverlap() { return(((FIELD_T::mask() & _rest::mask()) == 0) && _rest::noOverlap()); }
+  static constexpr bool writable() { return(FIELD_T::writable() && _rest::writable()); }
+  static constexpr uint8_t encode(typename FIELD_T::valType newVal, typename REST_T::valType... restVals) { return(FIELD_T::encode(newVal) | _rest::encode(restVals...)); }
+};
+
+//// Session register fields:
+NT3H1x01_REG_FIELD(NT3H1x01_Sess_NC_I2C_RST, NT3H1x01_FIELD_SESS, NT3H1x01_COMN_REGS_NC_REG_BYTE, NT3H1x01_NC_REG_I2C_RST_bits, bool);
+NT3H1x01_REG_FIELD(NT3H1x01_Sess_NC_PTHRU, NT3H1x01_FIELD_SESS, NT3H1x01_COMN_REGS_NC_REG_BYTE, NT3H1x01_NC_REG_PTHRU_bits, bool);
+NT3H1x01_REG_FIELD(NT3H1x01_Sess_NC_FD_OFF, NT3H1x01_FIELD_SESS, NT3H1x01_COMN_REGS_NC_REG_BYTE, NT3H1x01_NC_REG_FD_OFF_bits, NT3H1x01_FD_OFF_ENUM);
+NT3H1x01_REG_FIELD(NT3H1x01_Sess_NC_FD_ON, NT3H1x01_FIELD_SESS, NT3H1x01_COMN_REGS_NC_REG_BYTE, NT3H1x01_NC_REG_FD_ON_bits, NT3H1x01_FD_ON_ENUM);
+NT3H1x01_REG_FIELD(NT3H1x01_Sess_NC_MIRROR, NT3H1x01_FIELD_SESS, NT3H1x01_COMN_REGS_NC_REG_BYTE, NT3H1x01_NC_REG_MIRROR_bits, bool);
+NT3H1x01_REG_FIELD(NT3H1x01_Sess_NC_DIR, NT3H1x01_FIELD_SESS, NT3H1x01_COMN_REGS_NC_REG_BYTE, NT3H1x01_NC_REG_DIR_bits, bool);
+NT3H1x01_REG_FIELD(NT3H1x01_Sess_LAST_NDEF_BLOCK, NT3H1x01_FIELD_SESS, NT3H1x01_COMN_REGS_LAST_NDEF_BLOCK_BYTE, 0xFF, uint8_t);
+NT3H1x01_REG_FIELD(NT3H1x01_Sess_SRAM_MIRROR_BLOCK, NT3H1x01_FIELD_SESS, NT3H1x01_COMN_REGS_SRAM_MIRROR_BLOCK_BYTE, 0xFF, uint8_t);
+NT3H1x01_REG_FIELD(NT3H1x01_Sess_WDT_LS, NT3H1x01_FIELD_SESS, NT3H1x01_COMN_REGS_WDT_LS_BYTE, 0xFF, uint8_t);
+NT3H1x01_REG_FIELD(NT3H1x01_Sess_WDT_MS, NT3H1x01_FIELD_SESS, NT3H1x01_COMN_REGS_WDT_MS_BYTE, 0xFF, uint8_t);
+NT3H1x01_REG_FIELD(NT3H1x01_Sess_I2C_CLOCK_STR, NT3H1x01_FIELD_SESS, NT3H1x01_COMN_REGS_I2C_CLOCK_STR_BYTE, 0x01, bool, NT3H1x01_FIELD_RO); // (Read-only in Sess.)
+NT3H1x01_REG_FIELD(NT3H1x01_NS_NDEF_DATA_READ, NT3H1x01_FIELD_SESS, NT3H1x01_SESS_REGS_NS_REG_BYTE, NT3H1x01_NS_REG_NDEF_READ_bits, bool, NT3H1x01_FIELD_RO);
+NT3H1x01_REG_FIELD(NT3H1x01_NS_I2C_LOCKED, NT3H1x01_FIELD_SESS, NT3H1x01_SESS_REGS_NS_REG_BYTE, NT3H1x01_NS_REG_I2C_LOCKED_bits, bool);
+NT3H1x01_REG_FIELD(NT3H1x01_NS_RF_LOCKED, NT3H1x01_FIELD_SESS, NT3H1x01_SESS_REGS_NS_REG_BYTE, NT3H1x01_NS_REG_RF_LOCKED_bits, bool, NT3H1x01_FIELD_RO);
+NT3H1x01_REG_FIELD(NT3H1x01_NS_SRAM_I2C_READY, NT3H1x01_FIELD_SESS, NT3H1x01_SESS_REGS_NS_REG_BYTE, NT3H1x01_NS_REG_PTHRU_IN_bits, bool, NT3H1x01_FIELD_RO);
+NT3H1x01_REG_FIELD(NT3H1x01_NS_SRAM_RF_READY, NT3H1x01_FIELD_SESS, NT3H1x01_SESS_REGS_NS_REG_BYTE, NT3H1x01_NS_REG_PTHRU_OUT_bits, bool, NT3H1x01_FIELD_RO);
+NT3H1x01_REG_FIELD(NT3H1x01_NS_EEPROM_WR_ERR, NT3H1x01_FIELD_SESS, NT3H1x01_SESS_REGS_NS_REG_BYTE, NT3H1x01_NS_REG_EPR_WR_ERR_bits, bool); // (can only be cleared)
+NT3H1x01_REG_FIELD(NT3H1x01_NS_EEPROM_WR_BUSY, NT3H1x01_FIELD_SESS, NT3H1x01_SESS_REGS_NS_REG_BYTE, NT3H1x01_NS_REG_EPR_WR_BSY_bits, bool, NT3H1x01_FIELD_RO);
+NT3H1x01_REG_FIELD(NT3H1x01_NS_RF_FIELD_PRESENT, NT3H1x01_FIELD_SESS, NT3H1x01_SESS_REGS_NS_REG_BYTE, NT3H1x01_NS_REG_RF_FIELD_bits, bool, NT3H1x01_FIELD_RO);
+//// Configuration register fields: (NC_REG has no PTHRU and MIRROR bits here, they're RFU)
+NT3H1x01_REG_FIELD(NT3H1x01_Conf_NC_I2C_RST, NT3H1x01_FIELD_CONF, NT3H1x01_COMN_REGS_NC_REG_BYTE, NT3H1x01_NC_REG_I2C_RST_bits, bool);
+NT3H1x01_REG_FIELD(NT3H1x01_Conf_NC_FD_OFF, NT3H1x01_FIELD_CONF, NT3H1x01_COMN_REGS_NC_REG_BYTE, NT3H1x01_NC_REG_FD_OFF_bits, NT3H1x01_FD_OFF_ENUM);
+NT3H1x01_REG_FIELD(NT3H1x01_Conf_NC_FD_ON, NT3H1x01_FIELD_CONF, NT3H1x01_COMN_REGS_NC_REG_BYTE, NT3H1x01_NC_REG_FD_ON_bits, NT3H1x01_FD_ON_ENUM);
+NT3H1x01_REG_FIELD(NT3H1x01_Conf_NC_DIR, NT3H1x01_FIELD_CONF, NT3H1x01_COMN_REGS_NC_REG_BYTE, NT3H1x01_NC_REG_DIR_bits, bool);
+NT3H1x01_REG_FIELD(NT3H1x01_Conf_LAST_NDEF_BLOCK, NT3H1x01_FIELD_CONF, NT3H1x01_COMN_REGS_LAST_NDEF_BLOCK_BYTE, 0xFF, uint8_t);
+NT3H1x01_REG_FIELD(NT3H1x01_Conf_SRAM_MIRROR_BLOCK, NT3H1x01_FIELD_CONF, NT3H1x01_COMN_REGS_SRAM_MIRROR_BLOCK_BYTE, 0xFF, uint8_t);
+NT3H1x01_REG_FIELD(NT3H1x01_Conf_WDT_LS, NT3H1x01_FIELD_CONF, NT3H1x01_COMN_REGS_WDT_LS_BYTE, 0xFF, uint8_t);
+NT3H1x01_REG_FIELD(NT3H1x01_Conf_WDT_MS, NT3H1x01_FIELD_CONF, NT3H1x01_COMN_REGS_WDT_MS_BYTE, 0xFF, uint8_t);
+NT3H1x01_REG_FIELD(NT3H1x01_Conf_I2C_CLOCK_STR, NT3H1x01_FIELD_CONF, NT3H1x01_COMN_REGS_I2C_CLOCK_STR_BYTE, 0x01, bool);
+NT3H1x01_REG_FIELD(NT3H1x01_Conf_REG_LOCK_I2C, NT3H1x01_FIELD_CONF, NT3H1x01_CONF_REGS_REG_LOCK_BYTE, NT3H1x01_NC_REG_LOCK_I2C_bits, bool, NT3H1x01_FIELD_BURN);
+NT3H1x01_REG_FIELD(NT3H1x01_Conf_REG_LOCK_RF, NT3H1x01_FIELD_CONF, NT3H1x01_CONF_REGS_REG_LOCK_BYTE, NT3H1x01_NC_REG_LOCK_RF_bits, bool, NT3H1x01_FIELD_BURN);
+
+/**
+ * the desired state of (some of) the Configuration and Session registers, for applyConfiguration()
+ * only the fields you set are checked/written, everything else is left as it is on the tag.
+ *  e.g.: NT3H1x01_desiredConfig desired;  desired.set<NT3H1x01_Conf_NC_FD_ON>(NT3H1x01_FD_ON_TAG_SELECTED);  desired.set<NT3H1x01_Conf_WDT_LS>(0x48);
+ */
+struct NT3H1x01_desiredConfig
+{
+  uint8_t conf[7] = {0};     // desired Configuration register bytes (only the bits in confMask matter)
+  uint8_t confMask[7] = {0}; // which bits of the Configuration registers to enforce
+  uint8_t sess[7] = {0};     // desired Session register bytes (only the bits in sessMask matter)
+  uint8_t sessMask[7] = {0}; // which bits of the Session registers to enforce
+
+  /**
+   * set the desired value of a field (read-only fields and burn bits are a compile error, like with set<>())
+   * @tparam FIELD_T the field (see NT3H1x01_regField typedefs, e.g. NT3H1x01_Conf_NC_FD_ON or NT3H1x01_Sess_NC_FD_ON)
+   * @param newVal the desired value
+   */
+  template<typename FIELD_T>
+  void set(typename FIELD_T::valType newVal) {
+    static_assert(FIELD_T::writable(), "NT3H1x01_desiredConfig::set<>() field is Read-only (or a burn bit, see NT3H1x01_unlock_burning)");
+    uint8_t* regs = (FIELD_T::regs() == NT3H1x01_FIELD_SESS) ? sess : conf;
+    uint8_t* mask = (FIELD_T::regs() == NT3H1x01_FIELD_SESS) ? sessMask : confMask;
+    regs[FIELD_T::reg()] = (regs[FIELD_T::reg()] & ~FIELD_T::mask()) | FIELD_T::encode(newVal);
+    mask[FIELD_T::reg()] |= FIELD_T::mask();
+  }
+  /**
+   * set the desired value of both the Configuration and the Session register byte (so it takes effect now AND after a reset)
+   * @param reg which register (use NT3H1x01_CONF_SESS_REGS_ENUM enum, but not NT3H1x01_CONF_REGS_REG_LOCK_BYTE/NT3H1x01_SESS_REGS_NS_REG_BYTE)
+   * @param newVal the desired value
+   * @param bitMask (optional) which bits of the register to enforce
+   */
+  void setBoth(NT3H1x01_CONF_SESS_REGS_ENUM reg, uint8_t newVal, uint8_t bitMask=0xFF) {
+    if(reg >= NT3H1x01_CONF_REGS_REG_LOCK_BYTE) { return; } // (REG_LOCK is burned, NS_REG is status)
+    conf[reg] = (conf[reg] & ~bitMask) | (newVal & bitMask);  confMask[reg] |= bitMask;
+    if(reg == NT3H1x01_COMN_REGS_NC_REG_BYTE) { confMask[reg] &= ~NT3H1x01_NC_REG_RFU_bits; } // (PTHRU and MIRROR are RFU in the Configuration registers)
+    if(reg == NT3H1x01_COMN_REGS_I2C_CLOCK_STR_BYTE) { return; } // (Read-only in the Session registers)
+    sess[reg] = (sess[reg] & ~bitMask) | (newVal & bitMask);  sessMask[reg] |= bitMask;
+  }
+  /**
+   * set the desired WDT value (in both the Configuration and the Session registers)
+   * @param rawVal WDT value (in units of 9.43us, see NT3H1x01_WDT_RAW_TO_MICROSECONDS)
+   */
+  void setBoth_WDTraw(uint16_t rawVal) { setBoth(NT3H1x01_COMN_REGS_WDT_LS_BYTE, rawVal & 0xFF);  setBoth(NT3H1x01_COMN_REGS_WDT_MS_BYTE, rawVal >> 8); } // (just a macro)
+};
+
+/**
+ * what applyConfiguration() found/did
+ */
+struct NT3H1x01_configChanges
+{
+  uint8_t confChanged = 0;  // which Configuration register bytes differed (bit i = register byte i), they were all written in 1 block write
+  uint8_t sessChanged = 0;  // which Session register bytes differed (bit i = register byte i), each one was written with a masked write
+  bool confLocked = false;  // the Configuration registers differed, but REG_LOCK_I2C is burned, so they could not be written
+  bool changedAnything() const { return(confChanged || sessChanged); }
+};
+
+
+
+#ifndef NT3H1x01_MICROS // timestamp source for the trace and stats features. You can define your own (e.g. a virtual clock) before including the library
+  #if defined(NT3H1x01_useSimulator) && defined(NT3H1x01_simVirtualClock) // use the simulated tag's virtual clock (deterministic), see _NT3H1x01_thijs_sim.h
+    inline uint32_t NT3H1x01_simMicros(); // (defined in _NT3H1x01_thijs_sim.h)
+    #define NT3H1x01_MICROS()  NT3H1x01_simMicros()
+  #elif defined(ARDUINO)
+    #define NT3H1x01_MICROS()  ((uint32_t)micros())
+  #else // host PC
+    #include <chrono>
+    #define NT3H1x01_MICROS()  ((uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count())
+  #endif
+#endif
+
+enum NT3H1x01_TRACE_OP_ENUM : uint8_t { // the transport primitives (used by the trace and stats features)
+  NT3H1x01_TRACE_READ_BLOCK  = 0, // requestMemBlock()
+  NT3H1x01_TRACE_READ_SESS   = 1, // requestSessRegByte()
+  NT3H1x01_TRACE_ONLY_READ   = 2, // _onlyReadBytes()
+  NT3H1x01_TRACE_WRITE_BLOCK = 3, // writeMemBlock()
+  NT3H1x01_TRACE_WRITE_SESS  = 4  // writeSessRegByte()
+};
+static const char* const NT3H1x01_TRACE_OP_NAMES[5] = {"READ_BLOCK", "READ_SESS", "ONLY_READ", "WRITE_BLOCK", "WRITE_SESS"};
 
 
 #include "_NT3H1x01_thijs_base.h" // this file holds all the nitty-gritty low-level stuff (I2C implementations (platform optimizations))
+#ifdef NT3H1x01_trace
+  #include "_NT3H1x01_thijs_trace.h"
+#endif
+#ifdef NT3H1x01_capture
+  #include "_NT3H1x01_thijs_capture.h"
+#endif
+#ifdef NT3H1x01_stats
+  #include "_NT3H1x01_thijs_stats.h"
+  #define NT3H1x01_STATS_API()  _NT3H1x01_statsApiTimer _statsApiTimer(stats, __func__) // times the rest of the function it's in (if it's the outermost public call)
+  #define NT3H1x01_STATS_API_NAMED(label)  _NT3H1x01_statsApiTimer _statsApiTimer(stats, label) // same, under a label instead of the function name (for the register field templates, which would all be "get" or "set")
+  #define NT3H1x01_STATS_CACHE(useCache, hit)  stats.countCache(useCache, hit)
+#else
+  #define NT3H1x01_STATS_API()  ;
+  #define NT3H1x01_STATS_API_NAMED(label)  ;
+  #define NT3H1x01_STATS_CACHE(useCache, hit)  ;
+#endif
 /**
  * An I2C interfacing library for the NT3H1x01 NFC IC
- * 
+ * @tparam VARIANT_T which variant to (compile-time) specialize for. NT3H1x01_VARIANT_1k or _2k let the compiler fold away all variant checks (smaller/faster code),
+ *                   NT3H1x01_VARIANT_RUNTIME (a.k.a. NT3H1x01_thijs) decides at runtime, based on the constructor argument
  */
-class NT3H1x01_thijs : public _NT3H1x01_thijs_base
+template<NT3H1x01_VARIANT_ENUM VARIANT_T>
+class NT3H1x01 : public _NT3H1x01_thijs_base
 {
   public:
   //private:
   uint8_t _oneBlockBuff[NT3H1x01_BLOCK_SIZE]; // used for user-friendly functions. A cache of 1 block of memory, to be used whenever less-than-a-whole-block is to be changed (less memory assignment overhead)
   uint8_t _oneBlockBuffAddress = NT3H1x01_INVALID_MEMA; // indicates the memory address the _oneBlockBuff stores. Use with great caution, and only if speed is an absolute necessity!
   public:
-  using _NT3H1x01_thijs_base::_NT3H1x01_thijs_base;
+  static const NT3H1x01_VARIANT_ENUM variant = VARIANT_T;
+
+  /**
+   * constructor
+   * @param is2kVariant (only used for NT3H1x01_VARIANT_RUNTIME) true for the NT3H1201, false for the NT3H1101. The compile-time variants just ignore this.
+   * @param address 7-bit I2C address
+   */
+  NT3H1x01(bool is2kVariant=(VARIANT_T == NT3H1x01_VARIANT_2k), uint8_t address=NT3H1x01_DEFAULT_I2C_ADDRESS) :
+    _NT3H1x01_thijs_base((VARIANT_T == NT3H1x01_VARIANT_RUNTIME) ? is2kVariant : (VARIANT_T == NT3H1x01_VARIANT_2k), address) {}
+
+  /**
+   * whether this is the 2k variant (a compile-time constant, unless VARIANT_T is NT3H1x01_VARIANT_RUNTIME)
+   */
+  bool _is2k() const { return((VARIANT_T == NT3H1x01_VARIANT_RUNTIME) ? is2kVariant : (VARIANT_T == NT3H1x01_VARIANT_2k)); }
+  /**
+   * the memory map of this variant (see NT3H1x01_memMap)
+   */
+  NT3H1x01_memMap memMap() const { return(NT3H1x01_getMemMap(_is2k())); }
+  /**
+   * (just a macro) the Configuration registers memory block of this variant
+   */
+  uint8_t _confRegsMEMA() const { return(memMap().confRegsMEMA); }
+
+  NT3H1x01_AUTO_LAST_NDEF_ENUM autoLastNdefBlock = NT3H1x01_AUTO_LAST_NDEF_OFF; // whether writeUserBlock() and writeUserBytes() keep LAST_NDEF_BLOCK at the end of the NDEF TLV (see updateLastNdefBlock())
+  NT3H1x01_lockBits lockCache = {0, 0}; // the lock bits, as last read/written by readLocks() or lockArea() (only valid if lockCacheValid)
+  bool lockCacheValid = false;          // once the lock bits are known, the user memory write functions refuse to write locked blocks (without any I2C traffic), see isLocked()
+
+  #ifdef NT3H1x01_trace
+    NT3H1x01_traceRecorder trace; // every transport primitive call ends up in here, see _NT3H1x01_thijs_trace.h
+  #endif
+  #ifdef NT3H1x01_stats
+    NT3H1x01_busStats stats; // running bus statistics, see _NT3H1x01_thijs_stats.h
+  #endif
+  #ifdef NT3H1x01_capture
+    NT3H1x01_captureRecorder capture; // streams every transport primitive call to a log (once capture.begin() is called), see _NT3H1x01_thijs_capture.h
+  #endif
+  #ifdef NT3H1x01_retries
+    uint8_t maxRetries = 2;           // how many times a failed transport primitive call is retried (0 to disable at runtime)
+    uint16_t retryDelayMicros = 100;  // how long to wait before retrying (NOTE: an EEPROM write takes ~4ms, during which the tag NACKs unless I2C_CLOCK_STR is set)
+  #endif
+  #if defined(NT3H1x01_trace) || defined(NT3H1x01_stats) || defined(NT3H1x01_capture) || defined(NT3H1x01_retries)
+    /**
+     * (private) whether a failed transport primitive call should be retried (and wait a little before it is)
+     * @param err what the call returned
+     * @param attempt (reference) how many retries were done so far, incremented if it returns true
+     * @return true if it should be retried
+     */
+    bool _retryAgain(NT3H1x01_ERR_RETURN_TYPE err, uint8_t& attempt) {
+      #ifdef NT3H1x01_retries
+        if(_errGood(err) || (attempt >= maxRetries)) { return(false); }
+        attempt++;
+        #ifdef NT3H1x01_stats
+          stats.retries++;
+        #endif
+        #if defined(NT3H1x01_useSimulator)
+          _simTag->advanceTime(retryDelayMicros); // (only matters for the timing model)
+        #elif defined(ARDUINO)
+          delayMicroseconds(retryDelayMicros);
+        #endif
+        return(true);
+      #else
+        (void)err; (void)attempt; // (retries are off)
+        return(false);
+      #endif
+    }
+    /**
+     * (private) report a finished transport primitive call to the trace, stats and/or capture
+     */
+    void _primitiveDone(NT3H1x01_TRACE_OP_ENUM op, uint8_t blockAddress, uint8_t byteCount, NT3H1x01_ERR_RETURN_TYPE err, uint32_t startTime, const uint8_t payload[], uint8_t payloadLength) {
+      (void)op; (void)blockAddress; (void)byteCount; (void)err; (void)startTime; (void)payload; (void)payloadLength; // (not every combination of debug features uses all of them)
+      #ifdef NT3H1x01_trace
+        trace.record(op, blockAddress, byteCount, err, startTime);
+      #endif
+      #ifdef NT3H1x01_stats
+        stats.countPrimitive(op, blockAddress, byteCount, _errGood(err), err);
+      #endif
+      #ifdef NT3H1x01_capture
+        capture.record(op, blockAddress, payload, payloadLength, _errGood(err), startTime);
+      #endif
+    }
+    //// these wrap (hide) the transport primitives of the base class, to record (and retry) them. See _NT3H1x01_thijs_base.h for their documentation
+    NT3H1x01_ERR_RETURN_TYPE requestMemBlock(uint8_t blockAddress, uint8_t readBuff[]) {
+      NT3H1x01_STATS_API();
+      NT3H1x01_ERR_RETURN_TYPE err;  uint8_t attempt = 0;
+      do {
+        uint32_t startTime = NT3H1x01_MICROS();
+        err = _NT3H1x01_thijs_base::requestMemBlock(blockAddress, readBuff);
+        _primitiveDone(NT3H1x01_TRACE_READ_BLOCK, blockAddress, NT3H1x01_BLOCK_SIZE, err, startTime, readBuff, NT3H1x01_BLOCK_SIZE);
+      } while(_retryAgain(err, attempt));
+      return(err);
+    }
+    NT3H1x01_ERR_RETURN_TYPE requestSessRegByte(NT3H1x01_CONF_SESS_REGS_ENUM registerIndex, uint8_t& readBuff) {
+      NT3H1x01_STATS_API();
+      NT3H1x01_ERR_RETURN_TYPE err;  uint8_t attempt = 0;
+      do {
+        uint32_t startTime = NT3H1x01_MICROS();
+        err = _NT3H1x01_thijs_base::requestSessRegByte(registerIndex, readBuff);
+        _primitiveDone(NT3H1x01_TRACE_READ_SESS, registerIndex, 1, err, startTime, &readBuff, 1);
+      } while(_retryAgain(err, attempt));
+      return(err);
+    }
+    NT3H1x01_ERR_RETURN_TYPE _onlyReadBytes(uint8_t readBuff[], uint8_t bytesToRead) { // (NOT retried, as the read pointer may have moved on)
+      uint32_t startTime = NT3H1x01_MICROS();
+      NT3H1x01_ERR_RETURN_TYPE err = _NT3H1x01_thijs_base::_onlyReadBytes(readBuff, bytesToRead);
+      _primitiveDone(NT3H1x01_TRACE_ONLY_READ, NT3H1x01_INVALID_MEMA, bytesToRead, err, startTime, readBuff, bytesToRead);  return(err);
+    }
+    template<typename SOURCE_T>
+    NT3H1x01_ERR_RETURN_TYPE writeMemBlockFrom(uint8_t blockAddress, SOURCE_T writeBuff, uint8_t bytesToWrite=NT3H1x01_BLOCK_SIZE) {
+      NT3H1x01_STATS_API();
+      #ifdef NT3H1x01_capture // (only the capture records the payload, the write itself still comes from the source)
+        uint8_t padded[NT3H1x01_BLOCK_SIZE];  for(uint8_t i=0; i<NT3H1x01_BLOCK_SIZE; i++) { padded[i] = (i < bytesToWrite) ? writeBuff[i] : 0; } // (always writes a whole block, padded with 0's)
+      #else
+        const uint8_t* padded = NULL;
+      #endif
+      NT3H1x01_ERR_RETURN_TYPE err;  uint8_t attempt = 0;
+      do {
+        uint32_t startTime = NT3H1x01_MICROS();
+        err = _NT3H1x01_thijs_base::writeMemBlockFrom(blockAddress, writeBuff, bytesToWrite);
+        _primitiveDone(NT3H1x01_TRACE_WRITE_BLOCK, blockAddress, NT3H1x01_BLOCK_SIZE, err, startTime, padded, NT3H1x01_BLOCK_SIZE);
+      } while(_retryAgain(err, attempt));
+      return(err);
+    }
+    NT3H1x01_ERR_RETURN_TYPE writeMemBlock(uint8_t blockAddress, const uint8_t writeBuff[], uint8_t bytesToWrite=NT3H1x01_BLOCK_SIZE) { NT3H1x01_STATS_API();  return(writeMemBlockFrom(blockAddress, writeBuff, bytesToWrite)); }
+    NT3H1x01_ERR_RETURN_TYPE writeMemBlock_P(uint8_t blockAddress, const uint8_t PROGMEMbuff[], uint8_t bytesToWrite=NT3H1x01_BLOCK_SIZE) { NT3H1x01_STATS_API();  return(writeMemBlockFrom(blockAddress, NT3H1x01_progmemSource{PROGMEMbuff}, bytesToWrite)); }
+    NT3H1x01_ERR_RETURN_TYPE writeSessRegByte(NT3H1x01_CONF_SESS_REGS_ENUM registerIndex, uint8_t regDat, uint8_t mask=0xFF) {
+      NT3H1x01_STATS_API();
+      const uint8_t payload[2] = {regDat, mask};
+      NT3H1x01_ERR_RETURN_TYPE err;  uint8_t attempt = 0;
+      do {
+        uint32_t startTime = NT3H1x01_MICROS();
+        err = _NT3H1x01_thijs_base::writeSessRegByte(registerIndex, regDat, mask);
+        _primitiveDone(NT3H1x01_TRACE_WRITE_SESS, registerIndex, 1, err, startTime, payload, 2);
+      } while(_retryAgain(err, attempt));
+      return(err);
+    }
+  #endif
+
   /*
   This class only contains the higher level functions.
    for the base functions, please refer to _NT3H1x01_thijs_base.h
@@ -337,7 +858,7 @@ class NT3H1x01_thijs : public _NT3H1x01_thijs_base
   - requestMemBlock()
   - requestSessRegByte()
   - _onlyReadBytes()
-  - writeMemBlock()
+  - writeMemBlock()  (and writeMemBlock_P() and writeMemBlockFrom(), for constant/PROGMEM data)
   - writeSessRegByte()
   */
   //// the following functions are abstract enough that they'll work for either architecture
@@ -374,6 +895,7 @@ class NT3H1x01_thijs : public _NT3H1x01_thijs_base
     uint8_t* whichBuffToUse = _oneBlockBuff; // default to class member block
     if((bytesToRead == NT3H1x01_BLOCK_SIZE) && (bytesInBlockStart == 0)) { whichBuffToUse = readBuff; } // ONLY IF readBuff is actually a full block's worth of data, then you can read directly to it (skip copying)
     NT3H1x01_ERR_RETURN_TYPE err = NT3H1x01_ERR_RETURN_TYPE_OK;
+    NT3H1x01_STATS_CACHE(useCache && (whichBuffToUse == _oneBlockBuff), blockAddress == _oneBlockBuffAddress);
     if( ! (useCache && (blockAddress == _oneBlockBuffAddress) && (whichBuffToUse == _oneBlockBuff))) { // normally true
       err = requestMemBlock(blockAddress, whichBuffToUse); // fetch the whole block
       if(whichBuffToUse == _oneBlockBuff) { _oneBlockBuffAddress = blockAddress; } // remember which block is in the chache for later
@@ -396,6 +918,7 @@ class NT3H1x01_thijs : public _NT3H1x01_thijs_base
     T returnVal;
     if((bytesInBlockStart+sizeof(T)) > NT3H1x01_BLOCK_SIZE) { NT3H1x01debugPrint("_getValFromBlock() MISUSE!, you're trying to read bytes outside of the buffer"); return(NT3H1x01_ERR_RETURN_TYPE_FAIL);  }
     NT3H1x01_ERR_RETURN_TYPE err = NT3H1x01_ERR_RETURN_TYPE_OK;
+    NT3H1x01_STATS_CACHE(useCache, blockAddress == _oneBlockBuffAddress);
     if( ! (useCache && (blockAddress == _oneBlockBuffAddress))) { // normally true
       err = requestMemBlock(blockAddress, _oneBlockBuff); _oneBlockBuffAddress = blockAddress; // fetch the whole block
       if(!_errGood(err)) { NT3H1x01debugPrint("_getValFromBlock<>() read/write error!"); _oneBlockBuffAddress = NT3H1x01_INVALID_MEMA; return(returnVal); } // note: returns random value, as returnVal was not zero-initialized
@@ -407,6 +930,7 @@ class NT3H1x01_thijs : public _NT3H1x01_thijs_base
 
   /**
    * (private) overwrite an arbetrary set of bytes in a block (with bytes from a provided buffer)
+   * @tparam SOURCE_T type of the source: a (const) buffer or a NT3H1x01_progmemSource (see writeMemBlockFrom())
    * @param blockAddress MEMory Address (MEMA) of the block
    * @param bytesInBlockStart where in the block the relevant data starts (see defines up top)
    * @param bytesToWrite how many bytes are of interest (size of writeBuff)
@@ -414,19 +938,21 @@ class NT3H1x01_thijs : public _NT3H1x01_thijs_base
    * @param useCache (optional!, not recommended, use at own discretion) use data from _oneBlockBuff cache (if possible) instead of actually reading it from I2C (to save a little time).
    * @return (bool or esp_err_t or i2c_status_e, see on defines at top) whether it wrote/read successfully
    */
-  NT3H1x01_ERR_RETURN_TYPE _setBytesInBlock(uint8_t blockAddress, uint8_t bytesInBlockStart, uint8_t bytesToWrite, uint8_t writeBuff[], bool useCache=false) {
-    uint8_t* whichBuffToUse = _oneBlockBuff; // default to class member block
-    if((bytesToWrite == NT3H1x01_BLOCK_SIZE) && (bytesInBlockStart == 0)) { whichBuffToUse = writeBuff; } // ONLY IF readBuff is actually a full block's worth of data, then you can read directly to it (skip copying)
+  template<typename SOURCE_T>
+  NT3H1x01_ERR_RETURN_TYPE _setBytesInBlock(uint8_t blockAddress, uint8_t bytesInBlockStart, uint8_t bytesToWrite, SOURCE_T writeBuff, bool useCache=false) {
     NT3H1x01_ERR_RETURN_TYPE err = NT3H1x01_ERR_RETURN_TYPE_OK;
-    if(whichBuffToUse == _oneBlockBuff) { // if the writeBuff is not an entire block worth of data, you must first read the block (to fill in the gaps when you send it back)
+    if((bytesToWrite == NT3H1x01_BLOCK_SIZE) && (bytesInBlockStart == 0)) { // ONLY IF writeBuff is actually a full block's worth of data, then you can write directly from it (skip copying)
+      err = writeMemBlockFrom(blockAddress, writeBuff);
+    } else { // if the writeBuff is not an entire block worth of data, you must first read the block (to fill in the gaps when you send it back)
+      NT3H1x01_STATS_CACHE(useCache, blockAddress == _oneBlockBuffAddress);
       if( ! (useCache && (blockAddress == _oneBlockBuffAddress))) { // normally true
         err = requestMemBlock(blockAddress, _oneBlockBuff); _oneBlockBuffAddress = blockAddress; // fetch the whole block
         if(!_errGood(err)) { NT3H1x01debugPrint("_setBytesInBlock() read/write error!"); _oneBlockBuffAddress = NT3H1x01_INVALID_MEMA; return(err); }
       }
       if((blockAddress == NT3H1x01_I2C_ADDR_CHANGE_MEMA) && (bytesInBlockStart != NT3H1x01_I2C_ADDR_CHANGE_MEMA_BYTE)) { _oneBlockBuff[NT3H1x01_I2C_ADDR_CHANGE_MEMA_BYTE] = (slaveAddress<<1); } // I2C address byte reads as manufacturer ID
       for(uint8_t i=0; i<bytesToWrite; i++) { _oneBlockBuff[i+bytesInBlockStart] = writeBuff[i]; } // overwrite only the desired bytes
+      err = writeMemBlock(blockAddress, _oneBlockBuff);
     }
-    err = writeMemBlock(blockAddress, whichBuffToUse);
     if(!_errGood(err)) { NT3H1x01debugPrint("_setBytesInBlock() write error!"); }
     return(err); // err should always be OK, if it makes it to this point
   }
@@ -443,6 +969,7 @@ class NT3H1x01_thijs : public _NT3H1x01_thijs_base
   template<typename T> 
   NT3H1x01_ERR_RETURN_TYPE _setValInBlock(uint8_t blockAddress, uint8_t bytesInBlockStart, T newVal, bool writeMSBfirst=true, bool useCache=false) {
     NT3H1x01_ERR_RETURN_TYPE err = NT3H1x01_ERR_RETURN_TYPE_OK;
+    NT3H1x01_STATS_CACHE(useCache, blockAddress == _oneBlockBuffAddress);
     if( ! (useCache && (blockAddress == _oneBlockBuffAddress))) { // normally true
       err = requestMemBlock(blockAddress, _oneBlockBuff); _oneBlockBuffAddress = blockAddress; // fetch the whole block
       if(!_errGood(err)) { NT3H1x01debugPrint("_setValInBlock() read/write error!"); _oneBlockBuffAddress = NT3H1x01_INVALID_MEMA; return(err); }
@@ -455,6 +982,345 @@ class NT3H1x01_thijs : public _NT3H1x01_thijs_base
     return(err);
   }
 
+/////////////////////////////////////////////////////////////////////////////////////// user memory functions: //////////////////////////////////////////////////////////
+
+  /**
+   * read a whole block of user memory (checks whether the address is actually user memory first)
+   * @param blockAddress MEMory Address (MEMA) of the block (see memMap().userStart and .userEnd)
+   * @param readBuff a NT3H1x01_BLOCK_SIZE buffer to store the read values in
+   * @return (bool or esp_err_t or i2c_status_e, see on defines at top) whether it wrote/read successfully
+   */
+  NT3H1x01_ERR_RETURN_TYPE readUserBlock(uint8_t blockAddress, uint8_t readBuff[]) {
+    NT3H1x01_STATS_API();
+    if(!memMap().isUserBlock(blockAddress)) { NT3H1x01debugPrint("readUserBlock() address is not user memory!"); return(NT3H1x01_ERR_RETURN_TYPE_FAIL); }
+    return(requestMemBlock(blockAddress, readBuff));
+  }
+  /**
+   * read a whole block of user memory, with the address range check done at compile-time (for the compile-time variants)
+   * @tparam blockAddress MEMory Address (MEMA) of the block
+   * @param readBuff a NT3H1x01_BLOCK_SIZE buffer to store the read values in
+   * @return (bool or esp_err_t or i2c_status_e, see on defines at top) whether it wrote/read successfully
+   */
+  template<uint8_t blockAddress>
+  NT3H1x01_ERR_RETURN_TYPE readUserBlock(uint8_t readBuff[]) {
+    NT3H1x01_STATS_API();
+    static_assert((VARIANT_T == NT3H1x01_VARIANT_RUNTIME) || NT3H1x01_getMemMap(VARIANT_T == NT3H1x01_VARIANT_2k).isUserBlock(blockAddress), "readUserBlock<>() address is not user memory (for this variant)!");
+    return(readUserBlock(blockAddress, readBuff)); // (the runtime check folds away for the compile-time variants)
+  }
+
+  /**
+   * write a whole block of user memory (checks whether the address is actually user memory first).
+   * NOTE: on the 1k variant, the last user block (0x38) is shared with the Dynamic Locking bytes, so only the first 8 bytes are written there (read-modify-write)
+   * @param blockAddress MEMory Address (MEMA) of the block (see memMap().userStart and .userEnd)
+   * @param writeBuff a NT3H1x01_BLOCK_SIZE buffer of bytes to write
+   * @return (bool or esp_err_t or i2c_status_e, see on defines at top) whether it wrote/read successfully
+   */
+  NT3H1x01_ERR_RETURN_TYPE writeUserBlock(uint8_t blockAddress, const uint8_t writeBuff[]) { NT3H1x01_STATS_API();  return(_autoLastNdefBlock(_writeUserBlockFrom(blockAddress, writeBuff))); } // (just a macro)
+  /**
+   * write a whole block of user memory from PROGMEM (flash), without copying it into RAM first (checks whether the address is actually user memory first).
+   * @param blockAddress MEMory Address (MEMA) of the block (see memMap().userStart and .userEnd)
+   * @param PROGMEMbuff a NT3H1x01_BLOCK_SIZE buffer of bytes (declared with PROGMEM) to write
+   * @return (bool or esp_err_t or i2c_status_e, see on defines at top) whether it wrote/read successfully
+   */
+  NT3H1x01_ERR_RETURN_TYPE writeUserBlock_P(uint8_t blockAddress, const uint8_t PROGMEMbuff[]) { NT3H1x01_STATS_API();  return(_autoLastNdefBlock(_writeUserBlockFrom(blockAddress, NT3H1x01_progmemSource{PROGMEMbuff}))); } // (just a macro)
+  /**
+   * (private) writeUserBlock() and writeUserBlock_P(), see writeMemBlockFrom() for the source types.
+   * This one does NOT update LAST_NDEF_BLOCK (see autoLastNdefBlock), for functions that write several blocks and call _autoLastNdefBlock() once at the end
+   */
+  template<typename SOURCE_T>
+  NT3H1x01_ERR_RETURN_TYPE _writeUserBlockFrom(uint8_t blockAddress, SOURCE_T writeBuff) {
+    if(!memMap().isUserBlock(blockAddress)) { NT3H1x01debugPrint("writeUserBlock() address is not user memory!"); return(NT3H1x01_ERR_RETURN_TYPE_FAIL); }
+    if(isLocked(blockAddress)) { NT3H1x01debugPrint("writeUserBlock() block is locked!"); return(NT3H1x01_ERR_RETURN_TYPE_FAIL); }
+    return(_setBytesInBlock(blockAddress, 0, memMap().userBytesInBlock(blockAddress), writeBuff)); // (writes directly if it's a whole block)
+  }
+  /**
+   * write a whole block of user memory, with the address range check done at compile-time (for the compile-time variants)
+   * @tparam blockAddress MEMory Address (MEMA) of the block
+   * @param writeBuff a NT3H1x01_BLOCK_SIZE buffer of bytes to write
+   * @return (bool or esp_err_t or i2c_status_e, see on defines at top) whether it wrote/read successfully
+   */
+  template<uint8_t blockAddress>
+  NT3H1x01_ERR_RETURN_TYPE writeUserBlock(const uint8_t writeBuff[]) {
+    NT3H1x01_STATS_API();
+    static_assert((VARIANT_T == NT3H1x01_VARIANT_RUNTIME) || NT3H1x01_getMemMap(VARIANT_T == NT3H1x01_VARIANT_2k).isUserBlock(blockAddress), "writeUserBlock<>() address is not user memory (for this variant)!");
+    return(writeUserBlock(blockAddress, writeBuff)); // (the runtime check folds away for the compile-time variants)
+  }
+
+  /**
+   * write an arbetrary amount of (const) data to user memory, block by block, straight from the provided buffer (without copying it into RAM first).
+   * If the data does not fill the last block, the rest of that block is kept as-is (read-modify-write), just like the shared last block of the 1k variant.
+   * @param startBlock MEMory Address (MEMA) of the first block to write (see memMap().userStart and .userEnd)
+   * @param data the bytes to write
+   * @param length how many bytes to write (must fit in user memory, from startBlock onwards)
+   * @return (bool or esp_err_t or i2c_status_e, see on defines at top) whether it wrote/read successfully
+   */
+  NT3H1x01_ERR_RETURN_TYPE writeUserBytes(uint8_t startBlock, const uint8_t data[], uint16_t length) { NT3H1x01_STATS_API();  return(writeUserBytesFrom(startBlock, data, length)); } // (just a macro)
+  /**
+   * write an arbetrary amount of data from PROGMEM (flash) to user memory, the bytes go straight from flash to the I2C bus (on AVR), see writeUserBytes()
+   * @param startBlock MEMory Address (MEMA) of the first block to write (see memMap().userStart and .userEnd)
+   * @param PROGMEMdata the bytes (declared with PROGMEM) to write
+   * @param length how many bytes to write (must fit in user memory, from startBlock onwards)
+   * @return (bool or esp_err_t or i2c_status_e, see on defines at top) whether it wrote/read successfully
+   */
+  NT3H1x01_ERR_RETURN_TYPE writeUserBytes_P(uint8_t startBlock, const uint8_t PROGMEMdata[], uint16_t length) { NT3H1x01_STATS_API();  return(writeUserBytesFrom(startBlock, NT3H1x01_progmemSource{PROGMEMdata}, length)); } // (just a macro)
+  /**
+   * write an arbetrary amount of data to user memory, from any source (see writeMemBlockFrom()), see writeUserBytes()
+   * @tparam SOURCE_T type of the source: a (const) buffer or a NT3H1x01_progmemSource (anything with operator[] and operator+)
+   * @param startBlock MEMory Address (MEMA) of the first block to write (see memMap().userStart and .userEnd)
+   * @param data where to get the bytes from
+   * @param length how many bytes to write (must fit in user memory, from startBlock onwards)
+   * @return (bool or esp_err_t or i2c_status_e, see on defines at top) whether it wrote/read successfully
+   */
+  template<typename SOURCE_T>
+  NT3H1x01_ERR_RETURN_TYPE writeUserBytesFrom(uint8_t startBlock, SOURCE_T data, uint16_t length) {
+    NT3H1x01_STATS_API();
+    const NT3H1x01_memMap map = memMap();
+    if(!map.isUserBlock(startBlock)) { NT3H1x01debugPrint("writeUserBytes() address is not user memory!"); return(NT3H1x01_ERR_RETURN_TYPE_FAIL); }
+    if(length > (map.userBytes - ((uint16_t)(startBlock - map.userStart) * NT3H1x01_BLOCK_SIZE))) { NT3H1x01debugPrint("writeUserBytes() data does not fit in user memory!"); return(NT3H1x01_ERR_RETURN_TYPE_FAIL); }
+    if((length > 0) && isLocked(startBlock, startBlock + ((length - 1) / NT3H1x01_BLOCK_SIZE))) { NT3H1x01debugPrint("writeUserBytes() (part of) the area is locked!"); return(NT3H1x01_ERR_RETURN_TYPE_FAIL); } // (before writing anything)
+    NT3H1x01_ERR_RETURN_TYPE err = NT3H1x01_ERR_RETURN_TYPE_OK;
+    uint16_t offset = 0;
+    for(uint8_t blockAddress=startBlock; offset<length; blockAddress++) {
+      uint8_t bytesInBlock = map.userBytesInBlock(blockAddress);
+      if((length - offset) < bytesInBlock) { bytesInBlock = length - offset; }
+      err = _setBytesInBlock(blockAddress, 0, bytesInBlock, data + offset); // (writes directly from the source if it's a whole block)
+      if(!_errGood(err)) { NT3H1x01debugPrint("writeUserBytes() write error!"); return(err); }
+      offset += bytesInBlock;
+    }
+    return(_autoLastNdefBlock(err));
+  }
+
+  /**
+   * find the end of the NDEF message in the user memory: walks the TLV list from the start of the user memory up to the NDEF TLV,
+   *  reading only the blocks the TLV headers are in (usually just the first block)
+   * @param lastBlock (reference) MEMory Address (MEMA) of the block that holds the last byte of the NDEF TLV, 0 if there is no (valid) NDEF TLV
+   * @return (bool or esp_err_t or i2c_status_e, see on defines at top) whether it read successfully
+   */
+  NT3H1x01_ERR_RETURN_TYPE findNdefEnd(uint8_t& lastBlock) {
+    NT3H1x01_STATS_API();
+    const NT3H1x01_memMap map = memMap();
+    lastBlock = 0;
+    uint8_t buff[NT3H1x01_BLOCK_SIZE];  uint8_t buffBlock = NT3H1x01_INVALID_MEMA;
+    NT3H1x01_ERR_RETURN_TYPE err = NT3H1x01_ERR_RETURN_TYPE_OK;
+    uint16_t pos = 0;
+    while(pos < map.userBytes) {
+      uint8_t header[4];  uint8_t headerLength = 1; // type, length (1 or 3 bytes)
+      for(uint8_t i=0; i<headerLength; i++) {
+        if((pos + i) >= map.userBytes) { return(err); } // (malformed, the header runs past the end of the user memory)
+        uint8_t blockAddress = map.userStart + ((pos + i) / NT3H1x01_BLOCK_SIZE);
+        if(blockAddress != buffBlock) {
+          err = requestMemBlock(blockAddress, buff);
+          if(!_errGood(err)) { NT3H1x01debugPrint("findNdefEnd() read error!"); return(err); }
+          buffBlock = blockAddress;
+        }
+        header[i] = buff[(pos + i) % NT3H1x01_BLOCK_SIZE];
+        if(i == 0) {
+          if(header[0] == NT3H1x01_TLV_NULL) { break; }
+          if(header[0] == NT3H1x01_TLV_TERMINATOR) { return(err); } // (no NDEF TLV)
+          headerLength = 2;
+        } else if((i == 1) && (header[1] == NT3H1x01_TLV_LONG_LENGTH)) { headerLength = 4; }
+      }
+      if(header[0] == NT3H1x01_TLV_NULL) { pos++;  continue; }
+      uint32_t end = (uint32_t)pos + headerLength + ((headerLength == 4) ? (((uint16_t)header[2] << 8) | header[3]) : header[1]); // (exclusive)
+      if(end > map.userBytes) { return(err); } // (malformed, the value runs past the end of the user memory)
+      if(header[0] == NT3H1x01_TLV_NDEF) { lastBlock = map.userStart + ((end - 1) / NT3H1x01_BLOCK_SIZE);  return(err); }
+      pos = end;
+    }
+    return(err);
+  }
+  /**
+   * set LAST_NDEF_BLOCK to the block that holds the end of the NDEF message (see findNdefEnd()), only writing the register(s) if it changed.
+   * The RF side then reads no further than it needs to, and NDEF_DATA_READ (and NT3H1x01_FD_OFF_LAST_NDEF_READ) happen right when the message was read.
+   * @param persistent whether to set it in the Configuration registers too (an EEPROM write, but only if it changed, and it survives a reset)
+   * @return (bool or esp_err_t or i2c_status_e, see on defines at top) whether it read/wrote successfully
+   */
+  NT3H1x01_ERR_RETURN_TYPE updateLastNdefBlock(bool persistent=false) {
+    NT3H1x01_STATS_API();
+    uint8_t lastBlock;  NT3H1x01_ERR_RETURN_TYPE err = findNdefEnd(lastBlock);
+    if(!_errGood(err)) { return(err); }
+    NT3H1x01_desiredConfig desired;
+    if(persistent) { desired.setBoth(NT3H1x01_COMN_REGS_LAST_NDEF_BLOCK_BYTE, lastBlock); }
+    else { desired.set<NT3H1x01_Sess_LAST_NDEF_BLOCK>(lastBlock); }
+    return(applyConfiguration(desired));
+  }
+  /**
+   * (private) called at the end of the user memory write functions: update LAST_NDEF_BLOCK if autoLastNdefBlock says so (and the write was successful)
+   * @param err what the write returned
+   * @return (bool or esp_err_t or i2c_status_e, see on defines at top) err, or whatever updateLastNdefBlock() returned
+   */
+  NT3H1x01_ERR_RETURN_TYPE _autoLastNdefBlock(NT3H1x01_ERR_RETURN_TYPE err) {
+    if(!_errGood(err) || (autoLastNdefBlock == NT3H1x01_AUTO_LAST_NDEF_OFF)) { return(err); }
+    return(updateLastNdefBlock(autoLastNdefBlock == NT3H1x01_AUTO_LAST_NDEF_BOTH));
+  }
+
+/////////////////////////////////////////////////////////////////////////////////////// locking functions: //////////////////////////////////////////////////////////
+  // NOTE: the lock bits only stop the RF side from writing, the I2C side can always write. The library does check them (once they're known, see lockCacheValid),
+  //        so a block that was locked for the phone isn't changed by accident either
+
+  /**
+   * read the Static and Dynamic Locking bytes (2 block reads) into lockCache
+   * NOTE: the 3rd Dynamic Locking byte (block-locking) always reads as 0, so those bits are kept from lockCache (what lockArea() set earlier)
+   * @param locks (reference) the lock bits
+   * @return (bool or esp_err_t or i2c_status_e, see on defines at top) whether it read successfully
+   */
+  NT3H1x01_ERR_RETURN_TYPE readLocks(NT3H1x01_lockBits& locks) {
+    NT3H1x01_STATS_API();
+    const NT3H1x01_memMap map = memMap();
+    uint8_t buff[NT3H1x01_BLOCK_SIZE];
+    NT3H1x01_ERR_RETURN_TYPE err = requestMemBlock(NT3H1x01_STAT_LOCK_MEMA, buff);
+    if(!_errGood(err)) { NT3H1x01debugPrint("readLocks() read error!"); return(err); }
+    uint16_t staticBits = buff[NT3H1x01_STAT_LOCK_MEMA_BYTES_START] | ((uint16_t)buff[NT3H1x01_STAT_LOCK_MEMA_BYTES_START+1] << 8);
+    err = requestMemBlock(map.dynaLockMEMA, buff);
+    if(!_errGood(err)) { NT3H1x01debugPrint("readLocks() read error!"); return(err); }
+    uint32_t dynamicBits = buff[map.dynaLockByte] | ((uint32_t)buff[map.dynaLockByte+1] << 8) | (lockCacheValid ? (lockCache.dynamicBits & 0xFF0000) : 0);
+    lockCache = NT3H1x01_lockBits{staticBits, dynamicBits};  lockCacheValid = true;
+    locks = lockCache;
+    return(err);
+  }
+  /**
+   * forget the lock bits (e.g. when a phone may have set some), until the next readLocks() or lockArea() the write functions don't check them
+   */
+  void forgetLocks() { lockCacheValid = false; }
+  /**
+   * whether (part of) an area is locked, according to lockCache (no I2C traffic, false if the lock bits aren't known, see readLocks())
+   * @param startBlock MEMory Address (MEMA) of the first block
+   * @param endBlock (optional) MEMA of the last block (inclusive), just startBlock by default
+   * @return true if any page in the area is locked
+   */
+  bool isLocked(uint8_t startBlock, uint8_t endBlock=0) const {
+    if(endBlock < startBlock) { endBlock = startBlock; }
+    return(lockCacheValid && lockCache.intersects(NT3H1x01_lockBitsForArea(memMap(), startBlock, endBlock, true)));
+  }
+
+  /**
+   * (private) set Static Locking bits (1 read-modify-write of block 0x00, the write is skipped if they're all set already), updates lockCache
+   * @param bits the lock bits to set (see NT3H1x01_lockBits::staticBits), bits that are already set stay set
+   * @return (bool or esp_err_t or i2c_status_e, see on defines at top) whether it wrote/read successfully
+   */
+  NT3H1x01_ERR_RETURN_TYPE _setStaticLockBits(uint16_t bits) {
+    uint8_t buff[NT3H1x01_BLOCK_SIZE];
+    NT3H1x01_ERR_RETURN_TYPE err = requestMemBlock(NT3H1x01_STAT_LOCK_MEMA, buff);
+    if(!_errGood(err)) { NT3H1x01debugPrint("_setStaticLockBits() read error!"); return(err); }
+    uint16_t oldBits = buff[NT3H1x01_STAT_LOCK_MEMA_BYTES_START] | ((uint16_t)buff[NT3H1x01_STAT_LOCK_MEMA_BYTES_START+1] << 8);
+    lockCache.staticBits = oldBits | bits;
+    if(lockCache.staticBits == oldBits) { return(err); }
+    buff[NT3H1x01_I2C_ADDR_CHANGE_MEMA_BYTE] = (slaveAddress<<1); // I2C address byte reads as manufacturer ID
+    buff[NT3H1x01_STAT_LOCK_MEMA_BYTES_START] = lockCache.staticBits & 0xFF;  buff[NT3H1x01_STAT_LOCK_MEMA_BYTES_START+1] = lockCache.staticBits >> 8;
+    err = writeMemBlock(NT3H1x01_STAT_LOCK_MEMA, buff);
+    if(!_errGood(err)) { NT3H1x01debugPrint("_setStaticLockBits() write error!"); lockCache.staticBits = oldBits; }
+    return(err);
+  }
+  /**
+   * (private) set Dynamic Locking bits (1 read-modify-write of the Dynamic Locking block, the write is skipped if they're all set already), updates lockCache.
+   * RFUI bits are never set (see NT3H1x01_lockBitsUsable()), the block-locking byte (which reads as 0) is taken from lockCache
+   * @param bits the lock bits to set (see NT3H1x01_lockBits::dynamicBits), bits that are already set stay set
+   * @return (bool or esp_err_t or i2c_status_e, see on defines at top) whether it wrote/read successfully
+   */
+  NT3H1x01_ERR_RETURN_TYPE _setDynamicLockBits(uint32_t bits) {
+    const NT3H1x01_memMap map = memMap();
+    uint8_t buff[NT3H1x01_BLOCK_SIZE];
+    NT3H1x01_ERR_RETURN_TYPE err = requestMemBlock(map.dynaLockMEMA, buff);
+    if(!_errGood(err)) { NT3H1x01debugPrint("_setDynamicLockBits() read error!"); return(err); }
+    uint32_t oldBits = buff[map.dynaLockByte] | ((uint32_t)buff[map.dynaLockByte+1] << 8) | (lockCacheValid ? (lockCache.dynamicBits & 0xFF0000) : 0);
+    lockCache.dynamicBits = (oldBits | bits) & NT3H1x01_dynamicLockUsableBits(map);
+    if(lockCache.dynamicBits == oldBits) { return(err); }
+    for(uint8_t i=0; i<3; i++) { buff[map.dynaLockByte+i] = (lockCache.dynamicBits >> (8*i)) & 0xFF; }
+    err = writeMemBlock(map.dynaLockMEMA, buff); // (on the 1k variant, this block also holds the last 8 bytes of user memory, those are written back as they were)
+    if(!_errGood(err)) { NT3H1x01debugPrint("_setDynamicLockBits() write error!"); lockCache.dynamicBits = oldBits; }
+    return(err);
+  }
+  /**
+   * lock an area of memory against writes from the RF side (and from this library, see isLocked()), with Static and/or Dynamic Locking (see NT3H1x01_lockBitsForArea()).
+   * Only the lock bytes that actually need to change are written (1 read-modify-write per lock block at most, none if lockCache says it's all locked already).
+   * NOTE: the RF side can't clear lock bits, so to the phone this is permanent
+   * @param startBlock MEMory Address (MEMA) of the first block
+   * @param endBlock MEMA of the last block (inclusive)
+   * @param roundUp (Dynamic Locking locks 4 or 8 blocks per bit) true to lock every chunk the area touches (may lock more than the area), false for only whole chunks (may lock less)
+   * @param blockLock whether to also set the block-locking bits for them, so the RF side can't set any more lock bits in those chunks either
+   * @return (bool or esp_err_t or i2c_status_e, see on defines at top) whether it wrote/read successfully (fails without writing anything if the area is not user memory, or needs RFUI bits)
+   */
+  NT3H1x01_ERR_RETURN_TYPE lockArea(uint8_t startBlock, uint8_t endBlock, bool roundUp=true, bool blockLock=false) {
+    NT3H1x01_STATS_API();
+    const NT3H1x01_memMap map = memMap();
+    if(!map.isUserBlock(startBlock) || !map.isUserBlock(endBlock) || (endBlock < startBlock)) { NT3H1x01debugPrint("lockArea() area is not user memory!"); return(NT3H1x01_ERR_RETURN_TYPE_FAIL); }
+    const NT3H1x01_lockBits bits = NT3H1x01_lockBitsForArea(map, startBlock, endBlock, roundUp, blockLock);
+    if(!NT3H1x01_lockBitsUsable(map, bits)) { NT3H1x01debugPrint("lockArea() (part of) the area can only be locked with RFUI bits!"); return(NT3H1x01_ERR_RETURN_TYPE_FAIL); }
+    NT3H1x01_ERR_RETURN_TYPE err = NT3H1x01_ERR_RETURN_TYPE_OK;
+    bool cacheWasValid = lockCacheValid;
+    if(!cacheWasValid || (bits.staticBits & ~lockCache.staticBits)) {
+      err = _setStaticLockBits(bits.staticBits);
+      if(!_errGood(err)) { lockCacheValid = false; return(err); }
+    }
+    if(!cacheWasValid || (bits.dynamicBits & ~lockCache.dynamicBits)) {
+      err = _setDynamicLockBits(bits.dynamicBits);
+      if(!_errGood(err)) { lockCacheValid = false; return(err); }
+    }
+    lockCacheValid = true; // (both lock blocks were read at some point)
+    return(err);
+  }
+
+/////////////////////////////////////////////////////////////////////////////////////// register field functions: //////////////////////////////////////////////////////////
+
+  /**
+   * retrieve one field of the Session/Configuration registers (this version of the function lets you check for I2C errors)
+   *  e.g.: NT3H1x01_FD_ON_ENUM FD_ON;  err = get<NT3H1x01_Sess_NC_FD_ON>(FD_ON);
+   * @tparam FIELD_T the field (see NT3H1x01_regField typedefs at top, e.g. NT3H1x01_Sess_NC_FD_ON)
+   * @param readBuff reference to put the (decoded) result in
+   * @param useCache (only for Configuration register fields) (optional!, not recommended, use at own discretion) fetch data from _oneBlockBuff cache (if possible) instead of actually reading it from I2C (to save a little time).
+   * @return (bool or esp_err_t or i2c_status_e, see on defines at top) whether it wrote/read successfully
+   */
+  template<typename FIELD_T>
+  NT3H1x01_ERR_RETURN_TYPE get(typename FIELD_T::valType& readBuff, bool useCache) {
+    NT3H1x01_STATS_API_NAMED(NT3H1x01_fieldName<FIELD_T>::getLabel());
+    uint8_t regByte = 0;
+    NT3H1x01_ERR_RETURN_TYPE err = (FIELD_T::regs() == NT3H1x01_FIELD_SESS) ? requestSessRegByte(FIELD_T::reg(), regByte) : _getConfRegBytes(FIELD_T::reg(), 1, &regByte, useCache);
+    readBuff = FIELD_T::decode(regByte);
+    return(err);
+  }
+  template<typename FIELD_T>
+  NT3H1x01_ERR_RETURN_TYPE get(typename FIELD_T::valType& readBuff) { NT3H1x01_STATS_API_NAMED(NT3H1x01_fieldName<FIELD_T>::getLabel());  return(get<FIELD_T>(readBuff, false)); } // (just a macro)
+  /**
+   * retrieve one field of the Session/Configuration registers (this version DOES NOT let you check for I2C errors)
+   *  e.g.: if(getVal<NT3H1x01_NS_RF_LOCKED>()) { ... }
+   * @tparam FIELD_T the field (see NT3H1x01_regField typedefs at top, e.g. NT3H1x01_Sess_NC_FD_ON)
+   * @param useCache (only for Configuration register fields) (optional!, not recommended, use at own discretion) fetch data from _oneBlockBuff cache (if possible) instead of actually reading it from I2C (to save a little time).
+   * @return the (decoded) field value
+   */
+  template<typename FIELD_T>
+  typename FIELD_T::valType getVal(bool useCache=false) {
+    NT3H1x01_STATS_API_NAMED(NT3H1x01_fieldName<FIELD_T>::getValLabel());
+    typename FIELD_T::valType readBuff;   NT3H1x01_ERR_RETURN_TYPE err = get<FIELD_T>(readBuff, useCache);
+    if(!_errGood(err)) { NT3H1x01debugPrint("getVal<>() read/write error!"); }
+    return(readBuff);
+  }
+
+  /**
+   * (private) write one or more (already encoded) fields of the same register byte, in a single masked write
+   * @tparam FIELDS_T the fields (must all be in the same register byte, see set<>())
+   * @param regVal the encoded field values (only the bits of the fields are used)
+   * @param useCache (only for Configuration register fields) (optional!, not recommended, use at own discretion) use data from _oneBlockBuff cache (if possible) instead of actually reading it from I2C (to save a little time).
+   * @return (bool or esp_err_t or i2c_status_e, see on defines at top) whether it wrote/read successfully
+   */
+  template<typename... FIELDS_T>
+  NT3H1x01_ERR_RETURN_TYPE _setRegFields(uint8_t regVal, bool useCache=false) {
+    typedef _NT3H1x01_regFieldGroup<FIELDS_T...> group;
+    static_assert(group::sameReg(), "set<>() fields must all be in the same register byte (and all Session or all Configuration)");
+    static_assert(group::noOverlap(), "set<>() fields overlap");
+    static_assert(group::writable(), "set<>() one of the fields is Read-only (or a burn bit, see NT3H1x01_unlock_burning)");
+    if(group::regs() == NT3H1x01_FIELD_SESS) { return(writeSessRegByte(group::reg(), regVal, group::mask())); } // the mask is part of the I2C format, so no read needed
+    return(_setConfRegBits(group::reg(), regVal, group::mask(), useCache));
+  }
+  /**
+   * overwrite one or more fields of the Session/Configuration registers. Multiple fields (of the same register byte) are merged into ONE masked write
+   *  e.g.: err = set<NT3H1x01_Sess_NC_FD_ON, NT3H1x01_Sess_NC_FD_OFF, NT3H1x01_Sess_NC_DIR>(NT3H1x01_FD_ON_FIELD_PRESENCE, NT3H1x01_FD_OFF_FIELD_PRESENCE, true);
+   * (fields in different registers, read-only fields or overlapping fields are a compile error)
+   * @tparam FIELDS_T the fields (see NT3H1x01_regField typedefs at top, e.g. NT3H1x01_Sess_NC_FD_ON)
+   * @param newVals the new values, one per field (in the same order)
+   * @return (bool or esp_err_t or i2c_status_e, see on defines at top) whether it wrote/read successfully
+   */
+  template<typename... FIELDS_T>
+  NT3H1x01_ERR_RETURN_TYPE set(typename FIELDS_T::valType... newVals) { NT3H1x01_STATS_API_NAMED(_NT3H1x01_setLabel<FIELDS_T...>::get());  return(_setRegFields<FIELDS_T...>(_NT3H1x01_regFieldGroup<FIELDS_T...>::encode(newVals...))); } // (just a macro)
+
 /////////////////////////////////////////////////////////////////////////////////////// set functions: //////////////////////////////////////////////////////////
 
   /**
@@ -464,6 +1330,7 @@ class NT3H1x01_thijs : public _NT3H1x01_thijs_base
    * @return (bool or esp_err_t or i2c_status_e, see on defines at top) whether it wrote/read successfully
    */
   NT3H1x01_ERR_RETURN_TYPE setI2Caddress(uint8_t newAddress, bool useCache=false) { // does not seem to work (yet)
+    NT3H1x01_STATS_API();
     NT3H1x01_ERR_RETURN_TYPE err = _setValInBlock<uint8_t>(NT3H1x01_I2C_ADDR_CHANGE_MEMA, NT3H1x01_I2C_ADDR_CHANGE_MEMA_BYTE, newAddress<<1, true, useCache);
     if(_errGood(err)) { slaveAddress = newAddress; } // update this object's address byte ONLY IF the transfer seemed to go as intended
     else { NT3H1x01debugPrint("setI2Caddress() failed!"); }
@@ -476,14 +1343,14 @@ class NT3H1x01_thijs : public _NT3H1x01_thijs_base
    * @param useCache (optional!, not recommended, use at own discretion) fetch data from _oneBlockBuff cache (if possible) instead of actually reading it from I2C (to save a little time).
    * @return (bool or esp_err_t or i2c_status_e, see on defines at top) whether it wrote/read successfully
    */
-  NT3H1x01_ERR_RETURN_TYPE setCC(uint8_t writeBuff[], bool useCache = false) { return(_setBytesInBlock(NT3H1x01_CAPA_CONT_MEMA, NT3H1x01_CAPA_CONT_MEMA_BYTES_START, 4, writeBuff, useCache)); }
+  NT3H1x01_ERR_RETURN_TYPE setCC(const uint8_t writeBuff[], bool useCache = false) { NT3H1x01_STATS_API();  return(_setBytesInBlock(NT3H1x01_CAPA_CONT_MEMA, NT3H1x01_CAPA_CONT_MEMA_BYTES_START, 4, writeBuff, useCache)); }
   /**
    * overwrite the Capability Container (also mentioned as NDEF thingy) with a 4byte value
    * @param newVal 4 byte value (little-endian) to write to the CC bytes (i stronly recommend NT3H1x01_CAPA_CONT_DEFAULT_uint32_t[is2kVariant])
    * @param useCache (optional!, not recommended, use at own discretion) use data from _oneBlockBuff cache (if possible) instead of actually reading it from I2C (to save a little time).
    * @return (bool or esp_err_t or i2c_status_e, see on defines at top) whether it wrote/read successfully
    */
-  NT3H1x01_ERR_RETURN_TYPE setCC(uint32_t newVal, bool useCache = false) { return(_setValInBlock<uint32_t>(NT3H1x01_CAPA_CONT_MEMA, NT3H1x01_CAPA_CONT_MEMA_BYTES_START, newVal, true, useCache)); }
+  NT3H1x01_ERR_RETURN_TYPE setCC(uint32_t newVal, bool useCache = false) { NT3H1x01_STATS_API();  return(_setValInBlock<uint32_t>(NT3H1x01_CAPA_CONT_MEMA, NT3H1x01_CAPA_CONT_MEMA_BYTES_START, newVal, true, useCache)); }
 
   ///////////////////////////////////// Session register set functions: /////////////////////////////////////
   /**
@@ -491,70 +1358,64 @@ class NT3H1x01_thijs : public _NT3H1x01_thijs_base
    * @param newVal (see NT3H1x01_NC_REG_xxx_bits defines at top for contents)
    * @return (bool or esp_err_t or i2c_status_e, see on defines at top) whether it wrote successfully
    */
-  NT3H1x01_ERR_RETURN_TYPE setSess_NC_REG(uint8_t newVal) { return(writeSessRegByte(NT3H1x01_COMN_REGS_NC_REG_BYTE, newVal)); }
+  NT3H1x01_ERR_RETURN_TYPE setSess_NC_REG(uint8_t newVal) { NT3H1x01_STATS_API();  return(writeSessRegByte(NT3H1x01_COMN_REGS_NC_REG_BYTE, newVal)); }
   /**
    * overwrite FD_OFF bits from the NC_REG Session register
    * @param newVal FD_OFF determines the behaviour of the FD pin (falling)
    * @return (bool or esp_err_t or i2c_status_e, see on defines at top) whether it wrote successfully
    */
-  NT3H1x01_ERR_RETURN_TYPE setSess_NC_FD_OFF(NT3H1x01_FD_OFF_ENUM newVal) { return(writeSessRegByte(NT3H1x01_COMN_REGS_NC_REG_BYTE, static_cast<uint8_t>(newVal) << 4, NT3H1x01_NC_REG_FD_OFF_bits)); }
+  NT3H1x01_ERR_RETURN_TYPE setSess_NC_FD_OFF(NT3H1x01_FD_OFF_ENUM newVal) { NT3H1x01_STATS_API();  return(set<NT3H1x01_Sess_NC_FD_OFF>(newVal)); } // (just a macro)
   /**
    * overwrite FD_ON bits from the NC_REG Session register
    * @param newVal FD_ON determines the behaviour of the FD pin (rising)
    * @return (bool or esp_err_t or i2c_status_e, see on defines at top) whether it wrote successfully
    */
-  NT3H1x01_ERR_RETURN_TYPE setSess_NC_FD_ON(NT3H1x01_FD_ON_ENUM newVal) { return(writeSessRegByte(NT3H1x01_COMN_REGS_NC_REG_BYTE, static_cast<uint8_t>(newVal) << 2, NT3H1x01_NC_REG_FD_ON_bits)); }
-  /**
-   * (private) overwrite one arbetrary bit from the NC_REG Session register
-   * @param mask which bit to target (see NT3H1x01_NC_REG_xxx_bits defines at top for contents)
-   * @param newBitVal LSBit boolean, to be shifted by the mask to the correct position
-   * @return (bool or esp_err_t or i2c_status_e, see on defines at top) whether it wrote successfully
-   */
-  NT3H1x01_ERR_RETURN_TYPE _setSess_NC_oneBit(uint8_t mask, bool newBitVal) { return(writeSessRegByte(NT3H1x01_COMN_REGS_NC_REG_BYTE, newBitVal ? mask : 0, mask)); }
+  NT3H1x01_ERR_RETURN_TYPE setSess_NC_FD_ON(NT3H1x01_FD_ON_ENUM newVal) { NT3H1x01_STATS_API();  return(set<NT3H1x01_Sess_NC_FD_ON>(newVal)); } // (just a macro)
   /**
    * overwrite I2C_RST_ON_OFF bit from the NC_REG Session register
    * @param newVal I2C_RST_ON_OFF enables soft-reset through repeated starts in I2C communication (very cool, slightly niche)
    * @return (bool or esp_err_t or i2c_status_e, see on defines at top) whether it wrote successfully
    */
-  NT3H1x01_ERR_RETURN_TYPE setSess_NC_I2C_RST(bool newVal) { return(_setSess_NC_oneBit(NT3H1x01_NC_REG_I2C_RST_bits, newVal)); } // (just a macro)
+  NT3H1x01_ERR_RETURN_TYPE setSess_NC_I2C_RST(bool newVal) { NT3H1x01_STATS_API();  return(set<NT3H1x01_Sess_NC_I2C_RST>(newVal)); } // (just a macro)
   /**
    * overwrite TRANSFER_DIR/PTHRU_DIR bit from the NC_REG Session register
    * @param newVal TRANSFER_DIR/PTHRU_DIR bit (bool)     TRANSFER_DIR/PTHRU_DIR determines the direction of data in Pass-Through mode, or can disable RF write-access otherwise
    * @return (bool or esp_err_t or i2c_status_e, see on defines at top) whether it wrote successfully
    */
-  NT3H1x01_ERR_RETURN_TYPE setSess_NC_DIR(bool newVal) { return(_setSess_NC_oneBit(NT3H1x01_NC_REG_DIR_bits, newVal)); } // (just a macro)
+  NT3H1x01_ERR_RETURN_TYPE setSess_NC_DIR(bool newVal) { NT3H1x01_STATS_API();  return(set<NT3H1x01_Sess_NC_DIR>(newVal)); } // (just a macro)
   /**
    * overwrite PTHRU_ON_OFF bit from the NC_REG Session register
    * @param newVal PTHRU_ON_OFF bit (bool)     PTHRU_ON_OFF enables Pass-Through mode
    * @return (bool or esp_err_t or i2c_status_e, see on defines at top) whether it wrote successfully
    */
-  NT3H1x01_ERR_RETURN_TYPE setSess_NC_PTHRU(bool newVal) { return(_setSess_NC_oneBit(NT3H1x01_NC_REG_PTHRU_bits, newVal)); } // (just a macro)
+  NT3H1x01_ERR_RETURN_TYPE setSess_NC_PTHRU(bool newVal) { NT3H1x01_STATS_API();  return(set<NT3H1x01_Sess_NC_PTHRU>(newVal)); } // (just a macro)
   /**
    * overwrite SRAM_MIRROR_ON_OFF bit from the NC_REG Session register
    * @param newVal SRAM_MIRROR_ON_OFF bit (bool)     SRAM_MIRROR_ON_OFF enables Memory-Mirror mode
    * @return (bool or esp_err_t or i2c_status_e, see on defines at top) whether it wrote successfully
    */
-  NT3H1x01_ERR_RETURN_TYPE setSess_NC_MIRROR(bool newVal) { return(_setSess_NC_oneBit(NT3H1x01_NC_REG_MIRROR_bits, newVal)); } // (just a macro)
+  NT3H1x01_ERR_RETURN_TYPE setSess_NC_MIRROR(bool newVal) { NT3H1x01_STATS_API();  return(set<NT3H1x01_Sess_NC_MIRROR>(newVal)); } // (just a macro)
 
   /**
    * overwrite the LAST_NDEF_BLOCK byte in the Session registers
    * @param newVal address of last block (== 16 bytes == 4 pages) of user-memory that holds actual data
    * @return (bool or esp_err_t or i2c_status_e, see on defines at top) whether it wrote successfully
    */
-  NT3H1x01_ERR_RETURN_TYPE setSess_LAST_NDEF_BLOCK(uint8_t newVal) { return(writeSessRegByte(NT3H1x01_COMN_REGS_LAST_NDEF_BLOCK_BYTE, newVal)); }
+  NT3H1x01_ERR_RETURN_TYPE setSess_LAST_NDEF_BLOCK(uint8_t newVal) { NT3H1x01_STATS_API();  return(set<NT3H1x01_Sess_LAST_NDEF_BLOCK>(newVal)); } // (just a macro)
   /**
    * overwrite the SRAM_MIRROR_BLOCK byte in the Session registers
    * @param newVal address of first block of user-memory to be replaced (mapped over) by SRAM when Mirror-Mode is enabled
    * @return (bool or esp_err_t or i2c_status_e, see on defines at top) whether it wrote successfully
    */
-  NT3H1x01_ERR_RETURN_TYPE setSess_SRAM_MIRROR_BLOCK(uint8_t newVal) { return(writeSessRegByte(NT3H1x01_COMN_REGS_SRAM_MIRROR_BLOCK_BYTE, newVal)); }
+  NT3H1x01_ERR_RETURN_TYPE setSess_SRAM_MIRROR_BLOCK(uint8_t newVal) { NT3H1x01_STATS_API();  return(set<NT3H1x01_Sess_SRAM_MIRROR_BLOCK>(newVal)); } // (just a macro)
   /**
    * overwrite the WatchDog Timer threshold (raw) (from a byte buffer) in the Session registers
    * @param writeBuff 2 byte buffer to write to WDT_LS and WDT_MS (in that order)
    * @return (bool or esp_err_t or i2c_status_e, see on defines at top) whether it wrote successfully
    */
-  NT3H1x01_ERR_RETURN_TYPE setSess_WDTraw(uint8_t writeBuff[]) {
-    NT3H1x01_ERR_RETURN_TYPE err = writeSessRegByte(NT3H1x01_COMN_REGS_WDT_MS_BYTE, writeBuff[0]);
+  NT3H1x01_ERR_RETURN_TYPE setSess_WDTraw(const uint8_t writeBuff[]) {
+    NT3H1x01_STATS_API();
+    NT3H1x01_ERR_RETURN_TYPE err = writeSessRegByte(NT3H1x01_COMN_REGS_WDT_LS_BYTE, writeBuff[0]);
     if(!_errGood(err)) { return(err); } // if the first one failed, return that error
     return(writeSessRegByte(NT3H1x01_COMN_REGS_WDT_MS_BYTE, writeBuff[1]));
   }
@@ -564,6 +1425,7 @@ class NT3H1x01_thijs : public _NT3H1x01_thijs_base
    * @return (bool or esp_err_t or i2c_status_e, see on defines at top) whether it wrote successfully
    */
   NT3H1x01_ERR_RETURN_TYPE setSess_WDTraw(uint16_t newVal) {
+    NT3H1x01_STATS_API();
     uint8_t* bytePtrToNewVal = (uint8_t*) &newVal;
     return(setSess_WDTraw(bytePtrToNewVal));
   }
@@ -572,7 +1434,7 @@ class NT3H1x01_thijs : public _NT3H1x01_thijs_base
    * @param newVal the WatchDog Timer threshold in microseconds
    * @return (bool or esp_err_t or i2c_status_e, see on defines at top) whether it wrote successfully
    */
-  NT3H1x01_ERR_RETURN_TYPE setSess_WDT(float newVal) { return(setSess_WDTraw(constrain(newVal,0,(((float)0xFFFF)*NT3H1x01_WDT_RAW_TO_MICROSECONDS)) / NT3H1x01_WDT_RAW_TO_MICROSECONDS)); } // (just a macro)
+  NT3H1x01_ERR_RETURN_TYPE setSess_WDT(float newVal) { NT3H1x01_STATS_API();  return(setSess_WDTraw(constrain(newVal,0,(((float)0xFFFF)*NT3H1x01_WDT_RAW_TO_MICROSECONDS)) / NT3H1x01_WDT_RAW_TO_MICROSECONDS)); } // (just a macro)
 
   // /**                    ///////////// only 2 bits are R/W, the other 6 are Read-only. This function doesn't really make sense /////////////
   //  * overwrite the (whole) NS_REG Session register
@@ -580,24 +1442,17 @@ class NT3H1x01_thijs : public _NT3H1x01_thijs_base
   //  * @return (bool or esp_err_t or i2c_status_e, see on defines at top) whether it wrote successfully
   //  */
   // NT3H1x01_ERR_RETURN_TYPE setNS_REG(uint8_t newVal) { return(writeSessRegByte(NT3H1x01_SESS_REGS_NS_REG_BYTE, newVal, 0b01000100)); }
-  /**
-   * (private) overwrite one arbetrary bit from the NS_REG Session register. NOTE: only 2 bits are R/W, the rest is R-only: mask=0b01000100
-   * @param mask which bit to target (see NT3H1x01_NS_REG_xxx_bits defines at top for contents)
-   * @param newBitVal LSBit boolean, to be shifted by the mask to the correct position
-   * @return (bool or esp_err_t or i2c_status_e, see on defines at top) whether it wrote successfully
-   */
-  NT3H1x01_ERR_RETURN_TYPE _setNS_oneBit(uint8_t mask, bool newBitVal) { return(writeSessRegByte(NT3H1x01_SESS_REGS_NS_REG_BYTE, newBitVal ? mask : 0, mask)); }
   /**
    * overwrite I2C_LOCKED bit from the NS_REG Session register
    * @param newVal I2C_LOCKED is 1 if I2C has control of memory (arbitration). Should be cleared once the I2C interaction is completely done, may be cleared by WDT
    * @return (bool or esp_err_t or i2c_status_e, see on defines at top) whether it wrote successfully
    */
-  NT3H1x01_ERR_RETURN_TYPE setNS_I2C_LOCKED(bool newVal) { return(_setNS_oneBit(NT3H1x01_NS_REG_I2C_LOCKED_bits, newVal)); } // (just a macro)
+  NT3H1x01_ERR_RETURN_TYPE setNS_I2C_LOCKED(bool newVal) { NT3H1x01_STATS_API();  return(set<NT3H1x01_NS_I2C_LOCKED>(newVal)); } // (just a macro)
   /**
    * clear EEPROM_WR_ERR flag from the NS_REG Session register. EEPROM_WR_ERR is 1 if there was a (High Voltage?) error during EEPROM write. Flag needs to be manually cleared
    * @return (bool or esp_err_t or i2c_status_e, see on defines at top) whether it wrote successfully
    */
-  NT3H1x01_ERR_RETURN_TYPE clear_EEPROM_WR_ERR() { return(_setNS_oneBit(NT3H1x01_NS_REG_EPR_WR_ERR_bits, 0)); } // (just a macro)
+  NT3H1x01_ERR_RETURN_TYPE clear_EEPROM_WR_ERR() { NT3H1x01_STATS_API();  return(set<NT3H1x01_NS_EEPROM_WR_ERR>(false)); } // (just a macro)
 
   ///////////////////////////////////// Configuration register set functions: /////////////////////////////////////
   /**
@@ -611,7 +1466,7 @@ class NT3H1x01_thijs : public _NT3H1x01_thijs_base
    */
   template<typename T> 
   NT3H1x01_ERR_RETURN_TYPE _setConfRegVal(NT3H1x01_CONF_SESS_REGS_ENUM bytesInBlockStart, T newVal, bool writeMSBfirst=false, bool useCache=false)
-    { return(_setValInBlock<T>(is2kVariant ? NT3H1201_CONF_REGS_MEMA : NT3H1101_CONF_REGS_MEMA, bytesInBlockStart, newVal, writeMSBfirst, useCache)); } // (just a macro)
+    { return(_setValInBlock<T>(_confRegsMEMA(), bytesInBlockStart, newVal, writeMSBfirst, useCache)); } // (just a macro)
   /**
    * (private) overwrite a portion (mask) of an arbetrary byte in the Configuration registers (same as _setConfRegVal<uint8_t> BUT with a bitmask option)
    * @param byteInBlock where in the block the relevant data starts (see defines up top)
@@ -621,8 +1476,9 @@ class NT3H1x01_thijs : public _NT3H1x01_thijs_base
    * @return (bool or esp_err_t or i2c_status_e, see on defines at top) whether it wrote/read successfully
    */
   NT3H1x01_ERR_RETURN_TYPE _setConfRegBits(NT3H1x01_CONF_SESS_REGS_ENUM byteInBlock, uint8_t newVal, uint8_t mask, bool useCache=false) {
-    uint8_t blockAddress = (is2kVariant ? NT3H1201_CONF_REGS_MEMA : NT3H1101_CONF_REGS_MEMA);
+    uint8_t blockAddress = _confRegsMEMA();
     NT3H1x01_ERR_RETURN_TYPE err = NT3H1x01_ERR_RETURN_TYPE_OK;
+    NT3H1x01_STATS_CACHE(useCache, blockAddress == _oneBlockBuffAddress);
     if( ! (useCache && (blockAddress == _oneBlockBuffAddress))) { // normally true
       err = requestMemBlock(blockAddress, _oneBlockBuff); _oneBlockBuffAddress = blockAddress; // fetch the whole block
       if(!_errGood(err)) { NT3H1x01debugPrint("_setConfRegBits() read/write error!"); _oneBlockBuffAddress = NT3H1x01_INVALID_MEMA; return(err); }
@@ -640,7 +1496,7 @@ class NT3H1x01_thijs : public _NT3H1x01_thijs_base
    * @param useCache (optional!, not recommended, use at own discretion) use data from _oneBlockBuff cache (if possible) instead of actually reading it from I2C (to save a little time).
    * @return (bool or esp_err_t or i2c_status_e, see on defines at top) whether it wrote successfully
    */
-  NT3H1x01_ERR_RETURN_TYPE setConf_NC_REG(uint8_t newVal, bool useCache=false) { return(_setConfRegVal<uint8_t>(NT3H1x01_COMN_REGS_NC_REG_BYTE, newVal & (~NT3H1x01_NC_REG_RFU_bits), false, useCache)); } // some bits are RFU, and must be kept 0
+  NT3H1x01_ERR_RETURN_TYPE setConf_NC_REG(uint8_t newVal, bool useCache=false) { NT3H1x01_STATS_API();  return(_setConfRegVal<uint8_t>(NT3H1x01_COMN_REGS_NC_REG_BYTE, newVal & (~NT3H1x01_NC_REG_RFU_bits), false, useCache)); } // some bits are RFU, and must be kept 0
   /**
    * overwrite FD_OFF bits from the NC_REG Configuration register
    * @param newVal FD_OFF determines the behaviour of the FD pin (falling)
@@ -648,7 +1504,8 @@ class NT3H1x01_thijs : public _NT3H1x01_thijs_base
    * @return (bool or esp_err_t or i2c_status_e, see on defines at top) whether it wrote successfully
    */
   NT3H1x01_ERR_RETURN_TYPE setConf_NC_FD_OFF(NT3H1x01_FD_OFF_ENUM newVal, bool useCache=false) {
-    return(_setConfRegBits(NT3H1x01_COMN_REGS_NC_REG_BYTE, static_cast<uint8_t>(newVal) << 4, NT3H1x01_NC_REG_FD_OFF_bits, useCache)); }
+    NT3H1x01_STATS_API();
+    return(_setRegFields<NT3H1x01_Conf_NC_FD_OFF>(NT3H1x01_Conf_NC_FD_OFF::encode(newVal), useCache)); } // (just a macro)
   /**
    * overwrite FD_ON bits from the NC_REG Configuration register
    * @param newVal FD_ON determines the behaviour of the FD pin (rising)
@@ -656,30 +1513,22 @@ class NT3H1x01_thijs : public _NT3H1x01_thijs_base
    * @return (bool or esp_err_t or i2c_status_e, see on defines at top) whether it wrote successfully
    */
   NT3H1x01_ERR_RETURN_TYPE setConf_NC_FD_ON(NT3H1x01_FD_ON_ENUM newVal, bool useCache=false) {
-    return(_setConfRegBits(NT3H1x01_COMN_REGS_NC_REG_BYTE, static_cast<uint8_t>(newVal) << 2, NT3H1x01_NC_REG_FD_ON_bits, useCache)); }
-  /**
-   * (private) overwrite one arbetrary bit from the NC_REG Configuration register
-   * @param mask which bit to target (see NT3H1x01_NC_REG_xxx_bits defines at top for contents)
-   * @param newBitVal LSBit boolean, to be shifted by the mask to the correct position
-   * @param useCache (optional!, not recommended, use at own discretion) fetch data from _oneBlockBuff cache (if possible) instead of actually reading it from I2C (to save a little time).
-   * @return (bool or esp_err_t or i2c_status_e, see on defines at top) whether it wrote successfully
-   */
-  NT3H1x01_ERR_RETURN_TYPE _setConf_NC_oneBit(uint8_t mask, bool newBitVal, bool useCache=false) {
-    return(_setConfRegBits(NT3H1x01_COMN_REGS_NC_REG_BYTE, newBitVal ? mask : 0, mask, useCache)); }
+    NT3H1x01_STATS_API();
+    return(_setRegFields<NT3H1x01_Conf_NC_FD_ON>(NT3H1x01_Conf_NC_FD_ON::encode(newVal), useCache)); } // (just a macro)
   /**
    * overwrite I2C_RST_ON_OFF bit from the NC_REG Configuration register
    * @param newVal I2C_RST_ON_OFF enables soft-reset through repeated starts in I2C communication (very cool, slightly niche)
    * @param useCache (optional!, not recommended, use at own discretion) use data from _oneBlockBuff cache (if possible) instead of actually reading it from I2C (to save a little time).
    * @return (bool or esp_err_t or i2c_status_e, see on defines at top) whether it wrote successfully
    */
-  NT3H1x01_ERR_RETURN_TYPE setConf_NC_I2C_RST(bool newVal, bool useCache=false) { return(_setConf_NC_oneBit(NT3H1x01_NC_REG_I2C_RST_bits, newVal, useCache)); } // (just a macro)
+  NT3H1x01_ERR_RETURN_TYPE setConf_NC_I2C_RST(bool newVal, bool useCache=false) { NT3H1x01_STATS_API();  return(_setRegFields<NT3H1x01_Conf_NC_I2C_RST>(NT3H1x01_Conf_NC_I2C_RST::encode(newVal), useCache)); } // (just a macro)
   /**
    * overwrite TRANSFER_DIR/PTHRU_DIR bit from the NC_REG Configuration register
    * @param newVal TRANSFER_DIR/PTHRU_DIR bit (bool)     TRANSFER_DIR/PTHRU_DIR determines the direction of data in Pass-Through mode, or can disable RF write-access otherwise
    * @param useCache (optional!, not recommended, use at own discretion) use data from _oneBlockBuff cache (if possible) instead of actually reading it from I2C (to save a little time).
    * @return (bool or esp_err_t or i2c_status_e, see on defines at top) whether it wrote successfully
    */
-  NT3H1x01_ERR_RETURN_TYPE setConf_NC_DIR(bool newVal, bool useCache=false) { return(_setConf_NC_oneBit(NT3H1x01_NC_REG_DIR_bits, newVal, useCache)); } // (just a macro)
+  NT3H1x01_ERR_RETURN_TYPE setConf_NC_DIR(bool newVal, bool useCache=false) { NT3H1x01_STATS_API();  return(_setRegFields<NT3H1x01_Conf_NC_DIR>(NT3H1x01_Conf_NC_DIR::encode(newVal), useCache)); } // (just a macro)
 
   /**
    * overwrite the LAST_NDEF_BLOCK byte in the Configuration registers
@@ -687,43 +1536,44 @@ class NT3H1x01_thijs : public _NT3H1x01_thijs_base
    * @param useCache (optional!, not recommended, use at own discretion) use data from _oneBlockBuff cache (if possible) instead of actually reading it from I2C (to save a little time).
    * @return (bool or esp_err_t or i2c_status_e, see on defines at top) whether it wrote successfully
    */
-  NT3H1x01_ERR_RETURN_TYPE setConf_LAST_NDEF_BLOCK(uint8_t newVal, bool useCache=false) { return(_setConfRegVal<uint8_t>(NT3H1x01_COMN_REGS_LAST_NDEF_BLOCK_BYTE, newVal, false, useCache)); }
+  NT3H1x01_ERR_RETURN_TYPE setConf_LAST_NDEF_BLOCK(uint8_t newVal, bool useCache=false) { NT3H1x01_STATS_API();  return(_setConfRegVal<uint8_t>(NT3H1x01_COMN_REGS_LAST_NDEF_BLOCK_BYTE, newVal, false, useCache)); }
   /**
    * overwrite the SRAM_MIRROR_BLOCK byte in the Configuration registers
    * @param newVal address of first block of user-memory to be replaced (mapped over) by SRAM when Mirror-Mode is enabled
    * @param useCache (optional!, not recommended, use at own discretion) use data from _oneBlockBuff cache (if possible) instead of actually reading it from I2C (to save a little time).
    * @return (bool or esp_err_t or i2c_status_e, see on defines at top) whether it wrote successfully
    */
-  NT3H1x01_ERR_RETURN_TYPE setConf_SRAM_MIRROR_BLOCK(uint8_t newVal, bool useCache=false) { return(_setConfRegVal<uint8_t>(NT3H1x01_COMN_REGS_SRAM_MIRROR_BLOCK_BYTE, newVal, false, useCache)); }
+  NT3H1x01_ERR_RETURN_TYPE setConf_SRAM_MIRROR_BLOCK(uint8_t newVal, bool useCache=false) { NT3H1x01_STATS_API();  return(_setConfRegVal<uint8_t>(NT3H1x01_COMN_REGS_SRAM_MIRROR_BLOCK_BYTE, newVal, false, useCache)); }
   /**
    * overwrite the WatchDog Timer threshold (raw) (from a byte buffer) in the Configuration registers
    * @param writeBuff 2 byte buffer to write to WDT_LS and WDT_MS (in that order)
    * @param useCache (optional!, not recommended, use at own discretion) fetch data from _oneBlockBuff cache (if possible) instead of actually reading it from I2C (to save a little time).
    * @return (bool or esp_err_t or i2c_status_e, see on defines at top) whether it wrote successfully
    */
-  NT3H1x01_ERR_RETURN_TYPE setConf_WDTraw(uint8_t writeBuff[], bool useCache=false) {
-    return(_setBytesInBlock(is2kVariant ? NT3H1201_CONF_REGS_MEMA : NT3H1101_CONF_REGS_MEMA, NT3H1x01_COMN_REGS_WDT_LS_BYTE, 2, writeBuff, useCache)); } // (just a macro)
+  NT3H1x01_ERR_RETURN_TYPE setConf_WDTraw(const uint8_t writeBuff[], bool useCache=false) {
+    NT3H1x01_STATS_API();
+    return(_setBytesInBlock(_confRegsMEMA(), NT3H1x01_COMN_REGS_WDT_LS_BYTE, 2, writeBuff, useCache)); } // (just a macro)
   /**
    * overwrite the WatchDog Timer threshold (raw) in the Configuration registers
    * @param newVal the WatchDog Timer threshold as a uint16_t, (multiply with NT3H1x01_WDT_RAW_TO_MICROSECONDS to get microseconds)
    * @param useCache (optional!, not recommended, use at own discretion) use data from _oneBlockBuff cache (if possible) instead of actually reading it from I2C (to save a little time).
    * @return (bool or esp_err_t or i2c_status_e, see on defines at top) whether it wrote successfully
    */
-  NT3H1x01_ERR_RETURN_TYPE setConf_WDTraw(uint16_t newVal, bool useCache=false) { return(_setConfRegVal<uint16_t>(NT3H1x01_COMN_REGS_WDT_LS_BYTE, newVal, false, useCache)); } // (just a macro)
+  NT3H1x01_ERR_RETURN_TYPE setConf_WDTraw(uint16_t newVal, bool useCache=false) { NT3H1x01_STATS_API();  return(_setConfRegVal<uint16_t>(NT3H1x01_COMN_REGS_WDT_LS_BYTE, newVal, false, useCache)); } // (just a macro)
   /**
    * overwrite the WatchDog Timer threshold in the Configuration registers
    * @param newVal the WatchDog Timer threshold in microseconds
    * @param useCache (optional!, not recommended, use at own discretion) use data from _oneBlockBuff cache (if possible) instead of actually reading it from I2C (to save a little time).
    * @return (bool or esp_err_t or i2c_status_e, see on defines at top) whether it wrote successfully
    */
-  NT3H1x01_ERR_RETURN_TYPE setConf_WDT(float newVal, bool useCache=false) { return(setConf_WDTraw(constrain(newVal,0,(((float)0xFFFF)*NT3H1x01_WDT_RAW_TO_MICROSECONDS)) / NT3H1x01_WDT_RAW_TO_MICROSECONDS, useCache)); } // (just a macro)
+  NT3H1x01_ERR_RETURN_TYPE setConf_WDT(float newVal, bool useCache=false) { NT3H1x01_STATS_API();  return(setConf_WDTraw(constrain(newVal,0,(((float)0xFFFF)*NT3H1x01_WDT_RAW_TO_MICROSECONDS)) / NT3H1x01_WDT_RAW_TO_MICROSECONDS, useCache)); } // (just a macro)
   /**
    * overwrite the I2C_CLOCK_STR byte in the Configuration registers. NOTE: in Sess. regs I2C_CLOCK_STR is Read-only
    * @param newVal I2C clock stretching enable/disable
    * @param useCache (optional!, not recommended, use at own discretion) fetch data from _oneBlockBuff cache (if possible) instead of actually reading it from I2C (to save a little time).
    * @return (bool or esp_err_t or i2c_status_e, see on defines at top) whether it wrote successfully
    */
-  NT3H1x01_ERR_RETURN_TYPE set_I2C_CLOCK_STR(bool newVal, bool useCache=false) { return(_setConfRegBits(NT3H1x01_COMN_REGS_I2C_CLOCK_STR_BYTE, newVal, 0x01, useCache)); } // (just a macro)
+  NT3H1x01_ERR_RETURN_TYPE set_I2C_CLOCK_STR(bool newVal, bool useCache=false) { NT3H1x01_STATS_API();  return(_setRegFields<NT3H1x01_Conf_I2C_CLOCK_STR>(NT3H1x01_Conf_I2C_CLOCK_STR::encode(newVal), useCache)); } // (just a macro)
 
   #ifdef NT3H1x01_unlock_burning // functions that can have a permanent consequence)
     #warning("burnRegLockI2C() and burnRegLockRF() are untested!")
@@ -732,13 +1582,13 @@ class NT3H1x01_thijs : public _NT3H1x01_thijs_base
      * @param useCache (optional!, not recommended, use at own discretion) use data from _oneBlockBuff cache (if possible) instead of actually reading it from I2C (to save a little time).
      * @return (bool or esp_err_t or i2c_status_e, see on defines at top) whether it wrote/read successfully
      */
-    NT3H1x01_ERR_RETURN_TYPE burnRegLockI2C(bool useCache=false) { return(_setConfRegVal<uint8_t>(NT3H1x01_CONF_REGS_REG_LOCK_BYTE, NT3H1x01_NC_REG_LOCK_I2C_bits, false, useCache)); }
+    NT3H1x01_ERR_RETURN_TYPE burnRegLockI2C(bool useCache=false) { NT3H1x01_STATS_API();  return(_setConfRegVal<uint8_t>(NT3H1x01_CONF_REGS_REG_LOCK_BYTE, NT3H1x01_NC_REG_LOCK_I2C_bits, false, useCache)); }
     /**
      * disables writing to the Configuration register bytes from RF PERMANENTLY
      * @param useCache (optional!, not recommended, use at own discretion) use data from _oneBlockBuff cache (if possible) instead of actually reading it from I2C (to save a little time).
      * @return (bool or esp_err_t or i2c_status_e, see on defines at top) whether it wrote/read successfully
      */
-    NT3H1x01_ERR_RETURN_TYPE burnRegLockRF(bool useCache=false) { return(_setConfRegVal<uint8_t>(NT3H1x01_CONF_REGS_REG_LOCK_BYTE, NT3H1x01_NC_REG_LOCK_RF_bits, false, useCache)); }
+    NT3H1x01_ERR_RETURN_TYPE burnRegLockRF(bool useCache=false) { NT3H1x01_STATS_API();  return(_setConfRegVal<uint8_t>(NT3H1x01_CONF_REGS_REG_LOCK_BYTE, NT3H1x01_NC_REG_LOCK_RF_bits, false, useCache)); }
   #endif // NT3H1x01_unlock_burning
 
 /////////////////////////////////////////////////////////////////////////////////////// get functions: //////////////////////////////////////////////////////////
@@ -749,48 +1599,48 @@ class NT3H1x01_thijs : public _NT3H1x01_thijs_base
    * @param useCache (optional!, not recommended, use at own discretion) fetch data from _oneBlockBuff cache (if possible) instead of actually reading it from I2C (to save a little time).
    * @return (bool or esp_err_t or i2c_status_e, see on defines at top) whether it wrote/read successfully
    */
-  NT3H1x01_ERR_RETURN_TYPE getUID(uint8_t readBuff[], bool useCache=false) { return(_getBytesFromBlock(NT3H1x01_SERIAL_NR_MEMA, NT3H1x01_SERIAL_NR_MEMA_BYTES_START, 7, readBuff, useCache)); } // (just a macro)
+  NT3H1x01_ERR_RETURN_TYPE getUID(uint8_t readBuff[], bool useCache=false) { NT3H1x01_STATS_API();  return(_getBytesFromBlock(NT3H1x01_SERIAL_NR_MEMA, NT3H1x01_SERIAL_NR_MEMA_BYTES_START, 7, readBuff, useCache)); } // (just a macro)
   /**
    * retrieve the Capability Container (also mentioned as NDEF thingy) (this version of the function lets you check for I2C errors)
    * @param readBuff 4 byte buffer to put the results in (results should match NT3H1x01_CAPA_CONT_DEFAULT)
    * @param useCache (optional!, not recommended, use at own discretion) fetch data from _oneBlockBuff cache (if possible) instead of actually reading it from I2C (to save a little time).
    * @return (bool or esp_err_t or i2c_status_e, see on defines at top) whether it wrote/read successfully
    */
-  NT3H1x01_ERR_RETURN_TYPE getCC(uint8_t readBuff[], bool useCache=false) { return(_getBytesFromBlock(NT3H1x01_CAPA_CONT_MEMA, NT3H1x01_CAPA_CONT_MEMA_BYTES_START, 4, readBuff, useCache)); } // (just a macro)
+  NT3H1x01_ERR_RETURN_TYPE getCC(uint8_t readBuff[], bool useCache=false) { NT3H1x01_STATS_API();  return(_getBytesFromBlock(NT3H1x01_CAPA_CONT_MEMA, NT3H1x01_CAPA_CONT_MEMA_BYTES_START, 4, readBuff, useCache)); } // (just a macro)
   /**
    * retrieve the Capability Container (also mentioned as NDEF thingy) (this version DOES NOT let you check for I2C errors)
    * @param readMSBfirst whether to read the MSByte first or the LSByte first (Big/Little-endian respectively)
    * @param useCache (optional!, not recommended, use at own discretion) fetch data from _oneBlockBuff cache (if possible) instead of actually reading it from I2C (to save a little time).
    * @return the Capability Container as a uint32_t. result should match NT3H1x01_CAPA_CONT_DEFAULT_uint32_t
    */
-  uint32_t getCC(bool readMSBfirst=true, bool useCache=false) { return(_getValFromBlock<uint32_t>(NT3H1x01_CAPA_CONT_MEMA, NT3H1x01_CAPA_CONT_MEMA_BYTES_START, readMSBfirst, useCache)); } // (just a macro)
+  uint32_t getCC(bool readMSBfirst=true, bool useCache=false) { NT3H1x01_STATS_API();  return(_getValFromBlock<uint32_t>(NT3H1x01_CAPA_CONT_MEMA, NT3H1x01_CAPA_CONT_MEMA_BYTES_START, readMSBfirst, useCache)); } // (just a macro)
   /**
    * retrieve the ATQA bytes NOTE: datasheet mentions theses bytes are stored LSB first (this version of the function lets you check for I2C errors)
    * @param readBuff 2 byte buffer to put the results in (result should match 0x44,0x00)
    * @param useCache (optional!, not recommended, use at own discretion) fetch data from _oneBlockBuff cache (if possible) instead of actually reading it from I2C (to save a little time).
    * @return (bool or esp_err_t or i2c_status_e, see on defines at top) whether it wrote/read successfully
    */
-  NT3H1x01_ERR_RETURN_TYPE getATQA(uint8_t readBuff[], bool useCache=false) { return(_getBytesFromBlock(NT3H1x01_ATQA_MEMA, NT3H1x01_ATQA_MEMA_BYTES_START, 2, readBuff, useCache)); } // (just a macro)
+  NT3H1x01_ERR_RETURN_TYPE getATQA(uint8_t readBuff[], bool useCache=false) { NT3H1x01_STATS_API();  return(_getBytesFromBlock(NT3H1x01_ATQA_MEMA, NT3H1x01_ATQA_MEMA_BYTES_START, 2, readBuff, useCache)); } // (just a macro)
   /**
    * retrieve the ATQA bytes as uint16_t (this version DOES NOT let you check for I2C errors)
    * @param readMSBfirst whether to read the MSByte first or the LSByte first (Big/Little-endian respectively)
    * @param useCache (optional!, not recommended, use at own discretion) fetch data from _oneBlockBuff cache (if possible) instead of actually reading it from I2C (to save a little time).
    * @return ATQA bytes as a uint16_t.
    */
-  uint16_t getATQA(bool readMSBfirst=true, bool useCache=false) { return(_getValFromBlock<uint16_t>(NT3H1x01_ATQA_MEMA, NT3H1x01_ATQA_MEMA_BYTES_START, readMSBfirst, useCache)); } // (just a macro)
+  uint16_t getATQA(bool readMSBfirst=true, bool useCache=false) { NT3H1x01_STATS_API();  return(_getValFromBlock<uint16_t>(NT3H1x01_ATQA_MEMA, NT3H1x01_ATQA_MEMA_BYTES_START, readMSBfirst, useCache)); } // (just a macro)
   /**
    * retrieve the SAK byte (this version of the function lets you check for I2C errors)
    * @param readBuff byte pointer to put the result in
    * @param useCache (optional!, not recommended, use at own discretion) fetch data from _oneBlockBuff cache (if possible) instead of actually reading it from I2C (to save a little time).
    * @return (bool or esp_err_t or i2c_status_e, see on defines at top) whether it wrote/read successfully
    */
-  NT3H1x01_ERR_RETURN_TYPE getSAK(uint8_t readBuff[], bool useCache=false) { return(_getBytesFromBlock(NT3H1x01_SAK_MEMA, NT3H1x01_SAK_MEMA_BYTE, 1, readBuff, useCache)); } // (just a macro)
+  NT3H1x01_ERR_RETURN_TYPE getSAK(uint8_t readBuff[], bool useCache=false) { NT3H1x01_STATS_API();  return(_getBytesFromBlock(NT3H1x01_SAK_MEMA, NT3H1x01_SAK_MEMA_BYTE, 1, readBuff, useCache)); } // (just a macro)
   /**
    * retrieve the SAK byte (this version DOES NOT let you check for I2C errors)
    * @param useCache (optional!, not recommended, use at own discretion) fetch data from _oneBlockBuff cache (if possible) instead of actually reading it from I2C (to save a little time).
    * @return the SAK byte
    */
-  uint8_t getSAK(bool useCache=false) { return(_getValFromBlock<uint8_t>(NT3H1x01_SAK_MEMA, NT3H1x01_SAK_MEMA_BYTE, true, useCache)); } // (just a macro)
+  uint8_t getSAK(bool useCache=false) { NT3H1x01_STATS_API();  return(_getValFromBlock<uint8_t>(NT3H1x01_SAK_MEMA, NT3H1x01_SAK_MEMA_BYTE, true, useCache)); } // (just a macro)
 
 
   ///////////////////////////////////// Session register get functions: /////////////////////////////////////
@@ -799,12 +1649,13 @@ class NT3H1x01_thijs : public _NT3H1x01_thijs_base
    * @param readBuff byte reference to put the result in (see NT3H1x01_NC_REG_xxx_bits defines at top for contents)
    * @return (bool or esp_err_t or i2c_status_e, see on defines at top) whether it wrote/read successfully
    */
-  NT3H1x01_ERR_RETURN_TYPE getSess_NC_REG(uint8_t& readBuff) { return(requestSessRegByte(NT3H1x01_COMN_REGS_NC_REG_BYTE, readBuff)); } // (just a macro)
+  NT3H1x01_ERR_RETURN_TYPE getSess_NC_REG(uint8_t& readBuff) { NT3H1x01_STATS_API();  return(requestSessRegByte(NT3H1x01_COMN_REGS_NC_REG_BYTE, readBuff)); } // (just a macro)
   /**
    * retrieve the (whole) NC_REG Session register (this version DOES NOT let you check for I2C errors)
    * @return the (whole) NC_REG (see NT3H1x01_NC_REG_xxx_bits defines at top for contents)
    */
   uint8_t getSess_NC_REG() {
+    NT3H1x01_STATS_API();
     uint8_t readBuff;   NT3H1x01_ERR_RETURN_TYPE err = getSess_NC_REG(readBuff);
     if(!_errGood(err)) { NT3H1x01debugPrint("getSess_NC_REG() read/write error!"); }
     return(readBuff);
@@ -813,44 +1664,45 @@ class NT3H1x01_thijs : public _NT3H1x01_thijs_base
    * retrieve I2C_RST_ON_OFF bit from the NC_REG Session register
    * @return the I2C_RST_ON_OFF bit (bool)     I2C_RST_ON_OFF enables soft-reset through repeated starts in I2C communication (very cool, slightly niche)
    */
-  bool getSess_NC_I2C_RST() { return((getSess_NC_REG() & NT3H1x01_NC_REG_I2C_RST_bits) != 0); } // (just a macro)
+  bool getSess_NC_I2C_RST() { NT3H1x01_STATS_API();  return(getVal<NT3H1x01_Sess_NC_I2C_RST>()); } // (just a macro)
   /**
    * retrieve FD_OFF bits from the NC_REG Session register
    * @return the FD_OFF bits (2)     FD_OFF determines the behaviour of the FD pin (falling)
    */
-  NT3H1x01_FD_OFF_ENUM getSess_NC_FD_OFF() { return(static_cast<NT3H1x01_FD_OFF_ENUM>((getSess_NC_REG() & NT3H1x01_NC_REG_FD_OFF_bits) >> 4)); } // (just a macro)
+  NT3H1x01_FD_OFF_ENUM getSess_NC_FD_OFF() { NT3H1x01_STATS_API();  return(getVal<NT3H1x01_Sess_NC_FD_OFF>()); } // (just a macro)
   /**
    * retrieve FD_ON bits from the NC_REG Session register
    * @return the FD_ON bits (2)     FD_ON determines the behaviour of the FD pin (rising)
    */
-  NT3H1x01_FD_ON_ENUM getSess_NC_FD_ON() { return(static_cast<NT3H1x01_FD_ON_ENUM>((getSess_NC_REG() & NT3H1x01_NC_REG_FD_ON_bits) >> 2)); } // (just a macro)
+  NT3H1x01_FD_ON_ENUM getSess_NC_FD_ON() { NT3H1x01_STATS_API();  return(getVal<NT3H1x01_Sess_NC_FD_ON>()); } // (just a macro)
   /**
    * retrieve TRANSFER_DIR/PTHRU_DIR bit from the NC_REG Session register
    * @return the TRANSFER_DIR/PTHRU_DIR bit (bool)     TRANSFER_DIR/PTHRU_DIR determines the direction of data in Pass-Through mode, or can disable RF write-access otherwise
    */
-  bool getSess_NC_DIR() { return((getSess_NC_REG() & NT3H1x01_NC_REG_DIR_bits) != 0); } // (just a macro)
+  bool getSess_NC_DIR() { NT3H1x01_STATS_API();  return(getVal<NT3H1x01_Sess_NC_DIR>()); } // (just a macro)
   /**
    * retrieve PTHRU_ON_OFF bit from the NC_REG Session register
    * @return the PTHRU_ON_OFF bit (bool)     PTHRU_ON_OFF enables Pass-Through mode
    */
-  bool getSess_NC_PTHRU() { return((getSess_NC_REG() & NT3H1x01_NC_REG_PTHRU_bits) != 0); } // (just a macro)
+  bool getSess_NC_PTHRU() { NT3H1x01_STATS_API();  return(getVal<NT3H1x01_Sess_NC_PTHRU>()); } // (just a macro)
   /**
    * retrieve SRAM_MIRROR_ON_OFF bit from the NC_REG Session register
    * @return the SRAM_MIRROR_ON_OFF bit (bool)     SRAM_MIRROR_ON_OFF enables Memory-Mirror mode
    */
-  bool getSess_NC_MIRROR() { return((getSess_NC_REG() & NT3H1x01_NC_REG_MIRROR_bits) != 0); } // (just a macro)
+  bool getSess_NC_MIRROR() { NT3H1x01_STATS_API();  return(getVal<NT3H1x01_Sess_NC_MIRROR>()); } // (just a macro)
 
   /**
    * retrieve the LAST_NDEF_BLOCK byte from the Session registers (this version of the function lets you check for I2C errors)
    * @param readBuff byte reference to put the result in
    * @return (bool or esp_err_t or i2c_status_e, see on defines at top) whether it wrote/read successfully
    */
-  NT3H1x01_ERR_RETURN_TYPE getSess_LAST_NDEF_BLOCK(uint8_t& readBuff) { return(requestSessRegByte(NT3H1x01_COMN_REGS_LAST_NDEF_BLOCK_BYTE, readBuff)); } // (just a macro)
+  NT3H1x01_ERR_RETURN_TYPE getSess_LAST_NDEF_BLOCK(uint8_t& readBuff) { NT3H1x01_STATS_API();  return(requestSessRegByte(NT3H1x01_COMN_REGS_LAST_NDEF_BLOCK_BYTE, readBuff)); } // (just a macro)
   /**
    * retrieve the LAST_NDEF_BLOCK byte from the Session registers (this version DOES NOT let you check for I2C errors)
    * @return the LAST_NDEF_BLOCK byte
    */
   uint8_t getSess_LAST_NDEF_BLOCK() {
+    NT3H1x01_STATS_API();
     uint8_t readBuff;   NT3H1x01_ERR_RETURN_TYPE err = getSess_LAST_NDEF_BLOCK(readBuff);
     if(!_errGood(err)) { NT3H1x01debugPrint("getSess_LAST_NDEF_BLOCK() read/write error!"); }
     return(readBuff);
@@ -860,12 +1712,13 @@ class NT3H1x01_thijs : public _NT3H1x01_thijs_base
    * @param readBuff byte reference to put the result in
    * @return (bool or esp_err_t or i2c_status_e, see on defines at top) whether it wrote/read successfully
    */
-  NT3H1x01_ERR_RETURN_TYPE getSess_SRAM_MIRROR_BLOCK(uint8_t& readBuff) { return(requestSessRegByte(NT3H1x01_COMN_REGS_SRAM_MIRROR_BLOCK_BYTE, readBuff)); } // (just a macro)
+  NT3H1x01_ERR_RETURN_TYPE getSess_SRAM_MIRROR_BLOCK(uint8_t& readBuff) { NT3H1x01_STATS_API();  return(requestSessRegByte(NT3H1x01_COMN_REGS_SRAM_MIRROR_BLOCK_BYTE, readBuff)); } // (just a macro)
   /**
    * retrieve the SRAM_MIRROR_BLOCK byte from the Session registers (this version DOES NOT let you check for I2C errors)
    * @return the SRAM_MIRROR_BLOCK byte
    */
   uint8_t getSess_SRAM_MIRROR_BLOCK() {
+    NT3H1x01_STATS_API();
     uint8_t readBuff;   NT3H1x01_ERR_RETURN_TYPE err = getSess_SRAM_MIRROR_BLOCK(readBuff);
     if(!_errGood(err)) { NT3H1x01debugPrint("getSess_SRAM_MIRROR_BLOCK() read/write error!"); }
     return(readBuff);
@@ -876,6 +1729,7 @@ class NT3H1x01_thijs : public _NT3H1x01_thijs_base
    * @return (bool or esp_err_t or i2c_status_e, see on defines at top) whether it wrote/read successfully
    */
   NT3H1x01_ERR_RETURN_TYPE getSess_WDTraw(uint8_t readBuff[]) {
+    NT3H1x01_STATS_API();
     NT3H1x01_ERR_RETURN_TYPE err = requestSessRegByte(NT3H1x01_COMN_REGS_WDT_LS_BYTE, readBuff[0]);
     if(!_errGood(err)) { return(err); } // if the first one failed, return that error
     return(requestSessRegByte(NT3H1x01_COMN_REGS_WDT_MS_BYTE, readBuff[1]));
@@ -885,6 +1739,7 @@ class NT3H1x01_thijs : public _NT3H1x01_thijs_base
    * @return the WatchDog Timer threshold as a uint16_t, multiply with NT3H1x01_WDT_RAW_TO_MICROSECONDS to get microseconds
    */
   uint16_t getSess_WDTraw() {
+    NT3H1x01_STATS_API();
     uint16_t returnVal;   uint8_t* bytePtrToReturnVal = (uint8_t*) &returnVal; // assembly the 16bit number inherently by reading into it as a byte array
     NT3H1x01_ERR_RETURN_TYPE err = getSess_WDTraw(bytePtrToReturnVal);
     if(!_errGood(err)) { NT3H1x01debugPrint("getSess_WDTraw() read/write error!"); }
@@ -894,18 +1749,19 @@ class NT3H1x01_thijs : public _NT3H1x01_thijs_base
    * retrieve the WatchDog Timer threshold from the Session registers (this version DOES NOT let you check for I2C errors)
    * @return the WatchDog Timer threshold in microseconds
    */
-  float getSess_WDT() { return((float) getSess_WDTraw() * NT3H1x01_WDT_RAW_TO_MICROSECONDS); } // (just a macro)
+  float getSess_WDT() { NT3H1x01_STATS_API();  return((float) getSess_WDTraw() * NT3H1x01_WDT_RAW_TO_MICROSECONDS); } // (just a macro)
   /**
    * retrieve the I2C clock stretching bit from the Session registers (this version of the function lets you check for I2C errors)
    * @param readBuff byte reference to put the result in (may be bool?)
    * @return (bool or esp_err_t or i2c_status_e, see on defines at top) whether it wrote/read successfully
    */
-  NT3H1x01_ERR_RETURN_TYPE getSess_I2C_CLOCK_STR(uint8_t& readBuff) { return(requestSessRegByte(NT3H1x01_COMN_REGS_I2C_CLOCK_STR_BYTE, readBuff)); } // (just a macro)
+  NT3H1x01_ERR_RETURN_TYPE getSess_I2C_CLOCK_STR(uint8_t& readBuff) { NT3H1x01_STATS_API();  return(requestSessRegByte(NT3H1x01_COMN_REGS_I2C_CLOCK_STR_BYTE, readBuff)); } // (just a macro)
   /**
    * retrieve the I2C clock stretching bit from the Session registers (this version DOES NOT let you check for I2C errors)
    * @return the I2C clock stretching bit (bool)
    */
   bool getSess_I2C_CLOCK_STR() {
+    NT3H1x01_STATS_API();
     uint8_t readBuff;   NT3H1x01_ERR_RETURN_TYPE err = getSess_I2C_CLOCK_STR(readBuff);
     if(!_errGood(err)) { NT3H1x01debugPrint("getSess_I2C_CLOCK_STR() read/write error!"); }
     return(readBuff); // only the LSBit is used, the other 7 bits are RFU
@@ -916,12 +1772,13 @@ class NT3H1x01_thijs : public _NT3H1x01_thijs_base
    * @param readBuff byte reference to put the result in (see NT3H1x01_NS_REG_xxx_bits defines at top for contents)
    * @return (bool or esp_err_t or i2c_status_e, see on defines at top) whether it wrote/read successfully
    */
-  NT3H1x01_ERR_RETURN_TYPE getNS_REG(uint8_t& readBuff) { return(requestSessRegByte(NT3H1x01_SESS_REGS_NS_REG_BYTE, readBuff)); } // (just a macro)
+  NT3H1x01_ERR_RETURN_TYPE getNS_REG(uint8_t& readBuff) { NT3H1x01_STATS_API();  return(requestSessRegByte(NT3H1x01_SESS_REGS_NS_REG_BYTE, readBuff)); } // (just a macro)
   /**
    * retrieve the (whole) NS_REG Session register (this version DOES NOT let you check for I2C errors)
    * @return the (whole) NS_REG (see NT3H1x01_NS_REG_xxx_bits defines at top for contents)
    */
   uint8_t getNS_REG() {
+    NT3H1x01_STATS_API();
     uint8_t readBuff;   NT3H1x01_ERR_RETURN_TYPE err = getNS_REG(readBuff);
     if(!_errGood(err)) { NT3H1x01debugPrint("getNS_REG() read/write error!"); }
     return(readBuff);
@@ -930,42 +1787,42 @@ class NT3H1x01_thijs : public _NT3H1x01_thijs_base
    * retrieve NDEF_DATA_READ bit from the NS_REG Session register
    * @return the NDEF_DATA_READ bit (bool)     NDEF_DATA_READ flag is 1 once the RF interface has read the data at address LAST_NDEF_BLOCK (if set). Reading clears flag
    */
-  bool getNS_NDEF_DATA_READ() { return((getNS_REG() & NT3H1x01_NS_REG_NDEF_READ_bits) != 0); } // (just a macro)
+  bool getNS_NDEF_DATA_READ() { NT3H1x01_STATS_API();  return(getVal<NT3H1x01_NS_NDEF_DATA_READ>()); } // (just a macro)
   /**
    * retrieve I2C_LOCKED bit from the NS_REG Session register
    * @return the I2C_LOCKED bit (bool)     I2C_LOCKED is 1 if I2C has control of memory (arbitration). Should be cleared once the I2C interaction is completely done, may be cleared by WDT
    */
-  bool getNS_I2C_LOCKED() { return((getNS_REG() & NT3H1x01_NS_REG_I2C_LOCKED_bits) != 0); } // (just a macro)
+  bool getNS_I2C_LOCKED() { NT3H1x01_STATS_API();  return(getVal<NT3H1x01_NS_I2C_LOCKED>()); } // (just a macro)
   /**
    * retrieve RF_LOCKED bit from the NS_REG Session register
    * @return the RF_LOCKED bit (bool)     RF_LOCKED is 1 if RF has control of memory (arbitration)
    */
-  bool getNS_RF_LOCKED() { return((getNS_REG() & NT3H1x01_NS_REG_RF_LOCKED_bits) != 0); } // (just a macro)
+  bool getNS_RF_LOCKED() { NT3H1x01_STATS_API();  return(getVal<NT3H1x01_NS_RF_LOCKED>()); } // (just a macro)
   /**
    * retrieve SRAM_I2C_READY bit from the NS_REG Session register
    * @return the SRAM_I2C_READY bit (bool)     SRAM_I2C_READY is 1 if data is ready in SRAM buffer to be READ by I2C (i'm not sure if checking this flag changes it)
    */
-  bool getNS_SRAM_I2C_READY() { return((getNS_REG() & NT3H1x01_NS_REG_PTHRU_IN_bits) != 0); } // (just a macro)
+  bool getNS_SRAM_I2C_READY() { NT3H1x01_STATS_API();  return(getVal<NT3H1x01_NS_SRAM_I2C_READY>()); } // (just a macro)
   /**
    * retrieve SRAM_RF_READY bit from the NS_REG Session register
    * @return the SRAM_RF_READY bit (bool)     SRAM_RF_READY is 1 if data is ready in SRAM buffer to be READ by RF (the I2C should not need to check this flag, and i'm not sure if checking it clears it)
    */
-  bool getNS_SRAM_RF_READY() { return((getNS_REG() & NT3H1x01_NS_REG_PTHRU_OUT_bits) != 0); } // (just a macro)
+  bool getNS_SRAM_RF_READY() { NT3H1x01_STATS_API();  return(getVal<NT3H1x01_NS_SRAM_RF_READY>()); } // (just a macro)
   /**
    * retrieve EEPROM_WR_ERR bit from the NS_REG Session register
    * @return the EEPROM_WR_ERR bit (bool)     EEPROM_WR_ERR is 1 if there was a (High Voltage?) error during EEPROM write. Flag needs to be manually cleared
    */
-  bool getNS_EEPROM_WR_ERR() { return((getNS_REG() & NT3H1x01_NS_REG_EPR_WR_ERR_bits) != 0); } // (just a macro)
+  bool getNS_EEPROM_WR_ERR() { NT3H1x01_STATS_API();  return(getVal<NT3H1x01_NS_EEPROM_WR_ERR>()); } // (just a macro)
   /**
    * retrieve EEPROM_WR_BUSY bit from the NS_REG Session register
    * @return the EEPROM_WR_BUSY bit (bool)     EEPROM_WR_BUSY is 1 if EEPROM writing is in progress (access is disabled while writing)
    */
-  bool getNS_EEPROM_WR_BUSY() { return((getNS_REG() & NT3H1x01_NS_REG_EPR_WR_BSY_bits) != 0); } // (just a macro)
+  bool getNS_EEPROM_WR_BUSY() { NT3H1x01_STATS_API();  return(getVal<NT3H1x01_NS_EEPROM_WR_BUSY>()); } // (just a macro)
   /**
    * retrieve RF_FIELD_PRESENT bit from the NS_REG Session register
    * @return the RF_FIELD_PRESENT bit (bool)     RF_FIELD_PRESENT is 1 if an RF field is detected
    */
-  bool getNS_RF_FIELD_PRESENT() { return((getNS_REG() & NT3H1x01_NS_REG_RF_FIELD_bits) != 0); } // (just a macro)
+  bool getNS_RF_FIELD_PRESENT() { NT3H1x01_STATS_API();  return(getVal<NT3H1x01_NS_RF_FIELD_PRESENT>()); } // (just a macro)
 
   ///////////////////////////////////// Configuration register get functions: /////////////////////////////////////
   /**
@@ -977,7 +1834,7 @@ class NT3H1x01_thijs : public _NT3H1x01_thijs_base
    * @return (bool or esp_err_t or i2c_status_e, see on defines at top) whether it wrote/read successfully
    */
   NT3H1x01_ERR_RETURN_TYPE _getConfRegBytes(NT3H1x01_CONF_SESS_REGS_ENUM bytesInBlockStart, uint8_t bytesToRead, uint8_t readBuff[], bool useCache = false)
-    { return(_getBytesFromBlock(is2kVariant ? NT3H1201_CONF_REGS_MEMA : NT3H1101_CONF_REGS_MEMA, bytesInBlockStart, bytesToRead, readBuff, useCache)); }
+    { return(_getBytesFromBlock(_confRegsMEMA(), bytesInBlockStart, bytesToRead, readBuff, useCache)); }
   /**
    * (private) retrieve an arbetrary value from the Configuration registers (this version DOES NOT let you check for I2C errors)
    * @tparam T type of data to write
@@ -988,7 +1845,7 @@ class NT3H1x01_thijs : public _NT3H1x01_thijs_base
    */
   template<typename T> 
   T _getConfRegVal(NT3H1x01_CONF_SESS_REGS_ENUM bytesInBlockStart, bool readMSBfirst=false, bool useCache=false)
-    { return(_getValFromBlock<T>(is2kVariant ? NT3H1201_CONF_REGS_MEMA : NT3H1101_CONF_REGS_MEMA, bytesInBlockStart, readMSBfirst, useCache)); }
+    { return(_getValFromBlock<T>(_confRegsMEMA(), bytesInBlockStart, readMSBfirst, useCache)); }
 
   /**
    * retrieve the (whole) NC_REG Configuration register (this version of the function lets you check for I2C errors)
@@ -996,37 +1853,37 @@ class NT3H1x01_thijs : public _NT3H1x01_thijs_base
    * @param useCache (optional!, not recommended, use at own discretion) fetch data from _oneBlockBuff cache (if possible) instead of actually reading it from I2C (to save a little time).
    * @return (bool or esp_err_t or i2c_status_e, see on defines at top) whether it wrote/read successfully
    */
-  NT3H1x01_ERR_RETURN_TYPE getConf_NC_REG(uint8_t& readBuff, bool useCache=false) { return(_getConfRegBytes(NT3H1x01_COMN_REGS_NC_REG_BYTE, 1, &readBuff, useCache)); } // (just a macro)
+  NT3H1x01_ERR_RETURN_TYPE getConf_NC_REG(uint8_t& readBuff, bool useCache=false) { NT3H1x01_STATS_API();  return(_getConfRegBytes(NT3H1x01_COMN_REGS_NC_REG_BYTE, 1, &readBuff, useCache)); } // (just a macro)
   /**
    * retrieve the (whole) NC_REG Configuration register (this version DOES NOT let you check for I2C errors)
    * @param useCache (optional!, not recommended, use at own discretion) fetch data from _oneBlockBuff cache (if possible) instead of actually reading it from I2C (to save a little time).
    * @return the (whole) NC_REG (see NT3H1x01_NC_REG_xxx_bits defines at top for contents)
    */
-  uint8_t getConf_NC_REG(bool useCache=false) { return(_getConfRegVal<uint8_t>(NT3H1x01_COMN_REGS_NC_REG_BYTE, true, useCache)); } // (just a macro)
+  uint8_t getConf_NC_REG(bool useCache=false) { NT3H1x01_STATS_API();  return(_getConfRegVal<uint8_t>(NT3H1x01_COMN_REGS_NC_REG_BYTE, true, useCache)); } // (just a macro)
   /**
    * retrieve I2C_RST_ON_OFF bit from the NC_REG Configuration register
    * @param useCache (optional!, not recommended, use at own discretion) fetch data from _oneBlockBuff cache (if possible) instead of actually reading it from I2C (to save a little time).
    * @return the I2C_RST_ON_OFF bit (bool)     I2C_RST_ON_OFF enables soft-reset through repeated starts in I2C communication (very cool, slightly niche)
    */
-  bool getConf_NC_I2C_RST(bool useCache=false) { return((getConf_NC_REG(useCache) & NT3H1x01_NC_REG_I2C_RST_bits) != 0); } // (just a macro)
+  bool getConf_NC_I2C_RST(bool useCache=false) { NT3H1x01_STATS_API();  return(getVal<NT3H1x01_Conf_NC_I2C_RST>(useCache)); } // (just a macro)
   /**
    * retrieve FD_OFF bits from the NC_REG Configuration register
    * @param useCache (optional!, not recommended, use at own discretion) fetch data from _oneBlockBuff cache (if possible) instead of actually reading it from I2C (to save a little time).
    * @return the FD_OFF bits (2)     FD_OFF determines the behaviour of the FD pin (falling)
    */
-  NT3H1x01_FD_OFF_ENUM getConf_NC_FD_OFF(bool useCache=false) { return(static_cast<NT3H1x01_FD_OFF_ENUM>((getConf_NC_REG(useCache) & NT3H1x01_NC_REG_FD_OFF_bits) >> 4)); } // (just a macro)
+  NT3H1x01_FD_OFF_ENUM getConf_NC_FD_OFF(bool useCache=false) { NT3H1x01_STATS_API();  return(getVal<NT3H1x01_Conf_NC_FD_OFF>(useCache)); } // (just a macro)
   /**
    * retrieve FD_ON bits from the NC_REG Configuration register
    * @param useCache (optional!, not recommended, use at own discretion) fetch data from _oneBlockBuff cache (if possible) instead of actually reading it from I2C (to save a little time).
    * @return the FD_ON bits (2)     FD_ON determines the behaviour of the FD pin (rising)
    */
-  NT3H1x01_FD_ON_ENUM getConf_NC_FD_ON(bool useCache=false) { return(static_cast<NT3H1x01_FD_ON_ENUM>((getConf_NC_REG(useCache) & NT3H1x01_NC_REG_FD_ON_bits) >> 2)); } // (just a macro)
+  NT3H1x01_FD_ON_ENUM getConf_NC_FD_ON(bool useCache=false) { NT3H1x01_STATS_API();  return(getVal<NT3H1x01_Conf_NC_FD_ON>(useCache)); } // (just a macro)
   /**
    * retrieve TRANSFER_DIR/PTHRU_DIR bit from the NC_REG Configuration register
    * @param useCache (optional!, not recommended, use at own discretion) fetch data from _oneBlockBuff cache (if possible) instead of actually reading it from I2C (to save a little time).
    * @return the TRANSFER_DIR/PTHRU_DIR bit (bool)     TRANSFER_DIR/PTHRU_DIR determines the direction of data in Pass-Through mode, or can disable RF write-access otherwise
    */
-  bool getConf_NC_DIR(bool useCache=false) { return((getConf_NC_REG(useCache) & NT3H1x01_NC_REG_DIR_bits) != 0); } // (just a macro)
+  bool getConf_NC_DIR(bool useCache=false) { NT3H1x01_STATS_API();  return(getVal<NT3H1x01_Conf_NC_DIR>(useCache)); } // (just a macro)
 
   /**
    * retrieve the LAST_NDEF_BLOCK byte from the Configuration registers (this version of the function lets you check for I2C errors)
@@ -1034,79 +1891,109 @@ class NT3H1x01_thijs : public _NT3H1x01_thijs_base
    * @param useCache (optional!, not recommended, use at own discretion) fetch data from _oneBlockBuff cache (if possible) instead of actually reading it from I2C (to save a little time).
    * @return (bool or esp_err_t or i2c_status_e, see on defines at top) whether it wrote/read successfully
    */
-  NT3H1x01_ERR_RETURN_TYPE getConf_LAST_NDEF_BLOCK(uint8_t& readBuff, bool useCache=false) { return(_getConfRegBytes(NT3H1x01_COMN_REGS_LAST_NDEF_BLOCK_BYTE, 1, &readBuff, useCache)); } // (just a macro)
+  NT3H1x01_ERR_RETURN_TYPE getConf_LAST_NDEF_BLOCK(uint8_t& readBuff, bool useCache=false) { NT3H1x01_STATS_API();  return(_getConfRegBytes(NT3H1x01_COMN_REGS_LAST_NDEF_BLOCK_BYTE, 1, &readBuff, useCache)); } // (just a macro)
   /**
    * retrieve the LAST_NDEF_BLOCK byte from the Configuration registers (this version DOES NOT let you check for I2C errors)
    * @param useCache (optional!, not recommended, use at own discretion) fetch data from _oneBlockBuff cache (if possible) instead of actually reading it from I2C (to save a little time).
    * @return the LAST_NDEF_BLOCK byte
    */
-  uint8_t getConf_LAST_NDEF_BLOCK(bool useCache=false) { return(_getConfRegVal<uint8_t>(NT3H1x01_COMN_REGS_NC_REG_BYTE, true, useCache)); } // (just a macro)
+  uint8_t getConf_LAST_NDEF_BLOCK(bool useCache=false) { NT3H1x01_STATS_API();  return(getVal<NT3H1x01_Conf_LAST_NDEF_BLOCK>(useCache)); } // (just a macro)
   /**
    * retrieve the SRAM_MIRROR_BLOCK byte from the Configuration registers (this version of the function lets you check for I2C errors)
    * @param readBuff byte reference to put the result in
    * @param useCache (optional!, not recommended, use at own discretion) fetch data from _oneBlockBuff cache (if possible) instead of actually reading it from I2C (to save a little time).
    * @return (bool or esp_err_t or i2c_status_e, see on defines at top) whether it wrote/read successfully
    */
-  NT3H1x01_ERR_RETURN_TYPE getConf_SRAM_MIRROR_BLOCK(uint8_t& readBuff, bool useCache=false) { return(_getConfRegBytes(NT3H1x01_COMN_REGS_SRAM_MIRROR_BLOCK_BYTE, 1, &readBuff, useCache)); } // (just a macro)
+  NT3H1x01_ERR_RETURN_TYPE getConf_SRAM_MIRROR_BLOCK(uint8_t& readBuff, bool useCache=false) { NT3H1x01_STATS_API();  return(_getConfRegBytes(NT3H1x01_COMN_REGS_SRAM_MIRROR_BLOCK_BYTE, 1, &readBuff, useCache)); } // (just a macro)
   /**
    * retrieve the SRAM_MIRROR_BLOCK byte from the Configuration registers (this version DOES NOT let you check for I2C errors)
    * @param useCache (optional!, not recommended, use at own discretion) fetch data from _oneBlockBuff cache (if possible) instead of actually reading it from I2C (to save a little time).
    * @return the SRAM_MIRROR_BLOCK byte
    */
-  uint8_t getConf_SRAM_MIRROR_BLOCK(bool useCache=false) { return(_getConfRegVal<uint8_t>(NT3H1x01_COMN_REGS_SRAM_MIRROR_BLOCK_BYTE, true, useCache)); } // (just a macro)
+  uint8_t getConf_SRAM_MIRROR_BLOCK(bool useCache=false) { NT3H1x01_STATS_API();  return(_getConfRegVal<uint8_t>(NT3H1x01_COMN_REGS_SRAM_MIRROR_BLOCK_BYTE, true, useCache)); } // (just a macro)
   /**
    * retrieve the WatchDog Timer threshold (raw) from the Configuration registers (this version of the function lets you check for I2C errors)
    * @param readBuff 2 byte buffer to put the results in (first byte is LSB)
    * @param useCache (optional!, not recommended, use at own discretion) fetch data from _oneBlockBuff cache (if possible) instead of actually reading it from I2C (to save a little time).
    * @return (bool or esp_err_t or i2c_status_e, see on defines at top) whether it wrote/read successfully
    */
-  NT3H1x01_ERR_RETURN_TYPE getConf_WDTraw(uint8_t readBuff[], bool useCache=false) { return(_getConfRegBytes(NT3H1x01_COMN_REGS_WDT_LS_BYTE, 2, readBuff, useCache)); } // (just a macro)
+  NT3H1x01_ERR_RETURN_TYPE getConf_WDTraw(uint8_t readBuff[], bool useCache=false) { NT3H1x01_STATS_API();  return(_getConfRegBytes(NT3H1x01_COMN_REGS_WDT_LS_BYTE, 2, readBuff, useCache)); } // (just a macro)
   /**
    * retrieve the WatchDog Timer threshold (raw) from the Configuration registers (this version DOES NOT let you check for I2C errors)
    * @param useCache (optional!, not recommended, use at own discretion) fetch data from _oneBlockBuff cache (if possible) instead of actually reading it from I2C (to save a little time).
    * @return the WatchDog Timer threshold as a uint16_t, multiply with NT3H1x01_WDT_RAW_TO_MICROSECONDS to get microseconds
    */
-  uint16_t getConf_WDTraw(bool useCache=false) { return(_getConfRegVal<uint16_t>(NT3H1x01_COMN_REGS_WDT_LS_BYTE, false, useCache)); }
+  uint16_t getConf_WDTraw(bool useCache=false) { NT3H1x01_STATS_API();  return(_getConfRegVal<uint16_t>(NT3H1x01_COMN_REGS_WDT_LS_BYTE, false, useCache)); }
   /**
    * retrieve the WatchDog Timer threshold from the Configuration registers (this version DOES NOT let you check for I2C errors)
    * @param useCache (optional!, not recommended, use at own discretion) fetch data from _oneBlockBuff cache (if possible) instead of actually reading it from I2C (to save a little time).
    * @return the WatchDog Timer threshold in microseconds
    */
-  float getConf_WDT(bool useCache=false) { return((float) getConf_WDTraw(useCache) * NT3H1x01_WDT_RAW_TO_MICROSECONDS); } // (just a macro)
+  float getConf_WDT(bool useCache=false) { NT3H1x01_STATS_API();  return((float) getConf_WDTraw(useCache) * NT3H1x01_WDT_RAW_TO_MICROSECONDS); } // (just a macro)
   /**
    * retrieve the I2C clock stretching bit from the Configuration registers (this version of the function lets you check for I2C errors)
    * @param readBuff byte reference to put the result in (may be bool?)
    * @param useCache (optional!, not recommended, use at own discretion) fetch data from _oneBlockBuff cache (if possible) instead of actually reading it from I2C (to save a little time).
    * @return (bool or esp_err_t or i2c_status_e, see on defines at top) whether it wrote/read successfully
    */
-  NT3H1x01_ERR_RETURN_TYPE getConf_I2C_CLOCK_STR(uint8_t& readBuff, bool useCache=false) { return(_getConfRegBytes(NT3H1x01_COMN_REGS_I2C_CLOCK_STR_BYTE, 1, &readBuff, useCache)); } // (just a macro)
+  NT3H1x01_ERR_RETURN_TYPE getConf_I2C_CLOCK_STR(uint8_t& readBuff, bool useCache=false) { NT3H1x01_STATS_API();  return(_getConfRegBytes(NT3H1x01_COMN_REGS_I2C_CLOCK_STR_BYTE, 1, &readBuff, useCache)); } // (just a macro)
   /**
    * retrieve the I2C clock stretching bit from the Configuration registers (this version DOES NOT let you check for I2C errors)
    * @param useCache (optional!, not recommended, use at own discretion) fetch data from _oneBlockBuff cache (if possible) instead of actually reading it from I2C (to save a little time).
    * @return the I2C clock stretching bit (bool)
    */
-  bool getConf_I2C_CLOCK_STR(bool useCache=false) { return(_getConfRegVal<uint8_t>(NT3H1x01_COMN_REGS_I2C_CLOCK_STR_BYTE, true, useCache)); } // (templated as uint8_t then convert to bool) (just a macro)
+  bool getConf_I2C_CLOCK_STR(bool useCache=false) { NT3H1x01_STATS_API();  return(getVal<NT3H1x01_Conf_I2C_CLOCK_STR>(useCache)); } // (just a macro)
   /**
    * retrieve the REG_LOCK byte from the Configuration registers (this version of the function lets you check for I2C errors)
    * @param readBuff byte reference to put the result in
    * @param useCache (optional!, not recommended, use at own discretion) fetch data from _oneBlockBuff cache (if possible) instead of actually reading it from I2C (to save a little time).
    * @return (bool or esp_err_t or i2c_status_e, see on defines at top) whether it wrote/read successfully
    */
-  NT3H1x01_ERR_RETURN_TYPE getREG_LOCK(uint8_t& readBuff, bool useCache=false) { return(_getConfRegBytes(NT3H1x01_CONF_REGS_REG_LOCK_BYTE, 1, &readBuff, useCache)); } // (just a macro)
+  NT3H1x01_ERR_RETURN_TYPE getREG_LOCK(uint8_t& readBuff, bool useCache=false) { NT3H1x01_STATS_API();  return(_getConfRegBytes(NT3H1x01_CONF_REGS_REG_LOCK_BYTE, 1, &readBuff, useCache)); } // (just a macro)
   /**
    * retrieve the I2C clock stretching bit from the Configuration registers (this version DOES NOT let you check for I2C errors)
    * @param useCache (optional!, not recommended, use at own discretion) fetch data from _oneBlockBuff cache (if possible) instead of actually reading it from I2C (to save a little time).
    * @return the REG_LOCK byte (see NT3H1x01_NC_REG_LOCK_xxx_bits defines up top for contents)
    */
-  uint8_t getREG_LOCK(bool useCache=false) { return(_getConfRegVal<uint8_t>(NT3H1x01_CONF_REGS_REG_LOCK_BYTE, true, useCache)); } // (just a macro)
+  uint8_t getREG_LOCK(bool useCache=false) { NT3H1x01_STATS_API();  return(_getConfRegVal<uint8_t>(NT3H1x01_CONF_REGS_REG_LOCK_BYTE, true, useCache)); } // (just a macro)
 
 /////////////////////////////////////////////////////////////////////////////////////// debug functions: //////////////////////////////////////////////////////////
 
+  /**
+   * read block 0 (just once), check the manufacturer ID and the CC, and detect the variant from the CC memory size byte.
+   * Does the job of connectionCheck() and variantCheck() in half the bus traffic, and (for NT3H1x01_thijs) you don't need to know the variant beforehand.
+   * Block 0 stays in the _oneBlockBuff cache, so getUID(), getCC() etc. with useCache=true don't need to read it again.
+   * NOTE: the variant is detected from the CC, which can be overwritten (from I2C). If the CC memory size byte is not a factory default, this returns false (see resetCC())
+   * @param info (reference) where to put the UID, SAK, ATQA, static lock bytes and CC (filled in whenever the read was successful)
+   * @param autoDetect (only for NT3H1x01_VARIANT_RUNTIME) whether to update is2kVariant to what the tag says. The compile-time variants (and autoDetect=false) return false on a mismatch instead
+   * @return true if reading was successful, the manufacturer ID is NXP's, the CC is NFC Forum and the variant is known (and matches, if it's not auto-detected)
+   */
+  bool probe(NT3H1x01_deviceInfo& info, bool autoDetect=true) {
+    NT3H1x01_STATS_API();
+    NT3H1x01_ERR_RETURN_TYPE err = requestMemBlock(NT3H1x01_SERIAL_NR_MEMA, _oneBlockBuff);
+    if(!_errGood(err)) { _oneBlockBuffAddress = NT3H1x01_INVALID_MEMA; NT3H1x01debugPrint("probe() read/write error!"); return(false); }
+    _oneBlockBuffAddress = NT3H1x01_SERIAL_NR_MEMA;
+    for(uint8_t i=0; i<7; i++) { info.UID[i] = _oneBlockBuff[NT3H1x01_SERIAL_NR_MEMA_BYTES_START+i]; }
+    info.SAK = _oneBlockBuff[NT3H1x01_SAK_MEMA_BYTE];
+    for(uint8_t i=0; i<2; i++) { info.ATQA[i] = _oneBlockBuff[NT3H1x01_ATQA_MEMA_BYTES_START+i];  info.staticLock[i] = _oneBlockBuff[NT3H1x01_STAT_LOCK_MEMA_BYTES_START+i]; }
+    for(uint8_t i=0; i<4; i++) { info.CC[i] = _oneBlockBuff[NT3H1x01_CAPA_CONT_MEMA_BYTES_START+i]; }
+    info.is2kVariant = (info.CC[2] == NT3H1x01_getMemMap(true).ccSizeByte);
+    if(info.UID[0] != NT3H1x01_SERIAL_NR_NXP_MF_ID) { NT3H1x01debugPrint("probe() manufacturer ID is not NXP's!"); return(false); }
+    if(info.CC[0] != NT3H1x01_CAPA_CONT_DEFAULT[0][0]) { NT3H1x01debugPrint("probe() CC magic number is wrong!"); return(false); }
+    if(!info.is2kVariant && (info.CC[2] != NT3H1x01_getMemMap(false).ccSizeByte)) { NT3H1x01debugPrint("probe() CC memory size byte is not a known variant!"); return(false); }
+    if((VARIANT_T == NT3H1x01_VARIANT_RUNTIME) && autoDetect) {
+      if(info.is2kVariant != is2kVariant) { forgetLocks(); } // (the lock bits map to different blocks on the other variant)
+      is2kVariant = info.is2kVariant;
+    }
+    else if(info.is2kVariant != _is2k()) { NT3H1x01debugPrint("probe() variant does NOT match expectation!"); return(false); }
+    return(true);
+  }
   /**
    * checks if retrieving the UID works without errors, AND if the first byte matches the manufacturer ID
    * @return true if reading was successful and ...
    */
   bool connectionCheck() {
+    NT3H1x01_STATS_API();
     uint8_t UID[7];
     NT3H1x01_ERR_RETURN_TYPE err = getUID(UID); // fetch the Serial Number a.k.a. UID, the first byte of which should always be the manufacturer ID
     if(!_errGood(err)) { return(false); } // at this point it will have already printed several debug messages, no need to print another
@@ -1118,10 +2005,11 @@ class NT3H1x01_thijs : public _NT3H1x01_thijs_base
    * @return true if reading was successful and ...
    */
   bool variantCheck(bool useCache=false) {
+    NT3H1x01_STATS_API();
     uint8_t readBuff[4];
     NT3H1x01_ERR_RETURN_TYPE err = getCC(readBuff, useCache); // fetch the Serial Number a.k.a. UID, the 3rd byte of which indicates the size of the tag
     if(!_errGood(err)) { NT3H1x01debugPrint("variantCheck() read/write error!"); return(false); }
-    bool returnBool = (readBuff[2] == NT3H1x01_CAPA_CONT_DEFAULT[is2kVariant][2]);
+    bool returnBool = (readBuff[2] == memMap().ccSizeByte);
     if(!returnBool) { NT3H1x01debugPrint("variantCheck(), CC/NDEF memory size byte did NOT match expectation!"); }
     return(returnBool);
   }
@@ -1143,8 +2031,8 @@ class NT3H1x01_thijs : public _NT3H1x01_thijs_base
    * @return (bool or esp_err_t or i2c_status_e, see on defines at top) whether it wrote successfully
    */
   NT3H1x01_ERR_RETURN_TYPE resetConfiguration(bool useCache=false) {
-    uint8_t tempArr[6];  for(uint8_t i=0;i<6;i++) { tempArr[i]=NT3H1x01_CONF_REGS_DEFAULT[i]; } // this copy is needed, becuase DEFAULT array is const, and the function only likes non-const data...
-    return(_setBytesInBlock(is2kVariant ? NT3H1201_CONF_REGS_MEMA : NT3H1101_CONF_REGS_MEMA, NT3H1x01_COMN_REGS_NC_REG_BYTE, 6, tempArr, useCache)); // set all bytes (except REG_LOCK) to their default value
+    NT3H1x01_STATS_API();
+    return(_setBytesInBlock(_confRegsMEMA(), NT3H1x01_COMN_REGS_NC_REG_BYTE, 6, NT3H1x01_CONF_REGS_DEFAULT, useCache)); // set all bytes (except REG_LOCK) to their default value
   }
   /**
    * save the current Session registers in EEPROM (by writing them to the Configuration registers). NOTE: setConf_I2C_CLOCK_STR() must be called seperately, as it's a Read-only part of the Session registers
@@ -1152,6 +2040,7 @@ class NT3H1x01_thijs : public _NT3H1x01_thijs_base
    * @return (bool or esp_err_t or i2c_status_e, see on defines at top) whether it wrote successfully
    */
   NT3H1x01_ERR_RETURN_TYPE saveSessionToConfiguration(bool useCache=false) {
+    NT3H1x01_STATS_API();
     //// read from Sess:
     uint8_t tempArr[5];   NT3H1x01_ERR_RETURN_TYPE err;
     for(uint8_t i=0;i<5;i++) {
@@ -1160,14 +2049,68 @@ class NT3H1x01_thijs : public _NT3H1x01_thijs_base
     }
     tempArr[0] &= ~NT3H1x01_NC_REG_RFU_bits; // some bits are Reserved for Future Use, and must be kept at 0 (according to the datasheet)
     //// write to Conf:
-    return(_setBytesInBlock(is2kVariant ? NT3H1201_CONF_REGS_MEMA : NT3H1101_CONF_REGS_MEMA, NT3H1x01_COMN_REGS_NC_REG_BYTE, 5, tempArr, useCache));
+    return(_setBytesInBlock(_confRegsMEMA(), NT3H1x01_COMN_REGS_NC_REG_BYTE, 5, tempArr, useCache));
+  }
+  /**
+   * make sure the Configuration and Session registers are in a desired state, writing only what's different (e.g. call it at every boot without wearing out the EEPROM)
+   * The Configuration block is read once (and written at most once, only if something differs), Session registers are only read/written for the bytes in desired.sessMask
+   * If the Configuration registers are locked (REG_LOCK_I2C is burned) and they differ, changes.confLocked is set and it returns a failure (the Session registers are still applied)
+   * @param desired the desired state (see NT3H1x01_desiredConfig)
+   * @param changes (reference) what was different (and therefore written)
+   * @return (bool or esp_err_t or i2c_status_e, see on defines at top) whether it read/wrote successfully (and the Configuration registers were not locked, if they needed changing)
+   */
+  NT3H1x01_ERR_RETURN_TYPE applyConfiguration(const NT3H1x01_desiredConfig& desired, NT3H1x01_configChanges& changes) {
+    NT3H1x01_STATS_API();
+    changes = NT3H1x01_configChanges();
+    NT3H1x01_ERR_RETURN_TYPE err = NT3H1x01_ERR_RETURN_TYPE_OK;
+    bool anyConf = false;  for(uint8_t i=0; i<7; i++) { anyConf |= (desired.confMask[i] != 0); }
+    if(anyConf) {
+      uint8_t blockAddress = _confRegsMEMA();
+      err = requestMemBlock(blockAddress, _oneBlockBuff); _oneBlockBuffAddress = blockAddress; // fetch the whole block
+      if(!_errGood(err)) { NT3H1x01debugPrint("applyConfiguration() read error!"); _oneBlockBuffAddress = NT3H1x01_INVALID_MEMA; return(err); }
+      bool locked = _oneBlockBuff[NT3H1x01_CONF_REGS_REG_LOCK_BYTE] & NT3H1x01_NC_REG_LOCK_I2C_bits;
+      for(uint8_t i=0; i<7; i++) {
+        if((_oneBlockBuff[i] ^ desired.conf[i]) & desired.confMask[i]) {
+          changes.confChanged |= (1 << i);
+          _oneBlockBuff[i] = (_oneBlockBuff[i] & ~desired.confMask[i]) | (desired.conf[i] & desired.confMask[i]);
+        }
+      }
+      if(changes.confChanged) {
+        if(locked) {
+          NT3H1x01debugPrint("applyConfiguration() Configuration registers are locked (REG_LOCK_I2C)!");
+          changes.confLocked = true;  _oneBlockBuffAddress = NT3H1x01_INVALID_MEMA; // (the cache holds the unwritten changes)
+        } else {
+          err = writeMemBlock(blockAddress, _oneBlockBuff);
+          if(!_errGood(err)) { NT3H1x01debugPrint("applyConfiguration() write error!"); _oneBlockBuffAddress = NT3H1x01_INVALID_MEMA; return(err); }
+        }
+      }
+    }
+    for(uint8_t i=0; i<7; i++) {
+      if(desired.sessMask[i] == 0) { continue; }
+      uint8_t regByte;
+      err = requestSessRegByte(static_cast<NT3H1x01_CONF_SESS_REGS_ENUM>(i), regByte);
+      if(!_errGood(err)) { NT3H1x01debugPrint("applyConfiguration() Session read error!"); return(err); }
+      uint8_t diffBits = (regByte ^ desired.sess[i]) & desired.sessMask[i];
+      if(diffBits == 0) { continue; }
+      changes.sessChanged |= (1 << i);
+      err = writeSessRegByte(static_cast<NT3H1x01_CONF_SESS_REGS_ENUM>(i), desired.sess[i], diffBits); // (only the bits that differ)
+      if(!_errGood(err)) { NT3H1x01debugPrint("applyConfiguration() Session write error!"); return(err); }
+    }
+    return(changes.confLocked ? NT3H1x01_ERR_RETURN_TYPE_FAIL : err);
   }
+  /**
+   * make sure the Configuration and Session registers are in a desired state, writing only what's different (see the other applyConfiguration())
+   * @param desired the desired state (see NT3H1x01_desiredConfig)
+   * @return (bool or esp_err_t or i2c_status_e, see on defines at top) whether it read/wrote successfully
+   */
+  NT3H1x01_ERR_RETURN_TYPE applyConfiguration(const NT3H1x01_desiredConfig& desired) { NT3H1x01_STATS_API();  NT3H1x01_configChanges changes; return(applyConfiguration(desired, changes)); } // (just a macro)
   /**
    * copy first 6 bytes (and set 7th to default) from Configuration registers to Session registers. This is done at boot, this function just repeats it manually (alternatively, just reset IC)
    * @param useCache (optional!, not recommended, use at own discretion) fetch data from _oneBlockBuff cache (if possible) instead of actually reading it from I2C (to save a little time).
    * @return (bool or esp_err_t or i2c_status_e, see on defines at top) whether it wrote successfully
    */
   NT3H1x01_ERR_RETURN_TYPE reloadConfiguration(bool useCache=false) {
+    NT3H1x01_STATS_API();
     //// read from Sess:
     uint8_t tempArr[6];  NT3H1x01_ERR_RETURN_TYPE err = _getConfRegBytes(NT3H1x01_COMN_REGS_NC_REG_BYTE, 6, tempArr, useCache);
     if(!_errGood(err)) { NT3H1x01debugPrint("reloadConfiguration() read error!"); return(err); }
@@ -1183,10 +2126,12 @@ class NT3H1x01_thijs : public _NT3H1x01_thijs_base
    * write the defualt value (according to the datasheet) to the CC bytes, indicating the size of the card (make sure to initialize class object appropriately (is2kVariant))
    * @return (bool or esp_err_t or i2c_status_e, see on defines at top) whether it wrote successfully
    */
-  NT3H1x01_ERR_RETURN_TYPE resetCC() { return(setCC(NT3H1x01_CAPA_CONT_DEFAULT_uint32_t[is2kVariant])); } // write it as uint16_t (just a macro)
-  // NT3H1x01_ERR_RETURN_TYPE resetCC() { uint8_t tempArr[4]; for(uint8_t i=0;i<4;i++){tempArr[i]=NT3H1x01_CAPA_CONT_DEFAULT[is2kVariant][i];} return(setCC(tempArr)); } // write individual bytes
+  NT3H1x01_ERR_RETURN_TYPE resetCC() { NT3H1x01_STATS_API();  return(setCC(NT3H1x01_CAPA_CONT_DEFAULT_uint32_t[_is2k()])); } // write it as uint16_t (just a macro)
+  // NT3H1x01_ERR_RETURN_TYPE resetCC() { uint8_t tempArr[4]; for(uint8_t i=0;i<4;i++){tempArr[i]=NT3H1x01_CAPA_CONT_DEFAULT[_is2k()][i];} return(setCC(tempArr)); } // write individual bytes
 };
 
+typedef NT3H1x01<NT3H1x01_VARIANT_RUNTIME> NT3H1x01_thijs; // the (original) runtime-variant class, e.g.: NT3H1x01_thijs NFCtag(false);
+
 #endif  // NT3H1x01_thijs_h
 
 
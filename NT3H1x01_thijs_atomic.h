@@ -0,0 +1,142 @@
+/*
+
+(optional) atomic NDEF updates for the NT3H1x01_thijs library: rewrite a multi-block message without a phone ever reading a torn mix of old and new.
+
+A phone reads the message a few blocks at a time, so if a (multi-block) write happens in between, it can end up with half of each.
+Holding I2C_LOCKED for the whole write prevents that, but then the phone can't read anything for (blocks * ~4ms of EEPROM programming).
+Instead, the user memory is split into 2 regions, and the new message goes into the one the phone isn't looking at, after which
+ a single block write at the start of the user memory (the 'commit') makes the phone look at the other one:
+- region A starts at the first user block: the message is just there, the way any NDEF tag has it (NDEF TLV, Terminator TLV)
+- region B starts at splitBlock: the first user block then starts with a Proprietary TLV that spans all of region A,
+   which NFC Forum readers skip, so the first TLV they find after it is the NDEF TLV at the start of region B
+Writing into B (while A is the message) is invisible, as the phone stops at A's Terminator TLV.
+Writing into A (while B is the message) is invisible too, as long as the first block isn't touched (it's inside the Proprietary TLV),
+ so the first block of the new message is written last, and that's the commit.
+Between every block write, the memory is handed back to the RF side (I2C_LOCKED is cleared, see releaseI2C), so a phone only ever waits for 1 block write.
+NOTE: a phone that is still reading while TWO updates happen can still get a torn message (the 2nd update writes the region it's reading),
+ so don't update faster than a phone can read (a tap or so), e.g. only update after NDEF_DATA_READ (see LAST_NDEF_BLOCK) or when the RF field is gone.
+LAST_NDEF_BLOCK is left alone, unless autoLastNdefBlock says otherwise (then it follows the commit, 1 Session register write).
+Each region holds half of the user memory (by default), so a message can be up to ~440 bytes (1k variant) or ~950 bytes (2k variant).
+
+e.g.:
+  NT3H1x01_atomicNdef<NT3H1x01_VARIANT_RUNTIME> atomic(nfc);
+  atomic.begin(); // finds out which region the message is in now
+  ...
+  uint8_t image[400];  uint16_t size = NT3H1x01_encodeNdefMessage(records, recordCount, image, sizeof(image));
+  atomic.update(image, size);
+
+*/
+
+#ifndef NT3H1x01_thijs_atomic_h
+#define NT3H1x01_thijs_atomic_h
+
+#include "NT3H1x01_thijs.h"
+
+#include <string.h> // memcpy, memset
+
+/**
+ * an NDEF message that's always updated atomically (double-buffered, with a 1-block commit), see top of this file
+ */
+template<NT3H1x01_VARIANT_ENUM VARIANT_T>
+struct NT3H1x01_atomicNdef
+{
+  NT3H1x01<VARIANT_T>& tag;
+  uint8_t splitBlock;         // MEMory Address (MEMA) of the first block of region B (region A is everything before it)
+  bool activeB = false;       // which region holds the message (the phone sees), see begin()
+  bool releaseI2C = true;     // whether to hand the memory back to the RF side after every block write (1 Session register write each), so the phone never waits for more than 1 block
+  //// counters (of the last update()):
+  uint8_t blocksWritten = 0;  // blocks written (including the commit)
+
+  /**
+   * constructor
+   * @param tagToUse the tag
+   * @param split (optional) MEMA of the first block of region B, 0 to split the user memory in half. Both regions need at least 17 blocks (for the Proprietary TLV)
+   */
+  NT3H1x01_atomicNdef(NT3H1x01<VARIANT_T>& tagToUse, uint8_t split=0) : tag(tagToUse),
+    splitBlock(split ? split : (tagToUse.memMap().userStart + ((tagToUse.memMap().userEnd - tagToUse.memMap().userStart + 2) / 2))) {}
+
+  /**
+   * (just a macro) how many bytes of user memory a region holds (region B may be shorter, on the 1k variant the last user block is shared with the Dynamic Locking bytes)
+   * @param regionB which region
+   */
+  uint16_t regionSize(bool regionB) const {
+    const NT3H1x01_memMap memMap = tag.memMap();  uint16_t sizeA = (uint16_t)(splitBlock - memMap.userStart) * NT3H1x01_BLOCK_SIZE;
+    return(regionB ? (memMap.userBytes - sizeA) : sizeA);
+  }
+  /**
+   * (private) the Proprietary TLV that makes readers skip region A (it's all that matters in the commit block while region B is active)
+   * @param block (output) a NT3H1x01_BLOCK_SIZE buffer, the rest of it is 0's
+   */
+  void _skipHeader(uint8_t block[]) const {
+    uint16_t skipLength = regionSize(false) - 4; // (type, 3 length bytes)
+    memset(block, 0, NT3H1x01_BLOCK_SIZE);
+    block[0] = NT3H1x01_TLV_PROPRIETARY;  block[1] = NT3H1x01_TLV_LONG_LENGTH;  block[2] = skipLength >> 8;  block[3] = skipLength & 0xFF;
+  }
+
+  /**
+   * find out which region the message is in now (reads the first user block), call this once before update()
+   * @return (bool or esp_err_t or i2c_status_e, see on defines at top) whether it read successfully (fails if the regions are too small for the Proprietary TLV)
+   */
+  NT3H1x01_ERR_RETURN_TYPE begin() {
+    const NT3H1x01_memMap memMap = tag.memMap();
+    if(!memMap.isUserBlock(splitBlock) || (regionSize(false) < (17 * NT3H1x01_BLOCK_SIZE)) || (regionSize(true) < (17 * NT3H1x01_BLOCK_SIZE))) { NT3H1x01debugPrint("NT3H1x01_atomicNdef::begin() bad splitBlock!");  return(NT3H1x01_ERR_RETURN_TYPE_FAIL); }
+    uint8_t block[NT3H1x01_BLOCK_SIZE],  header[NT3H1x01_BLOCK_SIZE];
+    NT3H1x01_ERR_RETURN_TYPE err = tag.requestMemBlock(memMap.userStart, block);
+    if(!tag._errGood(err)) { NT3H1x01debugPrint("NT3H1x01_atomicNdef::begin() read error!");  return(err); }
+    _skipHeader(header);
+    activeB = (memcmp(block, header, 4) == 0);
+    if(releaseI2C) { err = tag.setNS_I2C_LOCKED(false); }
+    return(err);
+  }
+
+  /**
+   * replace the message, atomically (as far as the RF side can tell): the new one goes into the other region, then 1 block write switches over.
+   * @param image the new user memory contents (for a region), starting with the NDEF TLV, e.g. from NT3H1x01_NDEF_IMAGE() or NT3H1x01_encodeNdefMessage()
+   * @param imageSize size of image in bytes (must fit in the region it goes into, see regionSize())
+   * @return (bool or esp_err_t or i2c_status_e, see on defines at top) whether it wrote successfully. If a write fails before the commit, the phone still sees the old message
+   */
+  NT3H1x01_ERR_RETURN_TYPE update(const uint8_t image[], uint16_t imageSize) {
+    const NT3H1x01_memMap memMap = tag.memMap();
+    blocksWritten = 0;
+    const bool toB = !activeB;
+    if((imageSize == 0) || (imageSize > regionSize(toB))) { NT3H1x01debugPrint("NT3H1x01_atomicNdef::update() image does not fit in the region!");  return(NT3H1x01_ERR_RETURN_TYPE_FAIL); }
+    const uint8_t startBlock = toB ? splitBlock : memMap.userStart;
+    const uint8_t imageBlocks = (imageSize + NT3H1x01_BLOCK_SIZE - 1) / NT3H1x01_BLOCK_SIZE;
+    //// stage: every block the phone can't see (region A's first block is the commit, so that one is skipped here):
+    NT3H1x01_ERR_RETURN_TYPE err;
+    for(uint8_t i=(toB ? 0 : 1); i<imageBlocks; i++) {
+      err = _writeImageBlock(startBlock + i, image, imageSize, i);
+      if(!tag._errGood(err)) { NT3H1x01debugPrint("NT3H1x01_atomicNdef::update() write error!");  return(err); }
+    }
+    //// commit: the first user block either points past region A, or is the start of the new message (in region A)
+    if(toB) {
+      uint8_t header[NT3H1x01_BLOCK_SIZE];  _skipHeader(header);
+      err = _writeBlock(memMap.userStart, header);
+    } else {
+      err = _writeImageBlock(memMap.userStart, image, imageSize, 0);
+    }
+    if(!tag._errGood(err)) { NT3H1x01debugPrint("NT3H1x01_atomicNdef::update() commit error!");  return(err); }
+    activeB = toB;
+    return(tag._autoLastNdefBlock(err)); // (see autoLastNdefBlock)
+  }
+
+  /**
+   * (private) write 1 block of the image (padded with 0's)
+   */
+  NT3H1x01_ERR_RETURN_TYPE _writeImageBlock(uint8_t blockAddress, const uint8_t image[], uint16_t imageSize, uint8_t index) {
+    uint8_t block[NT3H1x01_BLOCK_SIZE] = {0};  uint16_t offset = (uint16_t)index * NT3H1x01_BLOCK_SIZE;
+    memcpy(block, &image[offset], ((imageSize - offset) < NT3H1x01_BLOCK_SIZE) ? (imageSize - offset) : NT3H1x01_BLOCK_SIZE);
+    return(_writeBlock(blockAddress, block));
+  }
+  /**
+   * (private) write a block (without updating LAST_NDEF_BLOCK, that's done once after the commit) and hand the memory back to the RF side
+   */
+  NT3H1x01_ERR_RETURN_TYPE _writeBlock(uint8_t blockAddress, const uint8_t block[]) {
+    NT3H1x01_ERR_RETURN_TYPE err = tag._writeUserBlockFrom(blockAddress, block);
+    if(!tag._errGood(err)) { return(err); }
+    blocksWritten++;
+    return(releaseI2C ? tag.setNS_I2C_LOCKED(false) : err);
+  }
+};
+
+#endif // NT3H1x01_thijs_atomic_h
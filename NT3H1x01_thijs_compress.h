@@ -0,0 +1,316 @@
+/*
+
+(optional) compression for the NT3H1x01_thijs library: store more application data in the user memory (888 or 1904 bytes), in fewer blocks.
+Every block that isn't written saves ~4ms of EEPROM programming time (and a little EEPROM wear), so compressing pays off on the tag side too.
+
+The codec is LZSS (an LZ77 variant): the data is a series of literal bytes and back-references ('copy N bytes from D bytes back'),
+ which works well on data that repeats itself, like telemetry records (the same field names/structure every time, slowly changing values) or text.
+Data without repetition (random, already compressed or encrypted) grows by 1 bit per byte (plus the header), so check the result (see NT3H1x01_lzEncoder::bytesOut).
+It's built for small RAM, and streams (so the data never has to be in RAM as a whole):
+- the encoder keeps a window of the last 2^NT3H1x01_LZ_WINDOW_BITS bytes (256 by default) plus NT3H1x01_LZ_LOOKAHEAD bytes,
+   and it's a NT3H1x01_streamReadFunc, so it slots right into NT3H1x01_streamToTag() (see NT3H1x01_thijs_stream.h), 1 block at a time
+- the decoder keeps only the window (and 1 block of output), and it's a NT3H1x01_streamWriteFunc, so it slots into NT3H1x01_streamFromTag()
+Anything else that moves data through those functions (e.g. the 64-byte SRAM buffer in Pass-Through mode) can use them the same way.
+
+The format (all of it is in the data, the decoder needs no settings):
+- header (NT3H1x01_LZ_HEADER_SIZE bytes): 'L', 'Z', then the version (high nibble) and window bits (low nibble)
+- then groups of a flag byte and 8 items, flag bit 0 (LSB) is the first item: 1 = a literal byte, 0 = a back-reference of 2 bytes (big-endian):
+   (distance << (16 - windowBits)) | (length - NT3H1x01_LZ_MIN_MATCH), with distance 1 ~ (2^windowBits)-1
+- a back-reference with distance 0 marks the end (so padding after it, like the rest of the last block, is ignored)
+There is no length in the header (the encoder doesn't know it until the end), nor a checksum (the tag has no bit errors to speak of, the I2C bus has its own checks).
+
+e.g.:
+  NT3H1x01_lzEncoder encoder(readFunc, &sourceContext); // (readFunc supplies the uncompressed data, see NT3H1x01_streamReadFunc)
+  NT3H1x01_streamToTag(nfc, NT3H1x01_lzEncoder::read, &encoder, result);
+  ...
+  NT3H1x01_lzDecoder decoder(writeFunc, &sinkContext);  // (writeFunc takes the uncompressed data, see NT3H1x01_streamWriteFunc)
+  NT3H1x01_streamFromTag(nfc, NT3H1x01_lzDecoder::write, &decoder, result);
+  if(!decoder.finish()) { ... } // (truncated or malformed)
+or for data that's in RAM anyway: NT3H1x01_lzCompress() and NT3H1x01_lzDecompress()
+
+*/
+
+#ifndef NT3H1x01_thijs_compress_h
+#define NT3H1x01_thijs_compress_h
+
+#include "NT3H1x01_thijs.h"
+#include "NT3H1x01_thijs_stream.h" // (NT3H1x01_streamReadFunc and NT3H1x01_streamWriteFunc)
+
+#include <string.h> // memcpy, memmove
+
+#ifndef NT3H1x01_LZ_WINDOW_BITS
+  #define NT3H1x01_LZ_WINDOW_BITS 8 // 8 ~ 12, the window is 2^this bytes (in RAM, for both the encoder and decoder). Bigger finds more repetition, but takes more RAM (and encoding time)
+#endif
+#ifndef NT3H1x01_LZ_LOOKAHEAD
+  #define NT3H1x01_LZ_LOOKAHEAD 64 // (encoder only) the longest back-reference it makes (also limited by the format: 2^(16-NT3H1x01_LZ_WINDOW_BITS) + 2)
+#endif
+#define NT3H1x01_LZ_WINDOW (1 << NT3H1x01_LZ_WINDOW_BITS)
+#define NT3H1x01_LZ_MIN_MATCH 3     // shorter back-references don't save anything (2 bytes plus a flag bit)
+#define NT3H1x01_LZ_VERSION 1
+#define NT3H1x01_LZ_HEADER_SIZE 3
+#define NT3H1x01_LZ_MAGIC_0 'L'
+#define NT3H1x01_LZ_MAGIC_1 'Z'
+
+static_assert((NT3H1x01_LZ_WINDOW_BITS >= 8) && (NT3H1x01_LZ_WINDOW_BITS <= 12), "NT3H1x01_LZ_WINDOW_BITS must be 8 ~ 12");
+static_assert(NT3H1x01_LZ_LOOKAHEAD >= NT3H1x01_LZ_MIN_MATCH, "NT3H1x01_LZ_LOOKAHEAD is too small to make any back-references");
+
+/**
+ * streaming compressor: pulls uncompressed data from a source (a NT3H1x01_streamReadFunc) and hands out the compressed data (as a NT3H1x01_streamReadFunc itself)
+ */
+struct NT3H1x01_lzEncoder
+{
+  NT3H1x01_streamReadFunc source;
+  void* sourceContext;
+  uint32_t bytesIn = 0;   // uncompressed bytes taken from the source (so far)
+  uint32_t bytesOut = 0;  // compressed bytes handed out (so far, including the header)
+  uint8_t _buff[NT3H1x01_LZ_WINDOW + NT3H1x01_LZ_LOOKAHEAD]; // (private) the window (before _pos) and the lookahead (from _pos)
+  uint16_t _pos = 0;      // (private) where the next item starts in _buff
+  uint16_t _filled = 0;   // (private) bytes in _buff
+  bool _sourceEnd = false; // (private) the source has no more data
+  bool _done = false;     // (private) the end marker was made
+  uint8_t _out[1 + 8*2];  // (private) compressed bytes ready to hand out (the header, or a whole group)
+  uint8_t _outPos = 0,  _outCount = 0; // (private)
+
+  /**
+   * constructor
+   * @param sourceFunc where the uncompressed data comes from (see NT3H1x01_streamReadFunc)
+   * @param context passed to sourceFunc as-is
+   */
+  NT3H1x01_lzEncoder(NT3H1x01_streamReadFunc sourceFunc, void* context) : source(sourceFunc), sourceContext(context) {
+    _out[0] = NT3H1x01_LZ_MAGIC_0;  _out[1] = NT3H1x01_LZ_MAGIC_1;  _out[2] = (NT3H1x01_LZ_VERSION << 4) | NT3H1x01_LZ_WINDOW_BITS;
+    _outCount = NT3H1x01_LZ_HEADER_SIZE;
+  }
+
+  /**
+   * (NT3H1x01_streamReadFunc) get the next compressed bytes
+   * @param buff where to put the compressed data
+   * @param length how many bytes are wanted
+   * @param context pointer to the NT3H1x01_lzEncoder
+   * @return how many bytes it put in buff (less than length only at the end of the compressed data)
+   */
+  static size_t read(uint8_t buff[], size_t length, void* context) {
+    NT3H1x01_lzEncoder& self = *(NT3H1x01_lzEncoder*)context;
+    size_t count = 0;
+    while(count < length) {
+      if(self._outPos < self._outCount) { buff[count++] = self._out[self._outPos++];  continue; }
+      if(self._done) { break; }
+      self._makeGroup();
+    }
+    self.bytesOut += count;
+    return(count);
+  }
+
+  /**
+   * (private) top up the lookahead from the source (sliding the window down when _buff is full)
+   */
+  void _fill() {
+    if(_sourceEnd || ((_filled - _pos) >= NT3H1x01_LZ_LOOKAHEAD)) { return; }
+    if((_filled == sizeof(_buff)) && (_pos > NT3H1x01_LZ_WINDOW)) {
+      uint16_t shift = _pos - NT3H1x01_LZ_WINDOW;
+      memmove(_buff, &_buff[shift], _filled - shift);  _pos -= shift;  _filled -= shift;
+    }
+    size_t wanted = sizeof(_buff) - _filled;
+    size_t got = source(&_buff[_filled], wanted, sourceContext);
+    _filled += got;  bytesIn += got;
+    if(got < wanted) { _sourceEnd = true; } // (a read function only returns less at the end of the data)
+  }
+
+  /**
+   * (private) make the next group (a flag byte and up to 8 items) in _out
+   */
+  void _makeGroup() {
+    const uint16_t maxDistance = NT3H1x01_LZ_WINDOW - 1;
+    const uint16_t formatMaxLength = (1 << (16 - NT3H1x01_LZ_WINDOW_BITS)) - 1 + NT3H1x01_LZ_MIN_MATCH;
+    _outPos = 0;  _outCount = 1;  _out[0] = 0;
+    for(uint8_t item=0; item<8; item++) {
+      _fill();
+      uint16_t maxLength = _filled - _pos;
+      if(maxLength == 0) { // the end: a back-reference with distance 0
+        _out[_outCount++] = 0;  _out[_outCount++] = 0;
+        _done = true;  return;
+      }
+      if(maxLength > NT3H1x01_LZ_LOOKAHEAD) { maxLength = NT3H1x01_LZ_LOOKAHEAD; }
+      if(maxLength > formatMaxLength) { maxLength = formatMaxLength; }
+      //// find the longest match in the window (newest first, so ties get the shortest distance):
+      uint16_t bestLength = NT3H1x01_LZ_MIN_MATCH - 1,  bestDistance = 0;
+      if(maxLength >= NT3H1x01_LZ_MIN_MATCH) {
+        uint16_t oldest = (_pos > maxDistance) ? (_pos - maxDistance) : 0;
+        for(uint16_t candidate=_pos; candidate-- > oldest; ) {
+          if((_buff[candidate + bestLength] != _buff[_pos + bestLength]) || (_buff[candidate] != _buff[_pos])) { continue; } // (quick reject)
+          uint16_t length = 1;
+          while((length < maxLength) && (_buff[candidate + length] == _buff[_pos + length])) { length++; } // (may run past _pos, the decoder copies byte by byte)
+          if(length > bestLength) { bestLength = length;  bestDistance = _pos - candidate;  if(length == maxLength) { break; } }
+        }
+      }
+      if(bestDistance) {
+        uint16_t token = (bestDistance << (16 - NT3H1x01_LZ_WINDOW_BITS)) | (bestLength - NT3H1x01_LZ_MIN_MATCH);
+        _out[_outCount++] = token >> 8;  _out[_outCount++] = token & 0xFF;
+        _pos += bestLength;
+      } else {
+        _out[0] |= (1 << item);
+        _out[_outCount++] = _buff[_pos++];
+      }
+    }
+  }
+};
+
+/**
+ * streaming decompressor: takes compressed data (as a NT3H1x01_streamWriteFunc) and passes the uncompressed data on to a sink (a NT3H1x01_streamWriteFunc), 1 block at a time
+ */
+struct NT3H1x01_lzDecoder
+{
+  NT3H1x01_streamWriteFunc sink;
+  void* sinkContext;
+  uint32_t bytesIn = 0;   // compressed bytes used (so far, including the header, up to the end marker)
+  uint32_t bytesOut = 0;  // uncompressed bytes made (so far, including the ones still in _out)
+  bool done = false;      // the end marker was found (anything after it is ignored)
+  bool error = false;     // the data is malformed (or made with a bigger window than NT3H1x01_LZ_WINDOW_BITS), or the sink didn't take the data
+  uint8_t _window[NT3H1x01_LZ_WINDOW]; // (private) the last uncompressed bytes (a ring buffer, indexed by bytesOut)
+  uint8_t _out[NT3H1x01_BLOCK_SIZE];   // (private) uncompressed bytes for the sink
+  uint8_t _outCount = 0;  // (private)
+  uint8_t _lengthBits = 0; // (private) from the header
+  uint8_t _flags = 0,  _itemsLeft = 0; // (private) the current group
+  uint8_t _tokenHigh = 0; // (private) first byte of a back-reference
+  uint8_t _state = 0;     // (private) 0~2 = header byte, 3 = item, 4 = 2nd byte of a back-reference
+
+  /**
+   * constructor
+   * @param sinkFunc where the uncompressed data goes (see NT3H1x01_streamWriteFunc)
+   * @param context passed to sinkFunc as-is
+   */
+  NT3H1x01_lzDecoder(NT3H1x01_streamWriteFunc sinkFunc, void* context) : sink(sinkFunc), sinkContext(context) {}
+
+  /**
+   * (NT3H1x01_streamWriteFunc) decompress the next compressed bytes
+   * @param data the compressed data
+   * @param length number of bytes
+   * @param context pointer to the NT3H1x01_lzDecoder
+   * @return how many bytes it took: all of them (even after the end marker), unless the data is malformed or the sink failed
+   */
+  static size_t write(const uint8_t data[], size_t length, void* context) {
+    NT3H1x01_lzDecoder& self = *(NT3H1x01_lzDecoder*)context;
+    for(size_t i=0; i<length; i++) {
+      if(self.done) { return(length); }
+      if(!self._take(data[i])) { self.error = true;  return(i); }
+      self.bytesIn++;
+    }
+    return(length);
+  }
+
+  /**
+   * call this after the last compressed data, passes the rest of the uncompressed data to the sink
+   * @return true if the compressed data was complete (and well-formed) and the sink took everything
+   */
+  bool finish() {
+    if(!error && !_flush()) { error = true; }
+    return(done && !error);
+  }
+
+  /**
+   * (private) pass _out to the sink
+   */
+  bool _flush() {
+    if(_outCount == 0) { return(true); }
+    bool good = (sink(_out, _outCount, sinkContext) == _outCount);
+    _outCount = 0;
+    return(good);
+  }
+  /**
+   * (private) 1 uncompressed byte
+   */
+  bool _emit(uint8_t value) {
+    _window[bytesOut & (NT3H1x01_LZ_WINDOW - 1)] = value;  bytesOut++;
+    _out[_outCount++] = value;
+    return((_outCount < sizeof(_out)) || _flush());
+  }
+  /**
+   * (private) 1 compressed byte
+   * @return false if it's malformed (or the sink failed)
+   */
+  bool _take(uint8_t value) {
+    if(error) { return(false); }
+    switch(_state) {
+      case 0:  _state++;  return(value == NT3H1x01_LZ_MAGIC_0);
+      case 1:  _state++;  return(value == NT3H1x01_LZ_MAGIC_1);
+      case 2: {
+        uint8_t windowBits = value & 0x0F;
+        _lengthBits = 16 - windowBits;  _state++;
+        return(((value >> 4) == NT3H1x01_LZ_VERSION) && (windowBits >= 8) && (windowBits <= NT3H1x01_LZ_WINDOW_BITS));
+      }
+      case 3:
+        if(_itemsLeft == 0) { _flags = value;  _itemsLeft = 8;  return(true); } // (a flag byte)
+        _itemsLeft--;
+        if(_flags & 1) { _flags >>= 1;  return(_emit(value)); } // a literal
+        _flags >>= 1;  _tokenHigh = value;  _state = 4;
+        return(true);
+      default: { // the 2nd byte of a back-reference
+        _state = 3;
+        uint16_t token = ((uint16_t)_tokenHigh << 8) | value;
+        uint16_t distance = token >> _lengthBits,  length = (token & ((1 << _lengthBits) - 1)) + NT3H1x01_LZ_MIN_MATCH;
+        if(distance == 0) { done = true;  return(_flush()); } // the end
+        if(distance > bytesOut) { return(false); } // (points before the start)
+        for(uint16_t i=0; i<length; i++) {
+          if(!_emit(_window[(bytesOut - distance) & (NT3H1x01_LZ_WINDOW - 1)])) { return(false); }
+        }
+        return(true);
+      }
+    }
+  }
+};
+
+/**
+ * (private) a RAM buffer as a NT3H1x01_streamReadFunc/NT3H1x01_streamWriteFunc
+ */
+struct _NT3H1x01_lzMemory
+{
+  uint8_t* data;  uint16_t size,  pos;
+  static size_t read(uint8_t buff[], size_t length, void* context) {
+    _NT3H1x01_lzMemory& self = *(_NT3H1x01_lzMemory*)context;
+    if(length > (size_t)(self.size - self.pos)) { length = self.size - self.pos; }
+    memcpy(buff, &self.data[self.pos], length);  self.pos += length;
+    return(length);
+  }
+  static size_t write(const uint8_t data[], size_t length, void* context) {
+    _NT3H1x01_lzMemory& self = *(_NT3H1x01_lzMemory*)context;
+    if(length > (size_t)(self.size - self.pos)) { length = self.size - self.pos; }
+    memcpy(&self.data[self.pos], data, length);  self.pos += length;
+    return(length);
+  }
+};
+
+/**
+ * compress data from RAM into RAM
+ * @param data the uncompressed data
+ * @param length number of bytes
+ * @param buff where to put the compressed data
+ * @param buffSize size of buff in bytes
+ * @return size of the compressed data, 0 if it doesn't fit in buff
+ */
+inline uint16_t NT3H1x01_lzCompress(const uint8_t data[], uint16_t length, uint8_t buff[], uint16_t buffSize) {
+  _NT3H1x01_lzMemory source = {(uint8_t*)data, length, 0}; // (only read from)
+  NT3H1x01_lzEncoder encoder(_NT3H1x01_lzMemory::read, &source);
+  uint16_t size = NT3H1x01_lzEncoder::read(buff, buffSize, &encoder);
+  if(!encoder._done || (encoder._outPos < encoder._outCount)) { NT3H1x01debugPrint("NT3H1x01_lzCompress() buffer too small!");  return(0); }
+  return(size);
+}
+
+/**
+ * decompress data from RAM into RAM
+ * @param data the compressed data (may be followed by padding, e.g. when it was read from the tag a block at a time)
+ * @param length number of bytes
+ * @param buff where to put the uncompressed data
+ * @param buffSize size of buff in bytes
+ * @param size (reference) size of the uncompressed data
+ * @return true if it was complete and well-formed, and it fit in buff
+ */
+inline bool NT3H1x01_lzDecompress(const uint8_t data[], uint16_t length, uint8_t buff[], uint16_t buffSize, uint16_t& size) {
+  _NT3H1x01_lzMemory sink = {buff, buffSize, 0};
+  NT3H1x01_lzDecoder decoder(_NT3H1x01_lzMemory::write, &sink);
+  NT3H1x01_lzDecoder::write(data, length, &decoder);
+  bool good = decoder.finish();
+  size = sink.pos;
+  if(!good) { NT3H1x01debugPrint("NT3H1x01_lzDecompress() malformed data (or buffer too small)!"); }
+  return(good);
+}
+
+#endif // NT3H1x01_thijs_compress_h
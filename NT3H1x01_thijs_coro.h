@@ -0,0 +1,210 @@
+/*
+
+C++20 coroutine API for the NT3H1x01_thijs library (only on toolchains that support coroutines, e.g. -std=gnu++20 on a host PC, recent ESP32 or STM32 GCC).
+Instead of blocking the caller for every I2C transaction, you can write:
+
+  NT3H1x01_coTask myFlow(NT3H1x01_coTag& tag) {
+    NT3H1x01_coBlock block = co_await tag.readBlock(0x01);
+    co_await tag.waitForEvent(NT3H1x01_CO_FD_ON);  // wait for a phone
+    NT3H1x01_ERR_RETURN_TYPE err = co_await tag.writeUserMemory(0x01, data, sizeof(data));
+  }
+
+The actual bus work is done by the NT3H1x01_worker (see NT3H1x01_thijs_worker.h), which is what makes it non-blocking.
+A coroutine is resumed on the worker (task/thread) once its I2C request is done, so keep the code between co_awaits short
+ (anything slow in there will delay other requests). Field Detection pin events are fed in by the application through fdEdge(),
+ and resume the waiting coroutine from wherever fdEdge() was called (so NOT directly from an interrupt, set a flag and call it from a task).
+
+NOTE: NT3H1x01_coTask is a minimal fire-and-forget coroutine type (it starts immediately and cleans itself up when done),
+ there is no scheduler or executor here, the worker and fdEdge() are the only things that resume coroutines.
+
+*/
+
+#ifndef NT3H1x01_thijs_coro_h
+#define NT3H1x01_thijs_coro_h
+
+#include "NT3H1x01_thijs_worker.h"
+
+#if !defined(__cpp_impl_coroutine)
+  #error("NT3H1x01_thijs_coro.h requires C++20 coroutines (compile with -std=gnu++20, and -fcoroutines on GCC 10)")
+#endif
+#include <coroutine>
+#include <atomic>
+
+
+/**
+ * a minimal fire-and-forget coroutine return type
+ */
+struct NT3H1x01_coTask
+{
+  struct promise_type {
+    NT3H1x01_coTask get_return_object() { return(NT3H1x01_coTask()); }
+    std::suspend_never initial_suspend() noexcept { return(std::suspend_never()); } // start running immediately
+    std::suspend_never final_suspend() noexcept { return(std::suspend_never()); }   // clean up the coroutine frame once done
+    void return_void() {}
+    void unhandled_exception() { NT3H1x01debugPrint("NT3H1x01_coTask unhandled exception!"); } // (exceptions are usually disabled on microcontrollers anyway)
+  };
+};
+
+/**
+ * the result of co_await readBlock()
+ */
+struct NT3H1x01_coBlock
+{
+  NT3H1x01_ERR_RETURN_TYPE err;
+  uint8_t data[NT3H1x01_BLOCK_SIZE];
+};
+
+enum NT3H1x01_CO_EVENT_ENUM : uint8_t { // Field Detection pin events (FD is active LOW)
+  NT3H1x01_CO_FD_ON  = 0, // FD pin went LOW (what triggers this is set by the FD_ON bits in NC_REG)
+  NT3H1x01_CO_FD_OFF = 1  // FD pin went HIGH (what triggers this is set by the FD_OFF bits in NC_REG)
+};
+
+
+/**
+ * a coroutine-friendly front end for a NT3H1x01_worker
+ */
+class NT3H1x01_coTag
+{
+  public:
+  NT3H1x01_worker& worker; // (should be start()ed before any co_await)
+
+  NT3H1x01_coTag(NT3H1x01_worker& workerToUse) : worker(workerToUse) {}
+
+  /**
+   * (private) the part all I2C awaitables share: submit a worker request on suspend, resume the coroutine from the worker's callback
+   */
+  struct _requestAwaitable {
+    NT3H1x01_coTag& coTag;
+    NT3H1x01_workerRequest request; // (lives in the coroutine frame while suspended)
+    std::coroutine_handle<> handle;
+    _requestAwaitable(NT3H1x01_coTag& coTagToUse) : coTag(coTagToUse) {}
+    bool await_ready() const noexcept { return(false); }
+    bool await_suspend(std::coroutine_handle<> handleToResume) {
+      handle = handleToResume;
+      request.callback = _resume;  request.callbackArg = this;
+      if(!coTag.worker.submit(request)) { request.err = NT3H1x01_ERR_RETURN_TYPE_FAIL; return(false); } // don't suspend if it was never queued
+      return(true); // NOTE: the worker may resume the coroutine before this even returns, so don't touch any members after submit()
+    }
+    static void _resume(NT3H1x01_workerRequest& finishedRequest) { ((_requestAwaitable*) finishedRequest.callbackArg)->handle.resume(); }
+  };
+
+  struct _readBlockAwaitable : _requestAwaitable {
+    _readBlockAwaitable(NT3H1x01_coTag& coTagToUse, uint8_t blockAddress) : _requestAwaitable(coTagToUse) { request.prepareReadBlock(blockAddress); }
+    NT3H1x01_coBlock await_resume() {
+      NT3H1x01_coBlock result;  result.err = request.err;
+      for(uint8_t i=0; i<NT3H1x01_BLOCK_SIZE; i++) { result.data[i] = request.buff[i]; }
+      return(result);
+    }
+  };
+  struct _errAwaitable : _requestAwaitable {
+    using _requestAwaitable::_requestAwaitable;
+    NT3H1x01_ERR_RETURN_TYPE await_resume() const { return(request.err); }
+  };
+  struct _sessAwaitable : _requestAwaitable {
+    using _requestAwaitable::_requestAwaitable;
+    uint8_t await_resume() const { return(request.buff[0]); } // (this version DOES NOT let you check for I2C errors)
+  };
+
+  /**
+   * read a block of memory
+   * @param blockAddress MEMory Address (MEMA) of the block
+   * @return (awaitable) NT3H1x01_coBlock with the error and the data
+   */
+  _readBlockAwaitable readBlock(uint8_t blockAddress) { return(_readBlockAwaitable(*this, blockAddress)); }
+
+  /**
+   * write a block of memory
+   * @param blockAddress MEMory Address (MEMA) of the block
+   * @param writeBuff a buffer of bytes to write (copied into the request, so it doesn't need to stay valid)
+   * @param bytesToWrite how many bytes of actual data to write, the remainder will be 0's
+   * @return (awaitable) (bool or esp_err_t or i2c_status_e, see on defines at top) whether it wrote successfully
+   */
+  _errAwaitable writeBlock(uint8_t blockAddress, const uint8_t writeBuff[], uint8_t bytesToWrite=NT3H1x01_BLOCK_SIZE) {
+    _errAwaitable awaitable(*this);  awaitable.request.prepareWriteBlock(blockAddress, writeBuff, bytesToWrite);  return(awaitable); }
+
+  /**
+   * read a Session register byte
+   * @param registerIndex Register Address (REGA) of the register byte
+   * @return (awaitable) the register byte
+   */
+  _sessAwaitable readSessReg(NT3H1x01_CONF_SESS_REGS_ENUM registerIndex) {
+    _sessAwaitable awaitable(*this);  awaitable.request.prepareReadSess(registerIndex);  return(awaitable); }
+
+  /**
+   * update a Session register byte
+   * @param registerIndex Register Address (REGA) of the register byte
+   * @param regDat the byte to write to the register
+   * @param mask the bits of the register that regDat should affect
+   * @return (awaitable) (bool or esp_err_t or i2c_status_e, see on defines at top) whether it wrote successfully
+   */
+  _errAwaitable writeSessReg(NT3H1x01_CONF_SESS_REGS_ENUM registerIndex, uint8_t regDat, uint8_t mask=0xFF) {
+    _errAwaitable awaitable(*this);  awaitable.request.prepareWriteSess(registerIndex, regDat, mask);  return(awaitable); }
+
+  /**
+   * run an arbitrary function on the worker (for the higher-level functions, e.g. setConf_WDT())
+   * @param job function to run (gets the tag and the request, request.userArg is jobArg)
+   * @param jobArg anything the job might need
+   * @return (awaitable) whatever the job returned
+   */
+  _errAwaitable runJob(NT3H1x01_workerJob job, void* jobArg=NULL) {
+    _errAwaitable awaitable(*this);  awaitable.request.prepareJob(job, jobArg);  return(awaitable); }
+
+  /**
+   * (private) the job that writeUserMemory() runs on the worker
+   */
+  struct _userMemoryWrite { uint8_t startBlock; const uint8_t* data; uint16_t length; };
+  static NT3H1x01_ERR_RETURN_TYPE _writeUserMemoryJob(NT3H1x01_thijs& tag, NT3H1x01_workerRequest& request) {
+    const _userMemoryWrite& args = *((const _userMemoryWrite*) request.userArg);
+    return(tag.writeUserBytes(args.startBlock, args.data, args.length)); // (checks the address range and locks first, and keeps LAST_NDEF_BLOCK up to date, see autoLastNdefBlock)
+  }
+  struct _writeUserMemoryAwaitable : _errAwaitable {
+    _userMemoryWrite args; // (lives in the coroutine frame, together with the request)
+    _writeUserMemoryAwaitable(NT3H1x01_coTag& coTagToUse, uint8_t startBlock, const uint8_t* data, uint16_t length) : _errAwaitable(coTagToUse), args{startBlock, data, length} {}
+    bool await_suspend(std::coroutine_handle<> handleToResume) { request.prepareJob(_writeUserMemoryJob, &args);  return(_errAwaitable::await_suspend(handleToResume)); }
+  };
+
+  /**
+   * write a (multi-block) chunk of user memory, as one request (so the worker does all blocks back-to-back), see writeUserBytes().
+   * If the data does not fill the last block, the rest of that block is kept as-is
+   * @param startBlock MEMory Address (MEMA) of the first block (see memMap().userStart and .userEnd)
+   * @param data the bytes to write (NOT copied, must stay valid until the co_await returns)
+   * @param length how many bytes to write (must fit in user memory, from startBlock onwards)
+   * @return (awaitable) (bool or esp_err_t or i2c_status_e, see on defines at top) whether it wrote successfully
+   */
+  _writeUserMemoryAwaitable writeUserMemory(uint8_t startBlock, const uint8_t* data, uint16_t length) { return(_writeUserMemoryAwaitable(*this, startBlock, data, length)); }
+
+  //// Field Detection pin events:
+  std::atomic<void*> _eventWaiters[2] = {{nullptr}, {nullptr}}; // (private) one waiting coroutine (handle address) per event type. Atomic, as waitForEvent() runs on the worker (or wherever the coroutine is) and fdEdge() on the application's task
+
+  struct _eventAwaitable {
+    NT3H1x01_coTag& coTag;
+    NT3H1x01_CO_EVENT_ENUM event;
+    bool await_ready() const noexcept { return(false); }
+    bool await_suspend(std::coroutine_handle<> handleToResume) {
+      void* expected = nullptr;
+      if(!coTag._eventWaiters[event].compare_exchange_strong(expected, handleToResume.address())) { NT3H1x01debugPrint("waitForEvent() only one coroutine can wait for an event at a time!"); return(false); }
+      return(true); // NOTE: fdEdge() may resume the coroutine before this even returns, so don't touch any members after the exchange
+    }
+    void await_resume() const noexcept {}
+  };
+
+  /**
+   * wait for a Field Detection pin edge (reported through fdEdge())
+   * @param event which edge to wait for
+   * @return (awaitable) nothing
+   */
+  _eventAwaitable waitForEvent(NT3H1x01_CO_EVENT_ENUM event) { return(_eventAwaitable{*this, event}); }
+
+  /**
+   * report a Field Detection pin change (call this from your code whenever the FD pin changes, e.g. after an interrupt set a flag)
+   * @param FDpinLevel the new state of the FD pin (it's active LOW, so false == NT3H1x01_CO_FD_ON)
+   */
+  void fdEdge(bool FDpinLevel) {
+    NT3H1x01_CO_EVENT_ENUM event = FDpinLevel ? NT3H1x01_CO_FD_OFF : NT3H1x01_CO_FD_ON;
+    void* waiter = _eventWaiters[event].exchange(nullptr); // (clear before resuming, the coroutine may want to wait again)
+    if(waiter == nullptr) { return; } // nobody is waiting
+    std::coroutine_handle<>::from_address(waiter).resume();
+  }
+};
+
+#endif // NT3H1x01_thijs_coro_h
@@ -0,0 +1,227 @@
+/*
+
+(optional) dynamic NDEF content for the NT3H1x01_thijs library: a message that's (mostly) in EEPROM, with a field that changes every tap
+ (a reading counter, a fresh sensor value, a nonce for a signed URL, etc.), served from the SRAM using Memory-Mirror mode.
+
+The split: the whole message is written to EEPROM once (only the blocks that differ, so calling begin() at every boot costs nothing),
+ then the SRAM (64 bytes = 4 blocks) is mirrored over the 4 user memory blocks that hold the dynamic field (see SRAM_MIRROR_BLOCK).
+From then on, the RF side reads those 4 blocks from SRAM, and updating the field is just an SRAM block write over I2C:
+ no EEPROM wear, no EEPROM programming time, and (at 400kHz) well under a millisecond for a field that sits in 1 block
+ (1 block write + 1 Session register write to hand the memory back to the RF side, see refresh()).
+Without external power (or after a Power-On-Reset) Memory-Mirror mode is off and the SRAM is gone, so the RF side just reads the EEPROM copy of the
+ message (the field as it was passed to begin()), which is still a valid message. Call restore() after a reset of the tag to turn the mirror back on.
+
+When to refresh (see service()):
+- NT3H1x01_DYNAMIC_ON_READ: after a reader read the whole message (NDEF_DATA_READ, set when the RF side reads LAST_NDEF_BLOCK), so the NEXT tap sees a new value.
+   This never races the reader, and it's what you want for counters and nonces (every value is read exactly once)
+- NT3H1x01_DYNAMIC_ON_FIELD: when an RF field shows up (RF_FIELD_PRESENT goes high), so THIS tap sees a fresh value (e.g. a sensor reading),
+   as long as the refresh is done before the reader gets to those blocks. Polling NS_REG is a bit slow for that,
+   so preferably hook the FD pin up to an interrupt (with FD_ON set to NT3H1x01_FD_ON_FIELD_PRESENCE) and call refresh() straight away.
+
+e.g.:
+  constexpr NT3H1x01_ndefRecordData records[] = {NT3H1x01_ndefUri(NT3H1x01_URI_HTTPS, "example.com/tap?n=00000000")};
+  constexpr NT3H1x01_ndefMessageData message = NT3H1x01_ndefMessage(records);
+  static constexpr auto image = NT3H1x01_NDEF_IMAGE(message);
+  NT3H1x01_dynamicNdef<NT3H1x01_VARIANT_RUNTIME> dynamic(nfc);
+  dynamic.begin(image.bytes, sizeof(image.bytes), 0, 19, 8); // record 0, the 8 digits at payload offset 19 (after the URI prefix byte and "example.com/tap?n=")
+  ...
+  void fillCounter(uint8_t field[], uint8_t length, void* context) { ... write the new digits into field[] ... }
+  dynamic.service(fillCounter, NULL); // in loop()
+
+*/
+
+#ifndef NT3H1x01_thijs_dynamic_h
+#define NT3H1x01_thijs_dynamic_h
+
+#include "NT3H1x01_thijs.h"
+#include "NT3H1x01_thijs_ndef.h" // (to find the field by record)
+
+#include <string.h> // memcpy, memcmp, memset
+
+#define NT3H1x01_DYNAMIC_WINDOW_BLOCKS (NT3H1x01_SRAM_MEMA_END - NT3H1x01_SRAM_MEMA_START + 1) // how many blocks the SRAM mirror covers
+#define NT3H1x01_DYNAMIC_WINDOW_SIZE (NT3H1x01_DYNAMIC_WINDOW_BLOCKS * NT3H1x01_BLOCK_SIZE) // 64 bytes, the most a dynamic field can be (minus its offset in the first block)
+
+enum NT3H1x01_DYNAMIC_TRIGGER_ENUM : uint8_t { // when service() refreshes the field (bits, so they can be combined)
+  NT3H1x01_DYNAMIC_ON_READ  = 0b01, // after a reader read up to LAST_NDEF_BLOCK (NDEF_DATA_READ), the next tap sees the new value
+  NT3H1x01_DYNAMIC_ON_FIELD = 0b10, // when an RF field appears (RF_FIELD_PRESENT went high), this tap sees the new value (if the refresh wins the race)
+  NT3H1x01_DYNAMIC_ON_BOTH  = 0b11
+};
+
+typedef void (*NT3H1x01_dynamicRefreshFunc)(uint8_t field[], uint8_t length, void* context); // fills in the new field contents (the old contents are still in there)
+
+/**
+ * an NDEF message with one field that lives in the (mirrored) SRAM, see top of this file
+ */
+template<NT3H1x01_VARIANT_ENUM VARIANT_T>
+struct NT3H1x01_dynamicNdef
+{
+  NT3H1x01<VARIANT_T>& tag;
+  uint8_t sram[NT3H1x01_DYNAMIC_WINDOW_SIZE]; // what the SRAM holds: the 4 mirrored blocks of the message (the field is in here)
+  uint8_t mirrorBlock = 0;   // MEMory Address (MEMA) of the first user memory block the SRAM is mirrored over (0 until begin())
+  uint8_t lastNdefBlock = 0; // MEMA of the block with the end of the message (so NDEF_DATA_READ means the whole message was read)
+  uint8_t fieldStart = 0;    // where the field starts in sram[]
+  uint8_t fieldLength = 0;
+  //// counters:
+  uint32_t reads = 0;             // NDEF_DATA_READ flags seen by service() (a.k.a. taps, more or less)
+  uint32_t refreshes = 0;         // successful refreshes
+  uint32_t sramBlockWrites = 0;   // SRAM blocks written (by refreshes and restore())
+  uint8_t eepromBlockWrites = 0;  // EEPROM blocks the last begin() had to write (0 if the message was already there)
+  bool _fieldWasPresent = false;  // (private) RF_FIELD_PRESENT the last time service() looked
+
+  NT3H1x01_dynamicNdef(NT3H1x01<VARIANT_T>& tagToUse) : tag(tagToUse) {}
+
+  /**
+   * the field (in sram[]), to change it directly before calling refresh()
+   * @return pointer to fieldLength bytes
+   */
+  uint8_t* field() { return(&sram[fieldStart]); }
+
+  /**
+   * write a message to the tag (only the blocks that differ) and serve a part of it from SRAM (Memory-Mirror mode, see top of this file)
+   * @param image the user memory contents (starting at the first user block), e.g. from NT3H1x01_NDEF_IMAGE() or NT3H1x01_encodeNdefMessage()
+   * @param imageSize size of image in bytes
+   * @param fieldOffset where the field starts in the image (a.k.a. in the user memory)
+   * @param length length of the field in bytes (it must fit in 4 blocks from the block it starts in, so up to 64 bytes, minus its offset in that block)
+   * @return (bool or esp_err_t or i2c_status_e, see on defines at top) whether it was successful (fails if the image doesn't fit, or the field doesn't fit in the SRAM window)
+   */
+  NT3H1x01_ERR_RETURN_TYPE beginAt(const uint8_t image[], uint16_t imageSize, uint16_t fieldOffset, uint8_t length) {
+    const NT3H1x01_memMap memMap = tag.memMap();
+    mirrorBlock = 0;  eepromBlockWrites = 0;
+    if((imageSize == 0) || (imageSize > memMap.userBytes)) { NT3H1x01debugPrint("NT3H1x01_dynamicNdef::begin() image does not fit in the user memory!");  return(NT3H1x01_ERR_RETURN_TYPE_FAIL); }
+    if((length == 0) || (((uint32_t)fieldOffset + length) > imageSize)) { NT3H1x01debugPrint("NT3H1x01_dynamicNdef::begin() field is outside of the image!");  return(NT3H1x01_ERR_RETURN_TYPE_FAIL); }
+    //// place the window: from the block the field starts in, but not past the last whole user block (on the 1k variant, the last one is shared with the Dynamic Locking bytes)
+    uint8_t lastWindowBlock = (memMap.userEndBytes == NT3H1x01_BLOCK_SIZE) ? memMap.userEnd : (memMap.userEnd - 1);
+    uint8_t windowStart = memMap.userStart + (fieldOffset / NT3H1x01_BLOCK_SIZE);
+    if((windowStart + NT3H1x01_DYNAMIC_WINDOW_BLOCKS - 1) > lastWindowBlock) { windowStart = lastWindowBlock - (NT3H1x01_DYNAMIC_WINDOW_BLOCKS - 1); }
+    uint16_t windowOffset = (windowStart - memMap.userStart) * NT3H1x01_BLOCK_SIZE;
+    if(((uint32_t)fieldOffset + length) > ((uint32_t)windowOffset + NT3H1x01_DYNAMIC_WINDOW_SIZE)) { NT3H1x01debugPrint("NT3H1x01_dynamicNdef::begin() field does not fit in the SRAM window!");  return(NT3H1x01_ERR_RETURN_TYPE_FAIL); }
+    //// the whole message goes in EEPROM (for when the mirror is off), but only the blocks that differ are written:
+    uint8_t imageBlocks = (imageSize + NT3H1x01_BLOCK_SIZE - 1) / NT3H1x01_BLOCK_SIZE;
+    NT3H1x01_ERR_RETURN_TYPE err = NT3H1x01_ERR_RETURN_TYPE_OK;
+    for(uint8_t i=0; i<imageBlocks; i++) {
+      uint8_t blockAddress = memMap.userStart + i;  uint16_t offset = i * NT3H1x01_BLOCK_SIZE;
+      uint8_t blockBytes = memMap.userBytesInBlock(blockAddress);
+      uint8_t newBlock[NT3H1x01_BLOCK_SIZE] = {0};  memcpy(newBlock, &image[offset], ((imageSize - offset) < blockBytes) ? (imageSize - offset) : blockBytes);
+      uint8_t current[NT3H1x01_BLOCK_SIZE];
+      err = tag.requestMemBlock(blockAddress, current);
+      if(!tag._errGood(err)) { NT3H1x01debugPrint("NT3H1x01_dynamicNdef::begin() read error!");  return(err); }
+      if(memcmp(current, newBlock, blockBytes) == 0) { continue; }
+      err = tag._writeUserBlockFrom(blockAddress, newBlock); // (LAST_NDEF_BLOCK is set by restore())
+      if(!tag._errGood(err)) { NT3H1x01debugPrint("NT3H1x01_dynamicNdef::begin() write error!");  return(err); }
+      eepromBlockWrites++;
+    }
+    //// and the window goes in SRAM:
+    memset(sram, 0, sizeof(sram));
+    memcpy(sram, &image[windowOffset], ((imageSize - windowOffset) < NT3H1x01_DYNAMIC_WINDOW_SIZE) ? (imageSize - windowOffset) : NT3H1x01_DYNAMIC_WINDOW_SIZE);
+    mirrorBlock = windowStart;  lastNdefBlock = memMap.userStart + imageBlocks - 1;
+    NT3H1x01_tlv tlv; // LAST_NDEF_BLOCK goes at the end of the NDEF message itself (not the Terminator TLV or padding after it), so the reader stops right there
+    if(NT3H1x01_findTLV(image, imageSize, NT3H1x01_TLV_NDEF, tlv) && ((tlv.valueOffset + tlv.length) > 0)) { lastNdefBlock = memMap.userStart + ((tlv.valueOffset + tlv.length - 1) / NT3H1x01_BLOCK_SIZE); }
+    fieldStart = fieldOffset - windowOffset;  fieldLength = length;
+    return(restore());
+  }
+  /**
+   * write a message to the tag (only the blocks that differ) and serve a part of one record's payload from SRAM, see beginAt()
+   * @param image the user memory contents (starting at the first user block), e.g. from NT3H1x01_NDEF_IMAGE() or NT3H1x01_encodeNdefMessage()
+   * @param imageSize size of image in bytes
+   * @param recordIndex which record of the NDEF message (0 for the first)
+   * @param payloadOffset where the field starts in the payload of that record (e.g. for a URI record, the prefix code byte is payload byte 0)
+   * @param length length of the field in bytes (up to 64, see beginAt())
+   * @return (bool or esp_err_t or i2c_status_e, see on defines at top) whether it was successful (also fails if the record isn't in the image, or the field is outside of its payload)
+   */
+  NT3H1x01_ERR_RETURN_TYPE begin(const uint8_t image[], uint16_t imageSize, uint8_t recordIndex, uint16_t payloadOffset, uint8_t length) {
+    NT3H1x01_tlv tlv;  NT3H1x01_ndefRecord rec;  bool found = false;
+    if(NT3H1x01_findTLV(image, imageSize, NT3H1x01_TLV_NDEF, tlv)) {
+      uint16_t pos = tlv.valueOffset;
+      for(uint8_t i=0; (i<=recordIndex) && NT3H1x01_nextNdefRecord(image, tlv.valueOffset + tlv.length, pos, rec); i++) { found = (i == recordIndex); }
+    }
+    if(!found) { NT3H1x01debugPrint("NT3H1x01_dynamicNdef::begin() record not found!");  return(NT3H1x01_ERR_RETURN_TYPE_FAIL); }
+    if(((uint32_t)payloadOffset + length) > rec.payloadLength) { NT3H1x01debugPrint("NT3H1x01_dynamicNdef::begin() field is outside of the payload!");  return(NT3H1x01_ERR_RETURN_TYPE_FAIL); }
+    return(beginAt(image, imageSize, rec.payloadOffset + payloadOffset, length));
+  }
+
+  /**
+   * (re)write the whole SRAM and (re)enable Memory-Mirror mode in the Session registers (only the bits that differ), e.g. after a Power-On-Reset of the tag (begin() does this too)
+   * @return (bool or esp_err_t or i2c_status_e, see on defines at top) whether it wrote/read successfully
+   */
+  NT3H1x01_ERR_RETURN_TYPE restore() {
+    if(mirrorBlock == 0) { NT3H1x01debugPrint("NT3H1x01_dynamicNdef::restore() begin() first!");  return(NT3H1x01_ERR_RETURN_TYPE_FAIL); }
+    NT3H1x01_ERR_RETURN_TYPE err = _writeSRAM(0, NT3H1x01_DYNAMIC_WINDOW_SIZE);
+    if(!tag._errGood(err)) { return(err); }
+    NT3H1x01_desiredConfig desired; // (Session registers only, the Configuration registers don't have the MIRROR and PTHRU bits)
+    desired.set<NT3H1x01_Sess_SRAM_MIRROR_BLOCK>(mirrorBlock);
+    desired.set<NT3H1x01_Sess_LAST_NDEF_BLOCK>(lastNdefBlock);
+    desired.set<NT3H1x01_Sess_NC_PTHRU>(false);
+    desired.set<NT3H1x01_Sess_NC_MIRROR>(true);
+    err = tag.applyConfiguration(desired);
+    if(!tag._errGood(err)) { NT3H1x01debugPrint("NT3H1x01_dynamicNdef::restore() configuration error!");  return(err); }
+    return(tag.setNS_I2C_LOCKED(false)); // hand the memory back to the RF side (instead of waiting for the WDT)
+  }
+
+  /**
+   * write the field (as it is in sram[], see field()) to the SRAM. Only the blocks the field is in are written, then the memory is handed back to the RF side.
+   * @return (bool or esp_err_t or i2c_status_e, see on defines at top) whether it wrote successfully
+   */
+  NT3H1x01_ERR_RETURN_TYPE refresh() {
+    if(mirrorBlock == 0) { NT3H1x01debugPrint("NT3H1x01_dynamicNdef::refresh() begin() first!");  return(NT3H1x01_ERR_RETURN_TYPE_FAIL); }
+    NT3H1x01_ERR_RETURN_TYPE err = _writeSRAM(fieldStart, fieldLength);
+    if(!tag._errGood(err)) { return(err); }
+    err = tag.setNS_I2C_LOCKED(false); // hand the memory back to the RF side (instead of waiting for the WDT)
+    if(tag._errGood(err)) { refreshes++; }
+    return(err);
+  }
+  /**
+   * let a function fill in the new field contents, then write them to the SRAM (see refresh())
+   * @param fillFunc function that changes the field (see NT3H1x01_dynamicRefreshFunc)
+   * @param context passed to fillFunc as-is
+   * @return (bool or esp_err_t or i2c_status_e, see on defines at top) whether it wrote successfully
+   */
+  NT3H1x01_ERR_RETURN_TYPE refresh(NT3H1x01_dynamicRefreshFunc fillFunc, void* context) { fillFunc(field(), fieldLength, context);  return(refresh()); } // (just a macro)
+  /**
+   * copy new field contents in, then write them to the SRAM (see refresh())
+   * @param data the new bytes
+   * @param length number of bytes
+   * @param offset (optional) where in the field they go
+   * @return (bool or esp_err_t or i2c_status_e, see on defines at top) whether it wrote successfully (fails if it doesn't fit in the field)
+   */
+  NT3H1x01_ERR_RETURN_TYPE update(const uint8_t data[], uint8_t length, uint8_t offset=0) {
+    if(((uint16_t)offset + length) > fieldLength) { NT3H1x01debugPrint("NT3H1x01_dynamicNdef::update() data does not fit in the field!");  return(NT3H1x01_ERR_RETURN_TYPE_FAIL); }
+    memcpy(&field()[offset], data, length);
+    return(refresh());
+  }
+
+  /**
+   * check NS_REG (1 Session register read, which also clears NDEF_DATA_READ) and refresh the field if one of the triggers happened, call this in loop()
+   * @param fillFunc function that changes the field (see NT3H1x01_dynamicRefreshFunc)
+   * @param context passed to fillFunc as-is
+   * @param triggers (optional) when to refresh (see NT3H1x01_DYNAMIC_TRIGGER_ENUM)
+   * @return (bool or esp_err_t or i2c_status_e, see on defines at top) whether it read (and wrote) successfully
+   */
+  NT3H1x01_ERR_RETURN_TYPE service(NT3H1x01_dynamicRefreshFunc fillFunc, void* context, uint8_t triggers=NT3H1x01_DYNAMIC_ON_READ) {
+    uint8_t NS_REG;  NT3H1x01_ERR_RETURN_TYPE err = tag.requestSessRegByte(NT3H1x01_SESS_REGS_NS_REG_BYTE, NS_REG);
+    if(!tag._errGood(err)) { NT3H1x01debugPrint("NT3H1x01_dynamicNdef::service() read error!");  return(err); }
+    bool fieldPresent = NS_REG & NT3H1x01_NS_REG_RF_FIELD_bits;
+    bool fieldOn = fieldPresent && !_fieldWasPresent;  _fieldWasPresent = fieldPresent;
+    bool dataRead = NS_REG & NT3H1x01_NS_REG_NDEF_READ_bits;
+    if(dataRead) { reads++; }
+    if(((triggers & NT3H1x01_DYNAMIC_ON_READ) && dataRead) || ((triggers & NT3H1x01_DYNAMIC_ON_FIELD) && fieldOn)) { return(refresh(fillFunc, context)); }
+    return(err);
+  }
+
+  /**
+   * (private) write the SRAM blocks that hold a range of sram[]
+   * @param from first byte of sram[]
+   * @param length number of bytes
+   * @return (bool or esp_err_t or i2c_status_e, see on defines at top) whether it wrote successfully
+   */
+  NT3H1x01_ERR_RETURN_TYPE _writeSRAM(uint8_t from, uint8_t length) {
+    NT3H1x01_ERR_RETURN_TYPE err = NT3H1x01_ERR_RETURN_TYPE_OK;
+    for(uint8_t i=(from / NT3H1x01_BLOCK_SIZE); i<=((from + length - 1) / NT3H1x01_BLOCK_SIZE); i++) {
+      err = tag.writeMemBlock(NT3H1x01_SRAM_MEMA_START + i, &sram[i * NT3H1x01_BLOCK_SIZE]);
+      if(!tag._errGood(err)) { NT3H1x01debugPrint("NT3H1x01_dynamicNdef SRAM write error!");  return(err); }
+      sramBlockWrites++;
+    }
+    return(err);
+  }
+};
+
+#endif // NT3H1x01_thijs_dynamic_h
@@ -0,0 +1,281 @@
+/*
+
+(optional) tag images for the NT3H1x01_thijs library: dump the whole I2C memory map of a tag to a file (or anything else), and program it back.
+Use it for backup/restore, for cloning a configured tag onto new ones, or to compare the contents of 2 tags.
+
+image format (all multi-byte values are little-endian):
+ header (16 bytes): 'N','T','i','m', version (1), flags (bit 0: 2k variant, bit 1: has SRAM), block count, SRAM block count, UID (7 bytes), 0
+ blocks: block 0x00 up to (and including) the Configuration registers (0x3A or 0x7A), 16 bytes each, in address order (so block N is at 16 + N*16)
+         (the one block the IC doesn't ACK, between the Dynamic Locking bytes and the Configuration registers, is stored as 0's)
+ SRAM (optional): blocks 0xF8~0xFB
+ trailer: CRC-32 (the usual one, as used by zip/ethernet) of everything before it
+The header only holds things from block 0, so an image can be streamed out as it is read (no need to buffer it, or to seek back).
+
+programming is conservative: it only writes blocks that differ, and it never writes the read-only or burn-once parts of the memory map:
+ - block 0: only the Capability Container is programmed (the UID, SAK, ATQA and the I2C address stay, the Static Locking bytes are kept as they are on the tag)
+ - the Dynamic Locking bytes (and the RFU bytes around them) are kept as they are on the tag
+ - Configuration registers: REG_LOCK is kept as it is on the tag
+ (to lock a tag, use the dedicated functions, see NT3H1x01_unlock_burning)
+and, like the other user memory writers, it refuses to write a block that is locked (see isLocked(), once the lock bits are known), that's a failure.
+Afterwards everything it programmed is read back and checked against the CRC of what it should be.
+
+on a host PC, an image file can be memory-mapped with NT3H1x01_mapImageFile() (so it never needs to be copied into RAM),
+ on a microcontroller, an image can just be a const array (or any buffer)
+
+*/
+
+#ifndef NT3H1x01_thijs_image_h
+#define NT3H1x01_thijs_image_h
+
+#include "NT3H1x01_thijs.h"
+
+#if !defined(ARDUINO)
+  #include <stdio.h> // FILE, fwrite
+  #if defined(__unix__) || defined(__APPLE__)
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+    #define NT3H1x01_IMAGE_MMAP // NT3H1x01_mapImageFile() is available
+  #endif
+#endif
+
+#define NT3H1x01_IMAGE_VERSION 1
+#define NT3H1x01_IMAGE_HEADER_SIZE 16
+#define NT3H1x01_IMAGE_TRAILER_SIZE 4
+#define NT3H1x01_IMAGE_FLAG_2K_bits   0b00000001
+#define NT3H1x01_IMAGE_FLAG_SRAM_bits 0b00000010
+#define NT3H1x01_IMAGE_SRAM_BLOCKS (NT3H1x01_SRAM_MEMA_END - NT3H1x01_SRAM_MEMA_START + 1)
+
+typedef void (*NT3H1x01_imageSink)(const uint8_t data[], size_t length, void* context); // where the image bytes go
+
+/**
+ * CRC-32 (reflected, polynomial 0xEDB88320), calculated bit by bit (no table, to save flash/RAM)
+ * @param data the bytes to add to the CRC
+ * @param length number of bytes
+ * @param crc (optional) the CRC of the data before this (to calculate it in parts), 0 to start
+ * @return the CRC of everything so far
+ */
+inline uint32_t NT3H1x01_crc32(const uint8_t data[], size_t length, uint32_t crc=0) {
+  crc = ~crc;
+  for(size_t i=0; i<length; i++) {
+    crc ^= data[i];
+    for(uint8_t j=0; j<8; j++) { crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1))); }
+  }
+  return(~crc);
+}
+
+/**
+ * the size of an image
+ * @param is2kVariant true for the NT3H1201, false for the NT3H1101
+ * @param includeSRAM whether the image holds the SRAM as well
+ * @return the size in bytes
+ */
+constexpr size_t NT3H1x01_imageSize(bool is2kVariant, bool includeSRAM) {
+  return(NT3H1x01_IMAGE_HEADER_SIZE + (NT3H1x01_getMemMap(is2kVariant).confRegsMEMA + 1 + (includeSRAM ? NT3H1x01_IMAGE_SRAM_BLOCKS : 0)) * NT3H1x01_BLOCK_SIZE + NT3H1x01_IMAGE_TRAILER_SIZE);
+}
+
+/**
+ * an image, interpreted (see NT3H1x01_parseImage())
+ */
+struct NT3H1x01_imageInfo
+{
+  bool is2kVariant;
+  uint8_t blockCount;      // memory blocks (0x00 up to the Configuration registers)
+  uint8_t sramBlockCount;  // 0 or NT3H1x01_IMAGE_SRAM_BLOCKS
+  uint8_t UID[7];
+  uint32_t CRC;
+  const uint8_t* blocks;   // points into the image, block N is at blocks[N * NT3H1x01_BLOCK_SIZE]
+  const uint8_t* SRAM;     // points into the image (NULL if the image has no SRAM)
+
+  /**
+   * get a block of the image
+   * @param blockAddress MEMory Address (MEMA) of the block (0x00 up to the Configuration registers, or SRAM)
+   * @return pointer to the 16 bytes of the block, or NULL if it's not in the image
+   */
+  const uint8_t* block(uint8_t blockAddress) const {
+    if(blockAddress < blockCount) { return(&blocks[blockAddress * NT3H1x01_BLOCK_SIZE]); }
+    if(SRAM && NT3H1x01_getMemMap(is2kVariant).isSRAMBlock(blockAddress)) { return(&SRAM[(blockAddress - NT3H1x01_SRAM_MEMA_START) * NT3H1x01_BLOCK_SIZE]); }
+    return(NULL);
+  }
+};
+
+/**
+ * check an image (magic number, version, size and CRC) and find the parts in it
+ * @param image the whole image (e.g. from NT3H1x01_mapImageFile())
+ * @param size size of the image in bytes
+ * @param info (reference) where to put the interpreted header
+ * @return true if it's a valid image
+ */
+inline bool NT3H1x01_parseImage(const uint8_t image[], size_t size, NT3H1x01_imageInfo& info) {
+  if(size < (NT3H1x01_IMAGE_HEADER_SIZE + NT3H1x01_IMAGE_TRAILER_SIZE)) { NT3H1x01debugPrint("NT3H1x01_parseImage() too small!"); return(false); }
+  if((image[0] != 'N') || (image[1] != 'T') || (image[2] != 'i') || (image[3] != 'm') || (image[4] != NT3H1x01_IMAGE_VERSION)) { NT3H1x01debugPrint("NT3H1x01_parseImage() not an image (or wrong version)!"); return(false); }
+  info.is2kVariant = image[5] & NT3H1x01_IMAGE_FLAG_2K_bits;
+  bool hasSRAM = image[5] & NT3H1x01_IMAGE_FLAG_SRAM_bits;
+  info.blockCount = image[6];  info.sramBlockCount = image[7];
+  if((info.blockCount != (NT3H1x01_getMemMap(info.is2kVariant).confRegsMEMA + 1)) || (info.sramBlockCount != (hasSRAM ? NT3H1x01_IMAGE_SRAM_BLOCKS : 0))
+     || (size != NT3H1x01_imageSize(info.is2kVariant, hasSRAM))) { NT3H1x01debugPrint("NT3H1x01_parseImage() size mismatch!"); return(false); }
+  for(uint8_t i=0; i<7; i++) { info.UID[i] = image[8+i]; }
+  size_t crcPos = size - NT3H1x01_IMAGE_TRAILER_SIZE;
+  info.CRC = (uint32_t)image[crcPos] | ((uint32_t)image[crcPos+1] << 8) | ((uint32_t)image[crcPos+2] << 16) | ((uint32_t)image[crcPos+3] << 24);
+  if(NT3H1x01_crc32(image, crcPos) != info.CRC) { NT3H1x01debugPrint("NT3H1x01_parseImage() CRC mismatch!"); return(false); }
+  info.blocks = &image[NT3H1x01_IMAGE_HEADER_SIZE];
+  info.SRAM = hasSRAM ? &info.blocks[info.blockCount * NT3H1x01_BLOCK_SIZE] : NULL;
+  return(true);
+}
+
+/**
+ * read the whole memory map of a tag, and stream it out as an image
+ * @param tag the tag to dump
+ * @param sink function that gets the image bytes (in order, a block at a time)
+ * @param context passed to the sink as-is
+ * @param includeSRAM (optional) whether to dump the SRAM as well
+ * @return (bool or esp_err_t or i2c_status_e, see on defines at top) whether it read successfully (if not, the image is incomplete, and won't pass NT3H1x01_parseImage())
+ */
+template<NT3H1x01_VARIANT_ENUM VARIANT_T>
+NT3H1x01_ERR_RETURN_TYPE NT3H1x01_dumpImage(NT3H1x01<VARIANT_T>& tag, NT3H1x01_imageSink sink, void* context, bool includeSRAM=false) {
+  const NT3H1x01_memMap memMap = tag.memMap();
+  uint8_t block[NT3H1x01_BLOCK_SIZE];
+  NT3H1x01_ERR_RETURN_TYPE err = tag.requestMemBlock(0x00, block); // (first, because the header holds the UID)
+  if(!tag._errGood(err)) { NT3H1x01debugPrint("NT3H1x01_dumpImage() read error!"); return(err); }
+  uint8_t header[NT3H1x01_IMAGE_HEADER_SIZE] = {'N', 'T', 'i', 'm', NT3H1x01_IMAGE_VERSION,
+                                                (uint8_t)((tag._is2k() ? NT3H1x01_IMAGE_FLAG_2K_bits : 0) | (includeSRAM ? NT3H1x01_IMAGE_FLAG_SRAM_bits : 0)),
+                                                (uint8_t)(memMap.confRegsMEMA + 1), (uint8_t)(includeSRAM ? NT3H1x01_IMAGE_SRAM_BLOCKS : 0)};
+  for(uint8_t i=0; i<7; i++) { header[8+i] = block[NT3H1x01_SERIAL_NR_MEMA_BYTES_START+i]; }
+  sink(header, NT3H1x01_IMAGE_HEADER_SIZE, context);
+  uint32_t crc = NT3H1x01_crc32(header, NT3H1x01_IMAGE_HEADER_SIZE);
+  uint16_t lastBlock = (includeSRAM ? NT3H1x01_SRAM_MEMA_END : memMap.confRegsMEMA);
+  for(uint16_t blockAddress=0x00; blockAddress<=lastBlock; blockAddress++) { // (uint16_t, so it can't overflow)
+    if((blockAddress > memMap.confRegsMEMA) && !memMap.isSRAMBlock(blockAddress)) { continue; } // (the gap between the Configuration registers and the SRAM is not in the image)
+    if(blockAddress == 0x00) { } // (already read)
+    else if(memMap.isValidBlock(blockAddress)) {
+      err = tag.requestMemBlock(blockAddress, block);
+      if(!tag._errGood(err)) { NT3H1x01debugPrint("NT3H1x01_dumpImage() read error!"); return(err); }
+    } else { for(uint8_t i=0; i<NT3H1x01_BLOCK_SIZE; i++) { block[i] = 0; } }
+    sink(block, NT3H1x01_BLOCK_SIZE, context);
+    crc = NT3H1x01_crc32(block, NT3H1x01_BLOCK_SIZE, crc);
+  }
+  const uint8_t trailer[NT3H1x01_IMAGE_TRAILER_SIZE] = {(uint8_t)crc, (uint8_t)(crc >> 8), (uint8_t)(crc >> 16), (uint8_t)(crc >> 24)};
+  sink(trailer, NT3H1x01_IMAGE_TRAILER_SIZE, context);
+  return(err);
+}
+#if defined(ARDUINO)
+  inline void _NT3H1x01_imagePrintSink(const uint8_t data[], size_t length, void* context) { ((Print*)context)->write(data, length); }
+  /**
+   * read the whole memory map of a tag, and write it to a Print (e.g. Serial, or a File on an SD card). See the other NT3H1x01_dumpImage()
+   */
+  template<NT3H1x01_VARIANT_ENUM VARIANT_T>
+  NT3H1x01_ERR_RETURN_TYPE NT3H1x01_dumpImage(NT3H1x01<VARIANT_T>& tag, Print& output, bool includeSRAM=false) { return(NT3H1x01_dumpImage(tag, _NT3H1x01_imagePrintSink, &output, includeSRAM)); } // (just a macro)
+#else
+  inline void _NT3H1x01_imageFileSink(const uint8_t data[], size_t length, void* context) { fwrite(data, 1, length, (FILE*)context); }
+  /**
+   * read the whole memory map of a tag, and write it to a file (opened with "wb"). See the other NT3H1x01_dumpImage()
+   */
+  template<NT3H1x01_VARIANT_ENUM VARIANT_T>
+  NT3H1x01_ERR_RETURN_TYPE NT3H1x01_dumpImage(NT3H1x01<VARIANT_T>& tag, FILE* file, bool includeSRAM=false) { return(NT3H1x01_dumpImage(tag, _NT3H1x01_imageFileSink, file, includeSRAM)); } // (just a macro)
+#endif
+
+/**
+ * what NT3H1x01_programImage() did
+ */
+struct NT3H1x01_programResult
+{
+  uint8_t blocksChecked = 0;  // blocks that were read and compared
+  uint8_t blocksWritten = 0;  // blocks that differed (and were written)
+  uint8_t blocksKept = 0;     // blocks that only differed in bytes that are never programmed (UID, lock bytes, etc., see top), so they were left alone
+  bool verified = false;      // whether the read-back matched (CRC) what it should be
+};
+
+/**
+ * (private) what a block should look like after programming: the image, except for the parts that are never programmed (those stay as they are on the tag)
+ * @param memMap memory map of the tag
+ * @param blockAddress MEMory Address (MEMA) of the block
+ * @param imageBlock the block in the image
+ * @param current the block as it is on the tag, is overwritten with what it should be
+ */
+inline void _NT3H1x01_imageTargetBlock(const NT3H1x01_memMap& memMap, uint8_t blockAddress, const uint8_t imageBlock[], uint8_t current[]) {
+  uint8_t programStart = 0, programEnd = NT3H1x01_BLOCK_SIZE; // which bytes of the block are programmed
+  if(blockAddress == 0x00) { programStart = NT3H1x01_CAPA_CONT_MEMA_BYTES_START; } // only the CC
+  else if(blockAddress == memMap.dynaLockMEMA) { programEnd = memMap.userBytesInBlock(blockAddress); } // only the user memory (1k variant)
+  else if(blockAddress == memMap.confRegsMEMA) { programEnd = NT3H1x01_CONF_REGS_REG_LOCK_BYTE; } // not REG_LOCK (or the fixed 0's after it)
+  for(uint8_t i=programStart; i<programEnd; i++) { current[i] = imageBlock[i]; }
+}
+
+/**
+ * program an image onto a tag, writing only the blocks that differ, then read everything back to verify it (see top for what is and isn't programmed)
+ * @param tag the tag to program (must be the same variant as the image)
+ * @param image the whole image (e.g. from NT3H1x01_mapImageFile())
+ * @param size size of the image in bytes
+ * @param result (reference) what it did
+ * @param verify (optional) whether to read everything back afterwards (to check the CRC)
+ * @return (bool or esp_err_t or i2c_status_e, see on defines at top) whether it was successful (invalid image, variant mismatch, a locked block that differs or a failed verify also return a failure)
+ */
+template<NT3H1x01_VARIANT_ENUM VARIANT_T>
+NT3H1x01_ERR_RETURN_TYPE NT3H1x01_programImage(NT3H1x01<VARIANT_T>& tag, const uint8_t image[], size_t size, NT3H1x01_programResult& result, bool verify=true) {
+  result = NT3H1x01_programResult();
+  NT3H1x01_imageInfo info;
+  if(!NT3H1x01_parseImage(image, size, info)) { return(NT3H1x01_ERR_RETURN_TYPE_FAIL); } // (check the whole image BEFORE touching the tag)
+  const NT3H1x01_memMap memMap = tag.memMap();
+  if(info.is2kVariant != tag._is2k()) { NT3H1x01debugPrint("NT3H1x01_programImage() image is for the other variant!"); return(NT3H1x01_ERR_RETURN_TYPE_FAIL); }
+  NT3H1x01_ERR_RETURN_TYPE err = NT3H1x01_ERR_RETURN_TYPE_OK;
+  uint8_t current[NT3H1x01_BLOCK_SIZE], target[NT3H1x01_BLOCK_SIZE];
+  uint32_t targetCRC = 0;
+  for(uint8_t pass=0; pass<(verify ? 2 : 1); pass++) { // pass 0: program, pass 1: verify
+    uint32_t readCRC = 0;
+    for(uint16_t blockAddress=0x00; blockAddress<=NT3H1x01_SRAM_MEMA_END; blockAddress++) { // (uint16_t, so it can't overflow)
+      const uint8_t* imageBlock = info.block(blockAddress);
+      if(!imageBlock || !memMap.isValidBlock(blockAddress)) { continue; }
+      err = tag.requestMemBlock(blockAddress, current);
+      if(!tag._errGood(err)) { NT3H1x01debugPrint("NT3H1x01_programImage() read error!"); tag._oneBlockBuffAddress = NT3H1x01_INVALID_MEMA; return(err); }
+      if(pass == 1) { readCRC = NT3H1x01_crc32(current, NT3H1x01_BLOCK_SIZE, readCRC);  continue; }
+      result.blocksChecked++;
+      for(uint8_t i=0; i<NT3H1x01_BLOCK_SIZE; i++) { target[i] = current[i]; }
+      _NT3H1x01_imageTargetBlock(memMap, blockAddress, imageBlock, target);
+      targetCRC = NT3H1x01_crc32(target, NT3H1x01_BLOCK_SIZE, targetCRC);
+      bool imageDiffers = false, targetDiffers = false;
+      for(uint8_t i=0; i<NT3H1x01_BLOCK_SIZE; i++) { imageDiffers |= (imageBlock[i] != current[i]);  targetDiffers |= (target[i] != current[i]); }
+      if(!targetDiffers) { if(imageDiffers) { result.blocksKept++; } continue; }
+      if((blockAddress <= memMap.userEnd) && tag.isLocked(blockAddress)) { NT3H1x01debugPrint("NT3H1x01_programImage() block is locked!"); tag._oneBlockBuffAddress = NT3H1x01_INVALID_MEMA; return(NT3H1x01_ERR_RETURN_TYPE_FAIL); } // (the CC and the user memory, like _writeUserBlockFrom())
+      if(blockAddress == NT3H1x01_I2C_ADDR_CHANGE_MEMA) { target[NT3H1x01_I2C_ADDR_CHANGE_MEMA_BYTE] = (tag.slaveAddress<<1); } // I2C address byte reads as manufacturer ID (and must not be changed)
+      err = tag.writeMemBlock(blockAddress, target);
+      if(!tag._errGood(err)) { NT3H1x01debugPrint("NT3H1x01_programImage() write error!"); tag._oneBlockBuffAddress = NT3H1x01_INVALID_MEMA; return(err); }
+      result.blocksWritten++;
+    }
+    if(pass == 1) {
+      result.verified = (readCRC == targetCRC);
+      if(!result.verified) { NT3H1x01debugPrint("NT3H1x01_programImage() verify failed!"); err = NT3H1x01_ERR_RETURN_TYPE_FAIL; }
+    }
+  }
+  tag._oneBlockBuffAddress = NT3H1x01_INVALID_MEMA; // (the cached block may have been overwritten)
+  return(err);
+}
+/**
+ * program an image onto a tag, writing only the blocks that differ (see the other NT3H1x01_programImage())
+ */
+template<NT3H1x01_VARIANT_ENUM VARIANT_T>
+NT3H1x01_ERR_RETURN_TYPE NT3H1x01_programImage(NT3H1x01<VARIANT_T>& tag, const uint8_t image[], size_t size) { NT3H1x01_programResult result; return(NT3H1x01_programImage(tag, image, size, result)); } // (just a macro)
+
+#ifdef NT3H1x01_IMAGE_MMAP
+  /**
+   * memory-map an image file (read-only), so it can be used without reading it into RAM
+   * @param path the file
+   * @param size (reference) where to put the size of the file
+   * @return pointer to the file contents, or NULL if it couldn't be mapped. Unmap it with NT3H1x01_unmapImageFile()
+   */
+  inline const uint8_t* NT3H1x01_mapImageFile(const char* path, size_t& size) {
+    int fd = open(path, O_RDONLY);
+    if(fd < 0) { return(NULL); }
+    struct stat fileStat;
+    if((fstat(fd, &fileStat) != 0) || (fileStat.st_size <= 0)) { close(fd); return(NULL); }
+    size = fileStat.st_size;
+    void* mapped = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); // (the mapping stays valid)
+    return((mapped == MAP_FAILED) ? NULL : (const uint8_t*)mapped);
+  }
+  /**
+   * unmap an image file mapped with NT3H1x01_mapImageFile()
+   */
+  inline void NT3H1x01_unmapImageFile(const uint8_t* image, size_t size) { if(image) { munmap((void*)image, size); } }
+#endif
+
+#endif // NT3H1x01_thijs_image_h
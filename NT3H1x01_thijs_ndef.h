@@ -0,0 +1,660 @@
+/*
+
+(optional) NDEF parsing (and encoding) for the NT3H1x01_thijs library.
+The user memory of an NFC Forum Type 2 tag (which is what the NT3H1x01 is, from the RF side) holds a list of TLV blocks (Type, Length, Value),
+ and the NDEF TLV (type 0x03) holds the actual NDEF message, which is a list of NDEF records (each with a TNF, type, optional ID and payload).
+The Capability Container (CC, in block 0) says which version of the spec the tag follows, how big the data area is and whether it's read/write-protected.
+
+Everything in here works on a plain byte buffer (a copy of the user memory, e.g. read with readUserBlock()),
+ and never reads outside of it, no matter what's in there (the content is written by phones, so treat it as untrusted).
+Nothing is copied: the parsed structs just hold offsets into the buffer you passed.
+
+e.g.:
+  uint16_t pos = 0;  NT3H1x01_tlv tlv;
+  if(NT3H1x01_findTLV(userMem, sizeof(userMem), NT3H1x01_TLV_NDEF, tlv)) {
+    NT3H1x01_ndefRecord rec;  uint16_t recPos = tlv.valueOffset;
+    while(NT3H1x01_nextNdefRecord(userMem, tlv.valueOffset + tlv.length, recPos, rec)) { ... &userMem[rec.payloadOffset] ... }
+  }
+
+Encoding works the other way around: describe the records (URI, Text, MIME or External) and get the user memory contents (NDEF TLV, message, Terminator TLV,
+ padded with 0's to a whole number of blocks). For static content, all of that can happen at compile-time (constexpr, even in C++11),
+ so the finished image can sit in flash and be written with writeUserBytes_P() without ever being built in RAM:
+  constexpr NT3H1x01_ndefRecordData records[] = {NT3H1x01_ndefUri(NT3H1x01_URI_HTTPS, "example.com"), NT3H1x01_ndefText("en", "Hello")}; // (must be static/global)
+  constexpr NT3H1x01_ndefMessageData message = NT3H1x01_ndefMessage(records);
+  static constexpr auto image PROGMEM = NT3H1x01_NDEF_IMAGE(message);
+  static_assert(image.fits(NT3H1x01_getMemMap(false)), "NDEF message is too big for the NT3H1101");
+  ...
+  nfc.writeUserBytes_P(1, image.bytes, sizeof(image.bytes));  nfc.setSess_LAST_NDEF_BLOCK(image.lastNdefBlock(1));
+For content that's only known at runtime, NT3H1x01_encodeNdefMessage() does the same thing into a RAM buffer.
+
+Small changes to a message that's already on the tag (a serial number or counter in a URI) don't need a re-encode: NT3H1x01_patchNdefPayload() and
+ NT3H1x01_spliceNdefPayload() find the record on the tag (reading only the blocks they need, see NT3H1x01_userMemReader) and rewrite only the blocks that change:
+  NT3H1x01_ndefPatchResult result;
+  NT3H1x01_patchNdefPayload(nfc, 0, 12, (const uint8_t*)"0042", 4, result); // overwrite 4 bytes of the payload of the first record (the length stays the same)
+  NT3H1x01_spliceNdefPayload(nfc, 0, 12, 4, (const uint8_t*)"12345", 5, result); // replace those 4 bytes by 5 bytes (the rest of the message moves up 1 byte)
+
+*/
+
+#ifndef NT3H1x01_thijs_ndef_h
+#define NT3H1x01_thijs_ndef_h
+
+#include "NT3H1x01_thijs.h"
+
+//// (the TLV block types (NT3H1x01_TLV_NDEF etc.) are in NT3H1x01_thijs.h, findNdefEnd() uses them too)
+
+//// NDEF record header bits:
+#define NT3H1x01_NDEF_MB_bits  0b10000000 // Message Begin
+#define NT3H1x01_NDEF_ME_bits  0b01000000 // Message End
+#define NT3H1x01_NDEF_CF_bits  0b00100000 // Chunk Flag
+#define NT3H1x01_NDEF_SR_bits  0b00010000 // Short Record (1 byte payload length instead of 4)
+#define NT3H1x01_NDEF_IL_bits  0b00001000 // ID Length field is present
+#define NT3H1x01_NDEF_TNF_bits 0b00000111 // Type Name Format
+
+#define NT3H1x01_CC_MAGIC 0xE1 // CC byte 0 for NFC Forum tags
+
+#ifndef NT3H1x01_SPLICE_READER_BLOCKS
+  #define NT3H1x01_SPLICE_READER_BLOCKS 4 // how many blocks NT3H1x01_spliceNdefPayload() keeps around while it moves data, enough to read every block only once for a shift of up to (this-1)*16 bytes
+#endif
+
+/**
+ * the Capability Container, interpreted
+ */
+struct NT3H1x01_ccInfo
+{
+  bool valid;             // whether byte 0 is the NFC Forum magic number (and the major version is 1)
+  uint8_t versionMajor;
+  uint8_t versionMinor;
+  uint16_t dataAreaBytes; // size of the data area (CC byte 2 * 8)
+  bool readable;          // read access nibble is 0 (unprotected)
+  bool writable;          // write access nibble is 0 (0xF means no write access at all)
+};
+
+/**
+ * interpret the 4 Capability Container bytes (see getCC())
+ * @param cc the 4 CC bytes
+ * @return the interpreted CC (check .valid)
+ */
+inline NT3H1x01_ccInfo NT3H1x01_parseCC(const uint8_t cc[4]) {
+  NT3H1x01_ccInfo info;
+  info.versionMajor = cc[1] >> 4;  info.versionMinor = cc[1] & 0x0F;
+  info.valid = (cc[0] == NT3H1x01_CC_MAGIC) && (info.versionMajor == 1);
+  info.dataAreaBytes = (uint16_t)cc[2] * 8;
+  info.readable = ((cc[3] >> 4) == 0);  info.writable = ((cc[3] & 0x0F) == 0);
+  return(info);
+}
+
+/**
+ * one TLV block (offsets are into the buffer it was parsed from)
+ */
+struct NT3H1x01_tlv
+{
+  uint8_t type;           // see NT3H1x01_TLV_ defines
+  uint16_t tlvOffset;     // where the TLV starts (the type byte)
+  uint16_t valueOffset;   // where the value starts
+  uint16_t length;        // length of the value
+};
+
+/**
+ * walk the TLV list: get the TLV at pos, and move pos to the next one (NULL TLVs are skipped)
+ * @tparam AREA_T a byte buffer, or a NT3H1x01_userMemReader (reads the tag on demand)
+ * @param area the user memory (copy)
+ * @param areaSize size of area in bytes
+ * @param pos (reference) where to start (0 for the first TLV), is moved past the returned TLV
+ * @param tlv (reference) where to put the TLV
+ * @return false at the Terminator TLV, the end of the area, or if the TLV doesn't fit in the area (malformed)
+ */
+template<typename AREA_T>
+bool NT3H1x01_nextTLV(const AREA_T& area, uint16_t areaSize, uint16_t& pos, NT3H1x01_tlv& tlv) {
+  while((pos < areaSize) && (area[pos] == NT3H1x01_TLV_NULL)) { pos++; } // skip padding
+  if((pos >= areaSize) || (area[pos] == NT3H1x01_TLV_TERMINATOR)) { return(false); }
+  tlv.type = area[pos];  tlv.tlvOffset = pos;
+  uint32_t cursor = (uint32_t)pos + 1; // (32bit, so nothing below can overflow)
+  if(cursor >= areaSize) { return(false); }
+  uint16_t length = area[cursor++];
+  if(length == NT3H1x01_TLV_LONG_LENGTH) {
+    if((cursor + 2) > areaSize) { return(false); }
+    length = ((uint16_t)area[cursor] << 8) | area[cursor+1];  cursor += 2;
+  }
+  if((cursor + length) > areaSize) { return(false); } // value doesn't fit
+  tlv.valueOffset = cursor;  tlv.length = length;
+  pos = cursor + length;
+  return(true);
+}
+
+/**
+ * find the first TLV of a certain type
+ * @tparam AREA_T a byte buffer, or a NT3H1x01_userMemReader (reads the tag on demand)
+ * @param area the user memory (copy)
+ * @param areaSize size of area in bytes
+ * @param type which TLV type (e.g. NT3H1x01_TLV_NDEF)
+ * @param tlv (reference) where to put the TLV
+ * @return true if found
+ */
+template<typename AREA_T>
+bool NT3H1x01_findTLV(const AREA_T& area, uint16_t areaSize, uint8_t type, NT3H1x01_tlv& tlv) {
+  uint16_t pos = 0;
+  while(NT3H1x01_nextTLV(area, areaSize, pos, tlv)) { if(tlv.type == type) { return(true); } }
+  return(false);
+}
+
+/**
+ * one NDEF record (offsets are into the buffer it was parsed from)
+ */
+struct NT3H1x01_ndefRecord
+{
+  uint8_t header;         // MB, ME, CF, SR, IL and TNF bits (see NT3H1x01_NDEF_ defines)
+  uint8_t typeLength;
+  uint8_t idLength;
+  uint16_t payloadLength; // (the spec allows up to 2^32, but nothing that big fits in this tag)
+  uint16_t recordOffset;  // where the record starts (the header byte)
+  uint16_t typeOffset;
+  uint16_t idOffset;
+  uint16_t payloadOffset;
+  uint16_t recordLength;  // total size of the record (header to end of payload)
+
+  uint8_t TNF() const { return(header & NT3H1x01_NDEF_TNF_bits); }
+  bool messageBegin() const { return(header & NT3H1x01_NDEF_MB_bits); }
+  bool messageEnd() const { return(header & NT3H1x01_NDEF_ME_bits); }
+};
+
+/**
+ * parse the NDEF record at pos, and move pos to the next one
+ * @tparam AREA_T a byte buffer, or a NT3H1x01_userMemReader (reads the tag on demand)
+ * @param msg the buffer holding the NDEF message (may be the whole user memory, just pass the end of the message as msgEnd)
+ * @param msgEnd where the message ends (e.g. tlv.valueOffset + tlv.length)
+ * @param pos (reference) where the record starts, is moved past it (only if it's valid)
+ * @param rec (reference) where to put the record
+ * @return false if there is no (valid) record at pos (e.g. the end of the message, or it doesn't fit)
+ */
+template<typename AREA_T>
+bool NT3H1x01_parseNdefRecord(const AREA_T& msg, uint16_t msgEnd, uint16_t& pos, NT3H1x01_ndefRecord& rec) {
+  uint32_t cursor = pos; // (32bit, so nothing below can overflow)
+  if((cursor + 3) > msgEnd) { return(false); } // header, type length, (at least 1 byte of) payload length
+  rec.recordOffset = pos;  rec.header = msg[cursor++];  rec.typeLength = msg[cursor++];
+  uint32_t payloadLength;
+  if(rec.header & NT3H1x01_NDEF_SR_bits) { payloadLength = msg[cursor++]; }
+  else {
+    if((cursor + 4) > msgEnd) { return(false); }
+    payloadLength = ((uint32_t)msg[cursor] << 24) | ((uint32_t)msg[cursor+1] << 16) | ((uint32_t)msg[cursor+2] << 8) | msg[cursor+3];  cursor += 4;
+  }
+  rec.idLength = 0;
+  if(rec.header & NT3H1x01_NDEF_IL_bits) { if(cursor >= msgEnd) { return(false); }  rec.idLength = msg[cursor++]; }
+  if(payloadLength > msgEnd) { return(false); } // (also keeps the sum below from overflowing)
+  uint32_t recordEnd = cursor + rec.typeLength + rec.idLength + payloadLength;
+  if(recordEnd > msgEnd) { return(false); }
+  rec.typeOffset = cursor;  rec.idOffset = cursor + rec.typeLength;  rec.payloadOffset = rec.idOffset + rec.idLength;
+  rec.payloadLength = payloadLength;  rec.recordLength = recordEnd - pos;
+  pos = recordEnd;
+  return(true);
+}
+
+/**
+ * walk the records of an NDEF message (stops after the record with the ME bit)
+ * @tparam AREA_T a byte buffer, or a NT3H1x01_userMemReader (reads the tag on demand)
+ * @param msg the buffer holding the NDEF message
+ * @param msgEnd where the message ends (e.g. tlv.valueOffset + tlv.length)
+ * @param pos (reference) where to start (e.g. tlv.valueOffset), is moved past the returned record (or to msgEnd after the last one)
+ * @param rec (reference) where to put the record
+ * @return false at the end of the message (or if the next record is malformed)
+ */
+template<typename AREA_T>
+bool NT3H1x01_nextNdefRecord(const AREA_T& msg, uint16_t msgEnd, uint16_t& pos, NT3H1x01_ndefRecord& rec) {
+  if(!NT3H1x01_parseNdefRecord(msg, msgEnd, pos, rec)) { return(false); }
+  if(rec.messageEnd()) { pos = msgEnd; } // (so the next call returns false)
+  return(true);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////// encoding: //////////////////////////////////////////////////////////
+
+//// Type Name Format values (NDEF record header):
+#define NT3H1x01_TNF_EMPTY      0x00
+#define NT3H1x01_TNF_WELL_KNOWN 0x01 // NFC Forum well-known type (e.g. "U" for URI, "T" for Text)
+#define NT3H1x01_TNF_MIME       0x02 // MIME media type (e.g. "text/vcard")
+#define NT3H1x01_TNF_URI        0x03 // absolute URI (as the type)
+#define NT3H1x01_TNF_EXTERNAL   0x04 // NFC Forum external type (e.g. "example.com:mytype")
+#define NT3H1x01_TNF_UNKNOWN    0x05
+
+//// URI record prefix codes (the first byte of the payload, replaces the start of the URI), the full list goes up to 0x23:
+#define NT3H1x01_URI_NONE       0x00 // the URI is written out in full
+#define NT3H1x01_URI_HTTP_WWW   0x01 // "http://www."
+#define NT3H1x01_URI_HTTPS_WWW  0x02 // "https://www."
+#define NT3H1x01_URI_HTTP       0x03 // "http://"
+#define NT3H1x01_URI_HTTPS      0x04 // "https://"
+#define NT3H1x01_URI_TEL        0x05 // "tel:"
+#define NT3H1x01_URI_MAILTO     0x06 // "mailto:"
+
+/**
+ * what to encode as one NDEF record (see NT3H1x01_ndefUri(), NT3H1x01_ndefText(), NT3H1x01_ndefMime() and NT3H1x01_ndefExternal()).
+ * the payload is: (optional) lead byte, part 1, part 2. Nothing is copied, it just points to the data (so the data must outlive it).
+ * All functions are constexpr, so a record describing constant data can be encoded at compile-time.
+ */
+struct NT3H1x01_ndefRecordData
+{
+  uint8_t TNF;              // Type Name Format (see NT3H1x01_TNF_ defines)
+  const char* type;         // record type (e.g. "U"), NOT null-terminated
+  uint8_t typeLength;
+  bool hasLeadByte;         // whether the payload starts with leadByte
+  uint8_t leadByte;         // URI prefix code, or Text status byte (language code length)
+  const char* part1;        // first part of the payload (e.g. the URI, or the language code)
+  const uint8_t* part1Bytes; // (used instead of part1 if not NULL, for binary payloads)
+  uint16_t part1Length;
+  const char* part2;        // second part of the payload (e.g. the text of a Text record)
+  uint16_t part2Length;
+
+  constexpr uint16_t payloadLength() const { return(hasLeadByte + part1Length + part2Length); }
+  constexpr bool shortRecord() const { return(payloadLength() <= 0xFF); } // whether the payload length fits in 1 byte (SR bit)
+  constexpr uint8_t headerLength() const { return(shortRecord() ? 3 : 6); } // header byte, type length, payload length (no ID)
+  constexpr uint16_t size() const { return(headerLength() + typeLength + payloadLength()); } // size of the encoded record
+  constexpr uint8_t headerByte(bool first, bool last) const {
+    return((first ? NT3H1x01_NDEF_MB_bits : 0) | (last ? NT3H1x01_NDEF_ME_bits : 0) | (shortRecord() ? NT3H1x01_NDEF_SR_bits : 0) | (TNF & NT3H1x01_NDEF_TNF_bits)); }
+  constexpr uint8_t payloadByte(uint16_t index) const {
+    return(hasLeadByte ? ((index == 0) ? leadByte : _partsByte(index - 1)) : _partsByte(index)); }
+  constexpr uint8_t _partsByte(uint16_t index) const { // (private)
+    return((index < part1Length) ? (part1Bytes ? part1Bytes[index] : (uint8_t)part1[index]) : (uint8_t)part2[index - part1Length]); }
+  /**
+   * one byte of the encoded record
+   * @param index 0 ~ size()-1
+   * @param first whether this is the first record of the message (MB bit)
+   * @param last whether this is the last record of the message (ME bit)
+   * @return the byte
+   */
+  constexpr uint8_t byteAt(uint16_t index, bool first, bool last) const {
+    return((index == 0) ? headerByte(first, last) : (index == 1) ? typeLength
+           : (index < headerLength()) ? (shortRecord() ? (uint8_t)payloadLength() : (uint8_t)((uint32_t)payloadLength() >> (8 * (5 - index)))) // (big-endian)
+           : (index < (headerLength() + typeLength)) ? (uint8_t)type[index - headerLength()]
+           : payloadByte(index - headerLength() - typeLength));
+  }
+};
+
+/**
+ * a URI record (well-known type "U")
+ * @param prefixCode which URI prefix the URI starts with (see NT3H1x01_URI_ defines), e.g. NT3H1x01_URI_HTTPS for "https://"
+ * @param uri the rest of the URI, e.g. "example.com"
+ * @param length length of uri (in bytes)
+ * @return the record description
+ */
+constexpr NT3H1x01_ndefRecordData NT3H1x01_ndefUri(uint8_t prefixCode, const char* uri, uint16_t length) {
+  return(NT3H1x01_ndefRecordData{NT3H1x01_TNF_WELL_KNOWN, "U", 1, true, prefixCode, uri, NULL, length, "", 0}); }
+template<size_t N>
+constexpr NT3H1x01_ndefRecordData NT3H1x01_ndefUri(uint8_t prefixCode, const char (&uri)[N]) { return(NT3H1x01_ndefUri(prefixCode, uri, N-1)); } // (string literal, without the null-terminator)
+/**
+ * a Text record (well-known type "T"), UTF-8
+ * @param lang IANA language code, e.g. "en"
+ * @param langLength length of lang (max 63)
+ * @param text the text (UTF-8)
+ * @param textLength length of text (in bytes)
+ * @return the record description
+ */
+constexpr NT3H1x01_ndefRecordData NT3H1x01_ndefText(const char* lang, uint8_t langLength, const char* text, uint16_t textLength) {
+  return(NT3H1x01_ndefRecordData{NT3H1x01_TNF_WELL_KNOWN, "T", 1, true, (uint8_t)(langLength & 0x3F), lang, NULL, langLength, text, textLength}); } // (status byte bit 7 = 0 means UTF-8)
+template<size_t N, size_t M>
+constexpr NT3H1x01_ndefRecordData NT3H1x01_ndefText(const char (&lang)[N], const char (&text)[M]) { return(NT3H1x01_ndefText(lang, N-1, text, M-1)); }
+/**
+ * a MIME media record, e.g. "text/vcard" or "application/json"
+ * @param mimeType the MIME type
+ * @param typeLength length of mimeType
+ * @param payload the payload
+ * @param length length of the payload (in bytes)
+ * @return the record description
+ */
+constexpr NT3H1x01_ndefRecordData NT3H1x01_ndefMime(const char* mimeType, uint8_t typeLength, const uint8_t* payload, uint16_t length) {
+  return(NT3H1x01_ndefRecordData{NT3H1x01_TNF_MIME, mimeType, typeLength, false, 0, "", payload, length, "", 0}); }
+template<size_t N, size_t M>
+constexpr NT3H1x01_ndefRecordData NT3H1x01_ndefMime(const char (&mimeType)[N], const uint8_t (&payload)[M]) { return(NT3H1x01_ndefMime(mimeType, N-1, payload, M)); } // (binary payload, all M bytes)
+template<size_t N, size_t M>
+constexpr NT3H1x01_ndefRecordData NT3H1x01_ndefMime(const char (&mimeType)[N], const char (&payload)[M]) { // (text payload, without the null-terminator)
+  return(NT3H1x01_ndefRecordData{NT3H1x01_TNF_MIME, mimeType, N-1, false, 0, payload, NULL, M-1, "", 0}); }
+/**
+ * an NFC Forum external type record, e.g. "example.com:sensor" (for your own app)
+ * @param type the external type name ("domain:type")
+ * @param typeLength length of type
+ * @param payload the payload
+ * @param length length of the payload (in bytes)
+ * @return the record description
+ */
+constexpr NT3H1x01_ndefRecordData NT3H1x01_ndefExternal(const char* type, uint8_t typeLength, const uint8_t* payload, uint16_t length) {
+  return(NT3H1x01_ndefRecordData{NT3H1x01_TNF_EXTERNAL, type, typeLength, false, 0, "", payload, length, "", 0}); }
+template<size_t N, size_t M>
+constexpr NT3H1x01_ndefRecordData NT3H1x01_ndefExternal(const char (&type)[N], const uint8_t (&payload)[M]) { return(NT3H1x01_ndefExternal(type, N-1, payload, M)); } // (binary payload, all M bytes)
+template<size_t N, size_t M>
+constexpr NT3H1x01_ndefRecordData NT3H1x01_ndefExternal(const char (&type)[N], const char (&payload)[M]) { // (text payload, without the null-terminator)
+  return(NT3H1x01_ndefRecordData{NT3H1x01_TNF_EXTERNAL, type, N-1, false, 0, payload, NULL, M-1, "", 0}); }
+
+/**
+ * a whole NDEF message (a list of records), and how it ends up in the user memory: NDEF TLV, the message, Terminator TLV, 0's up to the end of the block
+ */
+struct NT3H1x01_ndefMessageData
+{
+  const NT3H1x01_ndefRecordData* records;
+  uint8_t recordCount;
+
+  constexpr uint16_t _sizeFrom(uint8_t record) const { return((record < recordCount) ? (records[record].size() + _sizeFrom(record + 1)) : 0); } // (private)
+  constexpr uint8_t _byteFrom(uint8_t record, uint16_t index) const { // (private)
+    return((index < records[record].size()) ? records[record].byteAt(index, record == 0, record == (recordCount - 1)) : _byteFrom(record + 1, index - records[record].size())); }
+  constexpr uint16_t size() const { return(_sizeFrom(0)); } // size of the encoded message
+  constexpr uint8_t byteAt(uint16_t index) const { return(_byteFrom(0, index)); } // one byte of the encoded message (0 ~ size()-1)
+  constexpr uint8_t tlvHeaderLength() const { return((size() < NT3H1x01_TLV_LONG_LENGTH) ? 2 : 4); } // type, length (1 or 3 bytes)
+  constexpr uint16_t tlvSize() const { return(tlvHeaderLength() + size() + 1); } // NDEF TLV + Terminator TLV
+  constexpr uint16_t imageSize() const { return(((tlvSize() + NT3H1x01_BLOCK_SIZE - 1) / NT3H1x01_BLOCK_SIZE) * NT3H1x01_BLOCK_SIZE); } // (a whole number of blocks)
+  /**
+   * one byte of the user memory image
+   * @param index 0 ~ imageSize()-1
+   * @return the byte
+   */
+  constexpr uint8_t imageByte(uint16_t index) const {
+    return((index == 0) ? NT3H1x01_TLV_NDEF
+           : (index < tlvHeaderLength()) ? ((tlvHeaderLength() == 2) ? (uint8_t)size() : (index == 1) ? NT3H1x01_TLV_LONG_LENGTH : (index == 2) ? (uint8_t)(size() >> 8) : (uint8_t)size())
+           : (index < (tlvHeaderLength() + size())) ? byteAt(index - tlvHeaderLength())
+           : (index == (tlvHeaderLength() + size())) ? NT3H1x01_TLV_TERMINATOR : 0);
+  }
+};
+
+/**
+ * (just a macro) make a message out of an array of records
+ * @param records the records (for compile-time use, this array must be static or global (constexpr))
+ * @return the message description (which points to the array)
+ */
+template<size_t N>
+constexpr NT3H1x01_ndefMessageData NT3H1x01_ndefMessage(const NT3H1x01_ndefRecordData (&records)[N]) { return(NT3H1x01_ndefMessageData{records, (uint8_t)N}); }
+
+/**
+ * the encoded user memory contents of an NDEF message, a whole number of blocks (see NT3H1x01_NDEF_IMAGE())
+ * @tparam SIZE size in bytes
+ */
+template<uint16_t SIZE>
+struct NT3H1x01_ndefImage
+{
+  uint8_t bytes[SIZE]; // what to write to the user memory (e.g. with writeUserBytes() or writeUserBytes_P())
+
+  constexpr uint8_t blocks() const { return(SIZE / NT3H1x01_BLOCK_SIZE); }
+  /**
+   * the value for LAST_NDEF_BLOCK: the block that holds the last byte of the NDEF message (not the Terminator TLV or the padding, the reader doesn't need those)
+   * @param startBlock where the image is written (usually the start of the user memory: 1)
+   * @return block address
+   */
+  constexpr uint8_t lastNdefBlock(uint8_t startBlock=1) const {
+    return(startBlock + (((bytes[1] == NT3H1x01_TLV_LONG_LENGTH) ? (4 + (((uint16_t)bytes[2] << 8) | bytes[3])) : (2 + bytes[1])) - 1) / NT3H1x01_BLOCK_SIZE); }
+  /**
+   * whether the image fits in the user memory
+   * @param memMap the memory map of the variant, e.g. NT3H1x01_getMemMap(false) for the NT3H1101
+   * @param startBlock where the image is written (usually the start of the user memory: 1)
+   * @return true if it fits
+   */
+  constexpr bool fits(NT3H1x01_memMap memMap, uint8_t startBlock=1) const {
+    return(memMap.isUserBlock(startBlock) && (SIZE <= (memMap.userBytes - ((uint16_t)(startBlock - memMap.userStart) * NT3H1x01_BLOCK_SIZE)))); }
+};
+
+//// (private) a list of indices (std::index_sequence is C++14), built in log(N) template recursion depth
+template<uint16_t... I> struct _NT3H1x01_indexSeq { typedef _NT3H1x01_indexSeq type; };
+template<typename A, typename B> struct _NT3H1x01_concatIndexSeq;
+template<uint16_t... A, uint16_t... B> struct _NT3H1x01_concatIndexSeq<_NT3H1x01_indexSeq<A...>, _NT3H1x01_indexSeq<B...>> : _NT3H1x01_indexSeq<A..., (uint16_t)(sizeof...(A) + B)...> {};
+template<uint16_t N> struct _NT3H1x01_makeIndexSeq : _NT3H1x01_concatIndexSeq<typename _NT3H1x01_makeIndexSeq<N/2>::type, typename _NT3H1x01_makeIndexSeq<N - N/2>::type> {};
+template<> struct _NT3H1x01_makeIndexSeq<0> : _NT3H1x01_indexSeq<> {};
+template<> struct _NT3H1x01_makeIndexSeq<1> : _NT3H1x01_indexSeq<0> {};
+
+template<uint16_t SIZE, uint16_t... I>
+constexpr NT3H1x01_ndefImage<SIZE> _NT3H1x01_buildNdefImage(const NT3H1x01_ndefMessageData& message, _NT3H1x01_indexSeq<I...>) { return(NT3H1x01_ndefImage<SIZE>{{message.imageByte(I)...}}); } // (private)
+/**
+ * encode a message into a user memory image (constexpr), use NT3H1x01_NDEF_IMAGE() to get the size right
+ * @tparam SIZE image size, should be message.imageSize()
+ * @param message the message
+ * @return the image
+ */
+template<uint16_t SIZE>
+constexpr NT3H1x01_ndefImage<SIZE> NT3H1x01_buildNdefImage(const NT3H1x01_ndefMessageData& message) { return(_NT3H1x01_buildNdefImage<SIZE>(message, typename _NT3H1x01_makeIndexSeq<SIZE>::type())); }
+#define NT3H1x01_NDEF_IMAGE(message)  NT3H1x01_buildNdefImage<(message).imageSize()>(message) // the user memory image of a (constexpr) message, e.g.: static constexpr auto image PROGMEM = NT3H1x01_NDEF_IMAGE(message);
+
+/**
+ * encode one NDEF record (at runtime), see NT3H1x01_encodeNdefMessage()
+ * @param rec the record description
+ * @param first whether this is the first record of the message (MB bit)
+ * @param last whether this is the last record of the message (ME bit)
+ * @param buff where to put it
+ * @param buffSize size of buff
+ * @return size of the encoded record (0 if it doesn't fit)
+ */
+inline uint16_t NT3H1x01_encodeNdefRecord(const NT3H1x01_ndefRecordData& rec, bool first, bool last, uint8_t buff[], uint16_t buffSize) {
+  uint16_t payloadLength = rec.payloadLength();
+  if(((uint32_t)rec.headerLength() + rec.typeLength + payloadLength) > buffSize) { return(0); }
+  uint16_t pos = 0;
+  buff[pos++] = rec.headerByte(first, last);
+  buff[pos++] = rec.typeLength;
+  if(rec.shortRecord()) { buff[pos++] = payloadLength; }
+  else { buff[pos++] = 0;  buff[pos++] = 0;  buff[pos++] = payloadLength >> 8;  buff[pos++] = payloadLength & 0xFF; } // (32bit big-endian)
+  for(uint8_t i=0; i<rec.typeLength; i++) { buff[pos++] = rec.type[i]; }
+  if(rec.hasLeadByte) { buff[pos++] = rec.leadByte; }
+  for(uint16_t i=0; i<rec.part1Length; i++) { buff[pos++] = rec.part1Bytes ? rec.part1Bytes[i] : rec.part1[i]; }
+  for(uint16_t i=0; i<rec.part2Length; i++) { buff[pos++] = rec.part2[i]; }
+  return(pos);
+}
+
+/**
+ * encode an NDEF message into a user memory image (at runtime): NDEF TLV, the message, Terminator TLV, 0's up to the end of the block.
+ * (this is what NT3H1x01_NDEF_IMAGE() does at compile-time, for content that's only known at runtime)
+ * @param records the records
+ * @param recordCount how many records
+ * @param buff where to put it (e.g. a buffer of memMap().userBytes)
+ * @param buffSize size of buff
+ * @return size of the image (a multiple of NT3H1x01_BLOCK_SIZE), 0 if it doesn't fit in buff
+ */
+inline uint16_t NT3H1x01_encodeNdefMessage(const NT3H1x01_ndefRecordData records[], uint8_t recordCount, uint8_t buff[], uint16_t buffSize) {
+  uint32_t messageSize = 0;
+  for(uint8_t r=0; r<recordCount; r++) { messageSize += records[r].size(); }
+  uint8_t tlvHeaderLength = (messageSize < NT3H1x01_TLV_LONG_LENGTH) ? 2 : 4;
+  uint32_t imageSize = ((tlvHeaderLength + messageSize + 1 + NT3H1x01_BLOCK_SIZE - 1) / NT3H1x01_BLOCK_SIZE) * NT3H1x01_BLOCK_SIZE;
+  if(imageSize > buffSize) { NT3H1x01debugPrint("NT3H1x01_encodeNdefMessage() message does not fit!"); return(0); }
+  uint16_t pos = 0;
+  buff[pos++] = NT3H1x01_TLV_NDEF;
+  if(tlvHeaderLength == 2) { buff[pos++] = messageSize; }
+  else { buff[pos++] = NT3H1x01_TLV_LONG_LENGTH;  buff[pos++] = messageSize >> 8;  buff[pos++] = messageSize & 0xFF; }
+  for(uint8_t r=0; r<recordCount; r++) { pos += NT3H1x01_encodeNdefRecord(records[r], r == 0, r == (recordCount - 1), &buff[pos], buffSize - pos); }
+  buff[pos++] = NT3H1x01_TLV_TERMINATOR;
+  while(pos < imageSize) { buff[pos++] = 0; }
+  return(pos);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////// patching (on the tag): //////////////////////////////////////////////////////////
+
+/**
+ * reads the user memory of a tag on demand, so the parsing functions above (NT3H1x01_findTLV() etc.) can run on the tag itself, without a copy of the whole user memory.
+ * it keeps the last few blocks it read (so walking through data that straddles a block boundary doesn't read blocks twice).
+ * offsets are from the start of the user memory (block memMap().userStart), just like for a copy of the user memory.
+ * NOTE: it doesn't notice writes to the tag, make a new one (or call forget()) after writing.
+ * @tparam CACHE_BLOCKS how many blocks it keeps (2 is enough to walk through the memory, see NT3H1x01_SPLICE_READER_BLOCKS for moving data)
+ */
+template<NT3H1x01_VARIANT_ENUM VARIANT_T, uint8_t CACHE_BLOCKS=2>
+struct NT3H1x01_userMemReader
+{
+  NT3H1x01<VARIANT_T>& tag;
+  mutable uint8_t blocks[CACHE_BLOCKS][NT3H1x01_BLOCK_SIZE];
+  mutable uint8_t blockAddresses[CACHE_BLOCKS];
+  mutable uint16_t blocksRead = 0;
+  mutable NT3H1x01_ERR_RETURN_TYPE err = NT3H1x01_ERR_RETURN_TYPE_OK; // the first error (after an error, nothing is read anymore and everything reads as 0)
+
+  NT3H1x01_userMemReader(NT3H1x01<VARIANT_T>& tagToUse) : tag(tagToUse) { forget(); }
+  uint16_t size() const { return(tag.memMap().userBytes); } // (the areaSize to pass to the parsing functions)
+  void forget() { for(uint8_t i=0; i<CACHE_BLOCKS; i++) { blockAddresses[i] = NT3H1x01_INVALID_MEMA; } }
+  /**
+   * one byte of the user memory (read from the tag if it's not one of the blocks it has)
+   * @param offset from the start of the user memory (0 ~ size()-1)
+   * @return the byte (0 if it couldn't be read)
+   */
+  uint8_t operator[](uint16_t offset) const {
+    uint8_t blockAddress = tag.memMap().userStart + (offset / NT3H1x01_BLOCK_SIZE);
+    for(uint8_t i=0; i<CACHE_BLOCKS; i++) { if(blockAddresses[i] == blockAddress) { return(blocks[i][offset % NT3H1x01_BLOCK_SIZE]); } }
+    if(!tag._errGood(err) || !tag.memMap().isUserBlock(blockAddress)) { return(0); }
+    uint8_t i = 0; // replace the block furthest away from this one (everything that uses this walks through the memory in one direction, so that's the one least likely to be needed again)
+    for(uint8_t j=1; j<CACHE_BLOCKS; j++) { if(_distance(blockAddresses[j], blockAddress) > _distance(blockAddresses[i], blockAddress)) { i = j; } } // (empty ones (NT3H1x01_INVALID_MEMA) are the furthest away)
+    err = tag.requestMemBlock(blockAddress, blocks[i]);
+    if(!tag._errGood(err)) { NT3H1x01debugPrint("NT3H1x01_userMemReader read error!");  return(0); }
+    blockAddresses[i] = blockAddress;  blocksRead++;
+    return(blocks[i][offset % NT3H1x01_BLOCK_SIZE]);
+  }
+  static uint8_t _distance(uint8_t a, uint8_t b) { return((a > b) ? (a - b) : (b - a)); } // (just a macro)
+};
+
+/**
+ * what NT3H1x01_patchNdefPayload() / NT3H1x01_spliceNdefPayload() did
+ */
+struct NT3H1x01_ndefPatchResult
+{
+  uint16_t blocksRead = 0;    // blocks read (to find the record, and to keep the bytes around the patch)
+  uint8_t blocksWritten = 0;  // EEPROM blocks written (only the ones that actually changed)
+  int16_t shift = 0;          // how far the data after the patch moved (bytes, including any length fields that grew)
+  uint8_t lastBlock = 0;      // the block that now holds the last byte of the NDEF TLV (like findNdefEnd()), e.g. for LAST_NDEF_BLOCK (0 if the length didn't change, then nothing moved)
+};
+
+/**
+ * (private) the new contents of the user memory after a splice, as a function of the old contents (so it can be built one block at a time).
+ * everything from the TLV length field onwards may move: old[] positions are shifted by the length fields that grew and by the size difference of the payload.
+ */
+template<typename AREA_T>
+struct _NT3H1x01_ndefSplice
+{
+  const AREA_T& old;
+  uint16_t tlvLengthPos = 0, tlvLengthBytes = 0, newTlvLength = 0; // TLV length field: where (old position), how long (old), new value
+  bool tlvGrows = false;                                      // the TLV length field goes from 1 to 3 bytes
+  uint16_t recordPos = 0;                                     // record header byte
+  bool recordGrows = false;                                   // the payload length field goes from 1 to 4 bytes (SR bit cleared)
+  uint16_t payloadLengthPos = 0, payloadLengthBytes = 0;      // payload length field (old position, old size)
+  uint32_t newPayloadLength = 0;
+  uint16_t splicePos = 0, removeLength = 0;                   // where the replaced bytes are (old position)
+  const uint8_t* insert = NULL;  uint16_t insertLength = 0;   // what replaces them
+  uint16_t oldEnd = 0, newEnd = 0;                            // end of the TLV list (after the Terminator)
+
+  _NT3H1x01_ndefSplice(const AREA_T& oldArea) : old(oldArea) {}
+
+  uint8_t _dT() const { return(tlvGrows ? 2 : 0); }
+  uint8_t _dR() const { return(recordGrows ? 3 : 0); }
+  /**
+   * one byte of the new contents
+   * @param pos position in the user memory (new)
+   * @return the byte
+   */
+  uint8_t at(uint16_t pos) const {
+    if(pos < tlvLengthPos) { return(old[pos]); } // (TLV type byte and everything before it)
+    uint16_t newTlvLengthBytes = tlvGrows ? 3 : tlvLengthBytes;
+    if(pos < (tlvLengthPos + newTlvLengthBytes)) { // TLV length
+      if(newTlvLengthBytes == 1) { return(newTlvLength); }
+      uint8_t i = pos - tlvLengthPos;
+      return((i == 0) ? NT3H1x01_TLV_LONG_LENGTH : (i == 1) ? (newTlvLength >> 8) : (newTlvLength & 0xFF));
+    }
+    pos -= _dT(); // (back to old positions, up to the payload length field)
+    if(pos < payloadLengthPos) { return((pos == recordPos) ? (old[pos] & ~(recordGrows ? NT3H1x01_NDEF_SR_bits : 0)) : old[pos]); }
+    uint16_t newPayloadLengthBytes = recordGrows ? 4 : payloadLengthBytes;
+    if(pos < (payloadLengthPos + newPayloadLengthBytes)) { // payload length (big-endian)
+      uint8_t i = pos - payloadLengthPos;
+      return((newPayloadLengthBytes == 1) ? newPayloadLength : (uint8_t)(newPayloadLength >> (8 * (3 - i))));
+    }
+    pos -= _dR();
+    if(pos < splicePos) { return(old[pos]); }
+    if(pos < (splicePos + insertLength)) { return(insert[pos - splicePos]); }
+    pos = pos - insertLength + removeLength;
+    return((pos < oldEnd) ? old[pos] : 0); // (0's after the end)
+  }
+};
+
+/**
+ * replace a range of bytes in the payload of an NDEF record on the tag (the payload may get longer or shorter).
+ * Only the blocks that actually change are written: everything before the record stays put, and the data after the patch moves by the size difference.
+ * The TLV and record length fields are updated (a short record/TLV becomes a long one when it needs to, a long one stays long).
+ * The move is done one block at a time (like memmove, in the direction that never overwrites data that still has to be moved), so no copy of the user memory is needed.
+ * @param tag the tag
+ * @param recordIndex which record of the NDEF message (0 for the first)
+ * @param payloadOffset where in the payload the replaced bytes start
+ * @param removeLength how many bytes of the payload are replaced
+ * @param data what replaces them
+ * @param insertLength length of data
+ * @param result (reference) what it did
+ * @return (bool or esp_err_t or i2c_status_e, see on defines at top) whether it was successful (fails if the record isn't there, the range is outside of the payload, the result doesn't fit,
+ *         or (part of) the blocks that would change are locked (see isLocked(), checked before writing anything))
+ */
+template<NT3H1x01_VARIANT_ENUM VARIANT_T>
+NT3H1x01_ERR_RETURN_TYPE NT3H1x01_spliceNdefPayload(NT3H1x01<VARIANT_T>& tag, uint8_t recordIndex, uint16_t payloadOffset, uint16_t removeLength, const uint8_t data[], uint16_t insertLength, NT3H1x01_ndefPatchResult& result) {
+  result = NT3H1x01_ndefPatchResult();
+  NT3H1x01_userMemReader<VARIANT_T, NT3H1x01_SPLICE_READER_BLOCKS> reader(tag); // (the data moves by the shift, so every block is needed twice: as the source of a block further on, and as the block being written)
+  const NT3H1x01_memMap memMap = tag.memMap();
+  //// find the record:
+  NT3H1x01_tlv tlv;  NT3H1x01_ndefRecord rec;  bool found = false;
+  if(NT3H1x01_findTLV(reader, reader.size(), NT3H1x01_TLV_NDEF, tlv)) {
+    uint16_t pos = tlv.valueOffset;
+    for(uint8_t i=0; (i<=recordIndex) && NT3H1x01_nextNdefRecord(reader, tlv.valueOffset + tlv.length, pos, rec); i++) { found = (i == recordIndex); }
+  }
+  if(!tag._errGood(reader.err)) { result.blocksRead = reader.blocksRead;  return(reader.err); }
+  if(!found) { NT3H1x01debugPrint("NT3H1x01_spliceNdefPayload() record not found!");  result.blocksRead = reader.blocksRead;  return(NT3H1x01_ERR_RETURN_TYPE_FAIL); }
+  if(((uint32_t)payloadOffset + removeLength) > rec.payloadLength) { NT3H1x01debugPrint("NT3H1x01_spliceNdefPayload() range is outside of the payload!");  result.blocksRead = reader.blocksRead;  return(NT3H1x01_ERR_RETURN_TYPE_FAIL); }
+  //// work out the new layout:
+  _NT3H1x01_ndefSplice<NT3H1x01_userMemReader<VARIANT_T, NT3H1x01_SPLICE_READER_BLOCKS>> splice(reader);
+  splice.splicePos = rec.payloadOffset + payloadOffset;  splice.removeLength = removeLength;  splice.insert = data;  splice.insertLength = insertLength;
+  int32_t delta = (int32_t)insertLength - removeLength;
+  splice.recordPos = rec.recordOffset;  splice.payloadLengthPos = rec.recordOffset + 2;
+  splice.payloadLengthBytes = (rec.header & NT3H1x01_NDEF_SR_bits) ? 1 : 4;
+  splice.newPayloadLength = (uint32_t)rec.payloadLength + delta;
+  splice.recordGrows = (splice.payloadLengthBytes == 1) && (splice.newPayloadLength > 0xFF);
+  splice.tlvLengthPos = tlv.tlvOffset + 1;  splice.tlvLengthBytes = tlv.valueOffset - splice.tlvLengthPos;
+  uint32_t newTlvLength = (uint32_t)tlv.length + delta + splice._dR();
+  splice.tlvGrows = (splice.tlvLengthBytes == 1) && (newTlvLength >= NT3H1x01_TLV_LONG_LENGTH);
+  splice.newTlvLength = newTlvLength;
+  int16_t shift = delta + splice._dT() + splice._dR();
+  uint16_t firstPos = splice.splicePos; // first byte that (may) change
+  uint16_t lastPos = splice.splicePos + insertLength; // (exclusive)
+  if(shift != 0) {
+    firstPos = splice.tlvLengthPos; // (the length fields change too)
+    uint16_t listEnd = tlv.valueOffset + tlv.length;  NT3H1x01_tlv otherTLV; // the rest of the TLV list moves along
+    while(NT3H1x01_nextTLV(reader, reader.size(), listEnd, otherTLV)) {}
+    if((listEnd < reader.size()) && (reader[listEnd] == NT3H1x01_TLV_TERMINATOR)) { listEnd++; }
+    splice.oldEnd = listEnd;
+    if(((int32_t)listEnd + shift) > reader.size()) { NT3H1x01debugPrint("NT3H1x01_spliceNdefPayload() the result does not fit in the user memory!");  result.blocksRead = reader.blocksRead;  return(NT3H1x01_ERR_RETURN_TYPE_FAIL); }
+    splice.newEnd = listEnd + shift;
+    lastPos = (shift > 0) ? splice.newEnd : (((splice.newEnd + NT3H1x01_BLOCK_SIZE - 1) / NT3H1x01_BLOCK_SIZE) * NT3H1x01_BLOCK_SIZE); // (when it shrinks, the rest of the new last block is cleared)
+    if(lastPos > reader.size()) { lastPos = reader.size(); }
+    result.lastBlock = memMap.userStart + ((tlv.valueOffset + splice._dT() + newTlvLength - 1) / NT3H1x01_BLOCK_SIZE); // (the last byte of the NDEF TLV, like findNdefEnd())
+  } else {
+    splice.oldEnd = reader.size();  splice.newEnd = splice.oldEnd; // (nothing moves, so the end doesn't matter)
+  }
+  if(!tag._errGood(reader.err)) { result.blocksRead = reader.blocksRead;  return(reader.err); }
+  const uint8_t firstBlock = firstPos / NT3H1x01_BLOCK_SIZE,  lastBlock = (lastPos > firstPos) ? ((lastPos - 1) / NT3H1x01_BLOCK_SIZE) : firstBlock;
+  if((lastPos > firstPos) && tag.isLocked(memMap.userStart + firstBlock, memMap.userStart + lastBlock)) { // (before writing anything, a move that stops halfway leaves a broken message)
+    NT3H1x01debugPrint("NT3H1x01_spliceNdefPayload() (part of) the area is locked!");  result.blocksRead = reader.blocksRead;  return(NT3H1x01_ERR_RETURN_TYPE_FAIL);
+  }
+  result.shift = shift;
+  //// write the blocks that change (back to front when the data moves up, front to back when it moves down, so nothing is overwritten before it's moved):
+  NT3H1x01_ERR_RETURN_TYPE err = NT3H1x01_ERR_RETURN_TYPE_OK;
+  if(lastPos > firstPos) {
+    for(uint8_t n=0; n<=(lastBlock - firstBlock); n++) {
+      uint8_t block = (shift > 0) ? (lastBlock - n) : (firstBlock + n);
+      uint8_t blockAddress = memMap.userStart + block;
+      uint8_t newBlock[NT3H1x01_BLOCK_SIZE];  bool changed = false;
+      for(uint8_t i=0; i<memMap.userBytesInBlock(blockAddress); i++) {
+        uint16_t pos = ((uint16_t)block * NT3H1x01_BLOCK_SIZE) + i;
+        newBlock[i] = ((pos >= firstPos) && (pos < lastPos)) ? splice.at(pos) : reader[pos];
+        changed |= (newBlock[i] != reader[pos]);
+      }
+      for(uint8_t i=memMap.userBytesInBlock(blockAddress); i<NT3H1x01_BLOCK_SIZE; i++) { newBlock[i] = 0; } // (not written, see writeUserBlock())
+      if(!tag._errGood(reader.err)) { err = reader.err;  break; }
+      if(!changed) { continue; }
+      err = tag._writeUserBlockFrom(blockAddress, newBlock); // (LAST_NDEF_BLOCK is updated once, at the end)
+      if(!tag._errGood(err)) { NT3H1x01debugPrint("NT3H1x01_spliceNdefPayload() write error!");  break; }
+      result.blocksWritten++;
+    }
+  }
+  result.blocksRead = reader.blocksRead;
+  return((result.blocksWritten > 0) ? tag._autoLastNdefBlock(err) : err); // (see autoLastNdefBlock)
+}
+
+/**
+ * overwrite a range of bytes in the payload of an NDEF record on the tag (the length stays the same, see NT3H1x01_spliceNdefPayload() for changing it).
+ * Only the blocks with bytes that actually change are written (e.g. a 4 digit counter in a URL is 1 block write, or 2 if it straddles a block boundary).
+ * @param tag the tag
+ * @param recordIndex which record of the NDEF message (0 for the first)
+ * @param payloadOffset where in the payload to start overwriting
+ * @param data the new bytes
+ * @param length length of data
+ * @param result (reference) what it did
+ * @return (bool or esp_err_t or i2c_status_e, see on defines at top) whether it was successful (fails if the record isn't there, or the range is outside of the payload)
+ */
+template<NT3H1x01_VARIANT_ENUM VARIANT_T>
+NT3H1x01_ERR_RETURN_TYPE NT3H1x01_patchNdefPayload(NT3H1x01<VARIANT_T>& tag, uint8_t recordIndex, uint16_t payloadOffset, const uint8_t data[], uint16_t length, NT3H1x01_ndefPatchResult& result) {
+  return(NT3H1x01_spliceNdefPayload(tag, recordIndex, payloadOffset, length, data, length, result)); } // (just a macro)
+
+#endif // NT3H1x01_thijs_ndef_h
@@ -0,0 +1,318 @@
+/*
+
+(optional) mass-provisioning for the NT3H1x01_thijs library: program a prepared image (see NT3H1x01_thijs_image.h) onto tag after tag, as fast as the bus allows.
+Meant for programming stations/fixtures with several sockets (slots) on one I2C bus (different I2C addresses, or a mux), each holding a tag.
+
+Every EEPROM block write keeps the tag busy for ~4ms (EEPROM_WR_BUSY), during which that tag stretches the clock (or NACKs) on any memory access.
+So instead of programming one tag at a time, the provisioner goes round-robin over the slots, and every step on a slot ends right after a write:
+ while tag N is busy programming that block, the bus is used for the other slots, and the CPU work (per-tag fields) is done for the next tag.
+Each tag goes through these stages (one or more steps each):
+ IDENTIFY: one block 0 read (probe()): UID, variant check
+ PREPARE:  (CPU only) copy the image and let the personalize function fill in per-tag fields (e.g. a URL with the UID or a serial number in it)
+ PROGRAM:  read each block, and write it only if it differs (same rules as NT3H1x01_programImage(): the UID, lock bytes and REG_LOCK are never written)
+ VERIFY:   read back only the blocks that were written, and compare the CRC to that of what was written
+A load function (yours) is called whenever a slot is free, to put the next tag in it (and to see the result of the previous one).
+
+The provisioner is not thread-safe (like the rest of the library): use one per I2C bus, and run them in parallel (one thread each) to use more buses/cores.
+With simulated tags (see _NT3H1x01_thijs_sim.h) that have the timing model on, their virtual clocks are kept in sync, as if they were all on the one bus,
+ so the stats show what the real bus time would be (including EEPROM busy stalls).
+
+NOTE: each slot keeps a copy of the image blocks (about 2kB for the 2k variant), so this is meant for a host PC (or a big microcontroller).
+
+*/
+
+#ifndef NT3H1x01_thijs_provision_h
+#define NT3H1x01_thijs_provision_h
+
+#include "NT3H1x01_thijs.h"
+#include "NT3H1x01_thijs_image.h"
+#include "_NT3H1x01_thijs_stats.h" // (for NT3H1x01_latencyHist, regardless of NT3H1x01_stats)
+
+#ifndef NT3H1x01_PROVISION_MAX_SLOTS
+  #define NT3H1x01_PROVISION_MAX_SLOTS 8 // max number of slots (tags programmed at the same time) per provisioner
+#endif
+#define NT3H1x01_PROVISION_MAX_BLOCKS (NT3H1201_CONF_REGS_MEMA + 1) // blocks in an image of the 2k variant (the biggest)
+
+enum NT3H1x01_PROVISION_STAGE_ENUM : uint8_t {
+  NT3H1x01_PROVISION_IDENTIFY = 0,
+  NT3H1x01_PROVISION_PREPARE  = 1,
+  NT3H1x01_PROVISION_PROGRAM  = 2,
+  NT3H1x01_PROVISION_VERIFY   = 3,
+  NT3H1x01_PROVISION_DONE     = 4, // (not a stage, the tag is finished)
+  NT3H1x01_PROVISION_IDLE     = 5  // (not a stage, the slot has no tag)
+};
+#define NT3H1x01_PROVISION_STAGE_COUNT 4
+static const char* const NT3H1x01_PROVISION_STAGE_NAMES[NT3H1x01_PROVISION_STAGE_COUNT] = {"IDENTIFY", "PREPARE", "PROGRAM", "VERIFY"};
+
+/**
+ * the state (and, once done, the result) of the tag in one slot
+ */
+struct NT3H1x01_provisionTag
+{
+  uint32_t serial = 0;          // sequence number of the tag (0, 1, 2, ... in the order they were loaded, across all slots)
+  uint8_t UID[7];
+  NT3H1x01_PROVISION_STAGE_ENUM stage = NT3H1x01_PROVISION_IDLE; // where it is (or where it failed)
+  bool success = false;         // (once done) programmed and verified
+  uint8_t blocksWritten = 0;
+  uint32_t stageMicros[NT3H1x01_PROVISION_STAGE_COUNT] = {0}; // how long each stage took (including the time other slots had the bus)
+  uint32_t totalMicros = 0;
+  //// (private) working state:
+  uint8_t _nextBlock = 0;       // the next block to check (PROGRAM stage)
+  uint32_t _stageStart = 0, _tagStart = 0;
+  uint8_t _writtenBits[(NT3H1x01_PROVISION_MAX_BLOCKS + 7) / 8]; // which blocks were written (to verify only those)
+  uint8_t _blocks[NT3H1x01_PROVISION_MAX_BLOCKS * NT3H1x01_BLOCK_SIZE]; // the image for this tag (personalized), becomes what should be on the tag during PROGRAM
+
+  bool _written(uint8_t blockAddress) const { return(_writtenBits[blockAddress / 8] & (1 << (blockAddress % 8))); }
+};
+
+/**
+ * called whenever a slot is free, to put the next tag in it
+ * @param slot the slot index (in the order they were added with addSlot())
+ * @param tag the tag object of the slot
+ * @param finished the tag that just left the slot (NULL the first time)
+ * @param context as passed to begin()
+ * @return true if there is a new tag in the slot, false to leave it empty (once all slots are empty, run() returns)
+ */
+typedef bool (*NT3H1x01_provisionLoadFunc)(uint8_t slot, NT3H1x01_thijs& tag, const NT3H1x01_provisionTag* finished, void* context);
+/**
+ * called (in the PREPARE stage) to fill in the per-tag fields, e.g. a URL with the UID in it
+ * @param blocks the image blocks for this tag (block N at blocks[N * NT3H1x01_BLOCK_SIZE]), change them as needed (only the user memory and the CC/conf registers end up on the tag)
+ * @param tagState the tag (UID and serial are known by now)
+ * @param context as passed to begin()
+ * @return false if this tag can't be personalized (it fails, and is not written to)
+ */
+typedef bool (*NT3H1x01_personalizeFunc)(uint8_t blocks[], const NT3H1x01_provisionTag& tagState, void* context);
+
+/**
+ * running totals of a provisioner (or several, see merge())
+ */
+struct NT3H1x01_provisionStats
+{
+  uint32_t tagsDone = 0;      // tags that were programmed and verified
+  uint32_t tagsFailed = 0;
+  uint32_t blocksWritten = 0;
+  uint32_t elapsedMicros = 0; // from the start of run() until the last tag finished
+  NT3H1x01_latencyHist stages[NT3H1x01_PROVISION_STAGE_COUNT]; // per stage (indexed by NT3H1x01_PROVISION_STAGE_ENUM)
+  NT3H1x01_latencyHist perTag; // whole tag, from loading to done
+
+  /**
+   * throughput
+   * @return finished tags (successful or not) per minute
+   */
+  uint32_t tagsPerMinute() const { return(elapsedMicros ? (uint32_t)(((uint64_t)(tagsDone + tagsFailed) * 60000000) / elapsedMicros) : 0); }
+  /**
+   * add the totals of another provisioner that ran in parallel (elapsed time is the longest of the 2)
+   * @param other the stats of the other one
+   */
+  void merge(const NT3H1x01_provisionStats& other) {
+    tagsDone += other.tagsDone;  tagsFailed += other.tagsFailed;  blocksWritten += other.blocksWritten;
+    if(other.elapsedMicros > elapsedMicros) { elapsedMicros = other.elapsedMicros; }
+    for(uint8_t i=0; i<NT3H1x01_PROVISION_STAGE_COUNT; i++) { stages[i].merge(other.stages[i]); }
+    perTag.merge(other.perTag);
+  }
+};
+
+/**
+ * programs an image onto a stream of tags, in several slots at once (see top of file)
+ */
+class NT3H1x01_provisioner
+{
+  public:
+  NT3H1x01_provisionStats stats;
+  NT3H1x01_imageInfo image;
+  NT3H1x01_thijs* tags[NT3H1x01_PROVISION_MAX_SLOTS];
+  NT3H1x01_provisionTag slots[NT3H1x01_PROVISION_MAX_SLOTS];
+  uint8_t slotCount = 0;
+  uint32_t nextSerial = 0; // serial number for the next tag that is loaded
+  #ifdef NT3H1x01_useSimulator
+    uint64_t simBusMicros = 0; // (simulator only) the shared bus clock, see top of file
+  #endif
+
+  private:
+  NT3H1x01_provisionLoadFunc _load = NULL;
+  NT3H1x01_personalizeFunc _personalize = NULL;
+  void* _context = NULL;
+  uint32_t _startMicros = 0;
+  uint8_t _activeSlot = 0; // the slot being stepped
+
+  public:
+  /**
+   * add a slot (before run())
+   * @param tag the tag object for the slot (initialized, e.g. with init(), but there doesn't need to be a tag in it yet)
+   * @return false if there are already NT3H1x01_PROVISION_MAX_SLOTS slots
+   */
+  bool addSlot(NT3H1x01_thijs& tag) {
+    if(slotCount >= NT3H1x01_PROVISION_MAX_SLOTS) { NT3H1x01debugPrint("NT3H1x01_provisioner addSlot() too many slots!"); return(false); }
+    tags[slotCount] = &tag;  slots[slotCount] = NT3H1x01_provisionTag();  slotCount++;
+    return(true);
+  }
+
+  /**
+   * set the image and the callbacks
+   * @param imageData the whole image (e.g. from NT3H1x01_mapImageFile()), must stay valid while running (it's not copied)
+   * @param imageSize size of the image in bytes
+   * @param load function that puts the next tag in a slot (see NT3H1x01_provisionLoadFunc)
+   * @param personalize (optional) function that fills in per-tag fields (see NT3H1x01_personalizeFunc)
+   * @param context (optional) passed to the callbacks as-is
+   * @return false if the image is invalid
+   */
+  bool begin(const uint8_t imageData[], size_t imageSize, NT3H1x01_provisionLoadFunc load, NT3H1x01_personalizeFunc personalize=NULL, void* context=NULL) {
+    _load = load;  _personalize = personalize;  _context = context;
+    return(NT3H1x01_parseImage(imageData, imageSize, image));
+  }
+
+  /**
+   * provision tags until the load function stops supplying them
+   * @return the stats (also in .stats)
+   */
+  const NT3H1x01_provisionStats& run() {
+    _startMicros = _now();
+    for(uint8_t i=0; i<slotCount; i++) { _activeSlot = i;  _simSyncBefore(i);  _loadNext(i, NULL); }
+    while(step()) {}
+    return(stats);
+  }
+
+  /**
+   * do one round: one step on every slot that has a tag (use this instead of run() to do something else in between)
+   * @return false if all slots are empty
+   */
+  bool step() {
+    bool anyActive = false;
+    for(uint8_t i=0; i<slotCount; i++) {
+      if(slots[i].stage == NT3H1x01_PROVISION_IDLE) { continue; }
+      anyActive = true;
+      _activeSlot = i;
+      _simSyncBefore(i);
+      _stepSlot(i);
+      _simSyncAfter(i);
+    }
+    return(anyActive);
+  }
+
+  /**
+   * (private) time source for the stats
+   */
+  uint32_t _now() {
+    #ifdef NT3H1x01_useSimulator
+      NT3H1x01_simTag* sim = (_activeSlot < slotCount) ? tags[_activeSlot]->_simTag : NULL;
+      if(sim && sim->timingModel) { return((uint32_t)((sim->virtualMicros > simBusMicros) ? sim->virtualMicros : simBusMicros)); } // (the slot being stepped may be ahead of the bus clock)
+    #endif
+    return(NT3H1x01_MICROS());
+  }
+  #ifdef NT3H1x01_useSimulator
+    void _simSyncBefore(uint8_t i) { NT3H1x01_simTag* sim = tags[i]->_simTag;  if(sim && sim->timingModel && (sim->virtualMicros < simBusMicros)) { sim->advanceTime(simBusMicros - sim->virtualMicros); } }
+    void _simSyncAfter(uint8_t i) { NT3H1x01_simTag* sim = tags[i]->_simTag;  if(sim && sim->timingModel && (sim->virtualMicros > simBusMicros)) { simBusMicros = sim->virtualMicros; } }
+  #else
+    void _simSyncBefore(uint8_t i) {}
+    void _simSyncAfter(uint8_t i) {}
+  #endif
+
+  /**
+   * (private) ask the load function for the next tag in a slot
+   * @param i slot index
+   * @param finished the tag that just finished (NULL at the start)
+   */
+  void _loadNext(uint8_t i, const NT3H1x01_provisionTag* finished) {
+    if(!_load || !_load(i, *tags[i], finished, _context)) { slots[i].stage = NT3H1x01_PROVISION_IDLE; return; }
+    NT3H1x01_provisionTag& slot = slots[i];
+    slot.serial = nextSerial++;  slot.success = false;  slot.blocksWritten = 0;  slot._nextBlock = 0;  slot.totalMicros = 0;
+    for(uint8_t j=0; j<NT3H1x01_PROVISION_STAGE_COUNT; j++) { slot.stageMicros[j] = 0; }
+    for(uint8_t j=0; j<sizeof(slot._writtenBits); j++) { slot._writtenBits[j] = 0; }
+    slot._tagStart = slot._stageStart = _now();
+    slot.stage = NT3H1x01_PROVISION_IDENTIFY;
+  }
+
+  /**
+   * (private) move a slot on to the next stage (or finish it), and time the stage it was in
+   * @param i slot index
+   * @param success whether the current stage went well (if not, the tag is done)
+   */
+  void _endStage(uint8_t i, bool success) {
+    NT3H1x01_provisionTag& slot = slots[i];
+    uint32_t now = _now();
+    slot.stageMicros[slot.stage] = now - slot._stageStart;  stats.stages[slot.stage].add(slot.stageMicros[slot.stage]);
+    slot._stageStart = now;
+    if(success && (slot.stage != NT3H1x01_PROVISION_VERIFY)) { slot.stage = (NT3H1x01_PROVISION_STAGE_ENUM)(slot.stage + 1);  return; }
+    //// the tag is done:
+    slot.success = success;  slot.totalMicros = now - slot._tagStart;  stats.perTag.add(slot.totalMicros);
+    if(success) { stats.tagsDone++;  slot.stage = NT3H1x01_PROVISION_DONE; } else { stats.tagsFailed++; } // (a failed tag keeps the stage it failed in)
+    stats.blocksWritten += slot.blocksWritten;
+    stats.elapsedMicros = now - _startMicros;
+    tags[i]->_oneBlockBuffAddress = NT3H1x01_INVALID_MEMA; // (the cached block may have been overwritten)
+    NT3H1x01_provisionTag finished = slot; // (copy, the load function might reuse the slot right away)
+    _loadNext(i, &finished);
+  }
+
+  /**
+   * (private) do one step of the tag in a slot. Steps that write end right after the write, so the EEPROM programming overlaps with other slots
+   * @param i slot index
+   */
+  void _stepSlot(uint8_t i) {
+    NT3H1x01_thijs& tag = *tags[i];
+    NT3H1x01_provisionTag& slot = slots[i];
+    const NT3H1x01_memMap memMap = NT3H1x01_getMemMap(image.is2kVariant);
+    switch(slot.stage) {
+      case NT3H1x01_PROVISION_IDENTIFY: {
+        NT3H1x01_deviceInfo info;
+        tag.is2kVariant = image.is2kVariant; // (so probe() checks the tag is the same variant as the image)
+        bool success = tag.probe(info, false); // (leaves block 0 in tag._oneBlockBuff)
+        for(uint8_t j=0; j<7; j++) { slot.UID[j] = info.UID[j]; }
+        _endStage(i, success);
+        break; }
+      case NT3H1x01_PROVISION_PREPARE: {
+        for(uint16_t j=0; j<(image.blockCount * NT3H1x01_BLOCK_SIZE); j++) { slot._blocks[j] = image.blocks[j]; }
+        _endStage(i, _personalize ? _personalize(slot._blocks, slot, _context) : true);
+        break; }
+      case NT3H1x01_PROVISION_PROGRAM: {
+        uint8_t current[NT3H1x01_BLOCK_SIZE];
+        for(; slot._nextBlock<image.blockCount; slot._nextBlock++) {
+          uint8_t blockAddress = slot._nextBlock;
+          if(!memMap.isValidBlock(blockAddress)) { continue; }
+          if(blockAddress == NT3H1x01_SERIAL_NR_MEMA) { for(uint8_t j=0; j<NT3H1x01_BLOCK_SIZE; j++) { current[j] = tag._oneBlockBuff[j]; } } // (read by probe() already)
+          else if(!tag._errGood(tag.requestMemBlock(blockAddress, current))) { NT3H1x01debugPrint("NT3H1x01_provisioner read error!"); _endStage(i, false); return; }
+          uint8_t* target = &slot._blocks[blockAddress * NT3H1x01_BLOCK_SIZE];
+          uint8_t merged[NT3H1x01_BLOCK_SIZE];
+          for(uint8_t j=0; j<NT3H1x01_BLOCK_SIZE; j++) { merged[j] = current[j]; }
+          _NT3H1x01_imageTargetBlock(memMap, blockAddress, target, merged); // (merged becomes what it should be)
+          bool differs = false;
+          for(uint8_t j=0; j<NT3H1x01_BLOCK_SIZE; j++) { differs |= (merged[j] != current[j]);  target[j] = merged[j]; } // (the target is now what should read back)
+          if(!differs) { continue; }
+          for(uint8_t j=0; j<NT3H1x01_BLOCK_SIZE; j++) { current[j] = merged[j]; }
+          if(blockAddress == NT3H1x01_I2C_ADDR_CHANGE_MEMA) { current[NT3H1x01_I2C_ADDR_CHANGE_MEMA_BYTE] = (tag.slaveAddress<<1); } // I2C address byte reads as manufacturer ID (and must not be changed)
+          if(!tag._errGood(tag.writeMemBlock(blockAddress, current))) { NT3H1x01debugPrint("NT3H1x01_provisioner write error!"); _endStage(i, false); return; }
+          slot._writtenBits[blockAddress / 8] |= (1 << (blockAddress % 8));  slot.blocksWritten++;
+          slot._nextBlock++;
+          return; // let the other slots have the bus while this one is programming its EEPROM
+        }
+        _endStage(i, true);
+        break; }
+      case NT3H1x01_PROVISION_VERIFY: {
+        uint32_t targetCRC = 0, readCRC = 0;
+        uint8_t current[NT3H1x01_BLOCK_SIZE];
+        bool success = true;
+        for(uint8_t blockAddress=0; (blockAddress<image.blockCount) && success; blockAddress++) {
+          if(!slot._written(blockAddress)) { continue; } // (the rest was just read, and already matched)
+          success = tag._errGood(tag.requestMemBlock(blockAddress, current));
+          targetCRC = NT3H1x01_crc32(&slot._blocks[blockAddress * NT3H1x01_BLOCK_SIZE], NT3H1x01_BLOCK_SIZE, targetCRC);
+          readCRC = NT3H1x01_crc32(current, NT3H1x01_BLOCK_SIZE, readCRC);
+        }
+        if(success && (readCRC != targetCRC)) { NT3H1x01debugPrint("NT3H1x01_provisioner verify failed!"); success = false; }
+        _endStage(i, success);
+        break; }
+      default: break;
+    }
+  }
+};
+
+/**
+ * write a UID as (uppercase) hex, e.g. for a URL
+ * @param UID the 7 UID bytes
+ * @param output where to put the 14 characters (and a terminating 0), so at least 15 bytes
+ */
+inline void NT3H1x01_UIDtoHex(const uint8_t UID[7], char output[]) {
+  const char hexChars[] = "0123456789ABCDEF";
+  for(uint8_t i=0; i<7; i++) { output[i*2] = hexChars[UID[i] >> 4];  output[i*2+1] = hexChars[UID[i] & 0x0F]; }
+  output[14] = 0;
+}
+
+#endif // NT3H1x01_thijs_provision_h
@@ -0,0 +1,200 @@
+/*
+
+(optional) streaming for the NT3H1x01_thijs library: move up to ~2kB of data between a file (or anything else) and the user memory, one block at a time.
+This is the 'arbitrary file writing function' from the TODO list: the data can come from/go to
+ - an Arduino Stream: an SD card File, an ESP32 filesystem (SPIFFS/LittleFS/FFat) File, Serial, etc.
+ - a POSIX file descriptor (on a Linux/macOS host, e.g. with the simulated tag)
+ - anything else, through a read/write function of your own
+Only 1 block of data is ever held in RAM, no matter how big the file is.
+Writing to the tag ends by setting LAST_NDEF_BLOCK to the last block that holds data (so the RF side knows how much to read, see FD_OFF_LAST_NDEF_READ),
+ reading from the tag stops at LAST_NDEF_BLOCK (if it's set).
+
+Each EEPROM block write keeps the tag busy for ~4ms. The next block is fetched from the source right after a block was written, so the SD card/flash latency
+ is hidden behind the EEPROM programming time (instead of adding to it). With the worker (see NT3H1x01_thijs_worker.h), the I2C transfers themselves run
+ in the background as well: NT3H1x01_worker::streamToTag() and streamFromTag() keep 2 blocks in flight (double-buffered), one on the bus and one in the file.
+
+e.g.:
+  File file = SD.open("/tag.ndef");
+  NT3H1x01_streamResult result;
+  NT3H1x01_streamToTag(nfc, file, result);
+
+*/
+
+#ifndef NT3H1x01_thijs_stream_h
+#define NT3H1x01_thijs_stream_h
+
+#include "NT3H1x01_thijs.h"
+
+#if !defined(ARDUINO) && (defined(__unix__) || defined(__APPLE__))
+  #include <unistd.h>
+  #include <errno.h>
+  #define NT3H1x01_STREAM_POSIX // the file descriptor versions are available
+#endif
+
+/**
+ * where the data comes from (e.g. a file)
+ * @param buff where to put the data
+ * @param length how many bytes are wanted
+ * @param context as passed to the stream function
+ * @return how many bytes were read (less than length only at the end of the data)
+ */
+typedef size_t (*NT3H1x01_streamReadFunc)(uint8_t buff[], size_t length, void* context);
+/**
+ * where the data goes (e.g. a file)
+ * @param data the data
+ * @param length number of bytes
+ * @param context as passed to the stream function
+ * @return how many bytes were written (less than length is an error)
+ */
+typedef size_t (*NT3H1x01_streamWriteFunc)(const uint8_t data[], size_t length, void* context);
+
+/**
+ * what a stream function did
+ */
+struct NT3H1x01_streamResult
+{
+  uint16_t bytes = 0;        // data bytes moved
+  uint8_t blocks = 0;        // blocks written to/read from the tag
+  uint8_t lastBlock = 0;     // the last block that holds data (what LAST_NDEF_BLOCK was set to, 0 if there was no data)
+  bool truncated = false;    // (to the tag only) the source had more data than fits in the user memory
+};
+
+#if defined(ARDUINO)
+  inline size_t _NT3H1x01_streamReadArduino(uint8_t buff[], size_t length, void* context) { return(((Stream*)context)->readBytes(buff, length)); } // (just a macro)
+  inline size_t _NT3H1x01_streamWriteArduino(const uint8_t data[], size_t length, void* context) { return(((Stream*)context)->write(data, length)); } // (just a macro)
+#endif
+#ifdef NT3H1x01_STREAM_POSIX
+  inline size_t _NT3H1x01_streamReadFd(uint8_t buff[], size_t length, void* context) {
+    int fd = (int)(intptr_t)context;  size_t total = 0;
+    while(total < length) { // (read() may return less than asked, e.g. for pipes)
+      ssize_t got = read(fd, &buff[total], length - total);
+      if(got > 0) { total += got; } else if((got < 0) && (errno == EINTR)) { continue; } else { break; } // (0 is the end of the file)
+    }
+    return(total);
+  }
+  inline size_t _NT3H1x01_streamWriteFd(const uint8_t data[], size_t length, void* context) {
+    int fd = (int)(intptr_t)context;  size_t total = 0;
+    while(total < length) {
+      ssize_t written = write(fd, &data[total], length - total);
+      if(written > 0) { total += written; } else if((written < 0) && (errno == EINTR)) { continue; } else { break; }
+    }
+    return(total);
+  }
+#endif
+
+/**
+ * (private) set LAST_NDEF_BLOCK (only writes the registers that differ)
+ * @param tag the tag
+ * @param lastBlock the block address (0 disables it)
+ * @param persistent whether to set it in the Configuration registers too (an EEPROM write, but it survives a reset), or only in the Session registers
+ * @return (bool or esp_err_t or i2c_status_e, see on defines at top) whether it wrote/read successfully
+ */
+template<NT3H1x01_VARIANT_ENUM VARIANT_T>
+NT3H1x01_ERR_RETURN_TYPE _NT3H1x01_setLastNdefBlock(NT3H1x01<VARIANT_T>& tag, uint8_t lastBlock, bool persistent) {
+  NT3H1x01_desiredConfig desired;
+  if(persistent) { desired.setBoth(NT3H1x01_COMN_REGS_LAST_NDEF_BLOCK_BYTE, lastBlock); }
+  else { desired.set<NT3H1x01_Sess_LAST_NDEF_BLOCK>(lastBlock); }
+  return(tag.applyConfiguration(desired));
+}
+
+/**
+ * write data from a source into the user memory (block by block), then set LAST_NDEF_BLOCK to the last block that holds data.
+ * The rest of the last block is filled with 0's.
+ * A locked block (see NT3H1x01::isLocked(), only if the lock bits are known) stops it before anything is written to that block (the blocks before it ARE written, LAST_NDEF_BLOCK is not).
+ * @param tag the tag
+ * @param read function that supplies the data (see NT3H1x01_streamReadFunc)
+ * @param context passed to the read function as-is
+ * @param result (reference) what it did
+ * @param startBlock (optional) MEMory Address (MEMA) of the first block to write, 0 for the start of the user memory
+ * @param persistent (optional) whether LAST_NDEF_BLOCK is set in the Configuration registers too (see _NT3H1x01_setLastNdefBlock())
+ * @return (bool or esp_err_t or i2c_status_e, see on defines at top) whether it was successful (data that doesn't fit is a failure, but the part that fits IS written)
+ */
+template<NT3H1x01_VARIANT_ENUM VARIANT_T>
+NT3H1x01_ERR_RETURN_TYPE NT3H1x01_streamToTag(NT3H1x01<VARIANT_T>& tag, NT3H1x01_streamReadFunc read, void* context, NT3H1x01_streamResult& result, uint8_t startBlock=0, bool persistent=true) {
+  result = NT3H1x01_streamResult();
+  const NT3H1x01_memMap memMap = tag.memMap();
+  if(startBlock == 0) { startBlock = memMap.userStart; }
+  if(!memMap.isUserBlock(startBlock)) { NT3H1x01debugPrint("NT3H1x01_streamToTag() start address is not user memory!"); return(NT3H1x01_ERR_RETURN_TYPE_FAIL); }
+  uint8_t buff[NT3H1x01_BLOCK_SIZE];
+  NT3H1x01_ERR_RETURN_TYPE err = NT3H1x01_ERR_RETURN_TYPE_OK;
+  for(uint8_t blockAddress=startBlock; memMap.isUserBlock(blockAddress); blockAddress++) {
+    if(tag.isLocked(blockAddress)) { NT3H1x01debugPrint("NT3H1x01_streamToTag() block is locked!"); err = NT3H1x01_ERR_RETURN_TYPE_FAIL;  break; } // (before taking data from the source for it)
+    uint8_t bytesInBlock = memMap.userBytesInBlock(blockAddress);
+    size_t got = read(buff, bytesInBlock, context); // (right after the previous block was written, so this overlaps with the EEPROM programming time)
+    if(got == 0) { break; }
+    for(uint8_t i=got; i<NT3H1x01_BLOCK_SIZE; i++) { buff[i] = 0; }
+    err = tag._writeUserBlockFrom(blockAddress, buff); // (checks the locks too, and the last block of the 1k variant is shared with the lock bytes)
+    if(!tag._errGood(err)) { NT3H1x01debugPrint("NT3H1x01_streamToTag() write error!"); break; }
+    result.bytes += got;  result.blocks++;  result.lastBlock = blockAddress;
+    if(got < bytesInBlock) { break; } // (the end of the data)
+    if(!memMap.isUserBlock(blockAddress+1)) { // the user memory is full, check if there's more
+      uint8_t extra;
+      result.truncated = (read(&extra, 1, context) != 0);
+    }
+  }
+  tag._oneBlockBuffAddress = NT3H1x01_INVALID_MEMA; // (the cached block may have been overwritten)
+  if(!tag._errGood(err)) { return(err); } // (a write error or a locked block, LAST_NDEF_BLOCK is left as it was)
+  err = _NT3H1x01_setLastNdefBlock(tag, result.lastBlock, persistent);
+  if(result.truncated) { NT3H1x01debugPrint("NT3H1x01_streamToTag() the data does not fit in the user memory!"); return(NT3H1x01_ERR_RETURN_TYPE_FAIL); }
+  return(err);
+}
+
+/**
+ * read the user memory (block by block) and pass it to a sink, up to LAST_NDEF_BLOCK
+ * @param tag the tag
+ * @param write function that takes the data (see NT3H1x01_streamWriteFunc)
+ * @param context passed to the write function as-is
+ * @param result (reference) what it did
+ * @param startBlock (optional) MEMory Address (MEMA) of the first block to read, 0 for the start of the user memory
+ * @param lastBlock (optional) MEMory Address (MEMA) of the last block to read, 0 to use LAST_NDEF_BLOCK (from the Session registers, or the whole user memory if that's not set)
+ * @return (bool or esp_err_t or i2c_status_e, see on defines at top) whether it was successful (a sink that doesn't take all the data is a failure)
+ */
+template<NT3H1x01_VARIANT_ENUM VARIANT_T>
+NT3H1x01_ERR_RETURN_TYPE NT3H1x01_streamFromTag(NT3H1x01<VARIANT_T>& tag, NT3H1x01_streamWriteFunc write, void* context, NT3H1x01_streamResult& result, uint8_t startBlock=0, uint8_t lastBlock=0) {
+  result = NT3H1x01_streamResult();
+  const NT3H1x01_memMap memMap = tag.memMap();
+  if(startBlock == 0) { startBlock = memMap.userStart; }
+  NT3H1x01_ERR_RETURN_TYPE err = NT3H1x01_ERR_RETURN_TYPE_OK;
+  if(lastBlock == 0) {
+    err = tag.getSess_LAST_NDEF_BLOCK(lastBlock);
+    if(!tag._errGood(err)) { NT3H1x01debugPrint("NT3H1x01_streamFromTag() read error!"); return(err); }
+    if(!memMap.isUserBlock(lastBlock)) { lastBlock = memMap.userEnd; } // (not set)
+  }
+  if(!memMap.isUserBlock(startBlock) || !memMap.isUserBlock(lastBlock)) { NT3H1x01debugPrint("NT3H1x01_streamFromTag() address is not user memory!"); return(NT3H1x01_ERR_RETURN_TYPE_FAIL); }
+  uint8_t buff[NT3H1x01_BLOCK_SIZE];
+  for(uint16_t blockAddress=startBlock; blockAddress<=lastBlock; blockAddress++) {
+    err = tag.requestMemBlock(blockAddress, buff);
+    if(!tag._errGood(err)) { NT3H1x01debugPrint("NT3H1x01_streamFromTag() read error!"); return(err); }
+    uint8_t bytesInBlock = memMap.userBytesInBlock(blockAddress);
+    if(write(buff, bytesInBlock, context) != bytesInBlock) { NT3H1x01debugPrint("NT3H1x01_streamFromTag() sink did not take the data!"); return(NT3H1x01_ERR_RETURN_TYPE_FAIL); }
+    result.bytes += bytesInBlock;  result.blocks++;  result.lastBlock = blockAddress;
+  }
+  return(err);
+}
+
+#if defined(ARDUINO)
+  /**
+   * write data from an Arduino Stream (e.g. an SD card File) into the user memory. See the other NT3H1x01_streamToTag()
+   */
+  template<NT3H1x01_VARIANT_ENUM VARIANT_T>
+  NT3H1x01_ERR_RETURN_TYPE NT3H1x01_streamToTag(NT3H1x01<VARIANT_T>& tag, Stream& source, NT3H1x01_streamResult& result, uint8_t startBlock=0, bool persistent=true) { return(NT3H1x01_streamToTag(tag, _NT3H1x01_streamReadArduino, &source, result, startBlock, persistent)); } // (just a macro)
+  /**
+   * read the user memory into an Arduino Stream (e.g. an SD card File). See the other NT3H1x01_streamFromTag()
+   */
+  template<NT3H1x01_VARIANT_ENUM VARIANT_T>
+  NT3H1x01_ERR_RETURN_TYPE NT3H1x01_streamFromTag(NT3H1x01<VARIANT_T>& tag, Stream& sink, NT3H1x01_streamResult& result, uint8_t startBlock=0, uint8_t lastBlock=0) { return(NT3H1x01_streamFromTag(tag, _NT3H1x01_streamWriteArduino, &sink, result, startBlock, lastBlock)); } // (just a macro)
+#endif
+#ifdef NT3H1x01_STREAM_POSIX
+  /**
+   * write data from a file descriptor into the user memory. See the other NT3H1x01_streamToTag()
+   */
+  template<NT3H1x01_VARIANT_ENUM VARIANT_T>
+  NT3H1x01_ERR_RETURN_TYPE NT3H1x01_streamToTag(NT3H1x01<VARIANT_T>& tag, int fd, NT3H1x01_streamResult& result, uint8_t startBlock=0, bool persistent=true) { return(NT3H1x01_streamToTag(tag, _NT3H1x01_streamReadFd, (void*)(intptr_t)fd, result, startBlock, persistent)); } // (just a macro)
+  /**
+   * read the user memory into a file descriptor. See the other NT3H1x01_streamFromTag()
+   */
+  template<NT3H1x01_VARIANT_ENUM VARIANT_T>
+  NT3H1x01_ERR_RETURN_TYPE NT3H1x01_streamFromTag(NT3H1x01<VARIANT_T>& tag, int fd, NT3H1x01_streamResult& result, uint8_t startBlock=0, uint8_t lastBlock=0) { return(NT3H1x01_streamFromTag(tag, _NT3H1x01_streamWriteFd, (void*)(intptr_t)fd, result, startBlock, lastBlock)); } // (just a macro)
+#endif
+
+#endif // NT3H1x01_thijs_stream_h
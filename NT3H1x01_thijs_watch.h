@@ -0,0 +1,164 @@
+/*
+
+(optional) change detection for the NT3H1x01_thijs library: find out which blocks of the user memory a phone changed, without reading all of it.
+
+A phone writes an NDEF message into the TLV list at the start of the user memory, everything after the Terminator TLV doesn't matter.
+NT3H1x01_ndefWatcher::sync() walks the TLV list first (which only reads the blocks the TLV headers are in, see NT3H1x01_userMemReader),
+ so it knows where the content ends, and then only reads the blocks up to there (instead of all ~120 blocks of the 2k variant).
+Every block it reads is compared to a CRC-16 it kept from the last sync, and only the blocks that differ are reported (with their contents, no extra reads).
+If the TLV list is malformed (e.g. a phone write was interrupted), it reads up to LAST_NDEF_BLOCK instead (or the whole user memory, if that isn't set).
+The CRCs take 2 bytes per block (see NT3H1x01_WATCH_MAX_BLOCKS), copies of the blocks would take 16.
+
+When to sync (see service()): a phone is done writing when it releases the memory (RF_LOCKED goes low) or leaves (RF_FIELD_PRESENT goes low),
+ service() polls NS_REG for those, or you can pass it an FD pin edge (e.g. with FD_OFF set to NT3H1x01_FD_OFF_FIELD_PRESENCE).
+NOTE: reading NS_REG clears NDEF_DATA_READ, so don't use service() together with something else that waits for that flag (e.g. NT3H1x01_dynamicNdef::service())
+
+e.g.:
+  NT3H1x01_ndefWatcher<NT3H1x01_VARIANT_RUNTIME> watcher(nfc);
+  void blockChanged(uint8_t blockAddress, const uint8_t block[], void* context) { ... }
+  NT3H1x01_watchResult result;
+  watcher.sync(blockChanged, NULL, result); // the first sync reports every block (there is nothing to compare to yet)
+  ...
+  watcher.service(blockChanged, NULL, result); // in loop()
+
+*/
+
+#ifndef NT3H1x01_thijs_watch_h
+#define NT3H1x01_thijs_watch_h
+
+#include "NT3H1x01_thijs.h"
+#include "NT3H1x01_thijs_ndef.h" // (NT3H1x01_nextTLV() and NT3H1x01_userMemReader)
+
+#include <string.h> // memcpy, memset
+
+#ifndef NT3H1x01_WATCH_MAX_BLOCKS
+  #define NT3H1x01_WATCH_MAX_BLOCKS 119 // how many blocks (from the start of the user memory) are watched, 119 is all of them on the 2k variant (56 on the 1k variant)
+#endif
+
+typedef void (*NT3H1x01_watchChangeFunc)(uint8_t blockAddress, const uint8_t block[], void* context); // a block that changed (and its new contents)
+
+/**
+ * CRC-16/CCITT (polynomial 0x1021, starting at 0xFFFF), calculated bit by bit (no table, to save flash/RAM)
+ * @param data the bytes
+ * @param length number of bytes
+ * @return the CRC
+ */
+inline uint16_t NT3H1x01_crc16(const uint8_t data[], size_t length) {
+  uint16_t crc = 0xFFFF;
+  for(size_t i=0; i<length; i++) {
+    crc ^= (uint16_t)data[i] << 8;
+    for(uint8_t j=0; j<8; j++) { crc = (crc << 1) ^ (0x1021 & (0 - (crc >> 15))); }
+  }
+  return(crc);
+}
+
+/**
+ * what a sync did
+ */
+struct NT3H1x01_watchResult
+{
+  uint8_t blocksRead = 0;     // blocks read from the tag (including the ones needed to walk the TLV list)
+  uint8_t blocksChanged = 0;  // blocks that differed from the last sync (the ones that were reported)
+  uint8_t lastBlock = 0;      // the last block that was watched (the end of the TLV list)
+  bool synced = false;        // (service() only) whether it actually synced
+};
+
+/**
+ * keeps a CRC of every block of the NDEF content, to report only the blocks that changed, see top of this file
+ */
+template<NT3H1x01_VARIANT_ENUM VARIANT_T>
+struct NT3H1x01_ndefWatcher
+{
+  NT3H1x01<VARIANT_T>& tag;
+  uint16_t crcs[NT3H1x01_WATCH_MAX_BLOCKS];      // CRC of each block at the last sync (indexed from the start of the user memory)
+  uint8_t known[(NT3H1x01_WATCH_MAX_BLOCKS+7)/8] = {0}; // which entries of crcs[] are valid (bits)
+  bool _wasRFlocked = false;  // (private) RF_LOCKED the last time service() looked
+  bool _wasRFfield = false;   // (private) RF_FIELD_PRESENT the last time service() looked
+  bool _pending = false;      // (private) a sync is due (but RF still had the memory)
+
+  NT3H1x01_ndefWatcher(NT3H1x01<VARIANT_T>& tagToUse) : tag(tagToUse) {}
+
+  /**
+   * forget all CRCs, so the next sync reports every block again
+   */
+  void forget() { memset(known, 0, sizeof(known)); }
+
+  /**
+   * read the NDEF content (up to the end of the TLV list) and report the blocks that changed since the last sync.
+   * afterwards, the memory is handed back to the RF side (I2C_LOCKED is cleared)
+   * @param changed function that gets the blocks that changed (see NT3H1x01_watchChangeFunc), can be NULL
+   * @param context passed to the changed function as-is
+   * @param result (reference) what it did
+   * @return (bool or esp_err_t or i2c_status_e, see on defines at top) whether it read successfully
+   */
+  NT3H1x01_ERR_RETURN_TYPE sync(NT3H1x01_watchChangeFunc changed, void* context, NT3H1x01_watchResult& result) {
+    result = NT3H1x01_watchResult();
+    const NT3H1x01_memMap memMap = tag.memMap();
+    //// find the end of the TLV list (only reads the blocks with TLV headers in them):
+    NT3H1x01_userMemReader<VARIANT_T> reader(tag);
+    uint16_t pos = 0;  NT3H1x01_tlv tlv;
+    while(NT3H1x01_nextTLV(reader, reader.size(), pos, tlv)) {}
+    uint16_t end = reader.size();
+    if(pos < reader.size()) {
+      if(reader[pos] == NT3H1x01_TLV_TERMINATOR) { end = pos + 1; }
+      else { // malformed, fall back to LAST_NDEF_BLOCK (if it's set)
+        uint8_t lastNdefBlock = 0;
+        NT3H1x01_ERR_RETURN_TYPE err = tag.requestSessRegByte(NT3H1x01_COMN_REGS_LAST_NDEF_BLOCK_BYTE, lastNdefBlock);
+        if(!tag._errGood(err)) { NT3H1x01debugPrint("NT3H1x01_ndefWatcher::sync() read error!");  result.blocksRead = reader.blocksRead;  return(err); }
+        if(memMap.isUserBlock(lastNdefBlock)) { end = (lastNdefBlock - memMap.userStart + 1) * NT3H1x01_BLOCK_SIZE; }
+        if(end > reader.size()) { end = reader.size(); }
+      }
+    }
+    result.blocksRead = reader.blocksRead;
+    if(!tag._errGood(reader.err)) { return(reader.err); }
+    uint16_t blockCount = (end + NT3H1x01_BLOCK_SIZE - 1) / NT3H1x01_BLOCK_SIZE;
+    if(blockCount > NT3H1x01_WATCH_MAX_BLOCKS) { blockCount = NT3H1x01_WATCH_MAX_BLOCKS; }
+    result.lastBlock = memMap.userStart + blockCount - 1;
+    //// compare the blocks (the last 2 the reader read are still in its cache):
+    NT3H1x01_ERR_RETURN_TYPE err = NT3H1x01_ERR_RETURN_TYPE_OK;
+    for(uint8_t i=0; i<blockCount; i++) {
+      uint8_t blockAddress = memMap.userStart + i;
+      uint8_t block[NT3H1x01_BLOCK_SIZE];  bool cached = false;
+      for(uint8_t j=0; j<2; j++) { if(reader.blockAddresses[j] == blockAddress) { memcpy(block, reader.blocks[j], NT3H1x01_BLOCK_SIZE);  cached = true; } }
+      if(!cached) {
+        err = tag.requestMemBlock(blockAddress, block);
+        if(!tag._errGood(err)) { NT3H1x01debugPrint("NT3H1x01_ndefWatcher::sync() read error!");  return(err); }
+        result.blocksRead++;
+      }
+      uint16_t crc = NT3H1x01_crc16(block, memMap.userBytesInBlock(blockAddress));
+      if(_isKnown(i) && (crcs[i] == crc)) { continue; }
+      crcs[i] = crc;  known[i/8] |= (1 << (i%8));
+      result.blocksChanged++;
+      if(changed) { changed(blockAddress, block, context); }
+    }
+    for(uint8_t i=blockCount; i<NT3H1x01_WATCH_MAX_BLOCKS; i++) { known[i/8] &= ~(1 << (i%8)); } // (past the end doesn't matter, but it does if the content grows again)
+    return(tag.setNS_I2C_LOCKED(false)); // hand the memory back to the RF side (instead of waiting for the WDT)
+  }
+
+  /**
+   * check NS_REG (1 Session register read) and sync once the RF side is done with the memory (RF_LOCKED or RF_FIELD_PRESENT went low), call this in loop()
+   * @param changed function that gets the blocks that changed (see NT3H1x01_watchChangeFunc), can be NULL
+   * @param context passed to the changed function as-is
+   * @param result (reference) what it did (result.synced says whether it synced at all)
+   * @param FDedge (optional) whether the FD pin changed since the last call (if you watch it with an interrupt), that also triggers a sync
+   * @return (bool or esp_err_t or i2c_status_e, see on defines at top) whether it read successfully
+   */
+  NT3H1x01_ERR_RETURN_TYPE service(NT3H1x01_watchChangeFunc changed, void* context, NT3H1x01_watchResult& result, bool FDedge=false) {
+    result = NT3H1x01_watchResult();
+    uint8_t NS_REG;  NT3H1x01_ERR_RETURN_TYPE err = tag.requestSessRegByte(NT3H1x01_SESS_REGS_NS_REG_BYTE, NS_REG);
+    if(!tag._errGood(err)) { NT3H1x01debugPrint("NT3H1x01_ndefWatcher::service() read error!");  return(err); }
+    bool RFlocked = NS_REG & NT3H1x01_NS_REG_RF_LOCKED_bits;  bool RFfield = NS_REG & NT3H1x01_NS_REG_RF_FIELD_bits;
+    if(FDedge || (_wasRFlocked && !RFlocked) || (_wasRFfield && !RFfield)) { _pending = true; }
+    _wasRFlocked = RFlocked;  _wasRFfield = RFfield;
+    if(!_pending || RFlocked) { return(err); } // (the memory isn't accessible while RF has it)
+    _pending = false;
+    err = sync(changed, context, result);
+    result.synced = true;
+    if(!tag._errGood(err)) { _pending = true; } // (try again next time)
+    return(err);
+  }
+
+  bool _isKnown(uint8_t index) const { return(known[index/8] & (1 << (index%8))); } // (private)
+};
+
+#endif // NT3H1x01_thijs_watch_h
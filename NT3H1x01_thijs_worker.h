@@ -0,0 +1,412 @@
+/*
+
+An (optional) I2C worker for the NT3H1x01_thijs library.
+On the ESP32, every NT3H1x01 call blocks the calling task inside the I2C driver (for up to I2Ctimeout).
+With this worker, a dedicated task (pinned to one core) owns the I2C bus, and the application just queues requests.
+The application can then either:
+- pass a callback, which gets called (from the worker task!) once the request is done
+- keep the request object around and check isDone() / call wait() on it later (a bit like a std::future)
+
+The same code runs on a host PC (with std::thread instead of a FreeRTOS task), which is nice for benchmarking against the simulated tag (see _NT3H1x01_thijs_sim.h).
+Each request records when it was queued/started/finished (in microseconds), so you can measure latency and throughput under contention.
+
+NOTE: while the worker is running, it owns the NT3H1x01_thijs object. Don't call functions on that object directly from other tasks/threads,
+ use a NT3H1x01_WORKER_JOB request if you want to run a higher-level function (like setConf_WDT()) on the worker.
+NOTE: request objects are owned by the caller, and must stay valid (not go out of scope) until they are done!
+NOTE: if a request has a callback, the callback IS the completion signal: the worker doesn't touch the request after calling it,
+ so the callback may reuse/free the request (but that also means isDone() and wait() should not be used on requests with a callback).
+NOTE: a request submitted from the worker itself (from a job or callback) is executed right away, inside submit(),
+ because queueing it would make wait() wait for the worker, which is busy waiting (a deadlock).
+
+*/
+
+#ifndef NT3H1x01_thijs_worker_h
+#define NT3H1x01_thijs_worker_h
+
+#include "NT3H1x01_thijs.h"
+#include "NT3H1x01_thijs_stream.h" // (for streamToTag() and streamFromTag())
+
+#if defined(ARDUINO_ARCH_ESP32)
+  #include "freertos/FreeRTOS.h"
+  #include "freertos/task.h"
+  #include "freertos/queue.h"
+  #define NT3H1x01_WORKER_MICROS()  ((uint32_t)micros())
+#elif !defined(ARDUINO) // host PC
+  #include <thread>
+  #include <mutex>
+  #include <condition_variable>
+  #include <deque>
+  #include <chrono>
+  #define NT3H1x01_WORKER_MICROS()  ((uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count())
+#else
+  #error("NT3H1x01_thijs_worker.h is only available on the ESP32 (FreeRTOS) and on a host PC (std::thread)")
+#endif
+
+
+enum NT3H1x01_WORKER_REQ_ENUM : uint8_t { // what a request should do
+  NT3H1x01_WORKER_READ_BLOCK  = 0, // requestMemBlock()
+  NT3H1x01_WORKER_WRITE_BLOCK = 1, // writeMemBlock()
+  NT3H1x01_WORKER_READ_SESS   = 2, // requestSessRegByte()
+  NT3H1x01_WORKER_WRITE_SESS  = 3, // writeSessRegByte()
+  NT3H1x01_WORKER_JOB         = 4  // run a user function on the worker (for higher-level functions)
+};
+
+struct NT3H1x01_workerRequest; // (forward declaration for the function pointer types)
+typedef void (*NT3H1x01_workerCallback)(NT3H1x01_workerRequest& request); // called (from the worker) once a request is done
+typedef NT3H1x01_ERR_RETURN_TYPE (*NT3H1x01_workerJob)(NT3H1x01_thijs& tag, NT3H1x01_workerRequest& request); // a function to run on the worker (NT3H1x01_WORKER_JOB)
+
+/**
+ * a single request to the worker. Fill it in with one of the prepare functions (or manually), then submit() it.
+ */
+struct NT3H1x01_workerRequest
+{
+  NT3H1x01_WORKER_REQ_ENUM type;
+  uint8_t blockAddress = 0; // MEMA of the block (for _BLOCK requests)
+  NT3H1x01_CONF_SESS_REGS_ENUM registerIndex = NT3H1x01_COMN_REGS_NC_REG_BYTE; // REGA (for _SESS requests)
+  uint8_t mask = 0xFF; // (for NT3H1x01_WORKER_WRITE_SESS)
+  uint8_t bytesToWrite = NT3H1x01_BLOCK_SIZE; // (for NT3H1x01_WORKER_WRITE_BLOCK)
+  uint8_t buff[NT3H1x01_BLOCK_SIZE]; // data to write, or the data that was read (session register byte is buff[0])
+  NT3H1x01_workerJob job = NULL; // (for NT3H1x01_WORKER_JOB)
+  NT3H1x01_workerCallback callback = NULL; // (optional) called from the worker once done (instead of setting 'done')
+  void* userArg = NULL; // (optional) anything the job might need
+  void* callbackArg = NULL; // (optional) anything the callback might need
+  //// results:
+  NT3H1x01_ERR_RETURN_TYPE err = NT3H1x01_ERR_RETURN_TYPE_OK;
+  volatile bool done = false;
+  uint32_t queuedAt = 0;   // microseconds, when it was submitted
+  uint32_t startedAt = 0;  // microseconds, when the worker started on it
+  uint32_t finishedAt = 0; // microseconds, when the worker finished it
+  #if defined(ARDUINO_ARCH_ESP32)
+    TaskHandle_t _waitingTask = NULL; // (private) the task that submitted it (gets notified once done)
+  #endif
+
+  void prepareReadBlock(uint8_t blockAddressToRead) { type = NT3H1x01_WORKER_READ_BLOCK; blockAddress = blockAddressToRead; }
+  void prepareWriteBlock(uint8_t blockAddressToWrite, const uint8_t writeBuff[], uint8_t bytesToWriteInBlock=NT3H1x01_BLOCK_SIZE) {
+    type = NT3H1x01_WORKER_WRITE_BLOCK; blockAddress = blockAddressToWrite; bytesToWrite = bytesToWriteInBlock;
+    for(uint8_t i=0; i<bytesToWrite; i++) { buff[i] = writeBuff[i]; } }
+  void prepareReadSess(NT3H1x01_CONF_SESS_REGS_ENUM registerIndexToRead) { type = NT3H1x01_WORKER_READ_SESS; registerIndex = registerIndexToRead; }
+  void prepareWriteSess(NT3H1x01_CONF_SESS_REGS_ENUM registerIndexToWrite, uint8_t regDat, uint8_t regMask=0xFF) {
+    type = NT3H1x01_WORKER_WRITE_SESS; registerIndex = registerIndexToWrite; buff[0] = regDat; mask = regMask; }
+  void prepareJob(NT3H1x01_workerJob jobToRun, void* jobArg=NULL) { type = NT3H1x01_WORKER_JOB; job = jobToRun; userArg = jobArg; }
+
+  bool isDone() const { return(done); }
+  uint32_t latency() const { return(finishedAt - queuedAt); } // total time between submit() and completion (in microseconds)
+  uint32_t busTime() const { return(finishedAt - startedAt); } // time the worker spent on it (in microseconds)
+};
+
+
+/**
+ * A worker task/thread which owns the I2C bus (and the NT3H1x01_thijs object)
+ */
+class NT3H1x01_worker
+{
+  public:
+  NT3H1x01_thijs& tag; // the tag this worker talks to (should be initialized (init()) before start())
+  uint32_t requestsDone = 0; // total number of requests handled
+
+  NT3H1x01_worker(NT3H1x01_thijs& tagToUse) : tag(tagToUse) {}
+
+  /**
+   * (private) actually execute a request (on the worker)
+   * @param request the request to execute
+   */
+  void _execute(NT3H1x01_workerRequest& request) {
+    request.startedAt = NT3H1x01_WORKER_MICROS();
+    switch(request.type) {
+      case NT3H1x01_WORKER_READ_BLOCK:  request.err = tag.requestMemBlock(request.blockAddress, request.buff); break;
+      case NT3H1x01_WORKER_WRITE_BLOCK: request.err = tag.writeMemBlock(request.blockAddress, request.buff, request.bytesToWrite); break;
+      case NT3H1x01_WORKER_READ_SESS:   request.err = tag.requestSessRegByte(request.registerIndex, request.buff[0]); break;
+      case NT3H1x01_WORKER_WRITE_SESS:  request.err = tag.writeSessRegByte(request.registerIndex, request.buff[0], request.mask); break;
+      case NT3H1x01_WORKER_JOB:
+        if(request.job == NULL) { NT3H1x01debugPrint("NT3H1x01_worker job request without job!"); request.err = NT3H1x01_ERR_RETURN_TYPE_FAIL; break; }
+        request.err = request.job(tag, request); break;
+      default: NT3H1x01debugPrint("NT3H1x01_worker unknown request type!"); request.err = NT3H1x01_ERR_RETURN_TYPE_FAIL; break;
+    }
+    request.finishedAt = NT3H1x01_WORKER_MICROS();
+    requestsDone++;
+  }
+
+  #if defined(ARDUINO_ARCH_ESP32)
+
+    QueueHandle_t _queue = NULL;
+    TaskHandle_t _task = NULL;
+
+    /**
+     * start the worker task
+     * @param core which core to pin the worker task to (the Arduino loop() runs on core 1, so core 0 is the default)
+     * @param priority FreeRTOS priority of the worker task
+     * @param queueLength how many requests can be waiting at the same time
+     * @param stackSize stack size of the worker task (in bytes), callbacks and jobs run on this stack!
+     * @return true if the queue and task were created
+     */
+    bool start(BaseType_t core=0, UBaseType_t priority=2, UBaseType_t queueLength=16, uint32_t stackSize=4096) {
+      if(_task != NULL) { NT3H1x01debugPrint("NT3H1x01_worker already started!"); return(false); }
+      _queue = xQueueCreate(queueLength, sizeof(NT3H1x01_workerRequest*));
+      if(_queue == NULL) { NT3H1x01debugPrint("NT3H1x01_worker queue creation failed!"); return(false); }
+      if(xTaskCreatePinnedToCore(_taskFunc, "NT3H1x01_worker", stackSize, this, priority, &_task, core) != pdPASS) {
+        NT3H1x01debugPrint("NT3H1x01_worker task creation failed!"); vQueueDelete(_queue); _queue = NULL; _task = NULL; return(false); }
+      return(true);
+    }
+
+    /**
+     * stop the worker task (requests still in the queue are NOT executed)
+     */
+    void stop() {
+      if(_task != NULL) { vTaskDelete(_task); _task = NULL; }
+      if(_queue != NULL) { vQueueDelete(_queue); _queue = NULL; }
+    }
+
+    /**
+     * put a request in the queue
+     * @param request the request (must stay valid until it's done!)
+     * @param ticksToWait how long to wait if the queue is full
+     * @return true if the request was queued
+     */
+    bool submit(NT3H1x01_workerRequest& request, TickType_t ticksToWait=portMAX_DELAY) {
+      request.done = false;  request._waitingTask = xTaskGetCurrentTaskHandle();
+      request.queuedAt = NT3H1x01_WORKER_MICROS();
+      if((_task != NULL) && (request._waitingTask == _task)) { // submitted from the worker itself, run it right away (see NOTE at top)
+        request._waitingTask = NULL;
+        _execute(request);
+        if(request.callback != NULL) { request.callback(request); } else { request.done = true; }
+        return(true);
+      }
+      NT3H1x01_workerRequest* requestPtr = &request;
+      return(xQueueSend(_queue, &requestPtr, ticksToWait) == pdTRUE);
+    }
+
+    /**
+     * block (the calling task, not the worker) until a request is done
+     * @param request the request (which must have been submitted by the calling task)
+     * @return the result of the request
+     */
+    NT3H1x01_ERR_RETURN_TYPE wait(NT3H1x01_workerRequest& request) {
+      while(!request.done) { ulTaskNotifyTake(pdTRUE, portMAX_DELAY); } // (the worker notifies the submitting task once the request is done)
+      return(request.err);
+    }
+
+    static void _taskFunc(void* workerPtr) {
+      NT3H1x01_worker& worker = *((NT3H1x01_worker*) workerPtr);
+      NT3H1x01_workerRequest* requestPtr;
+      while(true) {
+        if(xQueueReceive(worker._queue, &requestPtr, portMAX_DELAY) != pdTRUE) { continue; }
+        worker._execute(*requestPtr);
+        TaskHandle_t waitingTask = requestPtr->_waitingTask; // (copy first, the request may go out of scope as soon as 'done' is set)
+        NT3H1x01_workerCallback callback = requestPtr->callback;
+        if(callback != NULL) { callback(*requestPtr); } // (the callback may resume/free whoever owns the request, so it's the last thing to touch it)
+        else { requestPtr->done = true; }
+        if(waitingTask != NULL) { xTaskNotifyGive(waitingTask); }
+      }
+    }
+
+  #else // host PC
+
+    std::thread _thread;
+    std::mutex _mutex;
+    std::condition_variable _queueCond; // signals new requests (or stop)
+    std::condition_variable _doneCond;  // signals finished requests
+    std::deque<NT3H1x01_workerRequest*> _queue;
+    bool _running = false;
+    std::thread::id _threadId; // (private) the worker thread (set by the thread itself, guarded by _mutex)
+
+    ~NT3H1x01_worker() { stop(); }
+
+    /**
+     * start the worker thread
+     * @return true if the thread was started
+     */
+    bool start() {
+      std::lock_guard<std::mutex> lock(_mutex);
+      if(_running) { NT3H1x01debugPrint("NT3H1x01_worker already started!"); return(false); }
+      _running = true;
+      _thread = std::thread(&NT3H1x01_worker::_threadFunc, this);
+      return(true);
+    }
+
+    /**
+     * stop the worker thread (after it finished all the requests that are still in the queue)
+     */
+    void stop() {
+      { std::lock_guard<std::mutex> lock(_mutex);  _running = false; }
+      _queueCond.notify_all();
+      if(_thread.joinable()) { _thread.join(); }
+    }
+
+    /**
+     * put a request in the queue
+     * @param request the request (must stay valid until it's done!)
+     * @return true if the request was queued
+     */
+    bool submit(NT3H1x01_workerRequest& request) {
+      request.done = false;
+      request.queuedAt = NT3H1x01_WORKER_MICROS();
+      bool fromWorker;
+      { std::lock_guard<std::mutex> lock(_mutex);
+        if(!_running) { NT3H1x01debugPrint("NT3H1x01_worker not running!"); return(false); }
+        fromWorker = (std::this_thread::get_id() == _threadId);
+        if(!fromWorker) { _queue.push_back(&request); } }
+      if(fromWorker) { // submitted from the worker itself, run it right away (see NOTE at top)
+        _execute(request);
+        if(request.callback != NULL) { request.callback(request); }
+        else { std::lock_guard<std::mutex> lock(_mutex);  request.done = true; }
+        _doneCond.notify_all();
+        return(true);
+      }
+      _queueCond.notify_one();
+      return(true);
+    }
+
+    /**
+     * block (the calling thread, not the worker) until a request is done
+     * @param request the request
+     * @return the result of the request
+     */
+    NT3H1x01_ERR_RETURN_TYPE wait(NT3H1x01_workerRequest& request) {
+      std::unique_lock<std::mutex> lock(_mutex);
+      _doneCond.wait(lock, [&request]{ return(request.done); });
+      return(request.err);
+    }
+
+    void _threadFunc() {
+      { std::lock_guard<std::mutex> lock(_mutex);  _threadId = std::this_thread::get_id(); }
+      while(true) {
+        NT3H1x01_workerRequest* requestPtr;
+        { std::unique_lock<std::mutex> lock(_mutex);
+          _queueCond.wait(lock, [this]{ return(!_queue.empty() || !_running); });
+          if(_queue.empty()) { return; } // (only if !_running)
+          requestPtr = _queue.front();  _queue.pop_front(); }
+        _execute(*requestPtr);
+        NT3H1x01_workerCallback callback = requestPtr->callback;
+        if(callback != NULL) { callback(*requestPtr); } // (the callback may resume/free whoever owns the request, so it's the last thing to touch it)
+        else { std::lock_guard<std::mutex> lock(_mutex);  requestPtr->done = true; }
+        _doneCond.notify_all();
+      }
+    }
+
+  #endif
+
+  /**
+   * submit a request and wait for it to be done (only really useful for testing, as this blocks the caller just like a direct call would)
+   * @param request the request
+   * @return the result of the request
+   */
+  NT3H1x01_ERR_RETURN_TYPE submitAndWait(NT3H1x01_workerRequest& request) {
+    if(!submit(request)) { return(NT3H1x01_ERR_RETURN_TYPE_FAIL); }
+    return(wait(request));
+  }
+
+  struct _streamTagState { NT3H1x01_memMap memMap; NT3H1x01_lockBits locks; bool locksKnown; }; // (private) what the stream functions need to know about the tag, copied on the worker (the tag is the worker's while it runs)
+  static NT3H1x01_ERR_RETURN_TYPE _streamTagStateJob(NT3H1x01_thijs& tag, NT3H1x01_workerRequest& request) {
+    _streamTagState& state = *((_streamTagState*)request.userArg);
+    state.memMap = tag.memMap();  state.locks = tag.lockCache;  state.locksKnown = tag.lockCacheValid;
+    return(NT3H1x01_ERR_RETURN_TYPE_OK);
+  }
+  static NT3H1x01_ERR_RETURN_TYPE _streamWriteJob(NT3H1x01_thijs& tag, NT3H1x01_workerRequest& request) { return(tag._writeUserBlockFrom(request.blockAddress, request.buff)); } // (just a macro) (LAST_NDEF_BLOCK is set at the end, see _NT3H1x01_setLastNdefBlock())
+  static NT3H1x01_ERR_RETURN_TYPE _streamLastBlockJob(NT3H1x01_thijs& tag, NT3H1x01_workerRequest& request) {
+    tag._oneBlockBuffAddress = NT3H1x01_INVALID_MEMA; // (the cached block may have been overwritten)
+    const bool persistent = *((const bool*)request.userArg);
+    return(_NT3H1x01_setLastNdefBlock(tag, request.blockAddress, persistent));
+  }
+
+  /**
+   * write data from a source into the user memory, then set LAST_NDEF_BLOCK (like NT3H1x01_streamToTag(), see NT3H1x01_thijs_stream.h), double-buffered:
+   *  while the worker writes one block to the tag, the next one is read from the source (by the calling task/thread). RAM use is 2 requests (blocks).
+   * A locked block stops it, like for NT3H1x01_streamToTag() (the lock bits are copied from the tag on the worker, at the start).
+   * NOTE: blocks the caller until it's done (called from the worker itself, e.g. from a job, the requests run inline, so it works, but without the double-buffering)
+   * @param read function that supplies the data (see NT3H1x01_streamReadFunc), called from the calling task/thread
+   * @param context passed to the read function as-is
+   * @param result (reference) what it did
+   * @param startBlock (optional) MEMory Address (MEMA) of the first block to write, 0 for the start of the user memory
+   * @param persistent (optional) whether LAST_NDEF_BLOCK is set in the Configuration registers too (see _NT3H1x01_setLastNdefBlock())
+   * @return (bool or esp_err_t or i2c_status_e, see on defines at top) whether it was successful (data that doesn't fit is a failure, but the part that fits IS written)
+   */
+  NT3H1x01_ERR_RETURN_TYPE streamToTag(NT3H1x01_streamReadFunc read, void* context, NT3H1x01_streamResult& result, uint8_t startBlock=0, bool persistent=true) {
+    result = NT3H1x01_streamResult();
+    NT3H1x01_workerRequest requests[2]; // the 2 buffers: one being written to the tag (by the worker), one being filled from the source
+    _streamTagState state;  requests[0].prepareJob(_streamTagStateJob, &state);
+    NT3H1x01_ERR_RETURN_TYPE err = submitAndWait(requests[0]);
+    if(!tag._errGood(err)) { return(err); }
+    const NT3H1x01_memMap& memMap = state.memMap;
+    if(startBlock == 0) { startBlock = memMap.userStart; }
+    if(!memMap.isUserBlock(startBlock)) { NT3H1x01debugPrint("NT3H1x01_worker streamToTag() start address is not user memory!"); return(NT3H1x01_ERR_RETURN_TYPE_FAIL); }
+    bool inFlight[2] = {false, false};  uint8_t current = 0;
+    for(uint8_t blockAddress=startBlock; memMap.isUserBlock(blockAddress); blockAddress++) {
+      NT3H1x01_workerRequest& request = requests[current];
+      if(state.locksKnown && state.locks.intersects(NT3H1x01_lockBitsForArea(memMap, blockAddress, blockAddress, true))) { // (like isLocked(), before taking data from the source for it. The job checks it again, in case the locks changed since)
+        NT3H1x01debugPrint("NT3H1x01_worker streamToTag() block is locked!"); err = NT3H1x01_ERR_RETURN_TYPE_FAIL;  break; }
+      uint8_t bytesInBlock = memMap.userBytesInBlock(blockAddress);
+      size_t got = read(request.buff, bytesInBlock, context); // (while the worker writes the other buffer)
+      if(got == 0) { break; }
+      for(uint8_t i=got; i<NT3H1x01_BLOCK_SIZE; i++) { request.buff[i] = 0; }
+      request.prepareJob(_streamWriteJob);  request.blockAddress = blockAddress;
+      if(!submit(request)) { err = NT3H1x01_ERR_RETURN_TYPE_FAIL;  break; }
+      inFlight[current] = true;
+      result.bytes += got;  result.blocks++;  result.lastBlock = blockAddress;
+      current ^= 1;
+      if(inFlight[current]) { inFlight[current] = false;  err = wait(requests[current]);  if(!tag._errGood(err)) { break; } } // (the older write has to be done before its buffer is reused)
+      if(got < bytesInBlock) { break; } // (the end of the data)
+      if(!memMap.isUserBlock(blockAddress+1)) { uint8_t extra;  result.truncated = (read(&extra, 1, context) != 0); } // the user memory is full, check if there's more
+    }
+    for(uint8_t i=0; i<2; i++) { if(inFlight[i]) { NT3H1x01_ERR_RETURN_TYPE lastErr = wait(requests[i]);  if(tag._errGood(err)) { err = lastErr; } } }
+    if(!tag._errGood(err)) { NT3H1x01debugPrint("NT3H1x01_worker streamToTag() write error!"); return(err); }
+    requests[0].prepareJob(_streamLastBlockJob, &persistent);  requests[0].blockAddress = result.lastBlock;
+    err = submitAndWait(requests[0]);
+    if(result.truncated) { NT3H1x01debugPrint("NT3H1x01_worker streamToTag() the data does not fit in the user memory!"); return(NT3H1x01_ERR_RETURN_TYPE_FAIL); }
+    return(err);
+  }
+
+  /**
+   * read the user memory and pass it to a sink, up to LAST_NDEF_BLOCK (like NT3H1x01_streamFromTag(), see NT3H1x01_thijs_stream.h), double-buffered:
+   *  while the sink takes one block (e.g. writing it to an SD card), the worker reads the next one from the tag. RAM use is 2 requests (blocks).
+   * NOTE: blocks the caller until it's done (called from the worker itself, e.g. from a job, the requests run inline, so it works, but without the double-buffering)
+   * @param write function that takes the data (see NT3H1x01_streamWriteFunc), called from the calling task/thread
+   * @param context passed to the write function as-is
+   * @param result (reference) what it did
+   * @param startBlock (optional) MEMory Address (MEMA) of the first block to read, 0 for the start of the user memory
+   * @param lastBlock (optional) MEMory Address (MEMA) of the last block to read, 0 to use LAST_NDEF_BLOCK (from the Session registers, or the whole user memory if that's not set)
+   * @return (bool or esp_err_t or i2c_status_e, see on defines at top) whether it was successful (a sink that doesn't take all the data is a failure)
+   */
+  NT3H1x01_ERR_RETURN_TYPE streamFromTag(NT3H1x01_streamWriteFunc write, void* context, NT3H1x01_streamResult& result, uint8_t startBlock=0, uint8_t lastBlock=0) {
+    result = NT3H1x01_streamResult();
+    NT3H1x01_workerRequest requests[2]; // the 2 buffers: one being read from the tag (by the worker), one being passed to the sink
+    _streamTagState state;  requests[0].prepareJob(_streamTagStateJob, &state);
+    NT3H1x01_ERR_RETURN_TYPE err = submitAndWait(requests[0]);
+    if(!tag._errGood(err)) { return(err); }
+    const NT3H1x01_memMap& memMap = state.memMap;
+    if(startBlock == 0) { startBlock = memMap.userStart; }
+    if(lastBlock == 0) {
+      requests[0].prepareReadSess(NT3H1x01_COMN_REGS_LAST_NDEF_BLOCK_BYTE);
+      err = submitAndWait(requests[0]);
+      if(!tag._errGood(err)) { NT3H1x01debugPrint("NT3H1x01_worker streamFromTag() read error!"); return(err); }
+      lastBlock = memMap.isUserBlock(requests[0].buff[0]) ? requests[0].buff[0] : memMap.userEnd; // (the whole user memory if it's not set)
+    }
+    if(!memMap.isUserBlock(startBlock) || !memMap.isUserBlock(lastBlock)) { NT3H1x01debugPrint("NT3H1x01_worker streamFromTag() address is not user memory!"); return(NT3H1x01_ERR_RETURN_TYPE_FAIL); }
+    bool inFlight[2] = {false, false};
+    uint16_t nextToRead = startBlock;
+    for(uint8_t i=0; (i<2) && (nextToRead<=lastBlock); i++) {
+      requests[i].prepareReadBlock(nextToRead++);
+      if(!submit(requests[i])) { err = NT3H1x01_ERR_RETURN_TYPE_FAIL;  break; }
+      inFlight[i] = true;
+    }
+    uint8_t current = 0;
+    for(uint16_t blockAddress=startBlock; (blockAddress<=lastBlock) && tag._errGood(err); blockAddress++) {
+      NT3H1x01_workerRequest& request = requests[current];
+      if(!inFlight[current]) { break; } // (submit() failed)
+      inFlight[current] = false;  err = wait(request);
+      if(!tag._errGood(err)) { NT3H1x01debugPrint("NT3H1x01_worker streamFromTag() read error!"); break; }
+      uint8_t bytesInBlock = memMap.userBytesInBlock(blockAddress);
+      if(write(request.buff, bytesInBlock, context) != bytesInBlock) { NT3H1x01debugPrint("NT3H1x01_worker streamFromTag() sink did not take the data!"); err = NT3H1x01_ERR_RETURN_TYPE_FAIL;  break; } // (while the worker reads the other buffer)
+      result.bytes += bytesInBlock;  result.blocks++;  result.lastBlock = blockAddress;
+      if(nextToRead <= lastBlock) {
+        request.prepareReadBlock(nextToRead++);
+        if(!submit(request)) { err = NT3H1x01_ERR_RETURN_TYPE_FAIL;  break; }
+        inFlight[current] = true;
+      }
+      current ^= 1;
+    }
+    for(uint8_t i=0; i<2; i++) { if(inFlight[i]) { wait(requests[i]); } } // (the requests must be done before they go out of scope)
+    return(err);
+  }
+};
+
+#endif // NT3H1x01_thijs_worker_h
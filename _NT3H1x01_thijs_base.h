@@ -2,12 +2,16 @@
 #ifndef _NT3H1x01_thijs_base_h
 #define _NT3H1x01_thijs_base_h
 
-#include "Arduino.h" // always import Arduino.h
+#if !defined(NT3H1x01_useSimulator) || defined(ARDUINO) // (the simulator can also run on a host PC, where there is no Arduino.h)
+  #include "Arduino.h" // always import Arduino.h
+#endif
 
 #include "NT3H1x01_thijs.h" // (i feel like this constitutes a cicular dependency, but the compiler doesn't seem to mind)
 
 
-#ifndef NT3H1x01_useWireLib // (note: ifNdef!) if this has been defined by the user, then don't do all this manual stuff
+#ifdef NT3H1x01_useSimulator // if this has been defined by the user, talk to a simulated tag (in RAM) instead of real hardware. Takes precedence over everything else
+  #include "_NT3H1x01_thijs_sim.h"
+#elif !defined(NT3H1x01_useWireLib) // (note: ifNdef!) if this has been defined by the user, then don't do all this manual stuff
   #if defined(__AVR_ATmega328P__) || defined(__AVR_ATmega328__) // TODO: test 328p processor defines! (also, this code may be functional on other AVR hw as well?)
     // nothing to import, all ATMega328P registers are imported by default
   #elif defined(ARDUINO_ARCH_ESP32)
@@ -47,7 +51,7 @@ otherwise, just a boolean, indicating general faillure should be enough, especia
   #define NT3H1x01_ERR_RETURN_TYPE_default  bool
   #define NT3H1x01_ERR_RETURN_TYPE_default_OK  true
   #define NT3H1x01_ERR_RETURN_TYPE_default_FAIL false
-  #ifdef NT3H1x01_useWireLib
+  #if defined(NT3H1x01_useWireLib) || defined(NT3H1x01_useSimulator)
     #define NT3H1x01_ERR_RETURN_TYPE  NT3H1x01_ERR_RETURN_TYPE_default
     #define NT3H1x01_ERR_RETURN_TYPE_OK  NT3H1x01_ERR_RETURN_TYPE_default_OK
     #define NT3H1x01_ERR_RETURN_TYPE_FAIL  NT3H1x01_ERR_RETURN_TYPE_default_FAIL
@@ -101,6 +105,26 @@ i2c_cmd_handle_t handle = i2c_cmd_link_create_static(buffer, sizeof(buffer));
 */
 
 
+//// write sources (see writeMemBlockFrom()), to write constant data to the tag without copying it into RAM first
+#if defined(__AVR__) // on AVR, flash is a separate address space (PROGMEM data can't just be dereferenced)
+  #include <avr/pgmspace.h>
+  #define NT3H1x01_READ_PROGMEM_BYTE(address)  pgm_read_byte(address)
+#else // on most other platforms flash is memory-mapped (PROGMEM is just const)
+  #define NT3H1x01_READ_PROGMEM_BYTE(address)  (*(const uint8_t*)(address))
+  #ifndef PROGMEM
+    #define PROGMEM // (e.g. on a host PC)
+  #endif
+#endif
+/**
+ * a write source that reads bytes straight from PROGMEM (flash), so constant payloads (NDEF messages, default configurations) never have to be copied into RAM
+ */
+struct NT3H1x01_progmemSource
+{
+  const uint8_t* address; // (in PROGMEM)
+  uint8_t operator[](uint8_t index) const { return(NT3H1x01_READ_PROGMEM_BYTE(address + index)); }
+  NT3H1x01_progmemSource operator+(uint16_t offset) const { return(NT3H1x01_progmemSource{address + offset}); } // (so it can be stepped through block by block, like a pointer)
+};
+
 /**
  * (this is only the base class, users should use NT3H1x01_thijs)
  * 
@@ -110,11 +134,88 @@ class _NT3H1x01_thijs_base
   public:
   //// I2C constants:
   uint8_t slaveAddress; // 7-bit address
-  const bool is2kVariant;
+  bool is2kVariant; // (not const, probe() can detect it)
   
   _NT3H1x01_thijs_base(bool is2kVariant, uint8_t address=NT3H1x01_DEFAULT_I2C_ADDRESS) : is2kVariant(is2kVariant), slaveAddress(address) {}
   
-  #ifdef NT3H1x01_useWireLib // higher level generalized (arduino wire library):
+  #ifdef NT3H1x01_useSimulator // simulated tag (no actual I2C), see _NT3H1x01_thijs_sim.h
+
+    public:
+
+    NT3H1x01_simTag* _simTag = NULL; // the simulated tag this object talks to (like a bus, multiple objects can share one)
+
+    /**
+     * initialize the simulated I2C bus
+     * @param simTagToUse the simulated tag to talk to
+     */
+    void init(NT3H1x01_simTag& simTagToUse) { _simTag = &simTagToUse; }
+
+    /**
+     * request a block of memory (NOTE: Session register data must be requested using requestSessRegByte() function)
+     * @param blockAddress MEMory Address (MEMA) of the block
+     * @param readBuff a NT3H1x01_BLOCK_SIZE buffer to store the read values in
+     * @return whether it wrote/read successfully
+     */
+    bool requestMemBlock(uint8_t blockAddress, uint8_t readBuff[]) {
+      if(!_simTag->i2cWrite(slaveAddress, &blockAddress, 1)) { NT3H1x01debugPrint("requestMemBlock() simulated write NACK!"); return(false); }
+      return(_onlyReadBytes(readBuff, NT3H1x01_BLOCK_SIZE));
+    }
+
+    /**
+     * request a Session register byte (must be done using this special command) 
+     * @param registerIndex Register Address (REGA) of the register byte (0~7) (uint8_t)
+     * @param readBuff a uint8_t pointer to store the read value in
+     * @return whether it wrote/read successfully
+     */
+    bool requestSessRegByte(NT3H1x01_CONF_SESS_REGS_ENUM registerIndex, uint8_t& readBuff) {
+      uint8_t requestArr[2] = {NT3H1x01_SESS_REGS_MEMA, registerIndex};
+      if(!_simTag->i2cWrite(slaveAddress, requestArr, 2)) { NT3H1x01debugPrint("requestSessRegByte() simulated write NACK!"); return(false); }
+      return(_onlyReadBytes(&readBuff, 1));
+    }
+  
+    /**
+     * (private) read bytes into a buffer (without first writing)
+     * @param readBuff a buffer to store the read values in
+     * @param bytesToRead how many bytes to read
+     * @return whether it read successfully
+     */
+    bool _onlyReadBytes(uint8_t readBuff[], uint8_t bytesToRead) {
+      uint8_t bytesReceived = _simTag->i2cRead(slaveAddress, readBuff, bytesToRead);
+      if(bytesReceived == 0) { NT3H1x01debugPrint("_onlyReadBytes() simulated read NACK!"); return(false); }
+      if(bytesReceived != bytesToRead) { NT3H1x01debugPrint("_onlyReadBytes() received insufficient data"); return(false); }
+      return(true);
+    }
+    
+    /**
+     * write a block worth of bytes from a source to a memory address (note: Session register data must be written using writeSessRegByte() function)
+     * @tparam SOURCE_T type of the source, see writeMemBlock() and writeMemBlock_P() (at the bottom of this class)
+     * @param blockAddress MEMory Address (MEMA) of the block
+     * @param writeBuff where to get the bytes from: a (const) buffer, or anything else with an operator[] (e.g. NT3H1x01_progmemSource)
+     * @param bytesToWrite how many bytes of actual data to write, the remainder (to complete the NT3H1x01_BLOCK_SIZE block) will be 0's
+     * @return whether it wrote successfully
+     */
+    template<typename SOURCE_T>
+    bool writeMemBlockFrom(uint8_t blockAddress, SOURCE_T writeBuff, uint8_t bytesToWrite=NT3H1x01_BLOCK_SIZE) {
+      if(bytesToWrite > NT3H1x01_BLOCK_SIZE) {/* PANIC */  NT3H1x01debugPrint("writeMemBlock() can only write in blocks of 16 bytes, not more!"); return(false); }
+      uint8_t copiedArray[NT3H1x01_BLOCK_SIZE+1]; copiedArray[0]=blockAddress; for(uint8_t i=0;i<NT3H1x01_BLOCK_SIZE;i++) { copiedArray[i+1]=(i<bytesToWrite) ? writeBuff[i] : 0; }
+      if(!_simTag->i2cWrite(slaveAddress, copiedArray, NT3H1x01_BLOCK_SIZE+1)) { NT3H1x01debugPrint("writeMemBlock() simulated write NACK!"); return(false); }
+      return(true);
+    }
+
+    /**
+     * update a Session register byte (must be done using this special command) 
+     * @param registerIndex Register Address (REGA) of the register byte (0~7) (uint8_t)
+     * @param regDat the byte to write to the register
+     * @param mask the bits of the register that regDat should affect
+     * @return whether it wrote successfully
+     */
+    bool writeSessRegByte(NT3H1x01_CONF_SESS_REGS_ENUM registerIndex, uint8_t regDat, uint8_t mask=0xFF) {
+      uint8_t regWriteArr[4] = {NT3H1x01_SESS_REGS_MEMA, registerIndex, mask, regDat};
+      if(!_simTag->i2cWrite(slaveAddress, regWriteArr, 4)) { NT3H1x01debugPrint("writeSessRegByte() simulated write NACK!"); return(false); }
+      return(true);
+    }
+
+  #elif defined(NT3H1x01_useWireLib) // higher level generalized (arduino wire library):
 
     public:
 
@@ -173,17 +274,19 @@ class _NT3H1x01_thijs_base
     }
     
     /**
-     * write a block worth of bytes from a buffer to a memory address (note: Session register data must be written using writeSessRegByte() function)
+     * write a block worth of bytes from a source to a memory address (note: Session register data must be written using writeSessRegByte() function)
+     * @tparam SOURCE_T type of the source, see writeMemBlock() and writeMemBlock_P() (at the bottom of this class)
      * @param blockAddress MEMory Address (MEMA) of the block
-     * @param writeBuff a buffer of bytes to write to the device
+     * @param writeBuff where to get the bytes from: a (const) buffer, or anything else with an operator[] (e.g. NT3H1x01_progmemSource)
      * @param bytesToWrite how many bytes of actual data to write, the remainder (to complete the NT3H1x01_BLOCK_SIZE block) will be 0's
      * @return whether it wrote successfully
      */
-    bool writeMemBlock(uint8_t blockAddress, uint8_t writeBuff[], uint8_t bytesToWrite=NT3H1x01_BLOCK_SIZE) {
+    template<typename SOURCE_T>
+    bool writeMemBlockFrom(uint8_t blockAddress, SOURCE_T writeBuff, uint8_t bytesToWrite=NT3H1x01_BLOCK_SIZE) {
       if(bytesToWrite > NT3H1x01_BLOCK_SIZE) {/* PANIC */  NT3H1x01debugPrint("writeMemBlock() can only write in blocks of 16 bytes, not more!"); return(false); }
       Wire.beginTransmission(slaveAddress);
       Wire.write(blockAddress);
-      Wire.write(writeBuff, bytesToWrite); // (usually) just calls a forloop that calls .write(byte) for every byte.
+      for(uint8_t i=0; i<bytesToWrite; i++) { Wire.write(writeBuff[i]); } // Wire.write(buff, len) (usually) just calls a forloop like this anyway, but this way the bytes can come straight from PROGMEM
       for(uint8_t i=0; i<(NT3H1x01_BLOCK_SIZE-bytesToWrite); i++) { Wire.write(0); } // pad 0's to make the block complete
       Wire.endTransmission();
       return(true);
@@ -367,16 +470,18 @@ class _NT3H1x01_thijs_base
     }
     
     /**
-     * write a block worth of bytes from a buffer to a memory address (note: Session register data must be written using writeSessRegByte() function)
+     * write a block worth of bytes from a source to a memory address (note: Session register data must be written using writeSessRegByte() function)
+     * @tparam SOURCE_T type of the source, see writeMemBlock() and writeMemBlock_P() (at the bottom of this class)
      * @param blockAddress MEMory Address (MEMA) of the block
-     * @param writeBuff a buffer of bytes to write to the device
+     * @param writeBuff where to get the bytes from: a (const) buffer, or anything else with an operator[] (e.g. NT3H1x01_progmemSource)
      * @param bytesToWrite how many bytes of actual data to write, the remainder (to complete the NT3H1x01_BLOCK_SIZE block) will be 0's
      * @return whether it wrote successfully
      */
-    bool writeMemBlock(uint8_t blockAddress, uint8_t writeBuff[], uint8_t bytesToWrite=NT3H1x01_BLOCK_SIZE) {
+    template<typename SOURCE_T>
+    bool writeMemBlockFrom(uint8_t blockAddress, SOURCE_T writeBuff, uint8_t bytesToWrite=NT3H1x01_BLOCK_SIZE) {
       if(bytesToWrite > NT3H1x01_BLOCK_SIZE) {/* PANIC */  NT3H1x01debugPrint("writeMemBlock() can only write in blocks of 16 bytes, not more!"); return(false); }
       if(!startWrite()) { return(false); }
-      twiWrite(registerToWrite);  //if(twoWireStatusReg != twi_SR_M_DAT_T_ACK) { return(false); } //should be ACK(?)
+      twiWrite(blockAddress);  //if(twoWireStatusReg != twi_SR_M_DAT_T_ACK) { return(false); } //should be ACK(?)
       for(uint8_t i=0; i<NT3H1x01_BLOCK_SIZE; i++) {
         twiWrite((i<bytesToWrite) ? writeBuff[i] : 0); // write real data if it exists, pad 0's where needed
         //if(twoWireStatusReg != twi_SR_M_DAT_T_ACK) { return(false); } //should be ACK(?)
@@ -497,13 +602,15 @@ class _NT3H1x01_thijs_base
     }
     
     /**
-     * write a block worth of bytes from a buffer to a memory address (note: Session register data must be written using writeSessRegByte() function)
+     * write a block worth of bytes from a source to a memory address (note: Session register data must be written using writeSessRegByte() function)
+     * @tparam SOURCE_T type of the source, see writeMemBlock() and writeMemBlock_P() (at the bottom of this class)
      * @param blockAddress MEMory Address (MEMA) of the block
-     * @param writeBuff a buffer of bytes to write to the device
+     * @param writeBuff where to get the bytes from: a (const) buffer, or anything else with an operator[] (e.g. NT3H1x01_progmemSource)
      * @param bytesToWrite how many bytes of actual data to write, the remainder (to complete the NT3H1x01_BLOCK_SIZE block) will be 0's
      * @return (esp_err_t or bool) whether it wrote successfully
      */
-    NT3H1x01_ERR_RETURN_TYPE writeMemBlock(uint8_t blockAddress, uint8_t writeBuff[], uint8_t bytesToWrite=NT3H1x01_BLOCK_SIZE) {
+    template<typename SOURCE_T>
+    NT3H1x01_ERR_RETURN_TYPE writeMemBlockFrom(uint8_t blockAddress, SOURCE_T writeBuff, uint8_t bytesToWrite=NT3H1x01_BLOCK_SIZE) {
       if(bytesToWrite > NT3H1x01_BLOCK_SIZE) {/* PANIC */  NT3H1x01debugPrint("writeMemBlock() can only write in blocks of 16 bytes, not more!"); return(NT3H1x01_ERR_RETURN_TYPE_FAIL); }
       esp_err_t err;
       // if(bytesToWrite == NT3H1x01_BLOCK_SIZE) {
@@ -625,13 +732,15 @@ class _NT3H1x01_thijs_base
     }
     
     /**
-     * write a block worth of bytes from a buffer to a memory address (note: Session register data must be written using writeSessRegByte() function)
+     * write a block worth of bytes from a source to a memory address (note: Session register data must be written using writeSessRegByte() function)
+     * @tparam SOURCE_T type of the source, see writeMemBlock() and writeMemBlock_P() (at the bottom of this class)
      * @param blockAddress MEMory Address (MEMA) of the block
-     * @param writeBuff a buffer of bytes to write to the device
+     * @param writeBuff where to get the bytes from: a (const) buffer, or anything else with an operator[] (e.g. NT3H1x01_progmemSource)
      * @param bytesToWrite how many bytes of actual data to write, the remainder (to complete the NT3H1x01_BLOCK_SIZE block) will be 0's
      * @return whether it wrote successfully
      */
-    bool writeMemBlock(uint8_t blockAddress, uint8_t writeBuff[], uint8_t bytesToWrite=NT3H1x01_BLOCK_SIZE) {
+    template<typename SOURCE_T>
+    bool writeMemBlockFrom(uint8_t blockAddress, SOURCE_T writeBuff, uint8_t bytesToWrite=NT3H1x01_BLOCK_SIZE) {
       //twi_setModule(module);  // see init() for explenation
       if(bytesToWrite > NT3H1x01_BLOCK_SIZE) {/* PANIC */  NT3H1x01debugPrint("writeMemBlock() can only write in blocks of 16 bytes, not more!"); return(false); }
       uint8_t copiedArray[NT3H1x01_BLOCK_SIZE+1]; copiedArray[0]=blockAddress; for(uint8_t i=0;i<NT3H1x01_BLOCK_SIZE;i++) { copiedArray[i+1]=(i<bytesToWrite) ? writeBuff[i] : 0; }
@@ -778,13 +887,15 @@ class _NT3H1x01_thijs_base
     }
     
     /**
-     * write a block worth of bytes from a buffer to a memory address (note: Session register data must be written using writeSessRegByte() function)
+     * write a block worth of bytes from a source to a memory address (note: Session register data must be written using writeSessRegByte() function)
+     * @tparam SOURCE_T type of the source, see writeMemBlock() and writeMemBlock_P() (at the bottom of this class)
      * @param blockAddress MEMory Address (MEMA) of the block
-     * @param writeBuff a buffer of bytes to write to the device
+     * @param writeBuff where to get the bytes from: a (const) buffer, or anything else with an operator[] (e.g. NT3H1x01_progmemSource)
      * @param bytesToWrite how many bytes of actual data to write, the remainder (to complete the NT3H1x01_BLOCK_SIZE block) will be 0's
      * @return (i2c_status_e or bool) whether it wrote successfully
      */
-    NT3H1x01_ERR_RETURN_TYPE writeMemBlock(uint8_t blockAddress, uint8_t writeBuff[], uint8_t bytesToWrite=NT3H1x01_BLOCK_SIZE) {
+    template<typename SOURCE_T>
+    NT3H1x01_ERR_RETURN_TYPE writeMemBlockFrom(uint8_t blockAddress, SOURCE_T writeBuff, uint8_t bytesToWrite=NT3H1x01_BLOCK_SIZE) {
       // note: for some alternate (potentially intersting) code, please refer to writeBytes() in AS5600_thijs or TMP112_thijs
       if(bytesToWrite > NT3H1x01_BLOCK_SIZE) {/* PANIC */  NT3H1x01debugPrint("writeMemBlock() can only write in blocks of 16 bytes, not more!"); return(NT3H1x01_ERR_RETURN_TYPE_FAIL); }
       #if defined(I2C_OTHER_FRAME) // if the STM32 subfamily is capable of writing without sending a stop
@@ -835,6 +946,24 @@ class _NT3H1x01_thijs_base
     #error("should never happen, platform optimization code has issue (probably at the top there)")
   #endif // platform-optimized code end
 
+  /**
+   * write a block worth of bytes from a (const) buffer to a memory address (note: Session register data must be written using writeSessRegByte() function)
+   * @param blockAddress MEMory Address (MEMA) of the block
+   * @param writeBuff a buffer of bytes to write to the device
+   * @param bytesToWrite how many bytes of actual data to write, the remainder (to complete the NT3H1x01_BLOCK_SIZE block) will be 0's
+   * @return (bool or esp_err_t or i2c_status_e, see on defines at top) whether it wrote successfully
+   */
+  NT3H1x01_ERR_RETURN_TYPE writeMemBlock(uint8_t blockAddress, const uint8_t writeBuff[], uint8_t bytesToWrite=NT3H1x01_BLOCK_SIZE) { return(writeMemBlockFrom(blockAddress, writeBuff, bytesToWrite)); }
+  /**
+   * write a block worth of bytes from PROGMEM (flash) to a memory address, without copying them into RAM first
+   * NOTE: on AVR and with the Wire library the bytes go straight from flash to the bus. The ESP32, MSP430 and STM32 drivers need one contiguous (address+data) buffer, so a 17 byte frame is still built on the stack (flash is memory-mapped there anyway)
+   * @param blockAddress MEMory Address (MEMA) of the block
+   * @param PROGMEMbuff a buffer of bytes (declared with PROGMEM) to write to the device
+   * @param bytesToWrite how many bytes of actual data to write, the remainder (to complete the NT3H1x01_BLOCK_SIZE block) will be 0's
+   * @return (bool or esp_err_t or i2c_status_e, see on defines at top) whether it wrote successfully
+   */
+  NT3H1x01_ERR_RETURN_TYPE writeMemBlock_P(uint8_t blockAddress, const uint8_t PROGMEMbuff[], uint8_t bytesToWrite=NT3H1x01_BLOCK_SIZE) { return(writeMemBlockFrom(blockAddress, NT3H1x01_progmemSource{PROGMEMbuff}, bytesToWrite)); }
+
   /*
   the remainder of the code can be found in the main header file: NT3H1x01_thijs.h
   This is just a parent class, meant to hold all the low-level I2C implementations
@@ -0,0 +1,253 @@
+
+#ifndef _NT3H1x01_thijs_capture_h
+#define _NT3H1x01_thijs_capture_h
+
+#include "NT3H1x01_thijs.h" // (for the constants, this file is only included by NT3H1x01_thijs.h when NT3H1x01_capture is defined)
+
+/*
+Capture every I2C transaction (including the data sent and received) to a compact binary log, which can be replayed into the simulated tag later.
+Where NT3H1x01_trace keeps the last few events in RAM (without data), this streams everything out, e.g. to Serial (on target) or to a file (on a host PC).
+To use, define NT3H1x01_capture (before including NT3H1x01_thijs.h), then call yourTag.capture.begin(Serial, yourTag.is2kVariant, yourTag.slaveAddress)
+ (or begin(someFILE, ...) on a host PC, or begin(yourSinkFunction, ...) for anything else)
+When NT3H1x01_capture is NOT defined, none of this exists (zero cost).
+
+log format (all multi-byte values are little-endian):
+ header: 'N','T','c','p', version (1), is2kVariant (0/1), I2C address (7-bit)
+ then 1 record per transport primitive call:
+  - op (NT3H1x01_TRACE_OP_ENUM) in the lower 3 bits, bit 7 is set if the call returned an error
+  - microseconds since the previous record (or since begin()), as a LEB128 varint (1 byte for gaps < 128us)
+  - block address (MEMA), or the register index for session register ops (NT3H1x01_INVALID_MEMA for _onlyReadBytes)
+  - payload length, then the payload:
+     READ_BLOCK: the 16 bytes that were read,  READ_SESS: the 1 byte that was read,  ONLY_READ: the bytes that were read
+     WRITE_BLOCK: the 16 bytes that were written,  WRITE_SESS: regDat, mask
+ so a block read costs ~20 bytes of log, a session register access ~5 bytes.
+
+to replay a log (on a host PC), see NT3H1x01_replayCapture() below and examples/NT3H1x01_thijs_replay
+
+NOTE: at 115200 baud, Serial can move ~11 bytes/ms, which is less than a 400kHz I2C bus, so capturing slows things down (use a bigger Serial TX buffer, or a faster baudrate)
+NOTE: not thread/interrupt-safe (same as the rest of the library)
+*/
+
+#define NT3H1x01_CAPTURE_VERSION 1
+#define NT3H1x01_CAPTURE_HEADER_SIZE 7
+#define NT3H1x01_CAPTURE_ERR_bit 0x80
+#define NT3H1x01_CAPTURE_OP_bits 0x07
+
+#if !defined(ARDUINO)
+  #include <stdio.h> // FILE, fwrite
+#endif
+
+typedef void (*NT3H1x01_captureSink)(const uint8_t data[], size_t length, void* context); // where the log bytes go
+
+class NT3H1x01_captureRecorder
+{
+  public:
+  NT3H1x01_captureSink sink = NULL; // (private) set by begin()
+  void* _sinkContext = NULL;        // (private) passed to the sink (e.g. the Print or FILE pointer)
+  uint32_t _lastTimestamp = 0;      // (private) timestamp of the previous record
+  uint32_t recorded = 0;            // number of records written since begin()
+
+  /**
+   * start capturing, to any sink you like
+   * @param sinkToUse function that gets the log bytes
+   * @param context passed to the sink as-is
+   * @param is2kVariant (stored in the header, for the replayer)
+   * @param slaveAddress (stored in the header, for the replayer)
+   */
+  void begin(NT3H1x01_captureSink sinkToUse, void* context, bool is2kVariant, uint8_t slaveAddress) {
+    sink = sinkToUse;  _sinkContext = context;  recorded = 0;  _lastTimestamp = NT3H1x01_MICROS();
+    const uint8_t header[NT3H1x01_CAPTURE_HEADER_SIZE] = {'N', 'T', 'c', 'p', NT3H1x01_CAPTURE_VERSION, is2kVariant, slaveAddress};
+    sink(header, NT3H1x01_CAPTURE_HEADER_SIZE, _sinkContext);
+  }
+  #if defined(ARDUINO)
+    /**
+     * start capturing to a Print (e.g. Serial), the log is binary, so capture it with something that doesn't mangle bytes (not the Arduino serial monitor)
+     * @param output where to write to (anything that inherits from Print)
+     * @param is2kVariant (stored in the header, for the replayer)
+     * @param slaveAddress (stored in the header, for the replayer)
+     */
+    void begin(Print& output, bool is2kVariant, uint8_t slaveAddress) { begin(_printSink, &output, is2kVariant, slaveAddress); }
+    static void _printSink(const uint8_t data[], size_t length, void* context) { ((Print*)context)->write(data, length); }
+  #else
+    /**
+     * start capturing to a file (opened with "wb")
+     * @param file where to write to
+     * @param is2kVariant (stored in the header, for the replayer)
+     * @param slaveAddress (stored in the header, for the replayer)
+     */
+    void begin(FILE* file, bool is2kVariant, uint8_t slaveAddress) { begin(_fileSink, file, is2kVariant, slaveAddress); }
+    static void _fileSink(const uint8_t data[], size_t length, void* context) { fwrite(data, 1, length, (FILE*)context); }
+  #endif
+
+  /**
+   * stop capturing (does not close the Print/FILE)
+   */
+  void end() { sink = NULL; }
+
+  /**
+   * (private) write one record, called by the wrapped primitives
+   * @param op which primitive
+   * @param blockAddress MEMory Address (MEMA) of the block (or the register index)
+   * @param payload the data that was read/written (see format at top)
+   * @param payloadLength number of bytes in payload
+   * @param errGood whether the primitive was successful
+   * @param startTime NT3H1x01_MICROS() from before the call
+   */
+  void record(NT3H1x01_TRACE_OP_ENUM op, uint8_t blockAddress, const uint8_t payload[], uint8_t payloadLength, bool errGood, uint32_t startTime) {
+    if(!sink) { return; }
+    uint8_t buff[1 + 5 + 2 + NT3H1x01_BLOCK_SIZE];  uint8_t len = 0;
+    buff[len++] = op | (errGood ? 0 : NT3H1x01_CAPTURE_ERR_bit);
+    uint32_t delta = startTime - _lastTimestamp;  _lastTimestamp = startTime;
+    do { buff[len++] = (delta & 0x7F) | ((delta > 0x7F) ? 0x80 : 0);  delta >>= 7; } while(delta); // LEB128 varint
+    if(payloadLength > NT3H1x01_BLOCK_SIZE) { payloadLength = NT3H1x01_BLOCK_SIZE; } // (nothing in this library reads more than a block at once)
+    buff[len++] = blockAddress;  buff[len++] = payloadLength;
+    for(uint8_t i=0; i<payloadLength; i++) { buff[len++] = payload[i]; }
+    sink(buff, len, _sinkContext);
+    recorded++;
+  }
+};
+
+/**
+ * one record from a capture log
+ */
+struct NT3H1x01_captureRecord
+{
+  NT3H1x01_TRACE_OP_ENUM op;
+  bool errGood;            // whether the call was successful (when it was captured)
+  uint32_t timestamp;      // microseconds since the start of the capture
+  uint8_t blockAddress;    // MEMory Address (MEMA) of the block (or the register index)
+  uint8_t payloadLength;
+  uint8_t payload[NT3H1x01_BLOCK_SIZE];
+};
+
+/**
+ * reads records from a capture log (in memory), works on any platform
+ */
+class NT3H1x01_captureReader
+{
+  public:
+  const uint8_t* _log;   // (private)
+  size_t _size;          // (private)
+  size_t _pos = 0;       // (private) read position
+  bool is2kVariant = false; // from the header
+  uint8_t slaveAddress = NT3H1x01_DEFAULT_I2C_ADDRESS; // from the header
+  uint32_t _timestamp = 0; // (private)
+
+  NT3H1x01_captureReader(const uint8_t log[], size_t size) : _log(log), _size(size) {}
+
+  /**
+   * check and read the header
+   * @return false if this is not a (supported) capture log
+   */
+  bool begin() {
+    _pos = 0;  _timestamp = 0;
+    if(_size < NT3H1x01_CAPTURE_HEADER_SIZE) { return(false); }
+    if((_log[0] != 'N') || (_log[1] != 'T') || (_log[2] != 'c') || (_log[3] != 'p') || (_log[4] != NT3H1x01_CAPTURE_VERSION)) { return(false); }
+    is2kVariant = _log[5];  slaveAddress = _log[6];  _pos = NT3H1x01_CAPTURE_HEADER_SIZE;
+    return(true);
+  }
+
+  /**
+   * read the next record
+   * @param rec reference to put the record in
+   * @return false at the end of the log (or if the log is truncated/corrupt)
+   */
+  bool next(NT3H1x01_captureRecord& rec) {
+    if(_pos >= _size) { return(false); }
+    uint8_t opByte = _log[_pos++];
+    if((opByte & NT3H1x01_CAPTURE_OP_bits) > NT3H1x01_TRACE_WRITE_SESS) { _pos = _size; return(false); }
+    rec.op = (NT3H1x01_TRACE_OP_ENUM)(opByte & NT3H1x01_CAPTURE_OP_bits);  rec.errGood = !(opByte & NT3H1x01_CAPTURE_ERR_bit);
+    uint32_t delta = 0;  uint8_t shift = 0;
+    while(true) {
+      if((_pos >= _size) || (shift > 28)) { _pos = _size; return(false); }
+      uint8_t varByte = _log[_pos++];  delta |= (uint32_t)(varByte & 0x7F) << shift;  shift += 7;
+      if(!(varByte & 0x80)) { break; }
+    }
+    _timestamp += delta;  rec.timestamp = _timestamp;
+    if((_pos + 2) > _size) { _pos = _size; return(false); }
+    rec.blockAddress = _log[_pos++];  rec.payloadLength = _log[_pos++];
+    if((rec.payloadLength > NT3H1x01_BLOCK_SIZE) || ((_pos + rec.payloadLength) > _size)) { _pos = _size; return(false); }
+    for(uint8_t i=0; i<rec.payloadLength; i++) { rec.payload[i] = _log[_pos++]; }
+    return(true);
+  }
+};
+
+#ifdef NT3H1x01_useSimulator
+  struct NT3H1x01_replayResult
+  {
+    bool validLog = false;     // whether the header was OK
+    uint32_t records = 0;      // records replayed
+    uint32_t mismatches = 0;   // reads that returned different data than when captured (the simulated tag's state differs from the real one)
+    uint32_t errDiffs = 0;     // calls that succeeded in one and failed in the other (e.g. a NACK from EEPROM busy time)
+    int32_t firstMismatch = -1; // index of the first record with a mismatch or errDiff (-1 if none)
+    uint32_t capturedErrors = 0; // calls that failed when captured
+    uint32_t capturedMicros = 0; // timestamp of the last record (how long the captured traffic took)
+  };
+
+  /**
+   * preload the simulated tag's memory with the (first) read of each block in the log, so the replay starts from the same state as the real tag
+   * (blocks that were written before they were read are left alone)
+   * @param log the capture log
+   * @param size size of the log in bytes
+   * @param simTag the simulated tag to preload
+   * @return false if the log header is bad
+   */
+  inline bool NT3H1x01_seedFromCapture(const uint8_t log[], size_t size, NT3H1x01_simTag& simTag) {
+    NT3H1x01_captureReader reader(log, size);
+    if(!reader.begin()) { return(false); }
+    simTag.is2kVariant = reader.is2kVariant;  simTag.slaveAddress = reader.slaveAddress;
+    bool touched[256] = {false};  bool sessTouched[8] = {false};
+    NT3H1x01_captureRecord rec;
+    while(reader.next(rec)) {
+      if(!rec.errGood) { continue; }
+      if((rec.op == NT3H1x01_TRACE_READ_BLOCK) && !touched[rec.blockAddress]) {
+        memcpy(simTag.mem[rec.blockAddress], rec.payload, rec.payloadLength);
+      } else if((rec.op == NT3H1x01_TRACE_READ_SESS) && (rec.blockAddress < 8) && !sessTouched[rec.blockAddress]) {
+        simTag.sessRegs[rec.blockAddress] = rec.payload[0];
+      }
+      if((rec.op == NT3H1x01_TRACE_READ_BLOCK) || (rec.op == NT3H1x01_TRACE_WRITE_BLOCK)) { touched[rec.blockAddress] = true; }
+      if(((rec.op == NT3H1x01_TRACE_READ_SESS) || (rec.op == NT3H1x01_TRACE_WRITE_SESS)) && (rec.blockAddress < 8)) { sessTouched[rec.blockAddress] = true; }
+    }
+    return(true);
+  }
+
+  /**
+   * drive a capture log into a simulated tag, and compare what it answers with what the real tag answered
+   * if the simulated tag has the timing model enabled (see NT3H1x01_simTag::enableTiming()), the gaps between the captured calls are replayed as well,
+   *  so WDT expiries, EEPROM busy NACKs, etc. happen like they did in the field (and the sim's counters tell you where the time went)
+   * @param log the capture log
+   * @param size size of the log in bytes
+   * @param simTag the simulated tag to replay into (see also NT3H1x01_seedFromCapture())
+   * @return the results (see NT3H1x01_replayResult)
+   */
+  inline NT3H1x01_replayResult NT3H1x01_replayCapture(const uint8_t log[], size_t size, NT3H1x01_simTag& simTag) {
+    NT3H1x01_replayResult result;
+    NT3H1x01_captureReader reader(log, size);
+    if(!reader.begin()) { return(result); }
+    result.validLog = true;
+    _NT3H1x01_thijs_base bus(reader.is2kVariant, reader.slaveAddress);  bus.init(simTag); // (the raw transport primitives, so nothing gets re-interpreted)
+    uint64_t clockStart = simTag.virtualMicros;
+    NT3H1x01_captureRecord rec;
+    while(reader.next(rec)) {
+      if(simTag.timingModel && ((clockStart + rec.timestamp) > simTag.virtualMicros)) { simTag.advanceTime((clockStart + rec.timestamp) - simTag.virtualMicros); } // (the host was busy with something else)
+      uint8_t readBuff[NT3H1x01_BLOCK_SIZE];  bool replayGood = true;  bool isRead = true;
+      switch(rec.op) {
+        case NT3H1x01_TRACE_READ_BLOCK:  replayGood = bus.requestMemBlock(rec.blockAddress, readBuff);  break;
+        case NT3H1x01_TRACE_READ_SESS:   replayGood = bus.requestSessRegByte((NT3H1x01_CONF_SESS_REGS_ENUM)rec.blockAddress, readBuff[0]);  break;
+        case NT3H1x01_TRACE_ONLY_READ:   replayGood = bus._onlyReadBytes(readBuff, rec.payloadLength);  break;
+        case NT3H1x01_TRACE_WRITE_BLOCK: replayGood = bus.writeMemBlock(rec.blockAddress, rec.payload, rec.payloadLength);  isRead = false;  break;
+        case NT3H1x01_TRACE_WRITE_SESS:  replayGood = bus.writeSessRegByte((NT3H1x01_CONF_SESS_REGS_ENUM)rec.blockAddress, rec.payload[0], rec.payload[1]);  isRead = false;  break;
+      }
+      bool mismatch = isRead && replayGood && rec.errGood && (memcmp(readBuff, rec.payload, rec.payloadLength) != 0);
+      if(mismatch) { result.mismatches++; }
+      if(replayGood != rec.errGood) { result.errDiffs++; }
+      if((mismatch || (replayGood != rec.errGood)) && (result.firstMismatch < 0)) { result.firstMismatch = result.records; }
+      if(!rec.errGood) { result.capturedErrors++; }
+      result.capturedMicros = rec.timestamp;
+      result.records++;
+    }
+    return(result);
+  }
+#endif // NT3H1x01_useSimulator
+
+#endif // _NT3H1x01_thijs_capture_h
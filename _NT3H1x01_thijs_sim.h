@@ -0,0 +1,439 @@
+
+#ifndef _NT3H1x01_thijs_sim_h
+#define _NT3H1x01_thijs_sim_h
+
+#include "NT3H1x01_thijs.h" // (for the constants, this file is only included by _NT3H1x01_thijs_base.h when NT3H1x01_useSimulator is defined)
+
+#include <string.h> // memcpy, memset
+
+/*
+A simulated NT3H1x01 tag, which lives entirely in RAM.
+This lets you run the library without any hardware (even on a host PC, where there is no Arduino core), which is handy for:
+- benchmarking how many I2C transactions (and bytes) each function costs
+- testing higher-level code (NDEF stuff, locking, etc.) without wearing out a real tag's EEPROM
+- reproducing weird situations (by poking the memory directly)
+
+It only models the I2C side of the IC (at the level of whole transactions), with the same quirks the real thing has:
+- reading block 0x00 byte 0 returns the NXP manufacturer ID, writing it changes the I2C address
+- the UID, SAK and ATQA are read-only
+- the Session registers are accessed with the special (mask-byte) format, NS_REG is mostly read-only
+- the 3rd Dynamic Locking byte always reads as 0
+- invalid memory addresses are NACKed
+
+Optionally (see enableTiming()), it also keeps a deterministic virtual clock, which models (roughly):
+- the time on the wire, per bit, at clockHz
+- EEPROM programming time after every EEPROM block write (EEPROM_WR_BUSY), during which memory access is
+   either clock-stretched (if I2C_CLOCK_STR is set) or NACKed (session registers stay accessible, so NS_REG can be polled)
+- arbitration: memory access by I2C sets I2C_LOCKED, which the watchdog timer (WDT_LS/WDT_MS) clears if the host doesn't
+- RF-side access windows (addRFwindow()), which get the memory (RF_LOCKED) if I2C isn't holding it
+Nothing happens 'by itself' between transactions, the clock only moves on transactions and advanceTime() (so results are repeatable).
+To make the trace/stats timestamps use this clock as well, define NT3H1x01_simVirtualClock (before including the library).
+
+What an RF reader (phone) would read can be checked with rfReadBlock(), which applies Memory-Mirror mode and sets NDEF_DATA_READ, and a phone writing to the tag
+ is rfWriteBlock() (no RF timing or access rules though, combine them with addRFwindow() for that).
+To have a phone read/write concurrently with the library, call those from betweenTransactions (called before every I2C transaction).
+
+Faults can be injected (to exercise the error/retry paths), either randomly (faultPermille[], with a seeded PRNG, so also repeatable)
+ or scripted at a specific transaction (scheduleFault()), see NT3H1x01_SIM_FAULT_ENUM for the types of faults.
+*/
+
+#ifndef NT3H1x01_SIM_RF_WINDOWS
+  #define NT3H1x01_SIM_RF_WINDOWS 8 // max number of scheduled RF access windows (see addRFwindow())
+#endif
+#ifndef NT3H1x01_SIM_SCRIPTED_FAULTS
+  #define NT3H1x01_SIM_SCRIPTED_FAULTS 8 // max number of scripted faults (see scheduleFault())
+#endif
+
+enum NT3H1x01_SIM_FAULT_ENUM : uint8_t {
+  NT3H1x01_SIM_FAULT_NONE          = 0,
+  NT3H1x01_SIM_FAULT_NACK          = 1, // the transaction is NACKed (nothing happens)
+  NT3H1x01_SIM_FAULT_SHORT_READ    = 2, // (reads only) the tag stops sending halfway (like Wire.available() != bytesToRead)
+  NT3H1x01_SIM_FAULT_EEPROM_WR_ERR = 3, // (EEPROM block writes only) the write is ACKed, but fails: the block is unchanged and EEPROM_WR_ERR is set
+  NT3H1x01_SIM_FAULT_RF_BURST      = 4, // the RF side takes the memory for rfBurstTransactions transactions (RF_LOCKED, memory access is NACKed)
+  NT3H1x01_SIM_FAULT_WDT_EXPIRE    = 5  // the WDT expires during the transaction (I2C_LOCKED is cleared right after it)
+};
+#define NT3H1x01_SIM_FAULT_COUNT 6
+
+class NT3H1x01_simTag;
+/**
+ * (private) the simulated tag whose virtual clock NT3H1x01_simMicros() returns (the last one that called enableTiming())
+ */
+inline NT3H1x01_simTag*& _NT3H1x01_simClockSource() { static NT3H1x01_simTag* source = NULL;  return(source); }
+
+class NT3H1x01_simTag
+{
+  public:
+  uint8_t slaveAddress; // 7-bit address (stored in EEPROM on the real IC)
+  bool is2kVariant;
+  uint8_t mem[256][NT3H1x01_BLOCK_SIZE]; // the whole I2C memory map (most of it is invalid, but this keeps the indexing simple)
+  uint8_t sessRegs[8]; // Session registers (note: NOT the same as block 0xFE in mem[][])
+  //// transaction counters:
+  uint32_t writeTransactions = 0; // number of (START, SLA+W, ..., STOP) transactions
+  uint32_t readTransactions = 0;  // number of (START, SLA+R, ..., STOP) transactions
+  uint32_t bytesWritten = 0;      // number of bytes sent by the I2C master (excluding address byte)
+  uint32_t bytesRead = 0;         // number of bytes sent by the tag (excluding address byte)
+  uint32_t eepromBlockWrites = 0; // number of 16-byte EEPROM blocks written
+  //// timing model (only when timingModel is true, see enableTiming()):
+  bool timingModel = false;
+  uint32_t clockHz = 400000;        // SCL frequency
+  uint32_t eepromWriteMicros = 4100; // EEPROM programming time per block (datasheet: 4.1ms typical)
+  uint64_t virtualMicros = 0;       // the virtual clock
+  uint64_t eepromBusyUntil = 0;     // when the current EEPROM programming cycle is done
+  uint32_t stretchedMicros = 0;     // total time SCL was held low by the tag (waiting for EEPROM programming)
+  uint32_t busyNACKs = 0;           // transactions NACKed because EEPROM programming was in progress (and I2C_CLOCK_STR was off)
+  uint32_t rfLockedNACKs = 0;       // transactions NACKed because the RF side had the memory
+  uint32_t wdtExpiries = 0;         // times the WDT had to clear I2C_LOCKED
+  uint32_t rfWindowsBlocked = 0;    // RF access windows that found the memory locked by I2C (the phone would see a failed read)
+  //// RF side (see rfReadBlock()):
+  uint32_t rfBlockReads = 0;        // blocks read by the (simulated) RF reader
+  uint32_t rfBlockWrites = 0;       // blocks written by the (simulated) RF reader
+  void (*betweenTransactions)(void* context) = NULL; // (optional) called before every I2C transaction, e.g. to let a simulated RF reader do something in between (with rfReadBlock())
+  void* betweenTransactionsContext = NULL;          // passed to betweenTransactions as-is
+  //// fault injection:
+  uint16_t faultPermille[NT3H1x01_SIM_FAULT_COUNT] = {0}; // chance (in 1/1000) of each fault type (indexed by NT3H1x01_SIM_FAULT_ENUM), per transaction it applies to
+  uint32_t faultSeed = 1;           // PRNG state (xorshift32, must not be 0), set it for a repeatable sequence of random faults
+  uint8_t rfBurstTransactions = 4;  // how long an RF_BURST fault keeps the memory (in transactions)
+  uint32_t faultsInjected[NT3H1x01_SIM_FAULT_COUNT] = {0}; // number of faults that actually happened (indexed by NT3H1x01_SIM_FAULT_ENUM)
+
+  private:
+  uint8_t _pointedBlock = 0;     // the block the (last) write transaction pointed to, for the following read transaction
+  uint8_t _pointedSessReg = 0;   // the session register byte the (last) write transaction pointed to (if _pointedBlock == NT3H1x01_SESS_REGS_MEMA)
+  uint64_t _i2cLockedSince = 0;  // when I2C_LOCKED was set (the WDT runs from there)
+  struct _rfWindow { uint64_t start; uint32_t duration; int8_t granted; }; // granted: -1 = not started yet, 0 = blocked by I2C, 1 = RF has the memory
+  _rfWindow _rfWindows[NT3H1x01_SIM_RF_WINDOWS];
+  uint8_t _rfWindowCount = 0;
+  struct _scriptedFault { uint32_t transaction; NT3H1x01_SIM_FAULT_ENUM fault; };
+  _scriptedFault _scriptedFaults[NT3H1x01_SIM_SCRIPTED_FAULTS];
+  uint8_t _scriptedFaultCount = 0;
+  uint8_t _rfBurstLeft = 0;        // transactions left in the current RF_BURST
+  bool _wdtExpiryPending = false;  // a WDT_EXPIRE fault happened in the previous transaction
+
+  public:
+  NT3H1x01_simTag(bool is2kVariant, uint8_t address=NT3H1x01_DEFAULT_I2C_ADDRESS) : slaveAddress(address), is2kVariant(is2kVariant) { factoryReset(); }
+
+  /**
+   * put all memory back to the (datasheet) factory defaults (UID is set to 04:01:02:03:04:05:06)
+   */
+  void factoryReset() {
+    memset(mem, 0, sizeof(mem));
+    const uint8_t defaultBlock0[NT3H1x01_BLOCK_SIZE] = {NT3H1x01_SERIAL_NR_NXP_MF_ID,0x01,0x02,0x03,0x04,0x05,0x06, 0x00, 0x44,0x00, 0x00,0x00,
+                                                        NT3H1x01_CAPA_CONT_DEFAULT[is2kVariant][0], NT3H1x01_CAPA_CONT_DEFAULT[is2kVariant][1],
+                                                        NT3H1x01_CAPA_CONT_DEFAULT[is2kVariant][2], NT3H1x01_CAPA_CONT_DEFAULT[is2kVariant][3]};
+    memcpy(mem[0], defaultBlock0, NT3H1x01_BLOCK_SIZE);
+    memcpy(mem[_confRegsMEMA()], NT3H1x01_CONF_REGS_DEFAULT, sizeof(NT3H1x01_CONF_REGS_DEFAULT));
+    powerOnReset();
+    writeTransactions = 0;  readTransactions = 0;  bytesWritten = 0;  bytesRead = 0;  eepromBlockWrites = 0;
+    virtualMicros = 0;  eepromBusyUntil = 0;  stretchedMicros = 0;  busyNACKs = 0;  rfLockedNACKs = 0;  wdtExpiries = 0;  rfWindowsBlocked = 0;  _rfWindowCount = 0;  rfBlockReads = 0;  rfBlockWrites = 0;
+    memset(faultsInjected, 0, sizeof(faultsInjected));  _scriptedFaultCount = 0;  _rfBurstLeft = 0;  _wdtExpiryPending = false; // (faultPermille and faultSeed are left alone)
+  }
+
+  /**
+   * simulate a Power-On-Reset: the Configuration registers get loaded into the Session registers
+   */
+  void powerOnReset() {
+    memcpy(sessRegs, mem[_confRegsMEMA()], 6);
+    sessRegs[NT3H1x01_SESS_REGS_NS_REG_BYTE] = NT3H1x01_SESS_REGS_DEFAULT[NT3H1x01_SESS_REGS_NS_REG_BYTE];
+    sessRegs[7] = 0;
+  }
+
+  /**
+   * estimate how long the counted transactions would take on a real bus (only the bits on the wire, no clock stretching or EEPROM programming time)
+   * each transaction is a START, the address byte (+ACK), the data bytes (+ACK each) and a STOP, so ~(11 + 9*bytes) SCL periods
+   * @param clockHz I2C clock frequency, e.g. 100000 or 400000 (the NT3H1x01 is rated for up to 400kHz)
+   * @return microseconds
+   */
+  uint32_t modelledBusMicros(uint32_t clockHz) const {
+    uint64_t bits = (uint64_t)(writeTransactions + readTransactions) * 11 + (uint64_t)(bytesWritten + bytesRead) * 9;
+    return((bits * 1000000 + clockHz - 1) / clockHz);
+  }
+
+  /**
+   * turn on the timing model (virtual clock, EEPROM busy time, WDT, RF access windows), see top of this file
+   * @param SCLfrequency I2C clock frequency, e.g. 100000 or 400000
+   */
+  void enableTiming(uint32_t SCLfrequency=400000) {
+    timingModel = true;  clockHz = SCLfrequency;
+    _NT3H1x01_simClockSource() = this; // (for NT3H1x01_simVirtualClock)
+  }
+
+  /**
+   * let (virtual) time pass without any I2C traffic, e.g. to model a delay() in your code
+   * @param micros microseconds
+   */
+  void advanceTime(uint32_t micros) { virtualMicros += micros;  _updateTime(); }
+
+  /**
+   * schedule a time window in which an RF reader (phone) wants to access the memory
+   * if I2C_LOCKED is set at the start of the window, the reader is blocked (rfWindowsBlocked), otherwise RF_LOCKED is set for the duration
+   * @param startMicros virtualMicros at which the window starts
+   * @param durationMicros how long the reader holds the memory
+   * @return false if there is no room for more windows (see NT3H1x01_SIM_RF_WINDOWS)
+   */
+  bool addRFwindow(uint64_t startMicros, uint32_t durationMicros) {
+    if(_rfWindowCount >= NT3H1x01_SIM_RF_WINDOWS) { return(false); }
+    _rfWindows[_rfWindowCount].start = startMicros;  _rfWindows[_rfWindowCount].duration = durationMicros;  _rfWindows[_rfWindowCount].granted = -1;
+    _rfWindowCount++;
+    return(true);
+  }
+
+  /**
+   * inject a specific fault at a specific transaction (on top of the random ones)
+   * @param transactionNumber at which transaction (counting both reads and writes, the first transaction after factoryReset() is 1)
+   * @param fault which fault (if it doesn't apply to that transaction (e.g. SHORT_READ on a write), nothing happens)
+   * @return false if there is no room for more scripted faults (see NT3H1x01_SIM_SCRIPTED_FAULTS)
+   */
+  bool scheduleFault(uint32_t transactionNumber, NT3H1x01_SIM_FAULT_ENUM fault) {
+    if(_scriptedFaultCount >= NT3H1x01_SIM_SCRIPTED_FAULTS) { return(false); }
+    _scriptedFaults[_scriptedFaultCount].transaction = transactionNumber;  _scriptedFaults[_scriptedFaultCount].fault = fault;
+    _scriptedFaultCount++;
+    return(true);
+  }
+
+  /**
+   * read a block the way an RF reader (phone) sees it: with Memory-Mirror mode on (and Pass-Through off), the SRAM replaces the 4 blocks from SRAM_MIRROR_BLOCK.
+   * reading the block at LAST_NDEF_BLOCK sets NDEF_DATA_READ (like it does on the real IC).
+   * NOTE: this does not go through the arbitration/timing model (use addRFwindow() for that), it's just to check what a phone would get
+   * @param blockAddress (I2C) MEMory Address (MEMA) of the block (the RF side uses 4-byte pages, but those map onto the same memory)
+   * @param readBuff a NT3H1x01_BLOCK_SIZE buffer to store the read values in
+   */
+  void rfReadBlock(uint8_t blockAddress, uint8_t readBuff[]) {
+    memcpy(readBuff, mem[_rfMappedBlock(blockAddress)], NT3H1x01_BLOCK_SIZE);
+    rfBlockReads++;
+    if((sessRegs[NT3H1x01_COMN_REGS_LAST_NDEF_BLOCK_BYTE] != 0) && (blockAddress == sessRegs[NT3H1x01_COMN_REGS_LAST_NDEF_BLOCK_BYTE])) { sessRegs[NT3H1x01_SESS_REGS_NS_REG_BYTE] |= NT3H1x01_NS_REG_NDEF_READ_bits; }
+  }
+  /**
+   * write a block of user memory the way an RF reader (phone) would (Memory-Mirror mode applies, see rfReadBlock()).
+   * Blocks locked by the Static/Dynamic Locking bits (see NT3H1x01_lockBitsForArea()) are refused, like a real tag NAKs the write.
+   * NOTE: like rfReadBlock(), this skips the arbitration/timing model (and it doesn't count as an eepromBlockWrites)
+   * @param blockAddress (I2C) MEMory Address (MEMA) of the block, must be user memory (or it's ignored)
+   * @param data a NT3H1x01_BLOCK_SIZE buffer (on the 1k variant, only the first 8 bytes go into the last user block, the rest are the Dynamic Locking bytes)
+   * @return whether it was written (false if it's not user memory, or locked)
+   */
+  bool rfWriteBlock(uint8_t blockAddress, const uint8_t data[]) {
+    const NT3H1x01_memMap memMap = NT3H1x01_getMemMap(is2kVariant);
+    if(!memMap.isUserBlock(blockAddress)) { return(false); }
+    uint8_t mappedBlock = _rfMappedBlock(blockAddress);
+    if(mappedBlock == blockAddress) { // (the SRAM isn't covered by the lock bits)
+      const uint8_t* dynaLock = &mem[memMap.dynaLockMEMA][memMap.dynaLockByte];
+      NT3H1x01_lockBits locks{(uint16_t)(mem[0][NT3H1x01_STAT_LOCK_MEMA_BYTES_START] | (mem[0][NT3H1x01_STAT_LOCK_MEMA_BYTES_START+1] << 8)), dynaLock[0] | ((uint32_t)dynaLock[1] << 8)};
+      if(locks.intersects(NT3H1x01_lockBitsForArea(memMap, blockAddress, blockAddress))) { return(false); }
+    }
+    memcpy(mem[mappedBlock], data, (mappedBlock == blockAddress) ? memMap.userBytesInBlock(blockAddress) : NT3H1x01_BLOCK_SIZE);
+    rfBlockWrites++;
+    return(true);
+  }
+  /**
+   * (private) which block of mem[] the RF side gets for a block address (the SRAM, if it's mirrored there)
+   */
+  uint8_t _rfMappedBlock(uint8_t blockAddress) const {
+    const uint8_t NC_REG = sessRegs[NT3H1x01_COMN_REGS_NC_REG_BYTE];  const uint8_t mirrorBlock = sessRegs[NT3H1x01_COMN_REGS_SRAM_MIRROR_BLOCK_BYTE];
+    bool mirrored = ((NC_REG & (NT3H1x01_NC_REG_MIRROR_bits | NT3H1x01_NC_REG_PTHRU_bits)) == NT3H1x01_NC_REG_MIRROR_bits)
+                    && (blockAddress >= mirrorBlock) && (blockAddress <= (mirrorBlock + (NT3H1x01_SRAM_MEMA_END - NT3H1x01_SRAM_MEMA_START)));
+    return(mirrored ? (NT3H1x01_SRAM_MEMA_START + (blockAddress - mirrorBlock)) : blockAddress);
+  }
+
+  /**
+   * the current WDT threshold (from the Session registers)
+   * @return microseconds
+   */
+  uint32_t wdtMicros() const { return((((uint32_t)sessRegs[NT3H1x01_COMN_REGS_WDT_MS_BYTE] << 8) | sessRegs[NT3H1x01_COMN_REGS_WDT_LS_BYTE]) * 943 / 100); } // (9.43us resolution)
+
+  /**
+   * (private) the Configuration registers block address for this variant
+   */
+  uint8_t _confRegsMEMA() const { return(NT3H1x01_getMemMap(is2kVariant).confRegsMEMA); }
+
+  /**
+   * check whether the I2C master is allowed to access a block
+   * @param blockAddress MEMory Address (MEMA) of the block
+   * @return true if the IC would ACK this memory address
+   */
+  bool isValidBlock(uint8_t blockAddress) const { return(NT3H1x01_getMemMap(is2kVariant).isValidBlock(blockAddress)); }
+
+  /**
+   * simulate a write transaction (START, SLA+W, data..., STOP)
+   * @param address 7-bit address the master sent
+   * @param data the bytes the master sent (after the address byte)
+   * @param length how many bytes the master sent
+   * @return true if everything was ACKed
+   */
+  bool i2cWrite(uint8_t address, const uint8_t data[], uint8_t length) {
+    if(betweenTransactions) { betweenTransactions(betweenTransactionsContext); }
+    if(address != slaveAddress) { return(false); } // no ACK
+    writeTransactions++;  bytesWritten += length;
+    bool memoryAccess = (length > 0) && (data[0] != NT3H1x01_SESS_REGS_MEMA);
+    NT3H1x01_SIM_FAULT_ENUM fault = _pickFault(false, (length == (NT3H1x01_BLOCK_SIZE+1)) && (data[0] < NT3H1x01_SRAM_MEMA_START), memoryAccess);
+    if(fault == NT3H1x01_SIM_FAULT_NACK) { _chargeBus(0); return(false); }
+    if(length == 0) { _chargeBus(0); return(true); } // (just an address check, like an I2C scan)
+    if(!isValidBlock(data[0])) { _chargeBus(0); return(false); } // NACK on the memory address
+    if(memoryAccess && _rfBurstNACK()) { return(false); }
+    if(timingModel && !_timedAccess(memoryAccess)) { return(false); }
+    _chargeBus(length);
+    _pointedBlock = data[0];
+    if(data[0] == NT3H1x01_SESS_REGS_MEMA) { // Session registers use a special format
+      if(length < 2) { return(false); }
+      _pointedSessReg = data[1] & 0x07;
+      if(length == 4) { _writeSessRegByte(_pointedSessReg, data[3], data[2]); } // REGA, MASK, REGDAT
+      return((length == 2) || (length == 4));
+    }
+    if(length == 1) { return(true); } // just setting the memory pointer (for a read)
+    if(length != (NT3H1x01_BLOCK_SIZE+1)) { return(false); } // the IC only accepts whole blocks
+    if(fault == NT3H1x01_SIM_FAULT_EEPROM_WR_ERR) { sessRegs[NT3H1x01_SESS_REGS_NS_REG_BYTE] |= NT3H1x01_NS_REG_EPR_WR_ERR_bits; } // (the block stays as it was)
+    else { _writeBlock(data[0], &data[1]); }
+    if(timingModel && (data[0] < NT3H1x01_SRAM_MEMA_START)) { eepromBusyUntil = virtualMicros + eepromWriteMicros;  _updateTime(); } // (SRAM is instant)
+    return(true);
+  }
+
+  /**
+   * simulate a read transaction (START, SLA+R, data..., STOP), which reads from the memory pointed to by the last write transaction
+   * @param address 7-bit address the master sent
+   * @param readBuff buffer to put the bytes the tag sends into
+   * @param length how many bytes the master wants
+   * @return how many bytes the tag actually sent (0 if the address was NACKed, less than length for a short read)
+   */
+  uint8_t i2cRead(uint8_t address, uint8_t readBuff[], uint8_t length) {
+    if(betweenTransactions) { betweenTransactions(betweenTransactionsContext); }
+    if(address != slaveAddress) { return(0); } // no ACK
+    readTransactions++;
+    bool memoryAccess = (_pointedBlock != NT3H1x01_SESS_REGS_MEMA);
+    NT3H1x01_SIM_FAULT_ENUM fault = _pickFault(true, false, memoryAccess);
+    if(fault == NT3H1x01_SIM_FAULT_NACK) { _chargeBus(0); return(0); }
+    if(memoryAccess && _rfBurstNACK()) { return(0); }
+    if(timingModel && !_timedAccess(memoryAccess)) { return(0); }
+    if(fault == NT3H1x01_SIM_FAULT_SHORT_READ) { length /= 2; }
+    bytesRead += length;  _chargeBus(length);
+    if(_pointedBlock == NT3H1x01_SESS_REGS_MEMA) {
+      for(uint8_t i=0; i<length; i++) { readBuff[i] = (i == 0) ? sessRegs[_pointedSessReg] : 0xFF; } // only 1 byte is returned, the rest is just a released bus
+      if((_pointedSessReg == NT3H1x01_SESS_REGS_NS_REG_BYTE) && (length > 0)) { sessRegs[NT3H1x01_SESS_REGS_NS_REG_BYTE] &= ~NT3H1x01_NS_REG_NDEF_READ_bits; } // reading clears NDEF_DATA_READ
+      return(length);
+    }
+    uint8_t blockCopy[NT3H1x01_BLOCK_SIZE];  memcpy(blockCopy, mem[_pointedBlock], NT3H1x01_BLOCK_SIZE);
+    if(_pointedBlock == 0) { blockCopy[NT3H1x01_I2C_ADDR_CHANGE_MEMA_BYTE] = NT3H1x01_SERIAL_NR_NXP_MF_ID; } // I2C address byte reads as manufacturer ID
+    const NT3H1x01_memMap memMap = NT3H1x01_getMemMap(is2kVariant);
+    if(_pointedBlock == memMap.dynaLockMEMA) { blockCopy[memMap.dynaLockByte+2] = 0; } // 3rd dynamic lock byte always reads as 0
+    for(uint8_t i=0; i<length; i++) { readBuff[i] = (i < NT3H1x01_BLOCK_SIZE) ? blockCopy[i] : 0xFF; }
+    return(length);
+  }
+
+  private:
+  /**
+   * (fault injection) decide whether this transaction gets a fault (and start the ones that last longer than 1 transaction)
+   * @param isRead whether it's a read transaction
+   * @param isEepromWrite whether it's a whole-block write to EEPROM
+   * @param memoryAccess whether it accesses the memory (everything except the Session registers)
+   * @return the fault for this transaction (NT3H1x01_SIM_FAULT_NONE most of the time)
+   */
+  NT3H1x01_SIM_FAULT_ENUM _pickFault(bool isRead, bool isEepromWrite, bool memoryAccess) {
+    if(_wdtExpiryPending) { sessRegs[NT3H1x01_SESS_REGS_NS_REG_BYTE] &= ~NT3H1x01_NS_REG_I2C_LOCKED_bits;  wdtExpiries++;  _wdtExpiryPending = false; } // (from the previous transaction)
+    NT3H1x01_SIM_FAULT_ENUM fault = NT3H1x01_SIM_FAULT_NONE;
+    uint32_t transactionNumber = writeTransactions + readTransactions;
+    for(uint8_t i=0; i<_scriptedFaultCount; i++) { if(_scriptedFaults[i].transaction == transactionNumber) { fault = _scriptedFaults[i].fault; } }
+    for(uint8_t i=1; (i<NT3H1x01_SIM_FAULT_COUNT) && (fault == NT3H1x01_SIM_FAULT_NONE); i++) {
+      if(faultPermille[i] == 0) { continue; }
+      faultSeed ^= faultSeed << 13;  faultSeed ^= faultSeed >> 17;  faultSeed ^= faultSeed << 5; // xorshift32
+      if((faultSeed % 1000) < faultPermille[i]) { fault = (NT3H1x01_SIM_FAULT_ENUM)i; }
+    }
+    //// drop faults that don't apply to this transaction:
+    if((fault == NT3H1x01_SIM_FAULT_SHORT_READ) && !isRead) { fault = NT3H1x01_SIM_FAULT_NONE; }
+    if((fault == NT3H1x01_SIM_FAULT_EEPROM_WR_ERR) && !isEepromWrite) { fault = NT3H1x01_SIM_FAULT_NONE; }
+    if((fault == NT3H1x01_SIM_FAULT_RF_BURST) && !memoryAccess) { fault = NT3H1x01_SIM_FAULT_NONE; } // (the RF side only matters for memory access)
+    if(fault == NT3H1x01_SIM_FAULT_RF_BURST) { _rfBurstLeft = rfBurstTransactions; }
+    if(fault == NT3H1x01_SIM_FAULT_WDT_EXPIRE) { _wdtExpiryPending = true; }
+    if(fault != NT3H1x01_SIM_FAULT_NONE) { faultsInjected[fault]++; }
+    //// the RF_BURST shows up in NS_REG (for the non-timing model, _updateTime() does the same):
+    if(_rfBurstLeft) { sessRegs[NT3H1x01_SESS_REGS_NS_REG_BYTE] |= NT3H1x01_NS_REG_RF_LOCKED_bits; }
+    else if(!timingModel) { sessRegs[NT3H1x01_SESS_REGS_NS_REG_BYTE] &= ~NT3H1x01_NS_REG_RF_LOCKED_bits; }
+    return(fault);
+  }
+
+  /**
+   * (fault injection) whether a memory access is NACKed because of an RF_BURST
+   */
+  bool _rfBurstNACK() {
+    if(_rfBurstLeft == 0) { return(false); }
+    _rfBurstLeft--;  rfLockedNACKs++;  _chargeBus(0);
+    return(true);
+  }
+
+  /**
+   * (timing model) advance the clock by the bits on the wire of one transaction (address byte + data bytes)
+   */
+  void _chargeBus(uint8_t length) {
+    if(!timingModel) { return; }
+    virtualMicros += ((uint64_t)(11 + 9 * (uint32_t)length) * 1000000 + clockHz - 1) / clockHz;
+    _updateTime();
+  }
+
+  /**
+   * (timing model) EEPROM busy / arbitration checks at the start of a transaction
+   * @param memoryAccess whether the transaction accesses the memory (everything except the Session registers)
+   * @return false if the tag NACKs
+   */
+  bool _timedAccess(bool memoryAccess) {
+    _updateTime();
+    if(!memoryAccess) { return(true); } // Session registers are always accessible
+    if(virtualMicros < eepromBusyUntil) {
+      if(sessRegs[NT3H1x01_COMN_REGS_I2C_CLOCK_STR_BYTE] & 0x01) { // clock stretching: SCL is held low until programming is done
+        stretchedMicros += eepromBusyUntil - virtualMicros;  virtualMicros = eepromBusyUntil;  _updateTime();
+      } else { _chargeBus(0);  busyNACKs++;  return(false); }
+    }
+    if(sessRegs[NT3H1x01_SESS_REGS_NS_REG_BYTE] & NT3H1x01_NS_REG_RF_LOCKED_bits) { _chargeBus(0);  rfLockedNACKs++;  return(false); }
+    if(!(sessRegs[NT3H1x01_SESS_REGS_NS_REG_BYTE] & NT3H1x01_NS_REG_I2C_LOCKED_bits)) { // I2C takes the memory (arbitration), the WDT starts
+      sessRegs[NT3H1x01_SESS_REGS_NS_REG_BYTE] |= NT3H1x01_NS_REG_I2C_LOCKED_bits;  _i2cLockedSince = virtualMicros;
+    }
+    return(true);
+  }
+
+  /**
+   * (timing model) update the NS_REG bits to the current virtualMicros (WDT, RF windows, EEPROM_WR_BUSY)
+   */
+  void _updateTime() {
+    uint8_t& NS_REG = sessRegs[NT3H1x01_SESS_REGS_NS_REG_BYTE];
+    uint64_t wdtDeadline = _i2cLockedSince + wdtMicros();
+    NS_REG &= ~(NT3H1x01_NS_REG_RF_LOCKED_bits | NT3H1x01_NS_REG_RF_FIELD_bits);
+    for(uint8_t i=0; i<_rfWindowCount; i++) {
+      _rfWindow& window = _rfWindows[i];
+      if(virtualMicros < window.start) { continue; }
+      if(window.granted < 0) { // (the window just started) was I2C holding the memory at that time?
+        bool i2cHeld = (NS_REG & NT3H1x01_NS_REG_I2C_LOCKED_bits) && (wdtDeadline > window.start);
+        window.granted = i2cHeld ? 0 : 1;  if(i2cHeld) { rfWindowsBlocked++; }
+      }
+      if(virtualMicros < (window.start + window.duration)) {
+        NS_REG |= NT3H1x01_NS_REG_RF_FIELD_bits;
+        if(window.granted) { NS_REG |= NT3H1x01_NS_REG_RF_LOCKED_bits; }
+      }
+    }
+    if(_rfBurstLeft) { NS_REG |= NT3H1x01_NS_REG_RF_LOCKED_bits; } // (fault injection)
+    if((NS_REG & NT3H1x01_NS_REG_I2C_LOCKED_bits) && (virtualMicros >= wdtDeadline)) { NS_REG &= ~NT3H1x01_NS_REG_I2C_LOCKED_bits;  wdtExpiries++; }
+    if(virtualMicros < eepromBusyUntil) { NS_REG |= NT3H1x01_NS_REG_EPR_WR_BSY_bits; } else { NS_REG &= ~NT3H1x01_NS_REG_EPR_WR_BSY_bits; }
+  }
+
+  void _writeBlock(uint8_t blockAddress, const uint8_t data[]) {
+    if(blockAddress == 0) { // only the I2C address, static lock bytes and CC are writable
+      slaveAddress = data[NT3H1x01_I2C_ADDR_CHANGE_MEMA_BYTE] >> 1; // (takes effect immediately in this simulation)
+      memcpy(&mem[0][NT3H1x01_STAT_LOCK_MEMA_BYTES_START], &data[NT3H1x01_STAT_LOCK_MEMA_BYTES_START], 2+4); // static lock bytes and CC
+    } else if(blockAddress == _confRegsMEMA()) {
+      if(mem[blockAddress][NT3H1x01_CONF_REGS_REG_LOCK_BYTE] & NT3H1x01_NC_REG_LOCK_I2C_bits) { return; } // Configuration registers are (permanently) locked for I2C
+      memcpy(mem[blockAddress], data, 6);
+      mem[blockAddress][NT3H1x01_CONF_REGS_REG_LOCK_BYTE] |= data[NT3H1x01_CONF_REGS_REG_LOCK_BYTE] & (NT3H1x01_NC_REG_LOCK_I2C_bits | NT3H1x01_NC_REG_LOCK_RF_bits); // burn bits can only be set
+    } else {
+      memcpy(mem[blockAddress], data, NT3H1x01_BLOCK_SIZE);
+    }
+    if(blockAddress < NT3H1x01_SRAM_MEMA_START) { eepromBlockWrites++; } // SRAM writes don't count
+  }
+
+  void _writeSessRegByte(uint8_t registerIndex, uint8_t regDat, uint8_t mask) {
+    if(registerIndex == NT3H1x01_SESS_REGS_NS_REG_BYTE) { mask &= (NT3H1x01_NS_REG_I2C_LOCKED_bits | NT3H1x01_NS_REG_EPR_WR_ERR_bits); } // only 2 bits are R/W
+    if(registerIndex == NT3H1x01_COMN_REGS_I2C_CLOCK_STR_BYTE) { return; } // Read-only in Session registers
+    if(registerIndex > NT3H1x01_SESS_REGS_NS_REG_BYTE) { return; }
+    sessRegs[registerIndex] = (sessRegs[registerIndex] & ~mask) | (regDat & mask);
+  }
+};
+
+/**
+ * the virtual clock of the simulated tag (the last one that called enableTiming()), used as NT3H1x01_MICROS() when NT3H1x01_simVirtualClock is defined
+ * @return microseconds (0 if no simulated tag has the timing model enabled)
+ */
+inline uint32_t NT3H1x01_simMicros() { return(_NT3H1x01_simClockSource() ? (uint32_t)_NT3H1x01_simClockSource()->virtualMicros : 0); }
+
+#endif // _NT3H1x01_thijs_sim_h
@@ -0,0 +1,222 @@
+
+#ifndef _NT3H1x01_thijs_stats_h
+#define _NT3H1x01_thijs_stats_h
+
+#include "NT3H1x01_thijs.h" // (for the constants, this file is only included by NT3H1x01_thijs.h when NT3H1x01_stats is defined)
+
+#include <string.h> // strcmp
+
+/*
+Running statistics of everything the library does on the bus, meant to be left on in production (and reported over telemetry or whatever).
+Where NT3H1x01_trace records individual transactions (and forgets them), this just counts:
+- bus transactions, bytes read/written (on the wire, excluding the I2C address byte), EEPROM block writes and errors, per transport primitive
+- cache hits and misses (only for calls with useCache=true)
+- latency histograms (log2 buckets) per public function you call, e.g. setConf_WDT() or getSess_NC_DIR() (see apiHist()),
+   the register field templates per field, e.g. "set<NT3H1x01_Sess_NC_DIR>" or "getVal<NT3H1x01_NS_RF_FIELD_PRESENT>" (see NT3H1x01_fieldName)
+It's opt-in: define NT3H1x01_stats before including the library, the whole thing is about 1.5kB (with the default NT3H1x01_STATS_API_SLOTS).
+
+NOTE: only the outermost public call is timed (getSess_NC_DIR() uses getVal<>() and requestSessRegByte(), but only counts as getSess_NC_DIR()),
+ so the histograms never overlap in time. The optional modules (e.g. NT3H1x01_streamToTag()) show up as the tag functions they call.
+NOTE: not thread/interrupt-safe (same as the rest of the library)
+*/
+
+#define NT3H1x01_STATS_HIST_BUCKETS 16 // bucket i counts latencies of [2^i, 2^(i+1)) microseconds (bucket 0 also counts 0us), the last bucket counts everything above 32ms
+#ifndef NT3H1x01_STATS_API_SLOTS
+  #define NT3H1x01_STATS_API_SLOTS 16 // how many different public functions get a latency histogram (the first ones that are called), you can define your own before including the library
+#endif
+
+/**
+ * latency histogram of one operation
+ */
+struct NT3H1x01_latencyHist
+{
+  uint32_t count = 0;
+  uint32_t totalMicros = 0;
+  uint32_t maxMicros = 0;
+  uint32_t buckets[NT3H1x01_STATS_HIST_BUCKETS] = {0};
+
+  void add(uint32_t micros) {
+    count++;  totalMicros += micros;  if(micros > maxMicros) { maxMicros = micros; }
+    uint8_t bucket = 0;
+    while((micros > 1) && (bucket < (NT3H1x01_STATS_HIST_BUCKETS-1))) { micros >>= 1;  bucket++; } // log2
+    buckets[bucket]++;
+  }
+  /**
+   * add the latencies of another histogram (e.g. of the same operation on another bus)
+   * @param other the histogram to add
+   */
+  void merge(const NT3H1x01_latencyHist& other) {
+    count += other.count;  totalMicros += other.totalMicros;  if(other.maxMicros > maxMicros) { maxMicros = other.maxMicros; }
+    for(uint8_t i=0; i<NT3H1x01_STATS_HIST_BUCKETS; i++) { buckets[i] += other.buckets[i]; }
+  }
+  /**
+   * average latency
+   * @return microseconds (0 if there were no calls)
+   */
+  uint32_t meanMicros() const { return(count ? (totalMicros / count) : 0); }
+  /**
+   * (approximate) latency percentile, from the histogram
+   * @param percent e.g. 99 for the 99th percentile
+   * @return the upper edge of the bucket the percentile falls in (or maxMicros, if that's lower), in microseconds (so it's an overestimate, by up to 2x)
+   */
+  uint32_t percentileMicros(uint8_t percent) const {
+    uint32_t threshold = ((uint64_t)count * percent + 99) / 100;  uint32_t sum = 0;
+    for(uint8_t i=0; i<(NT3H1x01_STATS_HIST_BUCKETS-1); i++) {
+      sum += buckets[i];
+      if((sum >= threshold) && (sum > 0)) { uint32_t edge = (uint32_t)2 << i;  return((edge < maxMicros) ? edge : maxMicros); }
+    }
+    return(maxMicros); // (the last bucket has no upper edge)
+  }
+};
+
+/**
+ * latency histogram of one public function
+ */
+struct NT3H1x01_apiHist
+{
+  const char* name = NULL; // the function name (__func__, or a label, see NT3H1x01_STATS_API_NAMED()), NULL if the slot is still free
+  NT3H1x01_latencyHist hist;
+};
+
+struct NT3H1x01_busStats
+{
+  uint32_t transactions = 0;      // I2C transactions (START ... STOP), e.g. requestMemBlock() is 2 (write the address, then read)
+  uint32_t bytesRead = 0;         // bytes sent by the tag
+  uint32_t bytesWritten = 0;      // bytes sent by the I2C master (excluding the I2C address byte)
+  uint32_t eepromBlockWrites = 0; // writeMemBlock() calls to EEPROM (not SRAM) blocks, the thing that wears out
+  uint32_t cacheHits = 0;         // useCache=true calls that could use _oneBlockBuff
+  uint32_t cacheMisses = 0;       // useCache=true calls that had to read the block anyway
+  uint32_t retries = 0;           // transactions that were retried (only with NT3H1x01_retries defined, see yourTag.maxRetries)
+  uint32_t errors = 0;            // transport primitive calls that returned an error
+  NT3H1x01_ERR_RETURN_TYPE lastError = NT3H1x01_ERR_RETURN_TYPE_OK; // the most recent error (to see WHAT went wrong, on platforms with error codes)
+  uint32_t primitiveCalls[5] = {0}; // calls per transport primitive (indexed by NT3H1x01_TRACE_OP_ENUM)
+  NT3H1x01_apiHist apis[NT3H1x01_STATS_API_SLOTS]; // per public function (in the order they were first called), see apiHist()
+  uint32_t apiOverflow = 0;       // calls of functions that didn't get a histogram (all NT3H1x01_STATS_API_SLOTS were taken)
+  uint8_t _apiDepth = 0;          // (private) how many public calls are running (nested), only the outermost one is timed
+
+  /**
+   * (private) count a transport primitive call, called by the wrapped primitives
+   * @param op which primitive
+   * @param blockAddress MEMory Address (MEMA) of the block (only used for writes, to tell EEPROM from SRAM)
+   * @param byteCount number of data bytes read/written
+   * @param errGood whether it was successful
+   * @param result what the primitive returned
+   */
+  void countPrimitive(NT3H1x01_TRACE_OP_ENUM op, uint8_t blockAddress, uint8_t byteCount, bool errGood, NT3H1x01_ERR_RETURN_TYPE result) {
+    primitiveCalls[op]++;
+    switch(op) {
+      case NT3H1x01_TRACE_READ_BLOCK:  transactions += 2;  bytesWritten += 1;  bytesRead += byteCount;  break; // MEMA, then the block
+      case NT3H1x01_TRACE_READ_SESS:   transactions += 2;  bytesWritten += 2;  bytesRead += byteCount;  break; // MEMA + REGA, then the register byte
+      case NT3H1x01_TRACE_ONLY_READ:   transactions += 1;  bytesRead += byteCount;  break;
+      case NT3H1x01_TRACE_WRITE_BLOCK: transactions += 1;  bytesWritten += 1 + byteCount;  if(errGood && (blockAddress < NT3H1x01_SRAM_MEMA_START)) { eepromBlockWrites++; }  break;
+      case NT3H1x01_TRACE_WRITE_SESS:  transactions += 1;  bytesWritten += 3 + byteCount;  break; // MEMA + REGA + MASK + REGDAT
+    }
+    if(!errGood) { errors++;  lastError = result; }
+  }
+  /**
+   * (private) count a cache lookup
+   * @param useCache whether the caller actually wanted to use the cache (otherwise it's not counted)
+   * @param hit whether the cache held the right block
+   */
+  void countCache(bool useCache, bool hit) { if(useCache) { if(hit) { cacheHits++; } else { cacheMisses++; } } }
+
+  /**
+   * (private) find (or claim) the histogram of a public function
+   * @param name the function name (__func__)
+   * @return the histogram, or NULL if all slots are taken (counted in apiOverflow)
+   */
+  NT3H1x01_latencyHist* _apiSlot(const char* name) {
+    for(uint8_t i=0; i<NT3H1x01_STATS_API_SLOTS; i++) {
+      if(apis[i].name == NULL) { apis[i].name = name;  return(&apis[i].hist); }
+      if((apis[i].name == name) || (strcmp(apis[i].name, name) == 0)) { return(&apis[i].hist); } // (overloads and template instances share a name, but not always the pointer)
+    }
+    apiOverflow++;
+    return(NULL);
+  }
+  /**
+   * the latency histogram of a public function
+   * @param name the function name, e.g. "setConf_WDT"
+   * @return the histogram, or NULL if that function wasn't called (or didn't get a slot)
+   */
+  const NT3H1x01_latencyHist* apiHist(const char* name) const {
+    for(uint8_t i=0; (i<NT3H1x01_STATS_API_SLOTS) && (apis[i].name != NULL); i++) { if(strcmp(apis[i].name, name) == 0) { return(&apis[i].hist); } }
+    return(NULL);
+  }
+
+  /**
+   * total time spent in a public function, as a fraction of the time spent in all of them (handy for finding the call sites that dominate)
+   * @param name the function name, e.g. "setConf_WDT"
+   * @return 0.0 ~ 1.0 (these add up to 1.0, as only the outermost calls are timed)
+   */
+  float timeShare(const char* name) const {
+    uint64_t total = 0;  for(uint8_t i=0; i<NT3H1x01_STATS_API_SLOTS; i++) { total += apis[i].hist.totalMicros; }
+    const NT3H1x01_latencyHist* hist = apiHist(name);
+    return((total && hist) ? ((float)hist->totalMicros / total) : 0.0);
+  }
+
+  /**
+   * reset all counters (e.g. after reporting them)
+   */
+  void reset() { uint8_t depth = _apiDepth;  *this = NT3H1x01_busStats();  _apiDepth = depth; } // (the calls that are running now still finish normally)
+
+  #if defined(ARDUINO)
+    /**
+     * print all counters in a (somewhat) legible fashion, e.g.: printTo(Serial)
+     * @param output where to print to (anything that inherits from Print)
+     */
+    void printTo(Print& output) const {
+      output.print("transactions:"); output.print(transactions); output.print(" read:"); output.print(bytesRead); output.print("B written:"); output.print(bytesWritten);
+      output.print("B EEPROM writes:"); output.print(eepromBlockWrites); output.print(" cache hit/miss:"); output.print(cacheHits); output.print("/"); output.print(cacheMisses);
+      output.print(" retries:"); output.print(retries); output.print(" errors:"); output.print(errors);
+      output.print(" (last:"); output.print((int32_t)lastError); output.println(")");
+      for(uint8_t i=0; (i<NT3H1x01_STATS_API_SLOTS) && (apis[i].name != NULL); i++) {
+        const NT3H1x01_latencyHist& hist = apis[i].hist;
+        output.print(apis[i].name); output.print("() n:"); output.print(hist.count); output.print(" mean:"); output.print(hist.meanMicros());
+        output.print("us p99:<="); output.print(hist.percentileMicros(99)); output.print("us max:"); output.print(hist.maxMicros); output.println("us");
+      }
+      if(apiOverflow) { output.print("(untimed calls, out of slots:"); output.print(apiOverflow); output.println(")"); }
+    }
+  #endif
+};
+
+constexpr size_t _NT3H1x01_strlen(const char* str) { return(*str ? (1 + _NT3H1x01_strlen(str + 1)) : 0); } // (private) (constexpr, so it folds away)
+template<typename... FIELDS_T> struct _NT3H1x01_fieldNamesLength { static constexpr size_t value = 0; }; // (private) the length of all field names, plus 1 separator each
+template<typename FIELD_T, typename... REST_T> struct _NT3H1x01_fieldNamesLength<FIELD_T, REST_T...> {
+  static constexpr size_t value = _NT3H1x01_strlen(NT3H1x01_fieldName<FIELD_T>::name()) + 1 + _NT3H1x01_fieldNamesLength<REST_T...>::value; };
+/**
+ * (private) the stats label of set<FIELDS...>(): "set<NT3H1x01_Sess_NC_DIR>" for one field (a literal), or e.g. "set<NT3H1x01_Sess_NC_FD_ON,NT3H1x01_Sess_NC_FD_OFF>" for several
+ *  (built once, on the first call, so that's a little RAM per combination of fields you use)
+ */
+template<typename... FIELDS_T>
+struct _NT3H1x01_setLabel
+{
+  char text[4 + _NT3H1x01_fieldNamesLength<FIELDS_T...>::value + 1]; // "set<", the names with ',' (or the final '>') after each, '\0'
+  _NT3H1x01_setLabel() {
+    const char* names[] = {NT3H1x01_fieldName<FIELDS_T>::name()...};
+    size_t pos = 0;
+    for(const char* c="set<"; *c; c++) { text[pos++] = *c; }
+    for(size_t i=0; i<sizeof...(FIELDS_T); i++) {
+      for(const char* c=names[i]; *c; c++) { text[pos++] = *c; }
+      text[pos++] = (i < (sizeof...(FIELDS_T) - 1)) ? ',' : '>';
+    }
+    text[pos] = '\0';
+  }
+  static const char* get() { static const _NT3H1x01_setLabel label;  return(label.text); }
+};
+template<typename FIELD_T>
+struct _NT3H1x01_setLabel<FIELD_T> { static constexpr const char* get() { return(NT3H1x01_fieldName<FIELD_T>::setLabel()); } }; // (just a literal)
+
+/**
+ * (private) times a public function call from construction to destruction (so every return path is covered), if it's the outermost one
+ */
+struct _NT3H1x01_statsApiTimer
+{
+  NT3H1x01_busStats& stats;
+  NT3H1x01_latencyHist* hist;
+  uint32_t startTime;
+  _NT3H1x01_statsApiTimer(NT3H1x01_busStats& statsToUse, const char* name) : stats(statsToUse),
+    hist((statsToUse._apiDepth++ == 0) ? statsToUse._apiSlot(name) : NULL), startTime(NT3H1x01_MICROS()) {}
+  ~_NT3H1x01_statsApiTimer() { stats._apiDepth--;  if(hist != NULL) { hist->add(NT3H1x01_MICROS() - startTime); } }
+};
+
+#endif // _NT3H1x01_thijs_stats_h
@@ -0,0 +1,102 @@
+
+#ifndef _NT3H1x01_thijs_trace_h
+#define _NT3H1x01_thijs_trace_h
+
+#include "NT3H1x01_thijs.h" // (for the constants, this file is only included by NT3H1x01_thijs.h when NT3H1x01_trace is defined)
+
+/*
+A tiny transaction recorder, for finding out what the library actually does on the bus (and how long it takes).
+Every call to one of the transport primitives (requestMemBlock, requestSessRegByte, _onlyReadBytes, writeMemBlock, writeSessRegByte)
+ records one NT3H1x01_traceEvent into a fixed-size ring buffer (oldest events get overwritten once it's full).
+Unlike NT3H1x01debugPrint, recording is just a few stores, so it's fine to leave on in hot paths.
+To use, define NT3H1x01_trace (before including NT3H1x01_thijs.h), then read the events from yourTag.trace
+When NT3H1x01_trace is NOT defined, none of this exists (zero cost).
+
+NOTE: the primitives call eachother internally (e.g. requestMemBlock() uses _onlyReadBytes()), those internal calls are NOT recorded separately,
+ so 1 event == 1 call from the library (or your code), and the bytes add up correctly.
+NOTE: not thread/interrupt-safe, so drain it from the same task that uses the tag (or from a worker job, see NT3H1x01_thijs_worker.h)
+*/
+
+#ifndef NT3H1x01_TRACE_BUFF_SIZE
+  #define NT3H1x01_TRACE_BUFF_SIZE 32 // number of events the ring buffer holds (each event is ~12 bytes, so keep it small on AVR)
+#endif
+
+struct NT3H1x01_traceEvent
+{
+  uint32_t timestamp;       // NT3H1x01_MICROS() at the start of the call
+  uint16_t duration;        // how long the call took (in microseconds, saturates at 65535)
+  NT3H1x01_TRACE_OP_ENUM op;
+  uint8_t blockAddress;     // MEMory Address (MEMA) of the block (or the register index for session register ops, or NT3H1x01_INVALID_MEMA for _onlyReadBytes)
+  uint8_t byteCount;        // number of data bytes read/written
+  NT3H1x01_ERR_RETURN_TYPE result;
+};
+
+typedef void (*NT3H1x01_traceHook)(const NT3H1x01_traceEvent& event);
+
+class NT3H1x01_traceRecorder
+{
+  public:
+  NT3H1x01_traceEvent events[NT3H1x01_TRACE_BUFF_SIZE];
+  uint16_t _head = 0;       // (private) where the next event goes
+  uint16_t _count = 0;      // (private) how many (unread) events are in the buffer
+  uint32_t dropped = 0;     // number of events that were overwritten before they were read
+  NT3H1x01_traceHook hook = NULL; // (optional) called for every event, right after it's recorded (keep it short, it runs in the I2C path)
+
+  /**
+   * (private) add an event to the ring buffer, called by the traced primitives
+   * @param op which primitive
+   * @param blockAddress MEMory Address (MEMA) of the block (or the register index)
+   * @param byteCount number of data bytes read/written
+   * @param result what the primitive returned
+   * @param startTime NT3H1x01_MICROS() from before the call
+   */
+  void record(NT3H1x01_TRACE_OP_ENUM op, uint8_t blockAddress, uint8_t byteCount, NT3H1x01_ERR_RETURN_TYPE result, uint32_t startTime) {
+    uint32_t duration = NT3H1x01_MICROS() - startTime;
+    NT3H1x01_traceEvent& event = events[_head];
+    event.timestamp = startTime;  event.duration = (duration > 0xFFFF) ? 0xFFFF : duration;
+    event.op = op;  event.blockAddress = blockAddress;  event.byteCount = byteCount;  event.result = result;
+    _head = (_head + 1) % NT3H1x01_TRACE_BUFF_SIZE;
+    if(_count < NT3H1x01_TRACE_BUFF_SIZE) { _count++; } else { dropped++; } // full, so the oldest event was just overwritten
+    if(hook) { hook(event); }
+  }
+
+  /**
+   * how many (unread) events are in the buffer
+   */
+  uint16_t available() const { return(_count); }
+
+  /**
+   * take the oldest event out of the buffer
+   * @param event reference to put the event in
+   * @return true if there was an event
+   */
+  bool drain(NT3H1x01_traceEvent& event) {
+    if(_count == 0) { return(false); }
+    event = events[(_head + NT3H1x01_TRACE_BUFF_SIZE - _count) % NT3H1x01_TRACE_BUFF_SIZE];
+    _count--;
+    return(true);
+  }
+
+  /**
+   * forget all events
+   */
+  void clear() { _count = 0;  dropped = 0; }
+
+  #if defined(ARDUINO)
+    /**
+     * print (and drain) all events in a (somewhat) legible fashion, e.g.: dump(Serial)
+     * @param output where to print to (anything that inherits from Print)
+     */
+    void dump(Print& output) {
+      NT3H1x01_traceEvent event;
+      while(drain(event)) {
+        output.print(event.timestamp); output.print("us "); output.print(NT3H1x01_TRACE_OP_NAMES[event.op]);
+        output.print(" 0x"); output.print(event.blockAddress, HEX); output.print(" "); output.print(event.byteCount); output.print("B ");
+        output.print(event.duration); output.print("us result:"); output.println((int32_t)event.result);
+      }
+      if(dropped) { output.print("(dropped "); output.print(dropped); output.println(" events)"); }
+    }
+  #endif
+};
+
+#endif // _NT3H1x01_thijs_trace_h
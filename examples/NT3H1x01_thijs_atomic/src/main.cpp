@@ -0,0 +1,152 @@
+/*
+
+Demonstrates atomic NDEF updates (see NT3H1x01_thijs_atomic.h) on a host PC, on both variants:
+a (simulated) phone keeps reading the message, 1 block in between every I2C transaction of the library (see simTag.betweenTransactions),
+ while the message is replaced 20 times, with messages of different lengths.
+First the simple way (writing the blocks in place), then with NT3H1x01_atomicNdef. Both hand the memory back to the phone after every block,
+ so the phone never waits long, but only the second one makes sure that every message the phone reads is a whole message (the old one, or the new one).
+
+usage (from this folder, after building, see README.txt):
+  atomic      prints what every approach cost, exits with 1 if the phone reads a torn message with NT3H1x01_atomicNdef
+
+*/
+
+#define NT3H1x01_useSimulator
+
+#include "NT3H1x01_thijs_atomic.h"
+#include "NT3H1x01_thijs_ndef.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define UPDATES 20
+#define IMAGE_MAX 432 // (fits in region B of the 1k variant)
+
+static NT3H1x01_simTag simTag1k(false), simTag2k(true); // (static, they're 4kB each)
+
+//// every message that is ever written (a message the phone reads must be one of these, from the right time):
+static uint8_t images[UPDATES * 2 + 1][IMAGE_MAX];
+static uint16_t imageSizes[UPDATES * 2 + 1];
+static uint8_t committed = 0;  // the last message that was written completely
+static uint8_t writing = 0;    // the message that is being written now (== committed if none)
+
+/**
+ * a phone that reads the tag over and over, 1 block at a time (from the start of the user memory, until it has a whole NDEF TLV)
+ */
+struct simPhone
+{
+  NT3H1x01_simTag& simTag;
+  uint8_t userBlocks;
+  uint8_t mem[1904]; // what it read so far (all of the user memory of the 2k variant, at most)
+  uint8_t blocksRead = 0;     // of the current read
+  uint8_t readStart = 0;      // the committed message when the current read started
+  uint8_t lastReadStart = 0;  // readStart of the last read that finished
+  uint8_t idle = 0;           // steps to wait before the next read (a real phone doesn't read back-to-back either)
+  uint32_t prng = 12345;
+  uint16_t reads = 0,  torn = 0;
+
+  simPhone(NT3H1x01_simTag& simTagToUse, uint8_t blocks) : simTag(simTagToUse), userBlocks(blocks) {}
+
+  /**
+   * read 1 block, and check the message once it's complete
+   */
+  void step() {
+    if(idle) { idle--;  return; }
+    if(blocksRead == 0) { readStart = committed; }
+    simTag.rfReadBlock(1 + blocksRead, &mem[blocksRead * NT3H1x01_BLOCK_SIZE]);  blocksRead++;
+    uint16_t size = blocksRead * NT3H1x01_BLOCK_SIZE,  pos = 0;  NT3H1x01_tlv tlv;
+    while(NT3H1x01_nextTLV(mem, size, pos, tlv)) { if(tlv.type == NT3H1x01_TLV_NDEF) { finish(&tlv);  return; } }
+    if(((pos < size) && (mem[pos] == NT3H1x01_TLV_TERMINATOR)) || (blocksRead >= userBlocks)) { finish(NULL); } // (no NDEF TLV at all)
+  }
+
+  /**
+   * a read is done, check it against the messages that were on the tag while it read
+   * @param tlv the NDEF TLV it found, NULL if none
+   */
+  void finish(const NT3H1x01_tlv* tlv) {
+    bool whole = false;
+    for(uint8_t i=readStart; tlv && (i<=writing) && !whole; i++) {
+      NT3H1x01_tlv expected;  NT3H1x01_findTLV(images[i], imageSizes[i], NT3H1x01_TLV_NDEF, expected);
+      whole = (tlv->length == expected.length) && (memcmp(&mem[tlv->valueOffset], &images[i][expected.valueOffset], expected.length) == 0);
+    }
+    reads++;  torn += !whole;
+    lastReadStart = readStart;  blocksRead = 0;
+    prng ^= prng << 13;  prng ^= prng >> 17;  prng ^= prng << 5;  idle = prng % 4; // (xorshift32)
+  }
+};
+
+/**
+ * NT3H1x01_simTag::betweenTransactions callback, lets the phone read 1 block
+ */
+void phoneStep(void* context) { ((simPhone*)context)->step(); }
+
+/**
+ * make message number index (of a different length every time)
+ */
+void makeMessage(uint8_t index) {
+  char text[IMAGE_MAX];
+  int length = snprintf(text, sizeof(text), "message %u: ", index);
+  uint16_t padding = 20 + ((index * 97) % 330);
+  for(uint16_t i=0; i<padding; i++) { text[length++] = 'a' + ((index + i) % 26); }
+  NT3H1x01_ndefRecordData record = NT3H1x01_ndefText("en", 2, text, length);
+  imageSizes[index] = NT3H1x01_encodeNdefMessage(&record, 1, images[index], IMAGE_MAX);
+}
+
+/**
+ * let the phone finish a read of the message that was just written (so the next update doesn't start while it's still reading an older one, see NOTE in NT3H1x01_thijs_atomic.h)
+ */
+void settle(simPhone& phone) {
+  for(uint16_t i=0; (i<2000) && !((phone.lastReadStart == committed) && (phone.blocksRead == 0)); i++) { phone.step(); }
+}
+
+int main() {
+  bool good = true;
+  for(uint8_t variant=0; variant<2; variant++) {
+    NT3H1x01_simTag& simTag = variant ? simTag2k : simTag1k;
+    NT3H1x01_thijs nfc(variant);  nfc.init(simTag);
+    const NT3H1x01_memMap map = nfc.memMap();
+    simPhone phone(simTag, map.userEnd - map.userStart + 1);
+    committed = writing = 0;
+    makeMessage(0);
+    nfc.writeUserBytes(map.userStart, images[0], imageSizes[0]);  nfc.setNS_I2C_LOCKED(false);
+    simTag.betweenTransactions = phoneStep;  simTag.betweenTransactionsContext = &phone;
+
+    //// the simple way: every block in place (and then let the phone have the memory back, so it doesn't wait long):
+    uint32_t writesBefore = simTag.eepromBlockWrites;
+    for(uint8_t update=1; update<=UPDATES; update++) {
+      makeMessage(update);  writing = update;
+      for(uint16_t offset=0; offset<imageSizes[update]; offset+=NT3H1x01_BLOCK_SIZE) {
+        good &= nfc._errGood(nfc.writeUserBytes(map.userStart + offset/NT3H1x01_BLOCK_SIZE, &images[update][offset], NT3H1x01_BLOCK_SIZE));
+        good &= nfc._errGood(nfc.setNS_I2C_LOCKED(false));
+      }
+      committed = update;
+      settle(phone);
+    }
+    printf("%s in place: %3u phone reads, %2u torn, %4u EEPROM block writes\n", variant ? "2k" : "1k",
+           phone.reads, phone.torn, simTag.eepromBlockWrites - writesBefore);
+
+    //// atomic (the message starts out in region A, from the loop above):
+    NT3H1x01_atomicNdef<NT3H1x01_VARIANT_RUNTIME> atomic(nfc);
+    NT3H1x01_ERR_RETURN_TYPE err = atomic.begin();
+    good &= nfc._errGood(err) && !atomic.activeB;
+    phone.reads = phone.torn = 0;  writesBefore = simTag.eepromBlockWrites;
+    for(uint8_t update=UPDATES+1; update<=(UPDATES*2); update++) {
+      makeMessage(update);  writing = update;
+      err = atomic.update(images[update], imageSizes[update]);
+      good &= nfc._errGood(err);
+      committed = update;
+      settle(phone);
+    }
+    bool thisGood = (phone.torn == 0) && (phone.reads >= UPDATES);
+    printf("%s atomic:   %3u phone reads, %2u torn, %4u EEPROM block writes (region B starts at 0x%02X)  %s\n", variant ? "2k" : "1k",
+           phone.reads, phone.torn, simTag.eepromBlockWrites - writesBefore, atomic.splitBlock, thisGood ? "OK" : "FAIL");
+    good &= thisGood;
+    //// after a reset, begin() finds the active region again:
+    NT3H1x01_atomicNdef<NT3H1x01_VARIANT_RUNTIME> fresh(nfc);
+    err = fresh.begin();
+    good &= nfc._errGood(err) && (fresh.activeB == atomic.activeB);
+    simTag.betweenTransactions = NULL;
+  }
+  printf(good ? "atomic updates OK\n" : "FAILED\n");
+  return(good ? 0 : 1);
+}
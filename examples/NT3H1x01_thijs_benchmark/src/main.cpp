@@ -0,0 +1,268 @@
+/*
+
+Bus cost benchmark of the NT3H1x01_thijs library, runs on a host PC (no hardware needed, it uses the simulated tag, see _NT3H1x01_thijs_sim.h)
+For every public function of the NT3H1x01 class (every overload, on both the 1k and 2k variant), this counts the I2C transactions, bytes on the wire and EEPROM block writes,
+ and estimates how long that takes on a 100kHz, 400kHz and 1MHz bus.
+Except: burnRegLockI2C() and burnRegLockRF() (they only exist with NT3H1x01_unlock_burning), and the extension headers (NDEF, streams, worker, etc.), which have their own examples.
+The compile-time variants (NT3H1x01<NT3H1x01_VARIANT_1k> / <NT3H1x01_VARIANT_2k>) run the same code as the runtime one, so they aren't benchmarked separately.
+It also runs every function with the simulator's timing model (virtual clock), which adds clock stretching and EEPROM programming time.
+Those counts (and the timed latency) are compared against baseline.txt, and the program exits with 1 if anything got more expensive (so it can run in CI).
+
+to run (from this folder):
+  pio run -e native && .pio/build/native/program baseline.txt    (PlatformIO, see platformio.ini)
+or:
+  g++ -std=gnu++11 -I../.. src/main.cpp -o benchmark && ./benchmark baseline.txt
+to accept the new numbers (after an intentional change):
+  ./benchmark baseline.txt --update
+
+NOTE: the numbers are deterministic (they come from the simulator, not the wall clock), so they're the same on every machine.
+ The us@xxx columns are only the bits on the wire (see NT3H1x01_simTag::modelledBusMicros()),
+ the 'timed' column is from the timing model (see NT3H1x01_simTag::enableTiming()), with default WDT and I2C_CLOCK_STR settings.
+
+*/
+
+#define NT3H1x01_useSimulator
+
+#include "NT3H1x01_thijs.h"
+
+#include <stdio.h>
+#include <string.h>
+
+struct benchResult
+{
+  const char* name;
+  bool is2kVariant;
+  uint32_t transactions;
+  uint32_t bytes;
+  uint32_t eepromWrites;
+  uint32_t micros100k, micros400k, micros1M;
+  uint32_t timedMicros; // with the timing model (at 400kHz): including clock stretching and the EEPROM programming time, until the tag is idle again
+};
+
+typedef void (*benchFunc)(NT3H1x01_thijs& tag);
+
+struct benchEntry
+{
+  const char* name;
+  benchFunc func;
+};
+
+uint8_t blockBuff[NT3H1x01_BLOCK_SIZE] = {0x03,0x0B,0xD1,0x01,0x07,0x54,0x02,'e','n','H','e','l','l','o',0xFE,0x00};
+const uint8_t userData[40] = {0x03,38}; // (an NDEF TLV that spans 3 blocks, for writeUserBytes())
+const uint8_t defaultWDT[2] = {0x48, 0x08}; // (the factory default, LS byte first)
+
+#define BENCH(funcName, code)  {funcName, [](NT3H1x01_thijs& tag) { code; }}
+
+const benchEntry benchmarks[] = {
+  //// raw access:
+  BENCH("requestMemBlock",              tag.requestMemBlock(0x01, blockBuff)),
+  BENCH("writeMemBlock",                tag.writeMemBlock(0x01, blockBuff)),
+  BENCH("writeMemBlock(partial)",       tag.writeMemBlock(0x01, blockBuff, 4)),
+  BENCH("writeMemBlock_P",              tag.writeMemBlock_P(0x01, blockBuff)),
+  BENCH("writeMemBlockFrom",            tag.writeMemBlockFrom(0x01, (const uint8_t*)blockBuff)),
+  BENCH("requestSessRegByte",           uint8_t regVal; tag.requestSessRegByte(NT3H1x01_SESS_REGS_NS_REG_BYTE, regVal)),
+  BENCH("writeSessRegByte",             tag.writeSessRegByte(NT3H1x01_COMN_REGS_SRAM_MIRROR_BLOCK_BYTE, 0xF8)),
+  //// block 0 stuff:
+  BENCH("getUID",                       uint8_t UID[7]; tag.getUID(UID)),
+  BENCH("getCC",                        tag.getCC()),
+  BENCH("getCC(buff)",                  uint8_t CC[4]; tag.getCC(CC)),
+  BENCH("setCC",                        tag.setCC(NT3H1x01_CAPA_CONT_DEFAULT_uint32_t[tag.is2kVariant])),
+  BENCH("setCC(buff)",                  tag.setCC(NT3H1x01_CAPA_CONT_DEFAULT[tag.is2kVariant])),
+  BENCH("resetCC",                      tag.resetCC()),
+  BENCH("getATQA",                      tag.getATQA()),
+  BENCH("getATQA(buff)",                uint8_t ATQA[2]; tag.getATQA(ATQA)),
+  BENCH("getSAK",                       tag.getSAK()),
+  BENCH("getSAK(buff)",                 uint8_t SAK[1]; tag.getSAK(SAK)),
+  BENCH("setI2Caddress",                tag.setI2Caddress(NT3H1x01_DEFAULT_I2C_ADDRESS)),
+  BENCH("connectionCheck",              tag.connectionCheck()),
+  BENCH("variantCheck",                 tag.variantCheck()),
+  BENCH("probe",                        NT3H1x01_deviceInfo info; tag.probe(info)),
+  BENCH("getUID+getCC(useCache)",       uint8_t UID[7]; tag.getUID(UID); tag.getCC(true, true)),
+  //// user memory:
+  BENCH("readUserBlock",                tag.readUserBlock(0x01, blockBuff)),
+  BENCH("readUserBlock<>",              tag.readUserBlock<0x01>(blockBuff)),
+  BENCH("writeUserBlock",               tag.writeUserBlock(0x01, blockBuff)),
+  BENCH("writeUserBlock<>",             tag.writeUserBlock<0x01>(blockBuff)),
+  BENCH("writeUserBlock_P",             tag.writeUserBlock_P(0x01, blockBuff)),
+  BENCH("writeUserBlock(last block)",   tag.writeUserBlock(tag.memMap().userEnd, blockBuff)),
+  BENCH("writeUserBytes(40 bytes)",     tag.writeUserBytes(0x01, userData, sizeof(userData))),
+  BENCH("writeUserBytesFrom(40 bytes)", tag.writeUserBytesFrom(0x01, NT3H1x01_progmemSource{userData}, sizeof(userData))),
+  BENCH("findNdefEnd(empty tag)",                 uint8_t lastBlock; tag.findNdefEnd(lastBlock)),
+  BENCH("updateLastNdefBlock(empty tag)",        tag.updateLastNdefBlock()),
+  BENCH("updateLastNdefBlock(persistent,empty)", tag.updateLastNdefBlock(true)),
+  //// lock bits:
+  BENCH("readLocks",                    NT3H1x01_lockBits locks; tag.readLocks(locks)),
+  BENCH("lockArea",                     tag.lockArea(0x01, 0x03)),
+  //// generic field access:
+  BENCH("get<Sess FD_ON>",              NT3H1x01_FD_ON_ENUM val; tag.get<NT3H1x01_Sess_NC_FD_ON>(val, false)),
+  BENCH("getVal<Conf FD_ON>",           tag.getVal<NT3H1x01_Conf_NC_FD_ON>()),
+  //// Session registers:
+  BENCH("getSess_NC_REG",               tag.getSess_NC_REG()),
+  BENCH("getSess_NC_I2C_RST",           tag.getSess_NC_I2C_RST()),
+  BENCH("getSess_NC_FD_OFF",            tag.getSess_NC_FD_OFF()),
+  BENCH("getSess_NC_FD_ON",             tag.getSess_NC_FD_ON()),
+  BENCH("getSess_NC_DIR",               tag.getSess_NC_DIR()),
+  BENCH("getSess_NC_PTHRU",             tag.getSess_NC_PTHRU()),
+  BENCH("getSess_NC_MIRROR",            tag.getSess_NC_MIRROR()),
+  BENCH("getSess_LAST_NDEF_BLOCK",      tag.getSess_LAST_NDEF_BLOCK()),
+  BENCH("getSess_SRAM_MIRROR_BLOCK",    tag.getSess_SRAM_MIRROR_BLOCK()),
+  BENCH("getSess_WDTraw",               tag.getSess_WDTraw()),
+  BENCH("getSess_WDTraw(buff)",         uint8_t WDT[2]; tag.getSess_WDTraw(WDT)),
+  BENCH("getSess_WDT",                  tag.getSess_WDT()),
+  BENCH("getSess_I2C_CLOCK_STR",        tag.getSess_I2C_CLOCK_STR()),
+  BENCH("getNS_REG",                    tag.getNS_REG()),
+  BENCH("getNS_NDEF_DATA_READ",         tag.getNS_NDEF_DATA_READ()),
+  BENCH("getNS_I2C_LOCKED",             tag.getNS_I2C_LOCKED()),
+  BENCH("getNS_RF_LOCKED",              tag.getNS_RF_LOCKED()),
+  BENCH("getNS_SRAM_I2C_READY",         tag.getNS_SRAM_I2C_READY()),
+  BENCH("getNS_SRAM_RF_READY",          tag.getNS_SRAM_RF_READY()),
+  BENCH("getNS_EEPROM_WR_ERR",          tag.getNS_EEPROM_WR_ERR()),
+  BENCH("getNS_EEPROM_WR_BUSY",         tag.getNS_EEPROM_WR_BUSY()),
+  BENCH("getNS_RF_FIELD_PRESENT",       tag.getNS_RF_FIELD_PRESENT()),
+  BENCH("setSess_NC_REG",               tag.setSess_NC_REG(NT3H1x01_SESS_REGS_DEFAULT[0])),
+  BENCH("setSess_NC_I2C_RST",           tag.setSess_NC_I2C_RST(false)),
+  BENCH("setSess_NC_FD_OFF",            tag.setSess_NC_FD_OFF(NT3H1x01_FD_OFF_HALT)),
+  BENCH("setSess_NC_FD_ON",             tag.setSess_NC_FD_ON(NT3H1x01_FD_ON_TAG_SELECTED)),
+  BENCH("setSess_NC_DIR",               tag.setSess_NC_DIR(true)),
+  BENCH("setSess_NC_PTHRU",             tag.setSess_NC_PTHRU(true)),
+  BENCH("setSess_NC_MIRROR",            tag.setSess_NC_MIRROR(true)),
+  BENCH("setSess_LAST_NDEF_BLOCK",      tag.setSess_LAST_NDEF_BLOCK(0x02)),
+  BENCH("setSess_SRAM_MIRROR_BLOCK",    tag.setSess_SRAM_MIRROR_BLOCK(0x01)),
+  BENCH("setSess_WDTraw",               tag.setSess_WDTraw((uint16_t)0x0848)),
+  BENCH("setSess_WDTraw(buff)",         tag.setSess_WDTraw(defaultWDT)),
+  BENCH("setSess_WDT",                  tag.setSess_WDT(20000)),
+  BENCH("setNS_I2C_LOCKED",             tag.setNS_I2C_LOCKED(false)),
+  BENCH("clear_EEPROM_WR_ERR",          tag.clear_EEPROM_WR_ERR()),
+  BENCH("setSess_NC FD_ON+FD_OFF+DIR",  tag.setSess_NC_FD_ON(NT3H1x01_FD_ON_TAG_SELECTED); tag.setSess_NC_FD_OFF(NT3H1x01_FD_OFF_HALT); tag.setSess_NC_DIR(true)),
+  BENCH("set<Sess FD_ON,FD_OFF,DIR>",   (tag.set<NT3H1x01_Sess_NC_FD_ON, NT3H1x01_Sess_NC_FD_OFF, NT3H1x01_Sess_NC_DIR>(NT3H1x01_FD_ON_TAG_SELECTED, NT3H1x01_FD_OFF_HALT, true))),
+  //// Configuration registers:
+  BENCH("getConf_NC_REG",               tag.getConf_NC_REG()),
+  BENCH("getConf_NC_REG(buff)",         uint8_t regVal; tag.getConf_NC_REG(regVal)),
+  BENCH("getConf_NC_I2C_RST",           tag.getConf_NC_I2C_RST()),
+  BENCH("getConf_NC_FD_OFF",            tag.getConf_NC_FD_OFF()),
+  BENCH("getConf_NC_FD_ON",             tag.getConf_NC_FD_ON()),
+  BENCH("getConf_NC_DIR",               tag.getConf_NC_DIR()),
+  BENCH("getConf_LAST_NDEF_BLOCK",      tag.getConf_LAST_NDEF_BLOCK()),
+  BENCH("getConf_LAST_NDEF_BLOCK(buff)", uint8_t regVal; tag.getConf_LAST_NDEF_BLOCK(regVal)),
+  BENCH("getConf_SRAM_MIRROR_BLOCK",    tag.getConf_SRAM_MIRROR_BLOCK()),
+  BENCH("getConf_SRAM_MIRROR_BLOCK(buff)", uint8_t regVal; tag.getConf_SRAM_MIRROR_BLOCK(regVal)),
+  BENCH("getConf_WDTraw",               tag.getConf_WDTraw()),
+  BENCH("getConf_WDTraw(buff)",         uint8_t WDT[2]; tag.getConf_WDTraw(WDT)),
+  BENCH("getConf_WDT",                  tag.getConf_WDT()),
+  BENCH("getConf_I2C_CLOCK_STR",        tag.getConf_I2C_CLOCK_STR()),
+  BENCH("getConf_I2C_CLOCK_STR(buff)",  uint8_t regVal; tag.getConf_I2C_CLOCK_STR(regVal)),
+  BENCH("getREG_LOCK",                  tag.getREG_LOCK()),
+  BENCH("getREG_LOCK(buff)",            uint8_t regVal; tag.getREG_LOCK(regVal)),
+  BENCH("setConf_NC_REG",               tag.setConf_NC_REG(NT3H1x01_CONF_REGS_DEFAULT[0])),
+  BENCH("setConf_NC_I2C_RST",           tag.setConf_NC_I2C_RST(true)),
+  BENCH("setConf_NC_FD_OFF",            tag.setConf_NC_FD_OFF(NT3H1x01_FD_OFF_HALT)),
+  BENCH("setConf_NC_FD_ON",             tag.setConf_NC_FD_ON(NT3H1x01_FD_ON_TAG_SELECTED)),
+  BENCH("setConf_NC_DIR",               tag.setConf_NC_DIR(true)),
+  BENCH("setConf_LAST_NDEF_BLOCK",      tag.setConf_LAST_NDEF_BLOCK(0x02)),
+  BENCH("setConf_SRAM_MIRROR_BLOCK",    tag.setConf_SRAM_MIRROR_BLOCK(0x01)),
+  BENCH("setConf_WDTraw",               tag.setConf_WDTraw((uint16_t)0x0848)),
+  BENCH("setConf_WDTraw(buff)",         tag.setConf_WDTraw(defaultWDT)),
+  BENCH("setConf_WDT",                  tag.setConf_WDT(20000)),
+  BENCH("set_I2C_CLOCK_STR",            tag.set_I2C_CLOCK_STR(true)),
+  BENCH("setConf_NC FD_ON+DIR",         tag.setConf_NC_FD_ON(NT3H1x01_FD_ON_TAG_SELECTED); tag.setConf_NC_DIR(true)),
+  BENCH("setConf_NC FD_ON+DIR(useCache)", tag.setConf_NC_FD_ON(NT3H1x01_FD_ON_TAG_SELECTED); tag.setConf_NC_DIR(true, true)),
+  BENCH("set<Conf FD_ON,DIR>",          (tag.set<NT3H1x01_Conf_NC_FD_ON, NT3H1x01_Conf_NC_DIR>(NT3H1x01_FD_ON_TAG_SELECTED, true))),
+  //// bulk:
+  BENCH("resetConfiguration",           tag.resetConfiguration()),
+  BENCH("saveSessionToConfiguration",   tag.saveSessionToConfiguration()),
+  BENCH("reloadConfiguration",          tag.reloadConfiguration()),
+  BENCH("applyConfiguration(changed)",  NT3H1x01_desiredConfig desired; desired.set<NT3H1x01_Conf_NC_FD_ON>(NT3H1x01_FD_ON_TAG_SELECTED); desired.set<NT3H1x01_Conf_NC_DIR>(true); desired.setBoth_WDTraw(0x0848);
+                                        tag.applyConfiguration(desired)),
+  BENCH("applyConfiguration(unchanged)", NT3H1x01_desiredConfig desired; desired.setBoth(NT3H1x01_COMN_REGS_NC_REG_BYTE, NT3H1x01_CONF_REGS_DEFAULT[0]); desired.setBoth_WDTraw(0x0848); // (the factory defaults)
+                                        tag.applyConfiguration(desired)),
+};
+const size_t benchCount = sizeof(benchmarks) / sizeof(benchmarks[0]);
+
+/**
+ * run one benchmark on a freshly reset tag
+ */
+benchResult runBench(const benchEntry& entry, bool is2kVariant) {
+  static NT3H1x01_simTag simTag(is2kVariant); // (static, it's 4kB)
+  simTag.is2kVariant = is2kVariant;  simTag.factoryReset();
+  NT3H1x01_thijs tag(is2kVariant);  tag.init(simTag);
+  entry.func(tag);
+  benchResult result;
+  result.name = entry.name;
+  result.is2kVariant = is2kVariant;
+  result.transactions = simTag.writeTransactions + simTag.readTransactions;
+  result.bytes = simTag.bytesWritten + simTag.bytesRead;
+  result.eepromWrites = simTag.eepromBlockWrites;
+  result.micros100k = simTag.modelledBusMicros(100000);
+  result.micros400k = simTag.modelledBusMicros(400000);
+  result.micros1M = simTag.modelledBusMicros(1000000);
+  //// and again, with the timing model:
+  simTag.factoryReset();  simTag.enableTiming(400000);
+  NT3H1x01_thijs timedTag(is2kVariant);  timedTag.init(simTag);
+  entry.func(timedTag);
+  result.timedMicros = (simTag.eepromBusyUntil > simTag.virtualMicros) ? simTag.eepromBusyUntil : simTag.virtualMicros;
+  simTag.timingModel = false;
+  return(result);
+}
+
+/**
+ * look up a benchmark in the baseline file
+ * @return true if found
+ */
+bool findBaseline(FILE* baselineFile, const char* name, bool is2kVariant, uint32_t& transactions, uint32_t& bytes, uint32_t& eepromWrites, uint32_t& timedMicros) {
+  rewind(baselineFile);
+  char line[160];
+  while(fgets(line, sizeof(line), baselineFile)) {
+    if(line[0] == '#') { continue; }
+    char* separator = strchr(line, '\t'); // (names contain spaces, so the name is terminated by a tab)
+    if(!separator) { continue; }
+    *separator = '\0';
+    if(strcmp(line, name) != 0) { continue; }
+    char variant[4];
+    if(sscanf(separator+1, "%3s %u %u %u %u", variant, &transactions, &bytes, &eepromWrites, &timedMicros) != 5) { continue; }
+    if(strcmp(variant, is2kVariant ? "2k" : "1k") == 0) { return(true); }
+  }
+  return(false);
+}
+
+int main(int argc, char* argv[]) {
+  const char* baselinePath = (argc > 1) ? argv[1] : "baseline.txt";
+  bool update = (argc > 2) && (strcmp(argv[2], "--update") == 0);
+
+  const size_t resultCount = 2 * benchCount;
+  benchResult results[resultCount];
+  for(size_t i=0; i<benchCount; i++) { results[i] = runBench(benchmarks[i], false);  results[benchCount + i] = runBench(benchmarks[i], true); } // (the 1k and 2k variants differ in addresses and user memory size)
+
+  printf("%-40s %3s %6s %6s %6s %10s %10s %10s %10s\n", "function", "", "trans.", "bytes", "EEPROM", "us@100kHz", "us@400kHz", "us@1MHz", "timed(us)");
+  for(size_t i=0; i<resultCount; i++) {
+    const benchResult& r = results[i];
+    printf("%-40s %3s %6u %6u %6u %10u %10u %10u %10u\n", r.name, r.is2kVariant ? "2k" : "1k", r.transactions, r.bytes, r.eepromWrites, r.micros100k, r.micros400k, r.micros1M, r.timedMicros);
+  }
+
+  if(update) {
+    FILE* baselineFile = fopen(baselinePath, "w");
+    if(!baselineFile) { printf("can't write %s\n", baselinePath); return(2); }
+    fprintf(baselineFile, "# NT3H1x01_thijs bus cost baseline (generated by the benchmark with --update)\n# function\tvariant transactions bytes EEPROMwrites timedMicros\n");
+    for(size_t i=0; i<resultCount; i++) { fprintf(baselineFile, "%s\t%s %u %u %u %u\n", results[i].name, results[i].is2kVariant ? "2k" : "1k", results[i].transactions, results[i].bytes, results[i].eepromWrites, results[i].timedMicros); }
+    fclose(baselineFile);
+    printf("\nbaseline updated: %s\n", baselinePath);
+    return(0);
+  }
+
+  FILE* baselineFile = fopen(baselinePath, "r");
+  if(!baselineFile) { printf("\nno baseline (%s), run with --update to create one\n", baselinePath); return(2); }
+  uint16_t regressions = 0, improvements = 0;
+  printf("\n");
+  for(size_t i=0; i<resultCount; i++) {
+    const benchResult& r = results[i];
+    uint32_t transactions, bytes, eepromWrites, timedMicros;
+    if(!findBaseline(baselineFile, r.name, r.is2kVariant, transactions, bytes, eepromWrites, timedMicros)) { printf("NEW:        %s (%s, not in baseline)\n", r.name, r.is2kVariant ? "2k" : "1k"); continue; }
+    if((r.transactions > transactions) || (r.bytes > bytes) || (r.eepromWrites > eepromWrites) || (r.timedMicros > timedMicros)) {
+      printf("REGRESSION: %s (%s)  %u/%u/%u/%uus -> %u/%u/%u/%uus\n", r.name, r.is2kVariant ? "2k" : "1k", transactions, bytes, eepromWrites, timedMicros, r.transactions, r.bytes, r.eepromWrites, r.timedMicros);  regressions++;
+    } else if((r.transactions < transactions) || (r.bytes < bytes) || (r.eepromWrites < eepromWrites) || (r.timedMicros < timedMicros)) {
+      printf("improved:   %s (%s)  %u/%u/%u/%uus -> %u/%u/%u/%uus\n", r.name, r.is2kVariant ? "2k" : "1k", transactions, bytes, eepromWrites, timedMicros, r.transactions, r.bytes, r.eepromWrites, r.timedMicros);  improvements++;
+    }
+  }
+  fclose(baselineFile);
+  printf("%u regressions, %u improvements%s\n", regressions, improvements, improvements ? " (run with --update to lock them in)" : "");
+  return(regressions ? 1 : 0);
+}
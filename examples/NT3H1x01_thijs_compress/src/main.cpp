@@ -0,0 +1,191 @@
+/*
+
+Benchmark of the compression codec (see NT3H1x01_thijs_compress.h) on a host PC:
+for a few kinds of payload (~1600 bytes each), it prints the compression ratio, how fast it encodes/decodes (wall clock, on this PC),
+ and what storing it on a (simulated) 2k tag costs, raw vs. compressed (streamed through the encoder/decoder, see NT3H1x01_thijs_stream.h).
+Every payload is read back from the tag and compared to the original.
+
+usage (from this folder, after building, see README.txt):
+  compress    prints one line per payload, exits with 1 if anything doesn't come back the same (or telemetry doesn't compress)
+
+NOTE: the speeds are from the wall clock, so they depend on the PC (and on how it was compiled), unlike the other numbers.
+
+*/
+
+#define NT3H1x01_useSimulator
+
+#include "NT3H1x01_thijs_compress.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <chrono>
+
+#define PAYLOAD_SIZE 1600 // (even random data still fits in the 2k variant after 'compression')
+#define SPEED_REPEATS 200
+
+static NT3H1x01_simTag simTag(true); // (static, it's 4kB)
+
+/**
+ * a RAM buffer as a NT3H1x01_streamReadFunc/NT3H1x01_streamWriteFunc
+ */
+struct memBuffer
+{
+  uint8_t data[2048];  uint16_t size = 0,  pos = 0;
+  static size_t read(uint8_t buff[], size_t length, void* context) {
+    memBuffer& self = *(memBuffer*)context;
+    if(length > (size_t)(self.size - self.pos)) { length = self.size - self.pos; }
+    memcpy(buff, &self.data[self.pos], length);  self.pos += length;
+    return(length);
+  }
+  static size_t write(const uint8_t data[], size_t length, void* context) {
+    memBuffer& self = *(memBuffer*)context;
+    if(length > (sizeof(self.data) - self.size)) { length = sizeof(self.data) - self.size; }
+    memcpy(&self.data[self.size], data, length);  self.size += length;
+    return(length);
+  }
+};
+
+//// the payloads:
+static uint32_t prng = 1;
+uint32_t nextRandom() { prng ^= prng << 13;  prng ^= prng >> 17;  prng ^= prng << 5;  return(prng); } // (xorshift32, repeatable)
+
+/**
+ * text telemetry: one line per minute, values that drift a little
+ */
+uint16_t makeCsvTelemetry(uint8_t buff[]) {
+  uint16_t size = 0;  int temp = 2137,  hum = 452,  bat = 371;
+  for(uint32_t t=1697712000; ; t+=60) {
+    char line[80];
+    int length = snprintf(line, sizeof(line), "t=%u,temp=%d.%02d,hum=%d.%d,bat=%d.%02d,rssi=-%u\n", t, temp/100, temp%100, hum/10, hum%10, bat/100, bat%100, 60 + nextRandom()%8);
+    if((size + length) > PAYLOAD_SIZE) { break; }
+    memcpy(&buff[size], line, length);  size += length;
+    temp += (int)(nextRandom() % 7) - 3;  hum += (int)(nextRandom() % 3) - 1;  bat -= !(nextRandom() % 8);
+  }
+  return(size);
+}
+/**
+ * the same, as JSON
+ */
+uint16_t makeJsonTelemetry(uint8_t buff[]) {
+  uint16_t size = 0;  int temp = 2137,  hum = 452;
+  for(uint32_t t=1697712000; ; t+=60) {
+    char line[96];
+    int length = snprintf(line, sizeof(line), "{\"ts\":%u,\"temp\":%d.%02d,\"hum\":%d.%d,\"door\":\"%s\"},", t, temp/100, temp%100, hum/10, hum%10, (nextRandom() % 5) ? "closed" : "open");
+    if((size + length) > PAYLOAD_SIZE) { break; }
+    memcpy(&buff[size], line, length);  size += length;
+    temp += (int)(nextRandom() % 7) - 3;  hum += (int)(nextRandom() % 3) - 1;
+  }
+  return(size);
+}
+/**
+ * binary telemetry: packed records (timestamp, 3 readings and a status byte), 12 bytes each
+ */
+uint16_t makeBinaryTelemetry(uint8_t buff[]) {
+  uint16_t size = 0;  uint32_t t = 1697712000;  int16_t temp = 2137;  uint16_t hum = 452,  bat = 3710;
+  while((size + 12) <= PAYLOAD_SIZE) {
+    uint8_t* rec = &buff[size];
+    rec[0] = t >> 24;  rec[1] = t >> 16;  rec[2] = t >> 8;  rec[3] = t;
+    rec[4] = temp >> 8;  rec[5] = temp;  rec[6] = hum >> 8;  rec[7] = hum;  rec[8] = bat >> 8;  rec[9] = bat;
+    rec[10] = 0x01;  rec[11] = 0;
+    size += 12;  t += 60;
+    temp += (int)(nextRandom() % 7) - 3;  hum += (int)(nextRandom() % 3) - 1;  bat -= !(nextRandom() % 8);
+  }
+  return(size);
+}
+/**
+ * (English) text
+ */
+uint16_t makeText(uint8_t buff[]) {
+  const char* words[] = {"the", "tag", "reads", "a", "message", "when", "phone", "is", "near", "and", "writes", "data", "to", "memory", "of", "NFC", "field", "block", "user", "with"};
+  uint16_t size = 0;
+  while(true) {
+    const char* word = words[nextRandom() % (sizeof(words)/sizeof(words[0]))];  uint16_t length = strlen(word);
+    if((size + length + 1) > PAYLOAD_SIZE) { break; }
+    memcpy(&buff[size], word, length);  size += length;
+    buff[size++] = (nextRandom() % 12) ? ' ' : '\n';
+  }
+  return(size);
+}
+/**
+ * random bytes (the worst case, nothing repeats)
+ */
+uint16_t makeRandom(uint8_t buff[]) {
+  for(uint16_t i=0; i<PAYLOAD_SIZE; i++) { buff[i] = nextRandom(); }
+  return(PAYLOAD_SIZE);
+}
+
+/**
+ * measure the codec on a payload, and store it on the tag (raw and compressed)
+ * @param name what the payload is (for printing)
+ * @param payload the payload
+ * @param compressedBlocks (reference) blocks written for the compressed version
+ * @param rawBlocks (reference) blocks written for the raw version
+ * @return true if everything came back the same
+ */
+bool measure(const char* name, const memBuffer& payload, uint8_t& compressedBlocks, uint8_t& rawBlocks) {
+  NT3H1x01_thijs nfc(true);  nfc.init(simTag);
+  uint8_t compressed[2048];  uint8_t decompressed[2048];  uint16_t compressedSize = 0,  decompressedSize = 0;
+  //// speed (RAM to RAM):
+  auto start = std::chrono::steady_clock::now();
+  for(uint16_t i=0; i<SPEED_REPEATS; i++) { compressedSize = NT3H1x01_lzCompress(payload.data, payload.size, compressed, sizeof(compressed)); }
+  auto middle = std::chrono::steady_clock::now();
+  bool good = (compressedSize > 0);
+  for(uint16_t i=0; i<SPEED_REPEATS; i++) { good &= NT3H1x01_lzDecompress(compressed, compressedSize, decompressed, sizeof(decompressed), decompressedSize); }
+  auto end = std::chrono::steady_clock::now();
+  good &= (decompressedSize == payload.size) && (memcmp(decompressed, payload.data, payload.size) == 0);
+  double encodeSeconds = std::chrono::duration<double>(middle - start).count(),  decodeSeconds = std::chrono::duration<double>(end - middle).count();
+  double encodeMBps = (payload.size * (double)SPEED_REPEATS) / encodeSeconds / 1e6,  decodeMBps = (payload.size * (double)SPEED_REPEATS) / decodeSeconds / 1e6;
+  //// raw on the tag:
+  memBuffer source = payload;  source.pos = 0;
+  NT3H1x01_streamResult result;
+  uint32_t writesBefore = simTag.eepromBlockWrites;
+  good &= nfc._errGood(NT3H1x01_streamToTag(nfc, memBuffer::read, &source, result, 0, false));
+  rawBlocks = result.blocks;
+  uint32_t rawWrites = simTag.eepromBlockWrites - writesBefore;
+  //// compressed on the tag (streamed, the payload is never compressed into RAM as a whole):
+  source.pos = 0;
+  NT3H1x01_lzEncoder encoder(memBuffer::read, &source);
+  writesBefore = simTag.eepromBlockWrites;
+  good &= nfc._errGood(NT3H1x01_streamToTag(nfc, NT3H1x01_lzEncoder::read, &encoder, result, 0, false));
+  compressedBlocks = result.blocks;
+  uint32_t compressedWrites = simTag.eepromBlockWrites - writesBefore;
+  good &= (encoder.bytesIn == payload.size) && (encoder.bytesOut == compressedSize);
+  //// and back (up to LAST_NDEF_BLOCK, the decoder ignores the padding after the end):
+  memBuffer sink;
+  NT3H1x01_lzDecoder decoder(memBuffer::write, &sink);
+  good &= nfc._errGood(NT3H1x01_streamFromTag(nfc, NT3H1x01_lzDecoder::write, &decoder, result)) && decoder.finish();
+  good &= (sink.size == payload.size) && (memcmp(sink.data, payload.data, payload.size) == 0);
+  printf("%-18s %5u %5u %6.1f%% %8.1f %8.1f %7u %7u %6.1f%%  %s\n", name, payload.size, compressedSize, 100.0 * compressedSize / payload.size,
+         encodeMBps, decodeMBps, rawWrites, compressedWrites, 100.0 * compressedWrites / rawWrites, good ? "OK" : "MISMATCH");
+  return(good);
+}
+
+int main() {
+  bool good = true;
+  printf("(window: %u bytes, lookahead: %u bytes)\n", NT3H1x01_LZ_WINDOW, NT3H1x01_LZ_LOOKAHEAD);
+  printf("%-18s %5s %5s %7s %8s %8s %7s %7s %7s\n", "payload", "raw", "comp", "ratio", "enc MB/s", "dec MB/s", "raw wr", "comp wr", "writes");
+  memBuffer payload;  uint8_t compressedBlocks, rawBlocks;
+  payload.size = makeCsvTelemetry(payload.data);
+  good &= measure("telemetry (CSV)", payload, compressedBlocks, rawBlocks);
+  good &= ((compressedBlocks * 10) <= (rawBlocks * 6)); // (at least 40% fewer blocks)
+  payload.size = makeJsonTelemetry(payload.data);
+  good &= measure("telemetry (JSON)", payload, compressedBlocks, rawBlocks);
+  good &= ((compressedBlocks * 10) <= (rawBlocks * 6));
+  payload.size = makeBinaryTelemetry(payload.data);
+  good &= measure("telemetry (binary)", payload, compressedBlocks, rawBlocks);
+  payload.size = makeText(payload.data);
+  good &= measure("text", payload, compressedBlocks, rawBlocks);
+  payload.size = makeRandom(payload.data);
+  good &= measure("random", payload, compressedBlocks, rawBlocks);
+  //// malformed data is caught:
+  uint8_t compressed[2048],  decompressed[2048];  uint16_t size;
+  uint16_t compressedSize = NT3H1x01_lzCompress(payload.data, 100, compressed, sizeof(compressed));
+  bool truncated = NT3H1x01_lzDecompress(compressed, compressedSize - 1, decompressed, sizeof(decompressed), size); // (no end marker)
+  compressed[0] = 'X';
+  bool badHeader = NT3H1x01_lzDecompress(compressed, compressedSize, decompressed, sizeof(decompressed), size);
+  printf("truncated data: %s, bad header: %s\n", truncated ? "ACCEPTED" : "rejected", badHeader ? "ACCEPTED" : "rejected");
+  good &= !truncated && !badHeader;
+  printf(good ? "compression OK\n" : "FAILED\n");
+  return(good ? 0 : 1);
+}
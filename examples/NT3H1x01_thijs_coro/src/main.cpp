@@ -0,0 +1,191 @@
+/*
+
+Runs the same sequence of operations with the coroutine API (see NT3H1x01_thijs_coro.h) and with the regular (blocking) API, on a host PC,
+ each on its own simulated 2k tag (with the timing model on, see enableTiming()), and reports both.
+The sequence (repeated ROUNDS times): read block 0, wait until a (simulated) phone comes near (FD pin goes LOW),
+ write a 100 byte payload to the user memory, read it back, read NS_REG and set SRAM_MIRROR_BLOCK.
+Afterwards (on a 1k tag), writeUserMemory() must refuse to write block 0, a locked block and the Dynamic Locking bytes (like writeUserBytes() does).
+The phone is a separate thread, so fdEdge() (and the coroutine it resumes) runs on a different thread than the worker, like it would on an ESP32.
+
+Both tags must end up exactly the same (memory, Session registers, number of transactions and EEPROM writes, bus time),
+ the difference is how long the calling thread is blocked: the blocking API blocks it for all of it, the coroutine only until its first co_await.
+
+NOTE: 'bus (us)' is the modelled bus time (virtual clock of the simulated tag), the other times are from the wall clock (the simulated tag isn't paced here).
+
+usage (from this folder, after building, see README.txt):
+  coro        prints what both APIs cost, exits with 1 if anything failed, the two tags don't end up the same or a write wasn't refused
+
+*/
+
+#define NT3H1x01_useSimulator
+
+#include "NT3H1x01_thijs_coro.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define ROUNDS 3
+#define PAYLOAD_SIZE 100
+#define PAYLOAD_BLOCKS ((PAYLOAD_SIZE + NT3H1x01_BLOCK_SIZE - 1) / NT3H1x01_BLOCK_SIZE)
+
+static NT3H1x01_simTag simSync(true), simCoro(true); // (static, they're 4kB each)
+
+/**
+ * what one run of the sequence found
+ */
+struct flowResult
+{
+  std::atomic<uint8_t> round{0}; // rounds finished (also tells the phone when to come near again)
+  uint8_t block0[NT3H1x01_BLOCK_SIZE];
+  uint8_t NS_REG = 0;
+  uint16_t errors = 0,  mismatches = 0;
+};
+
+/**
+ * the payload of a round
+ */
+void makePayload(uint8_t round, uint8_t payload[]) { for(uint8_t i=0; i<PAYLOAD_SIZE; i++) { payload[i] = (round * 41) ^ (i * 3); } }
+
+//// the blocking API:
+std::atomic<bool> syncFieldOn{false}; // (the blocking version has to poll the FD pin, this is the pin)
+
+void syncFlow(NT3H1x01_thijs& nfc, flowResult& result) {
+  static uint8_t payload[PAYLOAD_SIZE];
+  for(uint8_t round=0; round<ROUNDS; round++) {
+    result.errors += !nfc._errGood(nfc.requestMemBlock(0, result.block0));
+    while(!syncFieldOn) { std::this_thread::sleep_for(std::chrono::microseconds(100)); } // wait for the phone
+    syncFieldOn = false;
+    makePayload(round, payload);
+    result.errors += !nfc._errGood(nfc.writeUserBytes(1, payload, PAYLOAD_SIZE));
+    for(uint8_t i=0; i<PAYLOAD_BLOCKS; i++) {
+      uint8_t block[NT3H1x01_BLOCK_SIZE];
+      result.errors += !nfc._errGood(nfc.requestMemBlock(1 + i, block));
+      uint16_t remaining = PAYLOAD_SIZE - (i * NT3H1x01_BLOCK_SIZE);
+      result.mismatches += (memcmp(block, &payload[i * NT3H1x01_BLOCK_SIZE], (remaining < NT3H1x01_BLOCK_SIZE) ? remaining : NT3H1x01_BLOCK_SIZE) != 0);
+    }
+    result.errors += !nfc._errGood(nfc.requestSessRegByte(NT3H1x01_SESS_REGS_NS_REG_BYTE, result.NS_REG));
+    result.errors += !nfc._errGood(nfc.writeSessRegByte(NT3H1x01_COMN_REGS_SRAM_MIRROR_BLOCK_BYTE, 0xF0 + round));
+    result.round++;
+  }
+}
+
+//// the coroutine API:
+NT3H1x01_coTask coroFlow(NT3H1x01_coTag& coTag, flowResult& result) {
+  static uint8_t payload[PAYLOAD_SIZE]; // (must stay valid until writeUserMemory() is done)
+  for(uint8_t round=0; round<ROUNDS; round++) {
+    NT3H1x01_coBlock block0 = co_await coTag.readBlock(0);
+    result.errors += !coTag.worker.tag._errGood(block0.err);  memcpy(result.block0, block0.data, NT3H1x01_BLOCK_SIZE);
+    co_await coTag.waitForEvent(NT3H1x01_CO_FD_ON); // wait for the phone
+    makePayload(round, payload);
+    result.errors += !coTag.worker.tag._errGood(co_await coTag.writeUserMemory(1, payload, PAYLOAD_SIZE));
+    for(uint8_t i=0; i<PAYLOAD_BLOCKS; i++) {
+      NT3H1x01_coBlock block = co_await coTag.readBlock(1 + i);
+      result.errors += !coTag.worker.tag._errGood(block.err);
+      uint16_t remaining = PAYLOAD_SIZE - (i * NT3H1x01_BLOCK_SIZE);
+      result.mismatches += (memcmp(block.data, &payload[i * NT3H1x01_BLOCK_SIZE], (remaining < NT3H1x01_BLOCK_SIZE) ? remaining : NT3H1x01_BLOCK_SIZE) != 0);
+    }
+    result.NS_REG = co_await coTag.readSessReg(NT3H1x01_SESS_REGS_NS_REG_BYTE);
+    result.errors += !coTag.worker.tag._errGood(co_await coTag.writeSessReg(NT3H1x01_COMN_REGS_SRAM_MIRROR_BLOCK_BYTE, 0xF0 + round));
+    result.round++;
+  }
+}
+
+//// writeUserMemory() must refuse what writeUserBytes() refuses (on a 1k tag, see guardChecks()):
+struct guardResult
+{
+  std::atomic<bool> done{false};
+  bool block0refused = false,  lockedRefused = false,  sharedBlockRefused = false,  sharedBlockGood = false;
+};
+
+NT3H1x01_coTask guardFlow(NT3H1x01_coTag& coTag, uint8_t lockedBlock, guardResult& result) {
+  static const uint8_t data[NT3H1x01_BLOCK_SIZE] = {0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA};
+  NT3H1x01_thijs& tag = coTag.worker.tag;
+  result.block0refused = !tag._errGood(co_await coTag.writeUserMemory(0x00, data, NT3H1x01_BLOCK_SIZE)); // (I2C address and Static Locking bytes)
+  result.lockedRefused = !tag._errGood(co_await coTag.writeUserMemory(lockedBlock, data, NT3H1x01_BLOCK_SIZE));
+  result.sharedBlockRefused = !tag._errGood(co_await coTag.writeUserMemory(0x38, data, NT3H1x01_BLOCK_SIZE)); // (only 8 user bytes in there on the 1k variant)
+  result.sharedBlockGood = tag._errGood(co_await coTag.writeUserMemory(0x38, data, 8));
+  result.done = true;
+}
+
+/**
+ * try to write outside the user memory, into a locked block and over the Dynamic Locking bytes (with the coroutine API), none of which may change anything
+ * @return whether all of it was refused (and the tag is untouched)
+ */
+bool guardChecks() {
+  static NT3H1x01_simTag simGuard(false);
+  NT3H1x01_thijs nfc(false);  nfc.init(simGuard);
+  nfc.lockArea(0x04, 0x0B); // (before the worker starts, the worker owns the tag after that)
+  uint8_t lockedBlock = 0x04;  while(!nfc.isLocked(lockedBlock)) { lockedBlock++; } // (lockArea() may round the area to what 1 lock bit covers)
+  uint8_t memBefore[sizeof(simGuard.mem)];  memcpy(memBefore, simGuard.mem, sizeof(memBefore));
+  NT3H1x01_worker worker(nfc);  worker.start();
+  NT3H1x01_coTag coTag(worker);
+  guardResult result;
+  guardFlow(coTag, lockedBlock, result);
+  while(!result.done) { std::this_thread::sleep_for(std::chrono::microseconds(100)); }
+  worker.stop();
+  const NT3H1x01_memMap memMap = nfc.memMap();
+  bool sharedBlockWritten = (memcmp(simGuard.mem[0x38], memBefore + (0x38 * NT3H1x01_BLOCK_SIZE), memMap.dynaLockByte) != 0);
+  memcpy(memBefore + (0x38 * NT3H1x01_BLOCK_SIZE), simGuard.mem[0x38], memMap.dynaLockByte); // (the only thing that should have changed)
+  bool untouched = (memcmp(simGuard.mem, memBefore, sizeof(memBefore)) == 0);
+  printf("writeUserMemory() refuses block 0: %s, a locked block: %s, the Dynamic Locking bytes: %s, tag otherwise untouched: %s\n",
+         result.block0refused ? "yes" : "NO", result.lockedRefused ? "yes" : "NO", (result.sharedBlockRefused && result.sharedBlockGood && sharedBlockWritten) ? "yes" : "NO", untouched ? "yes" : "NO");
+  return(result.block0refused && result.lockedRefused && result.sharedBlockRefused && result.sharedBlockGood && sharedBlockWritten && untouched);
+}
+
+/**
+ * the phone: comes near the tag once per round (after a little while), until the flow finished all rounds
+ * @param coTag the coroutine front end (NULL for the blocking version, then it 'sets the FD pin' instead)
+ */
+void phone(NT3H1x01_coTag* coTag, flowResult* result) {
+  while(result->round < ROUNDS) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    if(coTag) { coTag->fdEdge(true);  coTag->fdEdge(false); } // (field off, field on. Edges with nobody waiting are just ignored)
+    else { syncFieldOn = true; }
+  }
+}
+
+/**
+ * print a run
+ */
+void report(const char* name, const NT3H1x01_simTag& sim, const flowResult& result, double blockedSeconds, double totalSeconds) {
+  printf("%-10s %6u %6u %7u %9u %10.2f %9.2f   %u errors, %u mismatches\n", name, sim.writeTransactions, sim.readTransactions, sim.eepromBlockWrites,
+         (uint32_t)sim.virtualMicros, blockedSeconds * 1000, totalSeconds * 1000, result.errors, result.mismatches);
+}
+
+int main() {
+  printf("%-10s %6s %6s %7s %9s %10s %9s\n", "API", "writes", "reads", "EEPROM", "bus (us)", "blocked ms", "total ms");
+  //// blocking:
+  NT3H1x01_thijs nfcSync(true);  nfcSync.init(simSync);  simSync.enableTiming(400000);
+  flowResult syncResult;
+  auto start = std::chrono::steady_clock::now();
+  std::thread syncPhone(phone, (NT3H1x01_coTag*)NULL, &syncResult);
+  syncFlow(nfcSync, syncResult);
+  double syncSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  syncPhone.join();
+  report("blocking", simSync, syncResult, syncSeconds, syncSeconds);
+
+  //// coroutine:
+  NT3H1x01_thijs nfcCoro(true);  nfcCoro.init(simCoro);  simCoro.enableTiming(400000);
+  NT3H1x01_worker worker(nfcCoro);  worker.start();
+  NT3H1x01_coTag coTag(worker);
+  flowResult coroResult;
+  start = std::chrono::steady_clock::now();
+  std::thread coroPhone(phone, &coTag, &coroResult);
+  coroFlow(coTag, coroResult); // (returns at the first co_await, the rest runs on the worker and the phone thread)
+  double blockedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  while(coroResult.round < ROUNDS) { std::this_thread::sleep_for(std::chrono::microseconds(100)); } // (the caller is free to do other things here)
+  double coroSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  coroPhone.join();
+  worker.stop();
+  report("coroutine", simCoro, coroResult, blockedSeconds, coroSeconds);
+
+  bool same = (memcmp(simSync.mem, simCoro.mem, sizeof(simSync.mem)) == 0) && (memcmp(simSync.sessRegs, simCoro.sessRegs, sizeof(simSync.sessRegs)) == 0)
+           && (simSync.writeTransactions == simCoro.writeTransactions) && (simSync.readTransactions == simCoro.readTransactions)
+           && (simSync.eepromBlockWrites == simCoro.eepromBlockWrites) && (simSync.virtualMicros == simCoro.virtualMicros)
+           && (memcmp(syncResult.block0, coroResult.block0, NT3H1x01_BLOCK_SIZE) == 0) && (syncResult.NS_REG == coroResult.NS_REG);
+  bool guarded = guardChecks();
+  bool good = same && guarded && (syncResult.errors == 0) && (syncResult.mismatches == 0) && (coroResult.errors == 0) && (coroResult.mismatches == 0);
+  printf("both tags the same: %s\n", same ? "yes" : "NO");
+  printf(good ? "coroutines OK\n" : "FAILED\n");
+  return(good ? 0 : 1);
+}
@@ -0,0 +1,110 @@
+/*
+
+Demonstrates dynamic NDEF content (see NT3H1x01_thijs_dynamic.h) on a host PC:
+a message with a tap counter in a URL is written to EEPROM once, and the counter is then served from SRAM (Memory-Mirror mode).
+A (simulated) phone reads the message 100 times (what the RF side sees, with simTag.rfReadBlock()), and after every read,
+ service() sees NDEF_DATA_READ and refreshes the counter, which costs 1 SRAM block write (and 0 EEPROM writes).
+
+usage (from this folder, after building, see README.txt):
+  dynamic     prints what every step cost, exits with 1 if the phone ever reads the wrong counter
+
+*/
+
+#define NT3H1x01_useSimulator
+
+#include "NT3H1x01_thijs_dynamic.h"
+
+#include <stdio.h>
+#include <string.h>
+
+//// the message (the record array must be global (or static) for the compile-time encoder to point to it)
+constexpr NT3H1x01_ndefRecordData records[] = {NT3H1x01_ndefText("en", "Visitor log, tap for your number"),
+                                               NT3H1x01_ndefUri(NT3H1x01_URI_HTTPS, "example.com/tap?n=00000000")};
+constexpr NT3H1x01_ndefMessageData message = NT3H1x01_ndefMessage(records);
+static constexpr auto image = NT3H1x01_NDEF_IMAGE(message);
+#define COUNTER_RECORD 1
+#define COUNTER_OFFSET 19 // (in the URI payload: the prefix code byte and "example.com/tap?n=")
+#define COUNTER_DIGITS 8
+
+static NT3H1x01_simTag simTag(false); // (static, it's 4kB)
+
+/**
+ * NT3H1x01_dynamicRefreshFunc that counts up, in decimal
+ * @param field the counter digits (on the tag)
+ * @param length number of digits
+ * @param context pointer to the uint32_t counter
+ */
+void fillCounter(uint8_t field[], uint8_t length, void* context) {
+  uint32_t& counter = *(uint32_t*)context;
+  counter++;
+  uint32_t val = counter;
+  for(uint8_t i=length; i>0; i--) { field[i-1] = '0' + (val % 10);  val /= 10; }
+}
+
+/**
+ * read the message like a phone would (from the RF side), and pick the counter out of the URI record
+ * @param lastBlock the last block the phone reads (LAST_NDEF_BLOCK)
+ * @return the counter, or -1 if the message doesn't parse
+ */
+int32_t phoneTap(uint8_t lastBlock) {
+  uint8_t userMem[NT3H1x01_DYNAMIC_WINDOW_SIZE * 4];  uint16_t size = 0;
+  for(uint8_t blockAddress=1; (blockAddress<=lastBlock) && ((size_t)(size + NT3H1x01_BLOCK_SIZE) <= sizeof(userMem)); blockAddress++) {
+    simTag.rfReadBlock(blockAddress, &userMem[size]);  size += NT3H1x01_BLOCK_SIZE;
+  }
+  NT3H1x01_tlv tlv;  NT3H1x01_ndefRecord rec;  bool found = false;
+  if(!NT3H1x01_findTLV(userMem, size, NT3H1x01_TLV_NDEF, tlv)) { return(-1); }
+  uint16_t pos = tlv.valueOffset;
+  for(uint8_t i=0; (i<=COUNTER_RECORD) && NT3H1x01_nextNdefRecord(userMem, tlv.valueOffset + tlv.length, pos, rec); i++) { found = (i == COUNTER_RECORD); }
+  if(!found || (rec.payloadLength < (COUNTER_OFFSET + COUNTER_DIGITS))) { return(-1); }
+  int32_t counter = 0;
+  for(uint8_t i=0; i<COUNTER_DIGITS; i++) {
+    uint8_t digit = userMem[rec.payloadOffset + COUNTER_OFFSET + i];
+    if((digit < '0') || (digit > '9')) { return(-1); }
+    counter = counter * 10 + (digit - '0');
+  }
+  return(counter);
+}
+
+int main() {
+  bool good = true;
+  NT3H1x01_thijs nfc(false);  nfc.init(simTag);
+  NT3H1x01_dynamicNdef<NT3H1x01_VARIANT_RUNTIME> dynamic(nfc);
+  uint32_t counter = 0;
+
+  //// the first begin() writes the message, the second one finds it already there:
+  NT3H1x01_ERR_RETURN_TYPE err = dynamic.begin(image.bytes, sizeof(image.bytes), COUNTER_RECORD, COUNTER_OFFSET, COUNTER_DIGITS);
+  printf("begin():  %s, %u EEPROM blocks written, SRAM mirrored over blocks 0x%02X~0x%02X, LAST_NDEF_BLOCK 0x%02X\n", nfc._errGood(err) ? "OK" : "FAIL",
+         dynamic.eepromBlockWrites, dynamic.mirrorBlock, dynamic.mirrorBlock + NT3H1x01_DYNAMIC_WINDOW_BLOCKS - 1, dynamic.lastNdefBlock);
+  good &= nfc._errGood(err);
+  err = dynamic.begin(image.bytes, sizeof(image.bytes), COUNTER_RECORD, COUNTER_OFFSET, COUNTER_DIGITS);
+  printf("again:    %s, %u EEPROM blocks written\n", nfc._errGood(err) ? "OK" : "FAIL", dynamic.eepromBlockWrites);
+  good &= nfc._errGood(err) && (dynamic.eepromBlockWrites == 0);
+
+  //// 100 taps, each one should see the next number:
+  uint32_t eepromWritesBefore = simTag.eepromBlockWrites;  uint32_t worstRefreshMicros = 0;  uint8_t mismatches = 0;
+  for(uint8_t tap=0; tap<100; tap++) {
+    int32_t seen = phoneTap(dynamic.lastNdefBlock);
+    if(seen != (int32_t)counter) { mismatches++;  printf("tap %u: phone read %d, expected %u\n", tap, seen, counter); }
+    uint32_t busBefore = simTag.modelledBusMicros(400000);  uint32_t refreshesBefore = dynamic.refreshes;
+    err = dynamic.service(fillCounter, &counter);
+    if(!nfc._errGood(err) || (dynamic.refreshes != (refreshesBefore + 1))) { mismatches++;  printf("tap %u: service() did not refresh\n", tap); }
+    uint32_t refreshMicros = simTag.modelledBusMicros(400000) - busBefore;
+    if(refreshMicros > worstRefreshMicros) { worstRefreshMicros = refreshMicros; }
+  }
+  err = dynamic.service(fillCounter, &counter); // (no tap since the last one, so nothing happens)
+  good &= nfc._errGood(err) && (dynamic.refreshes == 100);
+  printf("100 taps: %u wrong, %u refreshes, %u SRAM block writes, %u EEPROM block writes, worst service()+refresh at 400kHz: %uus\n",
+         mismatches, dynamic.refreshes, dynamic.sramBlockWrites, simTag.eepromBlockWrites - eepromWritesBefore, worstRefreshMicros);
+  good &= (mismatches == 0) && (simTag.eepromBlockWrites == eepromWritesBefore) && (worstRefreshMicros < 1000);
+
+  //// after a Power-On-Reset the mirror is off (and the SRAM is gone), the phone gets the EEPROM copy until restore():
+  simTag.powerOnReset();  memset(simTag.mem[NT3H1x01_SRAM_MEMA_START], 0, NT3H1x01_DYNAMIC_WINDOW_SIZE);
+  int32_t afterReset = phoneTap(dynamic.lastNdefBlock);
+  err = dynamic.restore();
+  int32_t afterRestore = phoneTap(dynamic.lastNdefBlock);
+  printf("reset:    phone reads %d (the EEPROM copy), after restore() %d\n", afterReset, afterRestore);
+  good &= (afterReset == 0) && nfc._errGood(err) && (afterRestore == (int32_t)counter);
+
+  printf(good ? "dynamic NDEF OK\n" : "FAILED\n");
+  return(good ? 0 : 1);
+}
@@ -0,0 +1,107 @@
+/*
+
+Fault-injection soak test of the NT3H1x01_thijs library, runs on a host PC (using the simulated tag, see _NT3H1x01_thijs_sim.h)
+It runs the same little workload (write a user block, check EEPROM_WR_ERR, read it back) many times,
+ with random NACKs, short reads, EEPROM write errors, RF contention and WDT expiries injected by the simulated tag,
+ for several retry settings (see NT3H1x01_retries), and reports how that affects the success rate, throughput and (tail) latency.
+All times come from the simulator's virtual clock (at 400kHz), so the results are the same on every run.
+
+usage (from this folder, after building, see README.txt):
+  faults [iterations] [faultScale]
+   iterations: how many times to run the workload per setting (default 1000)
+   faultScale: multiplies the default fault rates (default 1.0), e.g. 0 to see the fault-free baseline
+
+*/
+
+#define NT3H1x01_useSimulator
+#define NT3H1x01_simVirtualClock
+#define NT3H1x01_retries
+#define NT3H1x01_stats // (for stats.retries)
+
+#include "NT3H1x01_thijs.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include <algorithm>
+
+//// default fault rates (in 1/1000 per transaction it applies to), indexed by NT3H1x01_SIM_FAULT_ENUM:
+const uint16_t defaultFaultPermille[NT3H1x01_SIM_FAULT_COUNT] = {0, 10, 5, 5, 2, 5};
+const char* const faultNames[NT3H1x01_SIM_FAULT_COUNT] = {"NONE", "NACK", "SHORT_READ", "EEPROM_WR_ERR", "RF_BURST", "WDT_EXPIRE"};
+
+struct soakResult
+{
+  uint32_t succeeded = 0, failed = 0, recoveries = 0;
+  uint32_t p50 = 0, p99 = 0, maxMicros = 0;
+  uint64_t totalMicros = 0;
+  uint32_t retries = 0, transactions = 0;
+  uint32_t faults[NT3H1x01_SIM_FAULT_COUNT] = {0};
+};
+
+/**
+ * the workload: write a block, check whether the EEPROM write went OK (and redo it if not), read it back
+ * @return true if the block ended up correct
+ */
+bool workload(NT3H1x01_thijs& nfc, uint8_t blockAddress, uint8_t fill, uint32_t& recoveries) {
+  uint8_t writeBuff[NT3H1x01_BLOCK_SIZE], readBuff[NT3H1x01_BLOCK_SIZE];
+  memset(writeBuff, fill, NT3H1x01_BLOCK_SIZE);
+  if(!nfc._errGood(nfc.writeUserBlock(blockAddress, writeBuff))) { return(false); }
+  bool writeErr = true;
+  if(!nfc._errGood(nfc.get<NT3H1x01_NS_EEPROM_WR_ERR>(writeErr, false))) { return(false); }
+  if(writeErr) { // recovery path: clear the flag and write it again
+    recoveries++;
+    if(!nfc._errGood(nfc.clear_EEPROM_WR_ERR())) { return(false); }
+    if(!nfc._errGood(nfc.writeUserBlock(blockAddress, writeBuff))) { return(false); }
+  }
+  if(!nfc._errGood(nfc.readUserBlock(blockAddress, readBuff))) { return(false); }
+  return(memcmp(writeBuff, readBuff, NT3H1x01_BLOCK_SIZE) == 0);
+}
+
+soakResult soak(uint32_t iterations, float faultScale, uint8_t maxRetries) {
+  static NT3H1x01_simTag simTag(true); // (static, it's 4kB)
+  simTag.factoryReset();  simTag.enableTiming(400000);  simTag.faultSeed = 12345; // (same faults for every setting)
+  for(uint8_t i=0; i<NT3H1x01_SIM_FAULT_COUNT; i++) { simTag.faultPermille[i] = defaultFaultPermille[i] * faultScale; }
+  NT3H1x01_thijs nfc(true);  nfc.init(simTag);
+  nfc.maxRetries = maxRetries;
+  soakResult result;
+  std::vector<uint32_t> latencies;  latencies.reserve(iterations);
+  for(uint32_t i=0; i<iterations; i++) {
+    uint64_t startTime = simTag.virtualMicros;
+    bool good = workload(nfc, nfc.memMap().userStart + (i % 8), i, result.recoveries);
+    if(good) { result.succeeded++; } else { result.failed++; }
+    if(!good) { nfc.setNS_I2C_LOCKED(false); } // (give the memory back, like a real application would after an error)
+    latencies.push_back(simTag.virtualMicros - startTime);
+    simTag.advanceTime(1000); // (the application does something else for a while)
+  }
+  std::sort(latencies.begin(), latencies.end());
+  if(iterations) {
+    result.p50 = latencies[iterations / 2];  result.p99 = latencies[(iterations * 99) / 100];  result.maxMicros = latencies.back();
+    for(uint32_t i=0; i<iterations; i++) { result.totalMicros += latencies[i]; }
+  }
+  #ifdef NT3H1x01_stats
+    result.retries = nfc.stats.retries;
+  #endif
+  result.transactions = simTag.writeTransactions + simTag.readTransactions;
+  memcpy(result.faults, simTag.faultsInjected, sizeof(result.faults));
+  return(result);
+}
+
+int main(int argc, char* argv[]) {
+  uint32_t iterations = (argc > 1) ? atoi(argv[1]) : 1000;
+  float faultScale = (argc > 2) ? atof(argv[2]) : 1.0;
+  printf("%u iterations per setting, fault rates (per 1000 transactions):", iterations);
+  for(uint8_t i=1; i<NT3H1x01_SIM_FAULT_COUNT; i++) { printf(" %s:%g", faultNames[i], defaultFaultPermille[i] * faultScale); }
+  printf("\n\n%-8s %8s %8s %6s %12s %8s %8s %8s %8s %8s\n", "retries", "success", "failed", "recov.", "ops/s(bus)", "p50(us)", "p99(us)", "max(us)", "retried", "trans.");
+  const uint8_t retrySettings[] = {0, 1, 3};
+  for(uint8_t setting : retrySettings) {
+    soakResult r = soak(iterations, faultScale, setting);
+    float opsPerSecond = r.totalMicros ? (r.succeeded * 1000000.0 / r.totalMicros) : 0;
+    printf("%-8u %7.2f%% %8u %6u %12.1f %8u %8u %8u %8u %8u\n", setting, iterations ? (100.0 * r.succeeded / iterations) : 0, r.failed, r.recoveries,
+           opsPerSecond, r.p50, r.p99, r.maxMicros, r.retries, r.transactions);
+    printf("         faults:");
+    for(uint8_t i=1; i<NT3H1x01_SIM_FAULT_COUNT; i++) { printf(" %s:%u", faultNames[i], r.faults[i]); }
+    printf("\n");
+  }
+  return(0);
+}
@@ -0,0 +1,288 @@
+/*
+
+Fuzz harness for the NT3H1x01_thijs library, runs on a host PC (using the simulated tag, see _NT3H1x01_thijs_sim.h)
+Everything the library reads from the tag can be written by a phone (or garbled by a bad bus), so none of it should be trusted.
+This feeds arbitrary data through:
+ - the TLV / NDEF record parsing (NT3H1x01_thijs_ndef.h)
+ - the Capability Container interpretation (getCC(), variantCheck(), probe(), NT3H1x01_parseCC())
+ - the session/configuration register decoding (all the getSess_, getNS_ and getConf_ functions)
+ - the transport layer: a simulated tag with fuzzed memory contents and injected faults (NACKs, short reads, etc.), driven by a fuzzed sequence of API calls
+The first byte of each input picks which one (see FUZZ_TARGET_ENUM), the rest is the data for it.
+Build it with the sanitizers (AddressSanitizer + UndefinedBehaviorSanitizer) on, so out-of-bounds reads, overflows and such abort right away.
+
+usage (from this folder, after building, see README.txt):
+  fuzz                          run 100000 random inputs (a simple built-in generator, repeatable)
+  fuzz 1000000                  run that many random inputs
+  fuzz file1 file2 ...          run these inputs (e.g. a crash file, or a corpus made with --seeds)
+  fuzz --seeds corpusDir        write the built-in seed inputs (factory images, typical NDEF messages) to that (existing) folder
+ or build it with libFuzzer (clang, -DNT3H1x01_LIBFUZZER -fsanitize=fuzzer,address,undefined) and run it on the seed corpus:
+  fuzz corpusDir
+
+*/
+
+#define NT3H1x01_useSimulator
+#define NT3H1x01_retries
+
+#include "NT3H1x01_thijs.h"
+#include "NT3H1x01_thijs_ndef.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+enum FUZZ_TARGET_ENUM : uint8_t {
+  FUZZ_TARGET_NDEF,      // the data is (a copy of) the user memory
+  FUZZ_TARGET_CC,        // the data is block 0 (UID, static lock bytes, CC)
+  FUZZ_TARGET_REGISTERS, // the data is the session registers and the configuration registers
+  FUZZ_TARGET_TRANSPORT, // the data is fault settings, the tag memory and a sequence of API calls
+  FUZZ_TARGET_COUNT
+};
+
+#define FUZZ_CHECK(condition)  if(!(condition)) { fprintf(stderr, "check failed: %s (line %d)\n", #condition, __LINE__); abort(); }
+
+/**
+ * a little reader for the fuzz input (returns 0 when it runs out, so every input is 'valid')
+ */
+struct fuzzInput
+{
+  const uint8_t* data;  size_t size;  size_t pos = 0;
+  fuzzInput(const uint8_t* data, size_t size) : data(data), size(size) {}
+  uint8_t next() { return((pos < size) ? data[pos++] : 0); }
+  size_t left() const { return(size - pos); }
+  void take(uint8_t* dest, size_t count) { for(size_t i=0; i<count; i++) { dest[i] = next(); } }
+};
+
+static NT3H1x01_simTag simTag1k(false), simTag2k(true); // (static, they're 4kB each)
+
+/**
+ * get a simulated tag in a clean state (factoryReset() leaves the fault settings and the I2C address alone, but one input shouldn't affect the next)
+ */
+NT3H1x01_simTag& freshSimTag(bool is2k) {
+  NT3H1x01_simTag& simTag = is2k ? simTag2k : simTag1k;
+  simTag.factoryReset();
+  memset(simTag.faultPermille, 0, sizeof(simTag.faultPermille));  simTag.slaveAddress = NT3H1x01_DEFAULT_I2C_ADDRESS;
+  return(simTag);
+}
+
+/**
+ * walk all TLVs and all NDEF records, and check that everything they point to is inside the buffer
+ */
+void fuzzNDEF(fuzzInput& input) {
+  //// copy to an exactly-sized heap buffer, so AddressSanitizer catches any read past the end
+  size_t areaSize = input.left();  if(areaSize > 0xFFFF) { areaSize = 0xFFFF; }
+  std::vector<uint8_t> area(input.data + input.pos, input.data + input.pos + areaSize);
+  if(area.size() >= 4) { NT3H1x01_parseCC(area.data()); }
+  uint16_t pos = 0;  NT3H1x01_tlv tlv;  uint16_t tlvCount = 0;
+  while(NT3H1x01_nextTLV(area.data(), areaSize, pos, tlv)) {
+    FUZZ_CHECK(((uint32_t)tlv.valueOffset + tlv.length) <= areaSize);
+    FUZZ_CHECK(pos > tlv.tlvOffset); // (always makes progress)
+    tlvCount++;
+    if(tlv.type != NT3H1x01_TLV_NDEF) { continue; }
+    uint16_t msgEnd = tlv.valueOffset + tlv.length;
+    uint16_t recPos = tlv.valueOffset;  NT3H1x01_ndefRecord rec;  uint16_t recCount = 0;
+    while(NT3H1x01_nextNdefRecord(area.data(), msgEnd, recPos, rec)) {
+      FUZZ_CHECK(rec.recordOffset >= tlv.valueOffset);
+      FUZZ_CHECK(((uint32_t)rec.recordOffset + rec.recordLength) <= msgEnd);
+      FUZZ_CHECK(((uint32_t)rec.payloadOffset + rec.payloadLength) <= msgEnd);
+      FUZZ_CHECK(rec.typeOffset + rec.typeLength == rec.idOffset);
+      volatile uint8_t touch = 0; // read every byte the record points to
+      for(uint16_t i=rec.typeOffset; i<(rec.payloadOffset + rec.payloadLength); i++) { touch ^= area[i]; }
+      recCount++;
+      FUZZ_CHECK(recCount <= msgEnd); // (every record is at least 3 bytes, so this can never happen)
+    }
+  }
+  NT3H1x01_findTLV(area.data(), areaSize, NT3H1x01_TLV_NDEF, tlv);
+}
+
+/**
+ * put fuzzed data in block 0, then read it back through the library
+ */
+void fuzzCC(fuzzInput& input) {
+  bool is2k = input.next() & 1;
+  NT3H1x01_simTag& simTag = freshSimTag(is2k);
+  input.take(simTag.mem[0], NT3H1x01_BLOCK_SIZE);
+  NT3H1x01_thijs nfc(input.next() & 1); // (the variant the library thinks it is, may not match the tag)
+  nfc.init(simTag);
+  uint8_t CC[4];
+  FUZZ_CHECK(nfc._errGood(nfc.getCC(CC)));
+  FUZZ_CHECK(memcmp(CC, &simTag.mem[0][NT3H1x01_CAPA_CONT_MEMA_BYTES_START], 4) == 0);
+  NT3H1x01_ccInfo info = NT3H1x01_parseCC(CC);
+  FUZZ_CHECK(info.dataAreaBytes == CC[2] * 8);
+  bool variantMatches = nfc.variantCheck();
+  FUZZ_CHECK(variantMatches == (CC[2] == nfc.memMap().ccSizeByte));
+  NT3H1x01_deviceInfo deviceInfo;
+  bool probeGood = nfc.probe(deviceInfo);
+  FUZZ_CHECK(memcmp(deviceInfo.CC, CC, 4) == 0);
+  FUZZ_CHECK(!probeGood || (nfc.memMap().ccSizeByte == CC[2])); // (the detected variant must match the CC)
+  uint8_t UID[7];
+  nfc.getCC(true);  nfc.getUID(UID);  nfc.getSAK();  nfc.getATQA();
+}
+
+/**
+ * put fuzzed data in the registers, then decode all of them through the library
+ */
+void fuzzRegisters(fuzzInput& input) {
+  bool is2k = input.next() & 1;
+  NT3H1x01_simTag& simTag = freshSimTag(is2k);
+  input.take(simTag.sessRegs, sizeof(simTag.sessRegs));
+  input.take(simTag.mem[NT3H1x01_getMemMap(is2k).confRegsMEMA], NT3H1x01_BLOCK_SIZE);
+  NT3H1x01_thijs nfc(is2k);
+  nfc.init(simTag);
+  //// session registers:
+  nfc.getSess_NC_REG();  nfc.getSess_NC_FD_OFF();  nfc.getSess_NC_FD_ON();  nfc.getSess_NC_DIR();  nfc.getSess_NC_PTHRU();  nfc.getSess_NC_MIRROR();
+  nfc.getSess_LAST_NDEF_BLOCK();  nfc.getSess_SRAM_MIRROR_BLOCK();  nfc.getSess_WDTraw();  nfc.getSess_WDT();
+  nfc.getNS_REG();  nfc.getNS_NDEF_DATA_READ();  nfc.getNS_RF_LOCKED();  nfc.getNS_SRAM_RF_READY();  nfc.getNS_EEPROM_WR_ERR();  nfc.getNS_EEPROM_WR_BUSY();  nfc.getNS_RF_FIELD_PRESENT();
+  //// configuration registers (both from the tag and from the cache):
+  const bool useCacheSettings[2] = {false, true}; // (a bool, as some getters have a uint8_t& overload)
+  for(bool useCache : useCacheSettings) {
+    nfc.getConf_NC_REG(useCache);  nfc.getConf_NC_FD_OFF(useCache);  nfc.getConf_NC_FD_ON(useCache);  nfc.getConf_NC_DIR(useCache);
+    nfc.getConf_LAST_NDEF_BLOCK(useCache);  nfc.getConf_SRAM_MIRROR_BLOCK(useCache);  nfc.getConf_WDTraw(useCache);  nfc.getConf_WDT(useCache);  nfc.getREG_LOCK(useCache);
+    nfc.getConf_NC_I2C_RST(useCache);  nfc.getConf_I2C_CLOCK_STR(useCache);
+  }
+  FUZZ_CHECK(nfc.getConf_LAST_NDEF_BLOCK() == simTag.mem[nfc.memMap().confRegsMEMA][NT3H1x01_COMN_REGS_LAST_NDEF_BLOCK_BYTE]);
+}
+
+/**
+ * a simulated tag with fuzzed memory and faults, driven by a fuzzed sequence of API calls
+ */
+void fuzzTransport(fuzzInput& input) {
+  bool is2k = input.next() & 1;
+  NT3H1x01_simTag& simTag = freshSimTag(is2k);
+  for(uint8_t i=1; i<NT3H1x01_SIM_FAULT_COUNT; i++) { simTag.faultPermille[i] = input.next() * 4; } // (up to ~100%)
+  simTag.faultSeed = input.next() | 1; // (must not be 0)
+  simTag.rfBurstTransactions = input.next() & 0x0F;
+  for(uint8_t i=0; i<4; i++) { uint8_t transactionNumber = input.next();  simTag.scheduleFault(transactionNumber, (NT3H1x01_SIM_FAULT_ENUM)(input.next() % NT3H1x01_SIM_FAULT_COUNT)); }
+  uint8_t seededBlocks = input.next() & 0x0F; // fill some blocks (any address, even invalid ones) with fuzzed data
+  for(uint8_t i=0; i<seededBlocks; i++) { input.take(simTag.mem[input.next()], NT3H1x01_BLOCK_SIZE); }
+  NT3H1x01_thijs nfc(is2k);
+  nfc.init(simTag);
+  nfc.maxRetries = input.next() & 0x03;  nfc.retryDelayMicros = 0;
+  const NT3H1x01_memMap& map = nfc.memMap();
+  uint8_t buff[NT3H1x01_BLOCK_SIZE];
+  while(input.left()) {
+    uint8_t op = input.next(), arg = input.next();
+    switch(op % 12) {
+      case 0: nfc.readUserBlock(arg, buff); break; // (any address, the library should refuse the invalid ones)
+      case 1: input.take(buff, NT3H1x01_BLOCK_SIZE);  nfc.writeUserBlock(arg, buff); break;
+      case 2: nfc.requestMemBlock(arg, buff); break;
+      case 3: nfc.getNS_REG(); break;
+      case 4: nfc.setSess_NC_FD_ON((NT3H1x01_FD_ON_ENUM)(arg & 0x03)); break;
+      case 5: nfc.setConf_WDT(arg * 100); break;
+      case 6: nfc.getCC(buff);  NT3H1x01_parseCC(buff); break;
+      case 7: nfc.variantCheck(); break;
+      case 8: nfc.setConf_LAST_NDEF_BLOCK(arg); break;
+      case 9: nfc.getConf_NC_REG((bool)(arg & 1));  nfc.getConf_WDTraw((bool)(arg & 1)); break;
+      case 10: nfc.clear_EEPROM_WR_ERR(); break;
+      case 11: nfc.setNS_I2C_LOCKED(false); break;
+    }
+  }
+  //// and parse whatever ended up in the user memory:
+  std::vector<uint8_t> userMem(map.userBytes);
+  for(uint8_t block=map.userStart; block<=map.userEnd; block++) {
+    if(!nfc._errGood(nfc.readUserBlock(block, buff))) { break; }
+    memcpy(&userMem[(block - map.userStart) * NT3H1x01_BLOCK_SIZE], buff, map.userBytesInBlock(block));
+  }
+  fuzzInput userMemInput(userMem.data(), userMem.size());
+  fuzzNDEF(userMemInput);
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+  if(size == 0) { return(0); }
+  fuzzInput input(data, size);
+  switch(input.next() % FUZZ_TARGET_COUNT) {
+    case FUZZ_TARGET_NDEF: fuzzNDEF(input); break;
+    case FUZZ_TARGET_CC: fuzzCC(input); break;
+    case FUZZ_TARGET_REGISTERS: fuzzRegisters(input); break;
+    case FUZZ_TARGET_TRANSPORT: fuzzTransport(input); break;
+  }
+  return(0);
+}
+
+#ifndef NT3H1x01_LIBFUZZER // (libFuzzer has its own main())
+
+/**
+ * the seed corpus: what a freshly made tag and a typical phone-written tag look like (each one for every target)
+ */
+std::vector<std::vector<uint8_t> > seedInputs() {
+  std::vector<std::vector<uint8_t> > seeds;
+  const uint8_t textNDEF[] = {0x03,0x0B,0xD1,0x01,0x07,0x54,0x02,'e','n','H','e','l','l','o',0xFE}; // TLV with a single Text record
+  const uint8_t uriNDEF[] = {0x03,0x0F,0xD1,0x01,0x0B,0x55,0x04,'e','x','a','m','p','l','e','.','c','o','m',0xFE}; // URI record (https://)
+  const uint8_t twoRecordsNDEF[] = {0x01,0x03,0xA0,0x10,0x44, 0x03,0x11, 0x91,0x01,0x03,0x54,0x02,'e','n', 0x59,0x01,0x03,0x02,0x55,'i','d',0x04,'a','b', 0xFE}; // Lock Control TLV, then 2 records (one with an ID)
+  const uint8_t longTLV[] = {0x00,0x00,0x03,0xFF,0x00,0x08,0xC1,0x01,0x00,0x00,0x00,0x01,'U','X',0xFE}; // padding, 3-byte length, long (non-SR) record
+  const uint8_t* const messages[] = {textNDEF, uriNDEF, twoRecordsNDEF, longTLV};
+  const size_t messageSizes[] = {sizeof(textNDEF), sizeof(uriNDEF), sizeof(twoRecordsNDEF), sizeof(longTLV)};
+  for(uint8_t i=0; i<4; i++) { // NDEF target
+    std::vector<uint8_t> seed(1, FUZZ_TARGET_NDEF);  seed.insert(seed.end(), messages[i], messages[i] + messageSizes[i]);  seeds.push_back(seed);
+  }
+  for(uint8_t is2k=0; is2k<2; is2k++) {
+    NT3H1x01_simTag& simTag = freshSimTag(is2k);
+    std::vector<uint8_t> ccSeed = {FUZZ_TARGET_CC, is2k, is2k}; // CC target: factory block 0
+    ccSeed.insert(ccSeed.end(), simTag.mem[0], simTag.mem[0] + NT3H1x01_BLOCK_SIZE);  seeds.push_back(ccSeed);
+    std::vector<uint8_t> regSeed = {FUZZ_TARGET_REGISTERS, is2k}; // register target: factory registers
+    regSeed.insert(regSeed.end(), simTag.sessRegs, simTag.sessRegs + sizeof(simTag.sessRegs));
+    const uint8_t* confRegs = simTag.mem[NT3H1x01_getMemMap(is2k).confRegsMEMA];
+    regSeed.insert(regSeed.end(), confRegs, confRegs + NT3H1x01_BLOCK_SIZE);  seeds.push_back(regSeed);
+    std::vector<uint8_t> transportSeed = {FUZZ_TARGET_TRANSPORT, is2k, 2,1,1,0,1, 0x55, 4, 0,0,0,0,0,0,0,0, 1, 0x01}; // transport target: a few faults, NDEF in the first user block
+    transportSeed.insert(transportSeed.end(), textNDEF, textNDEF + sizeof(textNDEF));  transportSeed.push_back(0x00); // (padded to a whole block)
+    const uint8_t ops[] = {2, 3,0, 0,0x01, 3,0, 7,0, 5,200, 9,0, 0,0x02, 10,0, 11,0};
+    transportSeed.insert(transportSeed.end(), ops, ops + sizeof(ops));  seeds.push_back(transportSeed);
+  }
+  return(seeds);
+}
+
+int main(int argc, char* argv[]) {
+  if((argc == 3) && (strcmp(argv[1], "--seeds") == 0)) {
+    std::vector<std::vector<uint8_t> > seeds = seedInputs();
+    for(size_t i=0; i<seeds.size(); i++) {
+      char path[256];  snprintf(path, sizeof(path), "%s/seed%02u", argv[2], (unsigned int)i);
+      FILE* file = fopen(path, "wb");
+      if(!file) { printf("can't write %s\n", path); return(2); }
+      fwrite(seeds[i].data(), 1, seeds[i].size(), file);  fclose(file);
+    }
+    printf("wrote %u seeds to %s\n", (unsigned int)seeds.size(), argv[2]);
+    return(0);
+  }
+  if((argc > 1) && (atoi(argv[1]) == 0)) { // run files
+    for(int i=1; i<argc; i++) {
+      FILE* file = fopen(argv[i], "rb");
+      if(!file) { printf("can't open %s\n", argv[i]); return(2); }
+      std::vector<uint8_t> data;  uint8_t chunk[256];  size_t got;
+      while((got = fread(chunk, 1, sizeof(chunk), file)) > 0) { data.insert(data.end(), chunk, chunk + got); }
+      fclose(file);
+      LLVMFuzzerTestOneInput(data.data(), data.size());
+    }
+    printf("ran %d inputs, no problems found\n", argc - 1);
+    return(0);
+  }
+  //// random inputs: mostly mutated seeds (so they get past the first few checks), some pure noise
+  uint32_t iterations = (argc > 1) ? atoi(argv[1]) : 100000;
+  std::vector<std::vector<uint8_t> > seeds = seedInputs();
+  uint32_t state = 0x12345678;
+  auto random = [&state]() { state ^= state << 13;  state ^= state >> 17;  state ^= state << 5;  return(state); }; // xorshift32
+  for(uint32_t i=0; i<iterations; i++) {
+    std::vector<uint8_t> data;
+    if(random() % 4) {
+      data = seeds[random() % seeds.size()];
+      uint8_t mutations = 1 + (random() % 8);
+      for(uint8_t j=0; j<mutations; j++) {
+        uint32_t where = random() % (data.size() + 1);
+        switch(random() % 4) {
+          case 0: if(where < data.size()) { data[where] = random(); } break; // replace a byte
+          case 1: if(where < data.size()) { data[where] ^= 1 << (random() % 8); } break; // flip a bit
+          case 2: data.insert(data.begin() + where, (uint8_t)random()); break; // insert a byte
+          case 3: data.resize(where); break; // truncate
+        }
+      }
+      if(data.size() && (random() % 8 == 0)) { data[0] = random(); } // (sometimes feed one target's seed to another)
+    } else {
+      data.resize(random() % 512);
+      for(size_t j=0; j<data.size(); j++) { data[j] = random(); }
+    }
+    LLVMFuzzerTestOneInput(data.data(), data.size());
+  }
+  printf("ran %u random inputs, no problems found\n", iterations);
+  return(0);
+}
+
+#endif // NT3H1x01_LIBFUZZER
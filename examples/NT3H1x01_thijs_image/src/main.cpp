@@ -0,0 +1,90 @@
+/*
+
+Dumps, checks and programs tag images (see NT3H1x01_thijs_image.h) on a host PC, using the simulated tag.
+
+usage (from this folder, after building, see README.txt):
+  image --demo tag.img       configure a simulated tag (some NDEF data and a few registers), and dump it to tag.img
+  image tag.img              check tag.img and show what's in it
+  image --program tag.img    program tag.img onto a fresh simulated tag, twice (the second time, nothing should need writing),
+                             then onto a fresh tag with block 0x01 locked (which must be refused)
+
+*/
+
+#define NT3H1x01_useSimulator
+
+#include "NT3H1x01_thijs_image.h"
+
+#include <stdio.h>
+#include <string.h>
+
+int demo(const char* path) {
+  FILE* file = fopen(path, "wb");
+  if(!file) { printf("can't write %s\n", path); return(2); }
+  static NT3H1x01_simTag simTag(true); // (static, it's 4kB)
+  NT3H1x01_thijs nfc(true);  nfc.init(simTag);
+  //// some typical contents:
+  uint8_t block[NT3H1x01_BLOCK_SIZE] = {0x03,0x0B,0xD1,0x01,0x07,0x54,0x02,'e','n','H','e','l','l','o',0xFE,0x00};
+  nfc.writeUserBlock(0x01, block);
+  nfc.setConf_NC_FD_ON(NT3H1x01_FD_ON_TAG_SELECTED);
+  nfc.setConf_WDT(20000);
+  NT3H1x01_ERR_RETURN_TYPE err = NT3H1x01_dumpImage(nfc, file, true);
+  fclose(file);
+  if(!nfc._errGood(err)) { printf("dump failed\n"); return(1); }
+  printf("wrote %u bytes to %s\n", (uint32_t)NT3H1x01_imageSize(nfc.is2kVariant, true), path);
+  return(0);
+}
+
+int info(const char* path) {
+  size_t size;
+  const uint8_t* image = NT3H1x01_mapImageFile(path, size);
+  if(!image) { printf("can't open %s\n", path); return(2); }
+  NT3H1x01_imageInfo imageInfo;
+  bool valid = NT3H1x01_parseImage(image, size, imageInfo);
+  if(valid) {
+    printf("%s: NT3H1%c01 image, %u blocks%s, CRC %08X\n  UID:", path, imageInfo.is2kVariant ? '2' : '1', imageInfo.blockCount,
+           imageInfo.SRAM ? " + SRAM" : "", imageInfo.CRC);
+    for(uint8_t i=0; i<7; i++) { printf(" %02X", imageInfo.UID[i]); }
+    const uint8_t* conf = imageInfo.block(NT3H1x01_getMemMap(imageInfo.is2kVariant).confRegsMEMA);
+    printf("\n  CC: %02X %02X %02X %02X\n  conf. registers:", imageInfo.blocks[12], imageInfo.blocks[13], imageInfo.blocks[14], imageInfo.blocks[15]);
+    for(uint8_t i=0; i<8; i++) { printf(" %02X", conf[i]); }
+    printf("\n");
+  } else { printf("%s is not a (valid) tag image\n", path); }
+  NT3H1x01_unmapImageFile(image, size);
+  return(valid ? 0 : 1);
+}
+
+int program(const char* path) {
+  size_t size;
+  const uint8_t* image = NT3H1x01_mapImageFile(path, size);
+  if(!image) { printf("can't open %s\n", path); return(2); }
+  NT3H1x01_imageInfo imageInfo;
+  if(!NT3H1x01_parseImage(image, size, imageInfo)) { printf("%s is not a (valid) tag image\n", path); NT3H1x01_unmapImageFile(image, size); return(1); }
+  static NT3H1x01_simTag simTag(imageInfo.is2kVariant);
+  NT3H1x01_thijs nfc(imageInfo.is2kVariant);  nfc.init(simTag);
+  bool success = true;
+  for(uint8_t i=0; i<2; i++) {
+    uint32_t writesBefore = simTag.eepromBlockWrites;
+    NT3H1x01_programResult result;
+    success &= nfc._errGood(NT3H1x01_programImage(nfc, image, size, result));
+    printf("pass %u: %u blocks checked, %u written (%u EEPROM writes), %u kept (read-only/lock bytes differ), %s\n", i+1, result.blocksChecked,
+           result.blocksWritten, simTag.eepromBlockWrites - writesBefore, result.blocksKept, result.verified ? "verified" : "NOT verified");
+  }
+  //// and once more on a fresh tag, with the first user block locked (which must be refused, and left alone):
+  simTag.factoryReset();  nfc.forgetLocks();
+  nfc.lockArea(0x01, 0x01);
+  uint8_t lockedBefore[NT3H1x01_BLOCK_SIZE];  memcpy(lockedBefore, simTag.mem[0x01], NT3H1x01_BLOCK_SIZE);
+  NT3H1x01_programResult result;
+  bool refused = !nfc._errGood(NT3H1x01_programImage(nfc, image, size, result)) && (memcmp(lockedBefore, simTag.mem[0x01], NT3H1x01_BLOCK_SIZE) == 0);
+  printf("locked: block 0x01 %s\n", refused ? "refused (and untouched)" : "NOT refused");
+  success &= refused || (memcmp(imageInfo.block(0x01), lockedBefore, NT3H1x01_BLOCK_SIZE) == 0); // (nothing to refuse if the image has the same block)
+  NT3H1x01_unmapImageFile(image, size);
+  return(success ? 0 : 1);
+}
+
+int main(int argc, char* argv[]) {
+  if((argc == 3) && (strcmp(argv[1], "--demo") == 0)) { return(demo(argv[2])); }
+  if((argc == 3) && (strcmp(argv[1], "--program") == 0)) { return(program(argv[2])); }
+  if(argc == 2) { return(info(argv[1])); }
+  printf("usage: image --demo tag.img | image tag.img | image --program tag.img   (see README.txt)\n");
+  return(2);
+}
@@ -0,0 +1,90 @@
+/*
+
+Demonstrates Static and Dynamic Locking (see lockArea() in NT3H1x01_thijs.h) on a host PC, on both variants:
+a few areas are locked, and after each one it checks the lock bits, what it cost on the bus,
+ and that neither a (simulated) phone nor the library itself can write there anymore (while the rest of the memory stays writable).
+It also checks that probe() forgets the lock bits when it finds out the tag is the other variant.
+
+usage (from this folder, after building, see README.txt):
+  lock        prints one line per step, exits with 1 if anything doesn't match
+
+*/
+
+#define NT3H1x01_useSimulator
+
+#include "NT3H1x01_thijs.h"
+
+#include <stdio.h>
+
+static NT3H1x01_simTag simTag1k(false), simTag2k(true); // (static, they're 4kB each)
+
+//// the lock bits can be worked out at compile-time:
+static_assert(NT3H1x01_lockBitsForArea(NT3H1x01_getMemMap(false), 0x01, 0x0B).staticBits == 0xFFF0, "blocks 0x01~0x03 are pages 4~15");
+static_assert(NT3H1x01_lockBitsForArea(NT3H1x01_getMemMap(false), 0x01, 0x0B).dynamicBits == 0b11, "0x04~0x0B is 2 chunks of 4 blocks on the 1k variant");
+static_assert(NT3H1x01_lockBitsForArea(NT3H1x01_getMemMap(true), 0x01, 0x0B).dynamicBits == 0b1, "0x04~0x0B is 1 chunk of 8 blocks on the 2k variant");
+
+/**
+ * lock an area and check the result
+ * @param startBlock first block of the area
+ * @param endBlock last block of the area (inclusive)
+ * @param roundUp see lockArea()
+ * @param blockLock see lockArea()
+ * @param expectWrites how many lock blocks should be written
+ * @return true if everything matches
+ */
+bool lockAndCheck(NT3H1x01_thijs& nfc, NT3H1x01_simTag& simTag, uint8_t startBlock, uint8_t endBlock, bool roundUp, bool blockLock, uint8_t expectWrites) {
+  const NT3H1x01_memMap map = nfc.memMap();
+  const NT3H1x01_lockBits bits = NT3H1x01_lockBitsForArea(map, startBlock, endBlock, roundUp, blockLock);
+  uint32_t readsBefore = simTag.readTransactions,  writesBefore = simTag.writeTransactions; // (a block read is 2 transactions: a write to point at it, then the read)
+  NT3H1x01_ERR_RETURN_TYPE err = nfc.lockArea(startBlock, endBlock, roundUp, blockLock);
+  uint32_t reads = simTag.readTransactions - readsBefore,  writes = (simTag.writeTransactions - writesBefore) - reads;
+  bool good = nfc._errGood(err) && nfc.lockCache.covers(bits) && (writes == expectWrites) && (reads <= 2);
+  //// every block in (or, rounded up, around) the area should now be locked, for the phone and the library:
+  uint8_t phoneRefused = 0,  libraryRefused = 0,  phoneWrote = 0;  uint32_t busBefore = simTag.writeTransactions + simTag.readTransactions;
+  uint8_t block[NT3H1x01_BLOCK_SIZE] = {0xAB};
+  for(uint8_t blockAddress=map.userStart; blockAddress<=map.userEnd; blockAddress++) {
+    bool shouldBeLocked = nfc.lockCache.intersects(NT3H1x01_lockBitsForArea(map, blockAddress, blockAddress));
+    if(shouldBeLocked) {
+      phoneRefused += !simTag.rfWriteBlock(blockAddress, block);
+      libraryRefused += !nfc._errGood(nfc.writeUserBlock(blockAddress, block));
+    } else if((blockAddress >= 0x20) && (blockAddress < 0x24)) { // (a few unlocked blocks, to see the phone can still write there)
+      phoneWrote += simTag.rfWriteBlock(blockAddress, block);
+    }
+  }
+  uint8_t lockedBlocks = 0;  for(uint8_t b=map.userStart; b<=map.userEnd; b++) { lockedBlocks += nfc.isLocked(b); }
+  good &= (phoneRefused == lockedBlocks) && (libraryRefused == lockedBlocks) && (phoneWrote == 4) && ((simTag.writeTransactions + simTag.readTransactions) == busBefore); // (the library refused without any I2C traffic)
+  printf("%s: lock 0x%02X~0x%02X%s%s: static 0x%04X, dynamic 0x%06X, %u block reads, %u lock block writes, %2u blocks locked for the phone and the library  %s\n",
+         map.userEnd > 0x40 ? "2k" : "1k", startBlock, endBlock, roundUp ? "" : " (whole chunks)", blockLock ? " (block-locked)" : "",
+         nfc.lockCache.staticBits, nfc.lockCache.dynamicBits, reads, writes, lockedBlocks, good ? "OK" : "FAIL");
+  return(good);
+}
+
+int main() {
+  bool good = true;
+  for(uint8_t variant=0; variant<2; variant++) {
+    NT3H1x01_simTag& simTag = variant ? simTag2k : simTag1k;
+    NT3H1x01_thijs nfc(variant);  nfc.init(simTag);
+    good &= lockAndCheck(nfc, simTag, 0x01, 0x0B, true, false, 2);  // static and dynamic
+    good &= lockAndCheck(nfc, simTag, 0x02, 0x05, true, false, 0);  // already locked (nothing on the bus at all)
+    good &= lockAndCheck(nfc, simTag, 0x0E, 0x1C, false, false, 1); // only the whole chunks in there
+    good &= lockAndCheck(nfc, simTag, 0x0C, 0x0C, true, true, 1);   // block-locked too (only Dynamic Locking, there are no Static Locking bits in this area)
+    //// after a reset, the lock bits are read back (except the block-locking byte of the Dynamic Locking bytes, which always reads as 0):
+    NT3H1x01_lockBits cached = nfc.lockCache,  readBack;
+    NT3H1x01_thijs fresh(variant);  fresh.init(simTag);
+    bool before = fresh.isLocked(0x02);
+    NT3H1x01_ERR_RETURN_TYPE err = fresh.readLocks(readBack);
+    bool thisGood = !before && fresh._errGood(err) && (readBack.staticBits == cached.staticBits) && (readBack.dynamicBits == (cached.dynamicBits & 0xFFFF)) && fresh.isLocked(0x02);
+    printf("%s: after a reset: static 0x%04X, dynamic 0x%06X (isLocked() before readLocks(): %s)  %s\n", variant ? "2k" : "1k", readBack.staticBits, readBack.dynamicBits, before ? "yes" : "no", thisGood ? "OK" : "FAIL");
+    good &= thisGood;
+    //// a tag object that expected the other variant: probe() corrects it, and forgets the lock bits it had (they cover other blocks on the other variant):
+    NT3H1x01_thijs wrong(!variant);  wrong.init(simTag);
+    wrong.readLocks(readBack);
+    NT3H1x01_deviceInfo info;
+    bool probed = wrong.probe(info),  forgot = !wrong.lockCacheValid;
+    thisGood = probed && (wrong.is2kVariant == (bool)variant) && forgot && wrong._errGood(wrong.readLocks(readBack)) && wrong.isLocked(0x02);
+    printf("%s: probe() on a %s object: variant corrected, lock bits %s  %s\n", variant ? "2k" : "1k", variant ? "1k" : "2k", forgot ? "forgotten" : "KEPT", thisGood ? "OK" : "FAIL");
+    good &= thisGood;
+  }
+  printf(good ? "locking OK\n" : "FAILED\n");
+  return(good ? 0 : 1);
+}
@@ -0,0 +1,194 @@
+/*
+
+Checks the compile-time NDEF encoder (see NT3H1x01_thijs_ndef.h) on a host PC:
+every message below is encoded at compile-time (NT3H1x01_NDEF_IMAGE()), and then at runtime
+ - encoded again with the runtime encoder (NT3H1x01_encodeNdefMessage()), which should give the exact same bytes
+ - parsed back with the NDEF parser, which should find the same records
+ - written to a simulated tag (straight from the constexpr image, with writeUserBytes_P()) and read back
+and then a counter in a URL is patched in place on the tag (NT3H1x01_patchNdefPayload() and NT3H1x01_spliceNdefPayload()), showing how few blocks that takes
+ (with autoLastNdefBlock on, so LAST_NDEF_BLOCK should follow the end of the message), including a patch that moves the rest of the message by more than 2 blocks,
+ and a splice into a record that runs through a locked area, which must be refused before anything is written.
+
+usage (from this folder, after building, see README.txt):
+  ndef        prints one line per message, exits with 1 if anything doesn't match
+
+*/
+
+#define NT3H1x01_useSimulator
+
+#include "NT3H1x01_thijs_ndef.h"
+
+#include <stdio.h>
+#include <string.h>
+
+//// the messages (the record arrays must be global (or static) for the compile-time encoder to point to them)
+constexpr NT3H1x01_ndefRecordData uriRecords[] = {NT3H1x01_ndefUri(NT3H1x01_URI_HTTPS, "nxp.com")};
+constexpr NT3H1x01_ndefRecordData textRecords[] = {NT3H1x01_ndefText("en", "Hello, tag!")};
+constexpr NT3H1x01_ndefRecordData vcardRecords[] = {NT3H1x01_ndefMime("text/vcard", "BEGIN:VCARD\nVERSION:3.0\nFN:Thijs\nEND:VCARD\n")};
+constexpr uint8_t sensorConfig[] = {0x01, 0x02, 0x7F, 0x80, 0xFF, 0x00};
+constexpr NT3H1x01_ndefRecordData multiRecords[] = {NT3H1x01_ndefUri(NT3H1x01_URI_HTTPS_WWW, "example.com/device?id=42"),
+                                                    NT3H1x01_ndefText("nl", "Hallo"),
+                                                    NT3H1x01_ndefExternal("example.com:cfg", sensorConfig)};
+#define FIFTY_CHARS "0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLM\n"
+constexpr NT3H1x01_ndefRecordData longRecords[] = {NT3H1x01_ndefText("en", FIFTY_CHARS FIFTY_CHARS FIFTY_CHARS FIFTY_CHARS FIFTY_CHARS FIFTY_CHARS)}; // (>255 bytes: long record and 3 byte TLV length)
+#define FIVE_HUNDRED_CHARS FIFTY_CHARS FIFTY_CHARS FIFTY_CHARS FIFTY_CHARS FIFTY_CHARS FIFTY_CHARS FIFTY_CHARS FIFTY_CHARS FIFTY_CHARS FIFTY_CHARS
+constexpr NT3H1x01_ndefRecordData bigRecords[] = {NT3H1x01_ndefMime("text/plain", FIVE_HUNDRED_CHARS FIVE_HUNDRED_CHARS)}; // (only fits in the 2k variant)
+
+constexpr NT3H1x01_ndefMessageData uriMessage = NT3H1x01_ndefMessage(uriRecords);
+constexpr NT3H1x01_ndefMessageData textMessage = NT3H1x01_ndefMessage(textRecords);
+constexpr NT3H1x01_ndefMessageData vcardMessage = NT3H1x01_ndefMessage(vcardRecords);
+constexpr NT3H1x01_ndefMessageData multiMessage = NT3H1x01_ndefMessage(multiRecords);
+constexpr NT3H1x01_ndefMessageData longMessage = NT3H1x01_ndefMessage(longRecords);
+constexpr NT3H1x01_ndefMessageData bigMessage = NT3H1x01_ndefMessage(bigRecords);
+
+static constexpr auto uriImage PROGMEM = NT3H1x01_NDEF_IMAGE(uriMessage);
+static constexpr auto textImage PROGMEM = NT3H1x01_NDEF_IMAGE(textMessage);
+static constexpr auto vcardImage PROGMEM = NT3H1x01_NDEF_IMAGE(vcardMessage);
+static constexpr auto multiImage PROGMEM = NT3H1x01_NDEF_IMAGE(multiMessage);
+static constexpr auto longImage PROGMEM = NT3H1x01_NDEF_IMAGE(longMessage);
+static constexpr auto bigImage PROGMEM = NT3H1x01_NDEF_IMAGE(bigMessage);
+
+//// some things can be checked without even running it:
+static_assert(sizeof(uriImage.bytes) == NT3H1x01_BLOCK_SIZE, "a short URI should fit in 1 block");
+static_assert((uriImage.bytes[0] == NT3H1x01_TLV_NDEF) && (uriImage.bytes[1] == 12) && (uriImage.bytes[2] == 0xD1) && (uriImage.bytes[5] == 'U') && (uriImage.bytes[6] == NT3H1x01_URI_HTTPS), "URI record header");
+static_assert((uriImage.bytes[2 + 12] == NT3H1x01_TLV_TERMINATOR) && (uriImage.bytes[15] == 0), "Terminator TLV right after the message, then 0's");
+static_assert((longImage.bytes[1] == NT3H1x01_TLV_LONG_LENGTH) && !(longImage.bytes[4] & NT3H1x01_NDEF_SR_bits), "long TLV length and long record");
+static_assert(bigImage.fits(NT3H1x01_getMemMap(true)) && !bigImage.fits(NT3H1x01_getMemMap(false)), "the big message is meant for the 2k variant only");
+static_assert(multiImage.lastNdefBlock(1) == 5, "the multi-record message (68 bytes with the TLVs) ends in block 5");
+
+static NT3H1x01_simTag simTag1k(false), simTag2k(true); // (static, they're 4kB each)
+
+/**
+ * check one compile-time image
+ * @return true if everything matches
+ */
+template<uint16_t SIZE>
+bool check(const char* name, const NT3H1x01_ndefImage<SIZE>& image, const NT3H1x01_ndefMessageData& message, bool is2kVariant) {
+  bool good = true;
+  //// against the runtime encoder:
+  uint8_t runtimeImage[NT3H1x01_getMemMap(true).userBytes];
+  uint16_t runtimeSize = NT3H1x01_encodeNdefMessage(message.records, message.recordCount, runtimeImage, sizeof(runtimeImage));
+  if(runtimeSize != SIZE) { printf("  runtime encoder size %u != %u\n", runtimeSize, SIZE);  good = false; }
+  for(uint16_t i=0; (i<SIZE) && (i<runtimeSize); i++) { if(runtimeImage[i] != image.bytes[i]) { printf("  byte %u differs: %02X != %02X\n", i, image.bytes[i], runtimeImage[i]);  good = false;  break; } }
+  //// parse it back:
+  NT3H1x01_tlv tlv;  uint8_t recordsFound = 0;
+  if(!NT3H1x01_findTLV(image.bytes, SIZE, NT3H1x01_TLV_NDEF, tlv) || (tlv.length != message.size())) { printf("  NDEF TLV not found\n");  good = false; }
+  else {
+    NT3H1x01_ndefRecord rec;  uint16_t pos = tlv.valueOffset;
+    while(NT3H1x01_nextNdefRecord(image.bytes, tlv.valueOffset + tlv.length, pos, rec)) {
+      const NT3H1x01_ndefRecordData& expected = message.records[recordsFound];
+      bool same = (rec.TNF() == expected.TNF) && (rec.typeLength == expected.typeLength) && (rec.payloadLength == expected.payloadLength());
+      for(uint16_t i=0; same && (i<rec.payloadLength); i++) { same = (image.bytes[rec.payloadOffset + i] == expected.payloadByte(i)); }
+      if(!same) { printf("  record %u parsed back wrong\n", recordsFound);  good = false; }
+      recordsFound++;
+    }
+    if(recordsFound != message.recordCount) { printf("  parsed %u records, expected %u\n", recordsFound, message.recordCount);  good = false; }
+  }
+  //// on a (simulated) tag:
+  NT3H1x01_simTag& simTag = is2kVariant ? simTag2k : simTag1k;
+  simTag.factoryReset();
+  NT3H1x01_thijs nfc(is2kVariant);  nfc.init(simTag);
+  bool fits = image.fits(nfc.memMap());
+  bool written = nfc._errGood(nfc.writeUserBytes_P(1, image.bytes, SIZE)) && nfc._errGood(nfc.setSess_LAST_NDEF_BLOCK(image.lastNdefBlock(1)));
+  if(written != fits) { printf("  writing it to the tag %s\n", written ? "worked, but it shouldn't fit" : "failed");  good = false; }
+  if(written) {
+    bool same = true;
+    for(uint8_t b=0; same && (b<image.blocks()); b++) {
+      uint8_t block[NT3H1x01_BLOCK_SIZE];  nfc.readUserBlock(1 + b, block);
+      for(uint8_t i=0; i<NT3H1x01_BLOCK_SIZE; i++) { same &= (block[i] == image.bytes[(b * NT3H1x01_BLOCK_SIZE) + i]); }
+      if(!same) { printf("  tag block %u differs\n", 1 + b);  good = false; }
+    }
+    if(nfc.getSess_LAST_NDEF_BLOCK() != image.lastNdefBlock(1)) { printf("  LAST_NDEF_BLOCK wrong\n");  good = false; }
+  }
+  printf("%-6s %s: %u records, message %4u bytes, image %3u blocks, LAST_NDEF_BLOCK 0x%02X, %-14s %s\n", name, is2kVariant ? "2k" : "1k", message.recordCount, message.size(),
+         image.blocks(), image.lastNdefBlock(1), fits ? "fits" : "doesn't fit", good ? "OK" : "FAIL");
+  return(good);
+}
+
+//// a URL with a counter in it, followed by a Text record (which has to move when the counter gets longer):
+constexpr NT3H1x01_ndefRecordData counterRecords[] = {NT3H1x01_ndefUri(NT3H1x01_URI_HTTPS, "example.com/tag?n=0000"), NT3H1x01_ndefText("en", FIFTY_CHARS FIFTY_CHARS)};
+constexpr NT3H1x01_ndefMessageData counterMessage = NT3H1x01_ndefMessage(counterRecords);
+static constexpr auto counterImage PROGMEM = NT3H1x01_NDEF_IMAGE(counterMessage);
+#define COUNTER_OFFSET 19 // where the counter is in the URI payload (after the prefix code byte and "example.com/tag?n=")
+
+/**
+ * check that the counter URL on the tag says what it should, the Text record is still intact, and LAST_NDEF_BLOCK is the block the message ends in
+ * @return true if it does
+ */
+bool checkCounter(NT3H1x01_thijs& nfc, const char* expectedCounter) {
+  uint8_t userMem[NT3H1x01_getMemMap(false).userBytes];
+  for(uint8_t b=0; b<(sizeof(userMem) / NT3H1x01_BLOCK_SIZE); b++) { nfc.readUserBlock(1 + b, &userMem[b * NT3H1x01_BLOCK_SIZE]); }
+  NT3H1x01_tlv tlv;  NT3H1x01_ndefRecord uri, text;  uint16_t pos;
+  if(!NT3H1x01_findTLV(userMem, sizeof(userMem), NT3H1x01_TLV_NDEF, tlv)) { return(false); }
+  pos = tlv.valueOffset;
+  if(!NT3H1x01_nextNdefRecord(userMem, tlv.valueOffset + tlv.length, pos, uri) || !NT3H1x01_nextNdefRecord(userMem, tlv.valueOffset + tlv.length, pos, text)) { return(false); }
+  uint16_t counterLength = strlen(expectedCounter);
+  if((uri.payloadLength != (COUNTER_OFFSET + counterLength)) || memcmp(&userMem[uri.payloadOffset + COUNTER_OFFSET], expectedCounter, counterLength)) { return(false); }
+  if((text.payloadLength != counterRecords[1].payloadLength()) || (userMem[text.payloadOffset + 3] != '0')) { return(false); }
+  if(nfc.getSess_LAST_NDEF_BLOCK() != (1 + ((tlv.valueOffset + tlv.length - 1) / NT3H1x01_BLOCK_SIZE))) { return(false); }
+  return(userMem[tlv.valueOffset + tlv.length] == NT3H1x01_TLV_TERMINATOR);
+}
+
+/**
+ * patch the counter in place a few times
+ * @return true if everything matches
+ */
+bool patchCounter() {
+  simTag1k.factoryReset();
+  NT3H1x01_thijs nfc(false);  nfc.init(simTag1k);
+  nfc.autoLastNdefBlock = NT3H1x01_AUTO_LAST_NDEF_SESS;
+  nfc.writeUserBytes_P(1, counterImage.bytes, sizeof(counterImage.bytes));
+  const char* counters[] = {"0042", "0043", "12345", "7", "0000000000000000000000000000000000000008", "9", "000000000010"}; // (same length, same length, 1 longer, 4 shorter, 39 longer, 39 shorter,
+                                                                                                                     //  11 longer: the NDEF TLV ends right at the end of a block, the Terminator TLV is in the next one)
+  const char* previous = "0000";  bool good = true;
+  for(uint8_t i=0; i<(sizeof(counters) / sizeof(counters[0])); i++) {
+    NT3H1x01_ndefPatchResult result;  uint32_t writesBefore = simTag1k.eepromBlockWrites;  uint8_t lastBlockBefore = nfc.getSess_LAST_NDEF_BLOCK();
+    NT3H1x01_ERR_RETURN_TYPE err = NT3H1x01_spliceNdefPayload(nfc, 0, COUNTER_OFFSET, strlen(previous), (const uint8_t*)counters[i], strlen(counters[i]), result);
+    bool thisGood = nfc._errGood(err) && checkCounter(nfc, counters[i]) && ((simTag1k.eepromBlockWrites - writesBefore) == result.blocksWritten)
+                 && ((result.shift == 0) || (result.lastBlock == nfc.getSess_LAST_NDEF_BLOCK())) // (the end of the NDEF TLV, just like findNdefEnd())
+                 && (result.blocksRead <= ((lastBlockBefore > nfc.getSess_LAST_NDEF_BLOCK()) ? lastBlockBefore : nfc.getSess_LAST_NDEF_BLOCK()) + 2); // (every block of the message is read about once, also when the data moves by more than a block)
+    printf("patch  1k: counter %-5s -> %-5s read %2u blocks, wrote %2u blocks (of %u), shift %+d, LAST_NDEF_BLOCK 0x%02X  %s\n", previous, counters[i], result.blocksRead, result.blocksWritten,
+           counterImage.blocks(), result.shift, nfc.getSess_LAST_NDEF_BLOCK(), thisGood ? "OK" : "FAIL");
+    good &= thisGood;  previous = counters[i];
+  }
+  return(good);
+}
+
+//// a long Text record, with part of the user memory locked halfway through it:
+constexpr NT3H1x01_ndefRecordData lockedRecords[] = {NT3H1x01_ndefText("en", FIFTY_CHARS FIFTY_CHARS FIFTY_CHARS FIFTY_CHARS "0123456789abcdefghijklmnopqrstuvwxyzA")};
+constexpr NT3H1x01_ndefMessageData lockedMessage = NT3H1x01_ndefMessage(lockedRecords);
+static constexpr auto lockedImage PROGMEM = NT3H1x01_NDEF_IMAGE(lockedMessage);
+
+/**
+ * splice some bytes into a record that runs through a locked area, which must fail before anything is written (a move that stops halfway leaves a broken message)
+ * @return true if it failed and the user memory is untouched
+ */
+bool spliceLocked() {
+  simTag2k.factoryReset();
+  NT3H1x01_thijs nfc(true);  nfc.init(simTag2k);
+  nfc.writeUserBytes_P(1, lockedImage.bytes, sizeof(lockedImage.bytes));
+  nfc.lockArea(0x04, 0x0B);
+  uint8_t memBefore[sizeof(simTag2k.mem)];  memcpy(memBefore, simTag2k.mem, sizeof(memBefore));
+  NT3H1x01_ndefPatchResult result;  uint32_t writesBefore = simTag2k.eepromBlockWrites;
+  NT3H1x01_ERR_RETURN_TYPE err = NT3H1x01_spliceNdefPayload(nfc, 0, 3, 0, (const uint8_t*)"12345", 5, result);
+  bool good = !nfc._errGood(err) && (result.blocksWritten == 0) && (simTag2k.eepromBlockWrites == writesBefore) && (memcmp(simTag2k.mem, memBefore, sizeof(memBefore)) == 0);
+  printf("splice 2k: %u byte record through a locked area (0x04~0x0B): refused, wrote %u blocks  %s\n", lockedMessage.size(), result.blocksWritten, good ? "OK" : "FAIL");
+  return(good);
+}
+
+int main() {
+  bool good = true;
+  for(uint8_t variant=0; variant<2; variant++) {
+    bool is2kVariant = variant;
+    good &= check("uri", uriImage, uriMessage, is2kVariant);
+    good &= check("text", textImage, textMessage, is2kVariant);
+    good &= check("vcard", vcardImage, vcardMessage, is2kVariant);
+    good &= check("multi", multiImage, multiMessage, is2kVariant);
+    good &= check("long", longImage, longMessage, is2kVariant);
+    good &= check("big", bigImage, bigMessage, is2kVariant);
+  }
+  good &= patchCounter();
+  good &= spliceLocked();
+  printf(good ? "all images match\n" : "MISMATCH\n");
+  return(good ? 0 : 1);
+}
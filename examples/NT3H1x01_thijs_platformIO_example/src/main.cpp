@@ -23,6 +23,7 @@ Every function has a C++ documentation comment above it, so if your IDE is suffi
 #include <NT3H1x01_thijs.h>
 
 NT3H1x01_thijs NFCtag(  false  ); // initialize 1k variant
+// NT3H1x01<NT3H1x01_VARIANT_1k> NFCtag; // alternatively, fix the variant at compile-time (smaller/faster code, especially on AVR and MSP430)
 
 
 #ifdef ARDUINO_ARCH_ESP32  // on the ESP32, almost any pin can become an I2C pin
@@ -96,10 +97,12 @@ void setup()
   #endif
 
   //// first, some basic checks. NOTE: will halt entire sketch if something's wrong
-  if(!NFCtag.connectionCheck()) { Serial.println("NT3H1x01 connection check failed!");    while(1);    } else { Serial.println("connection good"); }
-  Serial.print("UID: "); uint8_t UID[7]; NFCtag.getUID(UID); for(uint8_t i=0; i<7; i++) { Serial.print(UID[i], HEX); Serial.print(' '); } Serial.println();
+  NT3H1x01_deviceInfo info; // probe() reads block 0 just once, checks it and detects the variant (so the 'false' in the constructor above doesn't really matter)
+  if(!NFCtag.probe(info)) { Serial.println("NT3H1x01 probe failed!");    while(1);    } else { Serial.print("probe good, variant: "); Serial.println(info.is2kVariant ? "2k" : "1k"); }
+  // if(!NFCtag.connectionCheck()) { Serial.println("NT3H1x01 connection check failed!");    while(1);    } else { Serial.println("connection good"); } // (the old way: reads block 0 twice, and doesn't detect the variant)
+  Serial.print("UID: "); for(uint8_t i=0; i<7; i++) { Serial.print(info.UID[i], HEX); Serial.print(' '); } Serial.println(); // (or: uint8_t UID[7]; NFCtag.getUID(UID);)
   //if(!NFCtag.variantCheck()) { Serial.println("resetting CC to factory default..."); NFCtag.resetCC(); } // you can only change the CC bytes from I2C (not RF)
-  Serial.print("CC as bytes: "); uint8_t CC[4]; NFCtag.getCC(CC); for(uint8_t i=0; i<4; i++) { Serial.print(CC[i], HEX); Serial.print(' '); }
+  Serial.print("CC as bytes: "); for(uint8_t i=0; i<4; i++) { Serial.print(info.CC[i], HEX); Serial.print(' '); }
   Serial.print("  should be: "); Serial.println(NT3H1x01_CAPA_CONT_DEFAULT_uint32_t[NFCtag.is2kVariant], HEX);
   if(!NFCtag.variantCheck()) { Serial.println("NT3H1x01 variant check failed!");    while(1);     } else  { Serial.println("variant good"); }
   Serial.println(); // seperator
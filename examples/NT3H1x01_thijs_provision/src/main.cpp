@@ -0,0 +1,134 @@
+/*
+
+Runs the mass-provisioning pipeline (see NT3H1x01_thijs_provision.h) against simulated tags, on a host PC.
+Each thread is one programming station (one I2C bus, one NT3H1x01_provisioner) with a number of slots (simulated tags),
+ and all threads take tags from one shared stream (like tags coming off a reel).
+
+usage (from this folder, after building, see README.txt):
+  provision [--threads T] [--slots S] [--tags N] [--timing] [--image tag.img]
+    --threads  number of stations running in parallel (default 1)
+    --slots    tags per station (default 4)
+    --tags     total number of tags to program (default 1000)
+    --timing   turn on the timing model of the simulated tags (400kHz), so the results are what the real bus would do (instead of how fast the host is)
+    --image    program this image (made with the NT3H1x01_thijs_image example) instead of the built-in one
+
+*/
+
+#define NT3H1x01_useSimulator
+
+#include "NT3H1x01_thijs_provision.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <memory>
+
+std::atomic<int32_t> tagsLeft(0);     // the shared stream of tags
+std::atomic<uint32_t> nextUID(1);     // (so every simulated tag gets its own UID)
+
+/**
+ * one programming station (thread)
+ */
+struct station
+{
+  std::vector<std::unique_ptr<NT3H1x01_simTag>> simTags;
+  std::vector<std::unique_ptr<NT3H1x01_thijs>> tags;
+  NT3H1x01_provisioner provisioner;
+};
+
+/**
+ * put the next tag from the stream in a slot (here: reset the simulated tag, and give it a new UID)
+ */
+bool loadTag(uint8_t /*slot*/, NT3H1x01_thijs& tag, const NT3H1x01_provisionTag* finished, void* /*context*/) {
+  if(finished && !finished->success) { printf("tag %u failed in stage %s\n", finished->serial, NT3H1x01_PROVISION_STAGE_NAMES[finished->stage]); }
+  if(tagsLeft.fetch_sub(1) <= 0) { return(false); }
+  NT3H1x01_simTag& simTag = *tag._simTag;
+  simTag.factoryReset();
+  uint32_t UID = nextUID.fetch_add(1);
+  for(uint8_t i=0; i<4; i++) { simTag.mem[0][3+i] = UID >> (24 - 8*i); }
+  return(true);
+}
+
+/**
+ * write an NDEF URI record with the UID and serial number into the user memory (block 1 onwards)
+ */
+bool personalize(uint8_t blocks[], const NT3H1x01_provisionTag& tagState, void* /*context*/) {
+  char UIDhex[15];  NT3H1x01_UIDtoHex(tagState.UID, UIDhex);
+  char URI[64];
+  int URIlength = snprintf(URI, sizeof(URI), "example.com/t/%s?n=%u", UIDhex, tagState.serial);
+  if((URIlength < 0) || (URIlength >= (int)sizeof(URI))) { return(false); }
+  uint8_t* userMem = &blocks[NT3H1x01_BLOCK_SIZE]; // (user memory starts at block 1)
+  uint8_t payloadLength = 1 + URIlength; // (URI prefix code + the rest)
+  const uint8_t header[] = {0x03, (uint8_t)(4 + payloadLength), 0xD1, 0x01, payloadLength, 'U', 0x04}; // NDEF TLV, short well-known record, type 'U', prefix "https://"
+  memcpy(userMem, header, sizeof(header));
+  memcpy(&userMem[sizeof(header)], URI, URIlength);
+  userMem[sizeof(header) + URIlength] = 0xFE; // Terminator TLV
+  return(true);
+}
+
+void makeDemoImage(std::vector<uint8_t>& image) {
+  static NT3H1x01_simTag simTag(true);
+  NT3H1x01_thijs nfc(true);  nfc.init(simTag);
+  nfc.setConf_NC_FD_ON(NT3H1x01_FD_ON_TAG_SELECTED);
+  nfc.setConf_WDT(20000);
+  struct sink { static void append(const uint8_t data[], size_t length, void* context) { ((std::vector<uint8_t>*)context)->insert(((std::vector<uint8_t>*)context)->end(), data, data + length); } };
+  NT3H1x01_dumpImage(nfc, sink::append, &image);
+}
+
+void printStats(const NT3H1x01_provisionStats& stats, bool timing) {
+  printf("%u tags done, %u failed, %u blocks written, in %.3f s %s\n", stats.tagsDone, stats.tagsFailed, stats.blocksWritten,
+         stats.elapsedMicros / 1000000.0, timing ? "(simulated bus time)" : "(wall clock)");
+  printf("  %u tags per minute\n", stats.tagsPerMinute());
+  for(uint8_t i=0; i<NT3H1x01_PROVISION_STAGE_COUNT; i++) {
+    printf("  %-9s mean %6u us, p99 < %6u us, max %6u us\n", NT3H1x01_PROVISION_STAGE_NAMES[i], stats.stages[i].meanMicros(), stats.stages[i].percentileMicros(99), stats.stages[i].maxMicros);
+  }
+  printf("  %-9s mean %6u us, max %6u us\n", "per tag", stats.perTag.meanMicros(), stats.perTag.maxMicros);
+}
+
+int main(int argc, char* argv[]) {
+  int threadCount = 1, slotCount = 4, tagCount = 1000;  bool timing = false;  const char* imagePath = NULL;
+  for(int i=1; i<argc; i++) {
+    if((strcmp(argv[i], "--threads") == 0) && (i+1 < argc)) { threadCount = atoi(argv[++i]); }
+    else if((strcmp(argv[i], "--slots") == 0) && (i+1 < argc)) { slotCount = atoi(argv[++i]); }
+    else if((strcmp(argv[i], "--tags") == 0) && (i+1 < argc)) { tagCount = atoi(argv[++i]); }
+    else if((strcmp(argv[i], "--image") == 0) && (i+1 < argc)) { imagePath = argv[++i]; }
+    else if(strcmp(argv[i], "--timing") == 0) { timing = true; }
+    else { printf("usage: provision [--threads T] [--slots S] [--tags N] [--timing] [--image tag.img]   (see README.txt)\n"); return(2); }
+  }
+  if((threadCount < 1) || (slotCount < 1) || (slotCount > NT3H1x01_PROVISION_MAX_SLOTS)) { printf("1 or more threads, 1 to %u slots\n", NT3H1x01_PROVISION_MAX_SLOTS); return(2); }
+
+  std::vector<uint8_t> builtInImage;
+  const uint8_t* image;  size_t imageSize;
+  if(imagePath) {
+    image = NT3H1x01_mapImageFile(imagePath, imageSize);
+    if(!image) { printf("can't open %s\n", imagePath); return(2); }
+  } else { makeDemoImage(builtInImage);  image = builtInImage.data();  imageSize = builtInImage.size(); }
+
+  tagsLeft = tagCount;
+  std::vector<std::unique_ptr<station>> stations;
+  for(int t=0; t<threadCount; t++) {
+    stations.emplace_back(new station());
+    station& thisStation = *stations.back();
+    if(!thisStation.provisioner.begin(image, imageSize, loadTag, personalize)) { printf("invalid image\n"); return(2); }
+    for(int s=0; s<slotCount; s++) {
+      thisStation.simTags.emplace_back(new NT3H1x01_simTag(thisStation.provisioner.image.is2kVariant, NT3H1x01_DEFAULT_I2C_ADDRESS + s)); // (each slot at its own I2C address, on the one bus)
+      if(timing) { thisStation.simTags.back()->enableTiming(400000); } // (before the threads start, enableTiming() is not thread-safe)
+      thisStation.tags.emplace_back(new NT3H1x01_thijs(thisStation.provisioner.image.is2kVariant, NT3H1x01_DEFAULT_I2C_ADDRESS + s));
+      thisStation.tags.back()->init(*thisStation.simTags.back());
+      thisStation.provisioner.addSlot(*thisStation.tags.back());
+    }
+  }
+  std::vector<std::thread> threads;
+  for(int t=0; t<threadCount; t++) { threads.emplace_back([&stations, t]() { stations[t]->provisioner.run(); }); }
+  for(std::thread& thread : threads) { thread.join(); }
+
+  NT3H1x01_provisionStats total;
+  for(int t=0; t<threadCount; t++) { total.merge(stations[t]->provisioner.stats); }
+  printf("%d station(s) with %d slot(s) each:\n", threadCount, slotCount);
+  printStats(total, timing);
+  if(imagePath) { NT3H1x01_unmapImageFile(image, imageSize); }
+  return(total.tagsFailed ? 1 : 0);
+}
@@ -0,0 +1,131 @@
+/*
+
+Replays I2C traffic captured with NT3H1x01_capture (see _NT3H1x01_thijs_capture.h) into the simulated tag, on a host PC.
+Use it to reproduce what a deployed unit did (including the timing: WDT expiries, EEPROM busy time, etc.),
+ and to compare the bus cost of the same workload before and after a library change.
+
+usage (from this folder, after building, see README.txt):
+  replay field.log                  summarize the log, then replay it into a simulated tag (preloaded with what the log read) with the timing model on
+  replay before.log after.log       compare the transaction counts of 2 logs (exits with 1 if after.log is more expensive)
+  replay --demo demo.log            write a capture of a small workload (run on the simulated tag), to try the above with
+
+on target, capture with something like:
+  #define NT3H1x01_capture
+  ...
+  nfc.capture.begin(Serial, nfc.is2kVariant, nfc.slaveAddress);
+ and save the raw serial bytes to a file (e.g. with a terminal that can log binary data, or: cat /dev/ttyUSB0 > field.log)
+
+*/
+
+#define NT3H1x01_useSimulator
+#define NT3H1x01_simVirtualClock
+#define NT3H1x01_capture
+#define NT3H1x01_stats // (for NT3H1x01_busStats, which summarize() counts with)
+
+#include "NT3H1x01_thijs.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+/**
+ * read a whole file into memory
+ * @return false if it couldn't be read
+ */
+bool loadFile(const char* path, std::vector<uint8_t>& data) {
+  FILE* file = fopen(path, "rb");
+  if(!file) { printf("can't open %s\n", path); return(false); }
+  uint8_t chunk[256];  size_t got;
+  while((got = fread(chunk, 1, sizeof(chunk), file)) > 0) { data.insert(data.end(), chunk, chunk + got); }
+  fclose(file);
+  return(true);
+}
+
+/**
+ * count the bus cost of a log (using the same counting rules as yourTag.stats)
+ * @return false if the log header is bad
+ */
+bool summarize(const std::vector<uint8_t>& log, NT3H1x01_busStats& stats, uint32_t& durationMicros) {
+  NT3H1x01_captureReader reader(log.data(), log.size());
+  if(!reader.begin()) { return(false); }
+  NT3H1x01_captureRecord rec;  durationMicros = 0;
+  while(reader.next(rec)) {
+    uint8_t byteCount = (rec.op == NT3H1x01_TRACE_WRITE_SESS) ? 1 : rec.payloadLength; // (WRITE_SESS payload also holds the mask)
+    stats.countPrimitive(rec.op, rec.blockAddress, byteCount, rec.errGood, NT3H1x01_ERR_RETURN_TYPE_OK);
+    durationMicros = rec.timestamp;
+  }
+  if(reader._pos != log.size()) { printf("(log is truncated or corrupt after byte %u)\n", (unsigned int)reader._pos); }
+  return(true);
+}
+
+void printSummary(const char* name, const NT3H1x01_busStats& stats, uint32_t durationMicros) {
+  printf("%s: %u transactions, %u bytes read, %u bytes written, %u EEPROM writes, %u errors, over %u us\n", name,
+         stats.transactions, stats.bytesRead, stats.bytesWritten, stats.eepromBlockWrites, stats.errors, durationMicros);
+  for(uint8_t i=0; i<5; i++) { printf("  %-12s %u\n", NT3H1x01_TRACE_OP_NAMES[i], stats.primitiveCalls[i]); }
+}
+
+int replay(const char* path) {
+  std::vector<uint8_t> log;
+  if(!loadFile(path, log)) { return(2); }
+  NT3H1x01_busStats stats;  uint32_t durationMicros;
+  if(!summarize(log, stats, durationMicros)) { printf("%s is not a capture log\n", path); return(2); }
+  printSummary(path, stats, durationMicros);
+
+  static NT3H1x01_simTag simTag(true); // (static, it's 4kB)
+  NT3H1x01_seedFromCapture(log.data(), log.size(), simTag); // start from the same memory contents as the real tag
+  simTag.enableTiming(400000);
+  NT3H1x01_replayResult result = NT3H1x01_replayCapture(log.data(), log.size(), simTag);
+  printf("\nreplayed %u records into the simulated tag (400kHz timing model):\n", result.records);
+  printf("  read mismatches: %u, success/fail differences: %u", result.mismatches, result.errDiffs);
+  if(result.firstMismatch >= 0) { printf(" (first at record %d)", result.firstMismatch); }
+  printf("\n  captured: %u us (%u errors),  simulated: %u us\n", result.capturedMicros, result.capturedErrors, (uint32_t)simTag.virtualMicros);
+  printf("  clock stretched: %u us, EEPROM busy NACKs: %u, RF locked NACKs: %u, WDT expiries: %u\n",
+         simTag.stretchedMicros, simTag.busyNACKs, simTag.rfLockedNACKs, simTag.wdtExpiries);
+  return(0);
+}
+
+int compare(const char* beforePath, const char* afterPath) {
+  std::vector<uint8_t> beforeLog, afterLog;
+  if(!loadFile(beforePath, beforeLog) || !loadFile(afterPath, afterLog)) { return(2); }
+  NT3H1x01_busStats before, after;  uint32_t beforeMicros, afterMicros;
+  if(!summarize(beforeLog, before, beforeMicros)) { printf("%s is not a capture log\n", beforePath); return(2); }
+  if(!summarize(afterLog, after, afterMicros)) { printf("%s is not a capture log\n", afterPath); return(2); }
+  printSummary(beforePath, before, beforeMicros);
+  printSummary(afterPath, after, afterMicros);
+  bool worse = (after.transactions > before.transactions) || ((after.bytesRead + after.bytesWritten) > (before.bytesRead + before.bytesWritten)) || (after.eepromBlockWrites > before.eepromBlockWrites);
+  printf("\ntransactions %+d, bytes %+d, EEPROM writes %+d -> %s\n", (int)(after.transactions - before.transactions),
+         (int)((after.bytesRead + after.bytesWritten) - (before.bytesRead + before.bytesWritten)), (int)(after.eepromBlockWrites - before.eepromBlockWrites),
+         worse ? "REGRESSION" : "ok");
+  return(worse ? 1 : 0);
+}
+
+int demo(const char* path) {
+  FILE* file = fopen(path, "wb");
+  if(!file) { printf("can't write %s\n", path); return(2); }
+  static NT3H1x01_simTag simTag(true);
+  simTag.enableTiming(400000);
+  NT3H1x01_thijs nfc(true);  nfc.init(simTag);
+  nfc.capture.begin(file, nfc.is2kVariant, nfc.slaveAddress);
+  //// a typical little workload:
+  uint8_t UID[7];  nfc.getUID(UID);
+  nfc.setSess_NC_FD_ON(NT3H1x01_FD_ON_TAG_SELECTED);
+  nfc.setConf_WDT(20000);
+  uint8_t block[NT3H1x01_BLOCK_SIZE] = {0x03,0x0B,0xD1,0x01,0x07,0x54,0x02,'e','n','H','e','l','l','o',0xFE,0x00};
+  nfc.writeUserBlock(0x01, block);
+  simTag.advanceTime(30000); // (the host does something else for a while)
+  nfc.readUserBlock(0x01, block);
+  nfc.getNS_REG();
+  nfc.capture.end();
+  fclose(file);
+  printf("wrote %u records to %s\n", nfc.capture.recorded, path);
+  return(0);
+}
+
+int main(int argc, char* argv[]) {
+  if((argc == 3) && (strcmp(argv[1], "--demo") == 0)) { return(demo(argv[2])); }
+  if(argc == 2) { return(replay(argv[1])); }
+  if(argc == 3) { return(compare(argv[1], argv[2])); }
+  printf("usage: %s field.log | %s before.log after.log | %s --demo demo.log\n", argv[0], argv[0], argv[0]);
+  return(2);
+}
@@ -0,0 +1,109 @@
+/*
+
+Checks the bus statistics (yourTag.stats, see _NT3H1x01_thijs_stats.h) against the simulated tag's own counters, on a host PC, on both variants:
+a mixed workload (Session and Configuration registers, user memory, the field API, a few functions that call other public functions)
+ is run on a simulated tag, after which the transactions, bytes and EEPROM writes the library counted must equal what the tag saw,
+ and every public function must have exactly as many calls in its latency histogram as the workload made (nested calls don't count),
+ with the register field templates counted per field (e.g. "set<NT3H1x01_Sess_LAST_NDEF_BLOCK>").
+The latencies come from the simulated tag's virtual clock (see NT3H1x01_simVirtualClock), so they're deterministic.
+
+usage (from this folder, after building, see README.txt):
+  stats       prints the latency histograms and the counters, exits with 1 if anything doesn't match
+
+*/
+
+#define NT3H1x01_useSimulator
+#define NT3H1x01_simVirtualClock
+#define NT3H1x01_stats
+
+#include "NT3H1x01_thijs.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define ROUNDS 5
+
+static NT3H1x01_simTag simTag1k(false), simTag2k(true); // (static, they're 4kB each)
+
+/**
+ * a public function and how many times the workload calls it directly
+ */
+struct expectedCalls { const char* name; uint32_t calls; };
+
+/**
+ * check that a public function's histogram holds the right number of calls
+ * @return true if it does
+ */
+bool checkCalls(const NT3H1x01_busStats& stats, const expectedCalls& expected) {
+  const NT3H1x01_latencyHist* hist = stats.apiHist(expected.name);
+  uint32_t count = hist ? hist->count : 0;
+  bool good = (count == expected.calls) && (!hist || (hist->percentileMicros(99) <= hist->maxMicros));
+  if(!good) { printf("  %s(): %u calls counted, %u made  MISMATCH\n", expected.name, count, expected.calls); }
+  return(good);
+}
+
+int main() {
+  bool good = true;
+  for(uint8_t variant=0; variant<2; variant++) {
+    NT3H1x01_simTag& simTag = variant ? simTag2k : simTag1k;
+    simTag.enableTiming(400000);
+    NT3H1x01_thijs nfc(variant);  nfc.init(simTag);
+    const NT3H1x01_memMap map = nfc.memMap();
+    uint8_t block[NT3H1x01_BLOCK_SIZE],  UID[7];
+    for(uint8_t round=0; round<ROUNDS; round++) {
+      for(uint8_t i=0; i<NT3H1x01_BLOCK_SIZE; i++) { block[i] = round * 16 + i; }
+      nfc.writeUserBlock(map.userStart + round, block);
+      nfc.readUserBlock(map.userStart + round, block);
+      nfc.getUID(UID);
+      nfc.setSess_NC_DIR(round & 1);
+      nfc.getSess_NC_DIR();            // (getVal<>() and requestSessRegByte() inside don't count)
+      nfc.getNS_REG();
+      nfc.setConf_WDT(20000.0 + round);  // (setConf_WDTraw() inside doesn't count)
+      nfc.getConf_WDTraw();
+      nfc.getConf_NC_FD_ON(true);       // (from the cache, as setConf_WDT() just read that block)
+      nfc.set<NT3H1x01_Sess_NC_FD_ON, NT3H1x01_Sess_NC_FD_OFF>(NT3H1x01_FD_ON_FIELD_PRESENCE, NT3H1x01_FD_OFF_FIELD_PRESENCE);
+      nfc.set<NT3H1x01_Sess_LAST_NDEF_BLOCK>(map.userStart + round); // (counted per field, not all as "set")
+      if(round == 0) { nfc.set<NT3H1x01_Sess_SRAM_MIRROR_BLOCK>(0xF8); }
+      nfc.setNS_I2C_LOCKED(false);
+    }
+    uint8_t data[40];  for(uint8_t i=0; i<sizeof(data); i++) { data[i] = i; }
+    nfc.writeUserBytes(map.userStart + 8, data, sizeof(data));
+    nfc.requestMemBlock(0, block);
+
+    const NT3H1x01_busStats& stats = nfc.stats;
+    printf("%s variant:\n", variant ? "2k" : "1k");
+    for(uint8_t i=0; (i<NT3H1x01_STATS_API_SLOTS) && (stats.apis[i].name != NULL); i++) {
+      const NT3H1x01_latencyHist& hist = stats.apis[i].hist;
+      printf("  %-52s n:%3u  mean:%6u us  p99:<=%6u us  max:%6u us  (%4.1f%% of the time)\n", stats.apis[i].name, hist.count, hist.meanMicros(),
+             hist.percentileMicros(99), hist.maxMicros, 100.0 * stats.timeShare(stats.apis[i].name));
+    }
+    //// the counters vs. what the tag saw:
+    uint32_t simTransactions = simTag.writeTransactions + simTag.readTransactions;
+    bool countersGood = (stats.transactions == simTransactions) && (stats.bytesRead == simTag.bytesRead) && (stats.bytesWritten == simTag.bytesWritten)
+                     && (stats.eepromBlockWrites == simTag.eepromBlockWrites) && (stats.errors == 0) && (stats.apiOverflow == 0) && (stats._apiDepth == 0);
+    printf("  transactions %u (tag: %u), read %u B (tag: %u B), written %u B (tag: %u B), EEPROM writes %u (tag: %u), cache hits %u  %s\n",
+           stats.transactions, simTransactions, stats.bytesRead, simTag.bytesRead, stats.bytesWritten, simTag.bytesWritten,
+           stats.eepromBlockWrites, simTag.eepromBlockWrites, stats.cacheHits, countersGood ? "OK" : "MISMATCH");
+    good &= countersGood && (stats.cacheHits == ROUNDS);
+    //// the calls vs. what the workload made:
+    const expectedCalls expected[] = {
+      {"writeUserBlock", ROUNDS}, {"readUserBlock", ROUNDS}, {"getUID", ROUNDS}, {"setSess_NC_DIR", ROUNDS}, {"getSess_NC_DIR", ROUNDS},
+      {"getNS_REG", ROUNDS}, {"setConf_WDT", ROUNDS}, {"getConf_WDTraw", ROUNDS}, {"getConf_NC_FD_ON", ROUNDS},
+      {"set<NT3H1x01_Sess_NC_FD_ON,NT3H1x01_Sess_NC_FD_OFF>", ROUNDS}, {"set<NT3H1x01_Sess_LAST_NDEF_BLOCK>", ROUNDS}, {"set<NT3H1x01_Sess_SRAM_MIRROR_BLOCK>", 1},
+      {"setNS_I2C_LOCKED", ROUNDS}, {"writeUserBytes", 1}, {"requestMemBlock", 1},
+      {"set", 0}, {"getVal<NT3H1x01_Sess_NC_DIR>", 0}, {"requestSessRegByte", 0}, {"setConf_WDTraw", 0}, {"writeMemBlock", 0}, {"writeUserBytesFrom", 0} // (only ever called from inside others)
+    };
+    bool callsGood = true;
+    for(uint8_t i=0; i<(sizeof(expected)/sizeof(expected[0])); i++) { callsGood &= checkCalls(stats, expected[i]); }
+    float shares = 0;  for(uint8_t i=0; (i<NT3H1x01_STATS_API_SLOTS) && (stats.apis[i].name != NULL); i++) { shares += stats.timeShare(stats.apis[i].name); }
+    callsGood &= (shares > 0.999) && (shares < 1.001);
+    printf("  calls per public function %s\n", callsGood ? "OK" : "MISMATCH");
+    good &= callsGood;
+    //// reset() starts over:
+    nfc.stats.reset();
+    nfc.getNS_REG();
+    good &= (stats.transactions == 2) && (stats.apiHist("getNS_REG") != NULL) && (stats.apiHist("getNS_REG")->count == 1) && (stats.apiHist("getUID") == NULL);
+  }
+  printf(good ? "stats OK\n" : "FAILED\n");
+  return(good ? 0 : 1);
+}
@@ -0,0 +1,157 @@
+/*
+
+Round-trip check of the streaming functions (see NT3H1x01_thijs_stream.h), on a host PC with the simulated tag (no hardware needed):
+ the blocking NT3H1x01_streamToTag() / NT3H1x01_streamFromTag() and the worker's (double-buffered) streamToTag() / streamFromTag() (see NT3H1x01_thijs_worker.h),
+ on both the 1k and the 2k variant.
+For a range of payload sizes (empty, less than a block, exactly a block, a few blocks, exactly the whole user memory and 1 byte too much),
+ every combination of writer and reader (blocking/worker) must:
+ - write the payload into the user memory as-is, with the rest of the last block filled with 0's,
+ - set LAST_NDEF_BLOCK (Session registers, and the Configuration registers too if persistent) to the last block that holds data,
+ - leave the Dynamic Locking bytes alone (they share the last user block on the 1k variant),
+ - report a payload that doesn't fit as a failure (and set 'truncated'), but still write the part that fits,
+ - read back exactly the blocks up to LAST_NDEF_BLOCK (or the whole user memory if it's not set).
+And with part of the user memory locked (see lockArea()), both writers must stop right before the first locked block:
+ without taking data from the source for it, without writing it, and without setting LAST_NDEF_BLOCK.
+
+usage (from this folder, after building, see README.txt):
+  stream      prints one line per variant and writer/reader combination, exits with 1 if anything didn't match
+
+*/
+
+#define NT3H1x01_useSimulator
+
+#include "NT3H1x01_thijs_worker.h" // (includes NT3H1x01_thijs_stream.h)
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+static NT3H1x01_simTag simTag(true); // (static, it's 4kB)
+
+/**
+ * a payload in RAM, as a source (for streamToTag) and a sink (for streamFromTag)
+ */
+struct memStream
+{
+  std::vector<uint8_t> data;
+  size_t pos = 0;
+  static size_t read(uint8_t buff[], size_t length, void* context) {
+    memStream& self = *((memStream*)context);
+    if(length > (self.data.size() - self.pos)) { length = self.data.size() - self.pos; }
+    memcpy(buff, self.data.data() + self.pos, length);  self.pos += length;
+    return(length);
+  }
+  static size_t write(const uint8_t data[], size_t length, void* context) {
+    memStream& self = *((memStream*)context);
+    self.data.insert(self.data.end(), data, data + length);
+    return(length);
+  }
+};
+
+uint16_t failures = 0;
+/**
+ * count (and print the first few) failed checks
+ */
+void check(bool good, const char* what, bool is2kVariant, bool workerWrites, bool workerReads, size_t size) {
+  if(good) { return; }
+  failures++;
+  if(failures <= 20) { printf("  FAIL: %s (%s, %s writer, %s reader, %u bytes)\n", what, is2kVariant ? "2k" : "1k", workerWrites ? "worker" : "blocking", workerReads ? "worker" : "blocking", (unsigned)size); }
+}
+
+/**
+ * write a payload with one API and read it back with the other (or the same), on a freshly reset tag
+ */
+void roundTrip(NT3H1x01_thijs& nfc, NT3H1x01_worker& worker, bool workerWrites, bool workerReads, size_t size, bool persistent) {
+  const NT3H1x01_memMap memMap = nfc.memMap();
+  const bool is2k = nfc.is2kVariant;
+  simTag.factoryReset();  nfc.forgetLocks();
+  nfc._oneBlockBuffAddress = NT3H1x01_INVALID_MEMA;
+  uint8_t dynaLockBefore[3];  memcpy(dynaLockBefore, &simTag.mem[memMap.dynaLockMEMA][memMap.dynaLockByte], 3);
+
+  memStream source;
+  for(size_t i=0; i<size; i++) { source.data.push_back((uint8_t)((i * 7) ^ (i >> 3) ^ 0x5A)); }
+  NT3H1x01_streamResult result;
+  NT3H1x01_ERR_RETURN_TYPE err = workerWrites ? worker.streamToTag(memStream::read, &source, result, 0, persistent)
+                                              : NT3H1x01_streamToTag(nfc, memStream::read, &source, result, 0, persistent);
+  const bool fits = (size <= memMap.userBytes);
+  const size_t written = fits ? size : memMap.userBytes;
+  check(nfc._errGood(err) == fits, "streamToTag() result", is2k, workerWrites, workerReads, size);
+  check(result.truncated == !fits, "truncated", is2k, workerWrites, workerReads, size);
+  check(result.bytes == written, "bytes written", is2k, workerWrites, workerReads, size);
+
+  //// the user memory itself (straight from the simulated tag):
+  uint8_t expectedLast = 0;  size_t offset = 0;  bool memGood = true;
+  for(uint8_t blockAddress=memMap.userStart; memMap.isUserBlock(blockAddress); blockAddress++) {
+    uint8_t bytesInBlock = memMap.userBytesInBlock(blockAddress);
+    if(offset >= written) { break; }
+    for(uint8_t i=0; i<bytesInBlock; i++) { memGood &= (simTag.mem[blockAddress][i] == (((offset + i) < written) ? source.data[offset + i] : 0)); }
+    expectedLast = blockAddress;  offset += bytesInBlock;
+  }
+  check(memGood, "user memory contents", is2k, workerWrites, workerReads, size);
+  check(result.lastBlock == expectedLast, "result.lastBlock", is2k, workerWrites, workerReads, size);
+  check(memcmp(dynaLockBefore, &simTag.mem[memMap.dynaLockMEMA][memMap.dynaLockByte], 3) == 0, "Dynamic Locking bytes untouched", is2k, workerWrites, workerReads, size);
+  check(nfc.getSess_LAST_NDEF_BLOCK() == expectedLast, "Session LAST_NDEF_BLOCK", is2k, workerWrites, workerReads, size);
+  check((nfc.getConf_LAST_NDEF_BLOCK() == expectedLast) == (persistent || (expectedLast == 0)), "Configuration LAST_NDEF_BLOCK", is2k, workerWrites, workerReads, size);
+
+  //// and back:
+  memStream sink;
+  err = workerReads ? worker.streamFromTag(memStream::write, &sink, result) : NT3H1x01_streamFromTag(nfc, memStream::write, &sink, result);
+  const uint8_t lastRead = expectedLast ? expectedLast : memMap.userEnd; // (LAST_NDEF_BLOCK not set: the whole user memory)
+  size_t expectedBytes = 0;  for(uint8_t b=memMap.userStart; b<=lastRead; b++) { expectedBytes += memMap.userBytesInBlock(b); }
+  check(nfc._errGood(err), "streamFromTag() result", is2k, workerWrites, workerReads, size);
+  check((result.bytes == expectedBytes) && (sink.data.size() == expectedBytes) && (result.lastBlock == lastRead), "bytes read", is2k, workerWrites, workerReads, size);
+  bool readGood = (sink.data.size() >= written) && (memcmp(sink.data.data(), source.data.data(), written) == 0);
+  for(size_t i=written; i<sink.data.size(); i++) { readGood &= (sink.data[i] == 0); } // (the padding of the last block, or the empty user memory)
+  check(readGood, "read back contents", is2k, workerWrites, workerReads, size);
+}
+
+/**
+ * stream a payload over a locked area (on a freshly reset tag), which must fail before the locked block is touched
+ */
+void lockedWrite(NT3H1x01_thijs& nfc, NT3H1x01_worker& worker, bool workerWrites, uint8_t lockBlock) {
+  const NT3H1x01_memMap memMap = nfc.memMap();
+  const bool is2k = nfc.is2kVariant;
+  simTag.factoryReset();  nfc.forgetLocks();
+  nfc._oneBlockBuffAddress = NT3H1x01_INVALID_MEMA;
+  check(nfc._errGood(nfc.lockArea(lockBlock, lockBlock)), "lockArea()", is2k, workerWrites, false, 0);
+  uint8_t firstLocked = memMap.userStart;  while(!nfc.isLocked(firstLocked)) { firstLocked++; } // (lockArea() may round the area down to what 1 lock bit covers)
+  uint8_t lockedBefore[NT3H1x01_BLOCK_SIZE];  memcpy(lockedBefore, simTag.mem[firstLocked], NT3H1x01_BLOCK_SIZE);
+  memStream source;
+  for(size_t i=0; i<memMap.userBytes; i++) { source.data.push_back((uint8_t)(i ^ 0xA5)); }
+  NT3H1x01_streamResult result;
+  NT3H1x01_ERR_RETURN_TYPE err = workerWrites ? worker.streamToTag(memStream::read, &source, result) : NT3H1x01_streamToTag(nfc, memStream::read, &source, result);
+  const size_t writable = (firstLocked - memMap.userStart) * NT3H1x01_BLOCK_SIZE;
+  check(!nfc._errGood(err), "streamToTag() over a locked block fails", is2k, workerWrites, false, source.data.size());
+  check(source.pos == writable, "no data taken for the locked block", is2k, workerWrites, false, source.data.size());
+  check(memcmp(lockedBefore, simTag.mem[firstLocked], NT3H1x01_BLOCK_SIZE) == 0, "locked block untouched", is2k, workerWrites, false, source.data.size());
+  bool beforeGood = true;  for(size_t i=0; i<writable; i++) { beforeGood &= (simTag.mem[memMap.userStart + (i / NT3H1x01_BLOCK_SIZE)][i % NT3H1x01_BLOCK_SIZE] == source.data[i]); }
+  check(beforeGood, "the blocks before it are written", is2k, workerWrites, false, source.data.size());
+  check(nfc.getSess_LAST_NDEF_BLOCK() == 0, "LAST_NDEF_BLOCK not set", is2k, workerWrites, false, source.data.size());
+}
+
+int main() {
+  for(uint8_t variant=0; variant<2; variant++) {
+    const bool is2k = (variant == 1);
+    simTag.is2kVariant = is2k;  simTag.factoryReset();
+    NT3H1x01_thijs nfc(is2k);  nfc.init(simTag);
+    NT3H1x01_worker worker(nfc);  worker.start();
+    const uint16_t userBytes = nfc.memMap().userBytes;
+    const size_t sizes[] = {0, 1, 15, 16, 17, 100, 257, (size_t)(userBytes - 1), userBytes, (size_t)(userBytes + 1)};
+    for(uint8_t combination=0; combination<4; combination++) {
+      const bool workerWrites = combination & 1,  workerReads = combination & 2;
+      uint16_t failuresBefore = failures;
+      for(size_t s=0; s<(sizeof(sizes)/sizeof(sizes[0])); s++) { roundTrip(nfc, worker, workerWrites, workerReads, sizes[s], (s % 2) == 0); }
+      printf("%s  %-8s writer, %-8s reader: %s\n", is2k ? "2k" : "1k", workerWrites ? "worker" : "blocking", workerReads ? "worker" : "blocking", (failures == failuresBefore) ? "OK" : "FAIL");
+    }
+    for(uint8_t workerWrites=0; workerWrites<2; workerWrites++) {
+      uint16_t failuresBefore = failures;
+      lockedWrite(nfc, worker, workerWrites, 0x05); // (a Static Locking bit)
+      lockedWrite(nfc, worker, workerWrites, 0x20); // (a Dynamic Locking bit)
+      printf("%s  %-8s writer, locked area:     %s\n", is2k ? "2k" : "1k", workerWrites ? "worker" : "blocking", (failures == failuresBefore) ? "OK" : "FAIL");
+    }
+    worker.stop();
+  }
+  bool good = (failures == 0);
+  printf(good ? "streams OK\n" : "FAILED\n");
+  return(good ? 0 : 1);
+}
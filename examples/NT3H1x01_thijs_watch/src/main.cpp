@@ -0,0 +1,100 @@
+/*
+
+Demonstrates change detection (see NT3H1x01_thijs_watch.h) on a host PC:
+a (simulated) phone writes to the tag a few times, during RF access windows (with the timing model on, see _NT3H1x01_thijs_sim.h),
+ and the watcher polls NS_REG, syncs once the phone lets go of the memory, and reports only the blocks that changed.
+Each sync is compared against what the phone actually changed, and against reading the whole user memory (119 blocks on the 2k variant).
+
+usage (from this folder, after building, see README.txt):
+  watch       prints what every sync cost, exits with 1 if a change is missed (or reported when there was none)
+
+*/
+
+#define NT3H1x01_useSimulator
+
+#include "NT3H1x01_thijs_watch.h"
+
+#include <stdio.h>
+#include <string.h>
+
+static NT3H1x01_simTag simTag(true); // (static, it's 4kB)
+
+static uint8_t reported[NT3H1x01_WATCH_MAX_BLOCKS]; // which blocks the watcher reported (indexed from the start of the user memory)
+
+/**
+ * NT3H1x01_watchChangeFunc that checks the reported contents against the simulated memory
+ */
+void blockChanged(uint8_t blockAddress, const uint8_t block[], void* context) {
+  bool& good = *(bool*)context;
+  reported[blockAddress - 1] = 1;
+  good &= (memcmp(block, simTag.mem[blockAddress], NT3H1x01_BLOCK_SIZE) == 0);
+}
+
+/**
+ * write a message the way a phone would: every block of it, from the RF side, during an RF access window
+ * @param text the text of a single Text record
+ * @param changedBlocks (reference) how many blocks actually end up different
+ */
+void phoneWrites(const char* text, uint8_t& changedBlocks) {
+  NT3H1x01_ndefRecordData record = NT3H1x01_ndefText("en", 2, text, strlen(text));
+  uint8_t image[NT3H1x01_WATCH_MAX_BLOCKS * NT3H1x01_BLOCK_SIZE];
+  uint16_t size = NT3H1x01_encodeNdefMessage(&record, 1, image, sizeof(image));
+  changedBlocks = 0;
+  for(uint16_t offset=0; offset<size; offset+=NT3H1x01_BLOCK_SIZE) {
+    changedBlocks += (memcmp(simTag.mem[1 + offset/NT3H1x01_BLOCK_SIZE], &image[offset], NT3H1x01_BLOCK_SIZE) != 0);
+    simTag.rfWriteBlock(1 + offset/NT3H1x01_BLOCK_SIZE, &image[offset]);
+  }
+  simTag.addRFwindow(simTag.virtualMicros + 2000, 3000 + 1000 * (size / NT3H1x01_BLOCK_SIZE)); // (the phone holds the memory while it writes)
+}
+
+/**
+ * poll the watcher (every millisecond) until it synced, and check it reported exactly what changed
+ * @param watcher the watcher
+ * @param name what the phone did (for printing)
+ * @param expectChanged how many blocks the phone actually changed
+ * @return true if the sync reported exactly the changed blocks
+ */
+bool pollUntilSynced(NT3H1x01_ndefWatcher<NT3H1x01_VARIANT_RUNTIME>& watcher, const char* name, uint8_t expectChanged) {
+  memset(reported, 0, sizeof(reported));
+  bool good = true;  NT3H1x01_watchResult result;  uint16_t polls = 0;
+  for(polls=1; polls<100; polls++) {
+    simTag.advanceTime(1000);
+    NT3H1x01_ERR_RETURN_TYPE err = watcher.service(blockChanged, &good, result);
+    good &= watcher.tag._errGood(err);
+    if(result.synced) { break; }
+  }
+  uint8_t reportedCount = 0;  for(uint8_t i=0; i<NT3H1x01_WATCH_MAX_BLOCKS; i++) { reportedCount += reported[i]; }
+  good &= result.synced && (result.blocksChanged == expectChanged) && (reportedCount == expectChanged);
+  printf("%-28s synced after %2u polls: read %2u blocks (up to 0x%02X, instead of 119), %u changed (expected %u) %s\n",
+         name, polls, result.blocksRead, result.lastBlock, result.blocksChanged, expectChanged, good ? "OK" : "MISMATCH");
+  return(good);
+}
+
+int main() {
+  bool good = true;
+  simTag.enableTiming();
+  NT3H1x01_thijs nfc(true);  nfc.init(simTag);
+  NT3H1x01_ndefWatcher<NT3H1x01_VARIANT_RUNTIME> watcher(nfc);
+
+  //// the first sync reports everything (there's nothing to compare to):
+  uint8_t changedBlocks;
+  phoneWrites("Hello, this is the first message", changedBlocks);
+  simTag.advanceTime(10000); // (let the phone finish)
+  NT3H1x01_watchResult result;
+  NT3H1x01_ERR_RETURN_TYPE err = watcher.sync(blockChanged, &good, result);
+  printf("%-28s read %2u blocks, %u reported\n", "first sync:", result.blocksRead, result.blocksChanged);
+  good &= nfc._errGood(err) && (result.blocksChanged == (result.lastBlock - nfc.memMap().userStart + 1));
+
+  //// then every phone write should report only what it changed:
+  phoneWrites("Hello, this is the first massage", changedBlocks); // (1 letter)
+  good &= pollUntilSynced(watcher, "1 letter changed:", changedBlocks);
+  phoneWrites("Hello, this is a much longer message, which takes a couple more blocks than the first one did", changedBlocks);
+  good &= pollUntilSynced(watcher, "longer message:", changedBlocks);
+  phoneWrites("Hello, this is a much longer message, which takes a couple more blocks than the first one did", changedBlocks); // (the same again)
+  good &= pollUntilSynced(watcher, "same message again:", 0);
+  phoneWrites("Short", changedBlocks);
+  good &= pollUntilSynced(watcher, "short message:", changedBlocks);
+
+  printf(good ? "change detection OK\n" : "FAILED\n");
+  return(good ? 0 : 1);
+}
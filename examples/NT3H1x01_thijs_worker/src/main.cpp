@@ -0,0 +1,195 @@
+/*
+
+Benchmark of the I2C worker (see NT3H1x01_thijs_worker.h) under contention, on a host PC:
+the simulated tag is paced to real time (see pace()), so every transaction takes as long as it would on a real bus (at 400kHz),
+ and EEPROM writes keep the bus (clock-stretched) for ~4ms, like on the real tag.
+Then 1, 2, 4 and 8 threads share the tag through the worker, each one writing its own block and reading it back (1 write per 3 reads),
+ one request at a time (so the latency is how long it waits behind the other threads, plus its own bus time).
+The same requests as direct calls (from a single thread, no worker) are the baseline.
+Finally, a job submits requests (and a whole streamToTag()/streamFromTag()) from the worker itself, which must run inline instead of deadlocking.
+
+usage (from this folder, after building, see README.txt):
+  worker      prints one line per number of threads, exits with 1 if any request failed or read back the wrong data
+
+NOTE: the times come from the wall clock, so they wobble a little from run to run (the order of magnitude is what matters).
+
+*/
+
+#define NT3H1x01_useSimulator
+
+#include "NT3H1x01_thijs_worker.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include <algorithm>
+
+#define REQUESTS_PER_THREAD 48
+#define MAX_THREADS 8
+
+static NT3H1x01_simTag simTag(true); // (static, it's 4kB)
+
+//// pacing the simulated tag to real time:
+static std::chrono::steady_clock::time_point paceStart;
+static uint64_t paceStartVirtual = 0;
+/**
+ * NT3H1x01_simTag::betweenTransactions callback: sleep until the wall clock catches up with the virtual clock of the simulated tag
+ *  (so the previous transaction took as long as the timing model says it does, including clock stretching during EEPROM writes)
+ */
+void pace(void* context) {
+  NT3H1x01_simTag& sim = *((NT3H1x01_simTag*)context);
+  std::this_thread::sleep_until(paceStart + std::chrono::microseconds(sim.virtualMicros - paceStartVirtual));
+}
+void restartPacing() { paceStart = std::chrono::steady_clock::now();  paceStartVirtual = simTag.virtualMicros; }
+
+/**
+ * the results of one run
+ */
+struct runResult
+{
+  std::vector<uint32_t> latencies; // of every request (microseconds)
+  uint32_t errors = 0,  mismatches = 0;
+  double seconds = 0;
+};
+
+/**
+ * the block a thread writes (and reads back)
+ */
+uint8_t blockOf(uint8_t thread) { return(2 + thread); } // (in the user memory, which starts at block 1)
+/**
+ * what a thread writes to its block for request i
+ */
+void makeBlock(uint8_t thread, uint16_t i, uint8_t block[]) { for(uint8_t j=0; j<NT3H1x01_BLOCK_SIZE; j++) { block[j] = (thread << 5) ^ (i * 7) ^ j; } }
+
+/**
+ * one client thread: REQUESTS_PER_THREAD requests (a write, then 3 reads that must return what was written), one at a time
+ */
+void client(NT3H1x01_worker* worker, uint8_t thread, runResult* result, std::mutex* resultMutex) {
+  std::vector<uint32_t> latencies;  uint32_t errors = 0,  mismatches = 0;
+  uint8_t written[NT3H1x01_BLOCK_SIZE];
+  NT3H1x01_workerRequest request;
+  for(uint16_t i=0; i<REQUESTS_PER_THREAD; i++) {
+    if((i % 4) == 0) { makeBlock(thread, i, written);  request.prepareWriteBlock(blockOf(thread), written); }
+    else { request.prepareReadBlock(blockOf(thread)); }
+    if(!worker->tag._errGood(worker->submitAndWait(request))) { errors++;  continue; }
+    latencies.push_back(request.latency());
+    if(((i % 4) != 0) && (memcmp(request.buff, written, NT3H1x01_BLOCK_SIZE) != 0)) { mismatches++; }
+  }
+  std::lock_guard<std::mutex> lock(*resultMutex);
+  result->latencies.insert(result->latencies.end(), latencies.begin(), latencies.end());
+  result->errors += errors;  result->mismatches += mismatches;
+}
+
+/**
+ * the same requests as 1 client, as direct calls (no worker)
+ */
+runResult runDirect(NT3H1x01_thijs& nfc) {
+  runResult result;  uint8_t written[NT3H1x01_BLOCK_SIZE],  readBack[NT3H1x01_BLOCK_SIZE];
+  restartPacing();
+  auto start = std::chrono::steady_clock::now();
+  for(uint16_t i=0; i<REQUESTS_PER_THREAD; i++) {
+    uint32_t requestStart = NT3H1x01_WORKER_MICROS();
+    NT3H1x01_ERR_RETURN_TYPE err;
+    if((i % 4) == 0) { makeBlock(0, i, written);  err = nfc.writeMemBlock(blockOf(0), written); }
+    else { err = nfc.requestMemBlock(blockOf(0), readBack); }
+    if(!nfc._errGood(err)) { result.errors++;  continue; }
+    result.latencies.push_back(NT3H1x01_WORKER_MICROS() - requestStart);
+    if(((i % 4) != 0) && (memcmp(readBack, written, NT3H1x01_BLOCK_SIZE) != 0)) { result.mismatches++; }
+  }
+  result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  return(result);
+}
+
+/**
+ * threadCount clients sharing the tag through the worker
+ */
+runResult runThreads(NT3H1x01_worker& worker, uint8_t threadCount) {
+  runResult result;  std::mutex resultMutex;  std::vector<std::thread> threads;
+  restartPacing();
+  auto start = std::chrono::steady_clock::now();
+  for(uint8_t t=0; t<threadCount; t++) { threads.push_back(std::thread(client, &worker, t, &result, &resultMutex)); }
+  for(uint8_t t=0; t<threadCount; t++) { threads[t].join(); }
+  result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  return(result);
+}
+
+/**
+ * print a run
+ * @return true if every request succeeded and read back the right data
+ */
+bool report(const char* name, runResult& result, uint16_t expected) {
+  std::sort(result.latencies.begin(), result.latencies.end());
+  uint64_t total = 0;  for(uint32_t latency : result.latencies) { total += latency; }
+  size_t count = result.latencies.size();
+  bool good = (result.errors == 0) && (result.mismatches == 0) && (count == expected);
+  printf("%-20s %5u %8.0f %8.0f %8u %8u %8u  %s\n", name, (unsigned)count, count / result.seconds, count ? (double)total / count : 0.0,
+         count ? result.latencies[count / 2] : 0, count ? result.latencies[(count * 99) / 100] : 0, count ? result.latencies[count - 1] : 0,
+         good ? "OK" : "FAIL");
+  return(good);
+}
+
+//// requests submitted from the worker itself:
+struct nestedArgs
+{
+  NT3H1x01_worker* worker;
+  uint8_t data[100];  uint16_t pos = 0,  size = 0;  // (streamed to the tag and back)
+  bool good = false;
+  static size_t read(uint8_t buff[], size_t length, void* context) {
+    nestedArgs& self = *((nestedArgs*)context);
+    if(length > (size_t)(sizeof(self.data) - self.pos)) { length = sizeof(self.data) - self.pos; }
+    memcpy(buff, &self.data[self.pos], length);  self.pos += length;
+    return(length);
+  }
+  static size_t write(const uint8_t data[], size_t length, void* context) {
+    nestedArgs& self = *((nestedArgs*)context);
+    for(size_t i=0; i<length; i++) { if((self.size < sizeof(self.data)) && (data[i] != self.data[self.size])) { self.good = false; }  self.size++; }
+    return(length);
+  }
+};
+/**
+ * a job that uses the worker itself (which has to run the requests inline)
+ */
+NT3H1x01_ERR_RETURN_TYPE nestedJob(NT3H1x01_thijs& tag, NT3H1x01_workerRequest& request) {
+  nestedArgs& args = *((nestedArgs*)request.userArg);
+  NT3H1x01_workerRequest inner;  inner.prepareReadSess(NT3H1x01_SESS_REGS_NS_REG_BYTE);
+  NT3H1x01_ERR_RETURN_TYPE err = args.worker->submitAndWait(inner);
+  if(!tag._errGood(err) || !inner.isDone()) { return(NT3H1x01_ERR_RETURN_TYPE_FAIL); }
+  NT3H1x01_streamResult result;
+  err = args.worker->streamToTag(nestedArgs::read, &args, result, 0, false);
+  if(!tag._errGood(err) || (result.bytes != sizeof(args.data))) { return(NT3H1x01_ERR_RETURN_TYPE_FAIL); }
+  args.good = true;
+  err = args.worker->streamFromTag(nestedArgs::write, &args, result);
+  if(!tag._errGood(err) || (args.size < sizeof(args.data))) { args.good = false; }
+  return(err);
+}
+
+int main() {
+  bool good = true;
+  NT3H1x01_thijs nfc(true);  nfc.init(simTag);
+  simTag.enableTiming(400000);
+  simTag.betweenTransactions = pace;  simTag.betweenTransactionsContext = &simTag;
+  printf("%-20s %5s %8s %8s %8s %8s %8s   (latency in microseconds)\n", "", "reqs", "reqs/s", "avg", "p50", "p99", "max");
+  runResult direct = runDirect(nfc);
+  good &= report("direct, 1 thread", direct, REQUESTS_PER_THREAD);
+
+  NT3H1x01_worker worker(nfc);
+  worker.start();
+  for(uint8_t threadCount=1; threadCount<=MAX_THREADS; threadCount*=2) {
+    runResult result = runThreads(worker, threadCount);
+    char name[24];  snprintf(name, sizeof(name), "worker, %u thread%s", threadCount, (threadCount > 1) ? "s" : "");
+    good &= report(name, result, REQUESTS_PER_THREAD * threadCount);
+  }
+
+  //// requests from the worker itself:
+  nestedArgs args;  args.worker = &worker;
+  for(uint8_t i=0; i<sizeof(args.data); i++) { args.data[i] = i * 3; }
+  NT3H1x01_workerRequest request;  request.prepareJob(nestedJob, &args);
+  NT3H1x01_ERR_RETURN_TYPE err = worker.submitAndWait(request);
+  bool nestedGood = nfc._errGood(err) && args.good;
+  printf("requests from a job (inline): %s\n", nestedGood ? "OK" : "FAIL");
+  good &= nestedGood;
+  worker.stop();
+  simTag.betweenTransactions = NULL;
+  printf(good ? "worker OK\n" : "FAILED\n");
+  return(good ? 0 : 1);
+}